@@ -7,6 +7,9 @@
  */
 #include "zFunction.h"
 #include "zVmEngine.h"
+#include "zVmDecoded.h"
+#include "zVmCompact.h"
+#include "zVmJit.h"
 #include "zLog.h"
 #include "zTypeManager.h"
 
@@ -135,19 +138,41 @@ bool zFunction::loadUnencodedText(const char* text, size_t len) {
 namespace {
 // 清理运行态解码缓存，确保下一次 loadEncodedData 从干净状态开始。
 void resetDecodedRuntimeState(zFunction& function) {
+    // arena 中的数组不归本对象释放，先摘除。
+    function.detachArenaStorage();
     // 释放寄存器数组。
     delete[] function.register_list;
     function.register_list = nullptr;
     // 释放指令数组。
     delete[] function.inst_list;
     function.inst_list = nullptr;
+    // 释放紧凑指令流（由旧 inst_list 转码而来）。
+    releaseCompactFunction(&function);
     // 释放分支数组。
     delete[] function.branch_words_ptr;
     function.branch_words_ptr = nullptr;
+    // 释放预解码记录（依赖旧 inst_list，必须同步失效）。
+    releaseDecodedFunction(&function);
+    // 校验结论依赖旧指令流，一并作废。
+    function.verified = false;
+    // 基线 JIT 产物同样依赖旧指令流，释放后重新计数。
+    releaseJitCode(function.jit_code.exchange(nullptr));
+    function.jit_state.store(VM_JIT_STATE_COLD);
+    function.jit_calls.store(0);
+    // 预设寄存器下标与清零区间随 register_list 失效。
+    function.register_init_list.clear();
+    function.register_zero_runs.clear();
+    // 间接跳转稠密索引随查找表失效。
+    function.branch_lookup_dense.clear();
+    function.branch_lookup_base = 0;
     // 释放类型相关资源。
     function.releaseTypeResources();
     // 函数签名指针失效。
     function.function_sig_type = nullptr;
+    // 模块绑定随私有分支表失效，需重新 cacheFunction 绑定。
+    function.module = nullptr;
+    function.module_state = nullptr;
+    function.module_branch_addrs.clear();
     // 重置计数字段，防止旧值污染。
     function.register_count = 0;
     function.inst_count = 0;
@@ -164,13 +189,16 @@ bool zFunction::parseFromStream(std::istream& in) {
     resetDecodedRuntimeState(*this);
     // 清空函数地址缓存。
     fun_addr_ = 0;
-    // 清空文本解析缓存。
-    register_ids_.clear();
-    type_tags_.clear();
-    branch_words_.clear();
-    branch_addrs_.clear();
-    inst_words_.clear();
+    // 文本解析缓存：解析完成后移入编码字段，不在对象上另存副本。
+    std::vector<uint32_t> parsed_register_ids;
+    std::vector<uint32_t> parsed_type_tags;
+    std::vector<uint32_t> parsed_branch_words;
+    std::vector<uint64_t> parsed_branch_addrs;
+    std::vector<uint32_t> parsed_inst_words;
+#if VM_FUNCTION_DIAGNOSTICS
+    // 诊断构建：逐行指令缓存保留在对象上。
     inst_lines_.clear();
+#endif
 
     bool in_inst_list = false;
     // 记录文本中的计数字段，用于后续一致性校验。
@@ -201,7 +229,7 @@ bool zFunction::parseFromStream(std::istream& in) {
                 continue;
             }
             if (trimmed.find("static const uint32_t reg_id_list[]") != std::string::npos) {
-                if (!parseArrayValues32(trimmed, register_ids_)) return false;
+                if (!parseArrayValues32(trimmed, parsed_register_ids)) return false;
                 continue;
             }
             if (trimmed.find("static const uint32_t reg_id_count") != std::string::npos) {
@@ -209,7 +237,7 @@ bool zFunction::parseFromStream(std::istream& in) {
                 continue;
             }
             if (trimmed.find("static const uint32_t type_id_list[]") != std::string::npos) {
-                if (!parseArrayValues32(trimmed, type_tags_)) return false;
+                if (!parseArrayValues32(trimmed, parsed_type_tags)) return false;
                 continue;
             }
             if (trimmed.find("static const uint32_t type_id_count") != std::string::npos) {
@@ -217,7 +245,7 @@ bool zFunction::parseFromStream(std::istream& in) {
                 continue;
             }
             if (trimmed.find("uint32_t branch_id_list") != std::string::npos && trimmed.find('{') != std::string::npos) {
-                if (!parseArrayValues32(trimmed, branch_words_)) return false;
+                if (!parseArrayValues32(trimmed, parsed_branch_words)) return false;
                 continue;
             }
             if (trimmed.find("static const uint32_t branch_id_count") != std::string::npos) {
@@ -225,7 +253,7 @@ bool zFunction::parseFromStream(std::istream& in) {
                 continue;
             }
             if (trimmed.find("uint64_t branch_addr_list") != std::string::npos && trimmed.find('{') != std::string::npos) {
-                if (!parseArrayValues64(trimmed, branch_addrs_)) return false;
+                if (!parseArrayValues64(trimmed, parsed_branch_addrs)) return false;
                 continue;
             }
             if (trimmed.find("static const uint32_t inst_id_count") != std::string::npos) {
@@ -256,7 +284,9 @@ bool zFunction::parseFromStream(std::istream& in) {
 
             if (value_part.empty()) continue;
 
+#if VM_FUNCTION_DIAGNOSTICS
             std::vector<uint32_t> words;
+#endif
             std::stringstream ss(value_part);
             std::string token;
             // 每行可包含多个 uint32，按逗号展开。
@@ -264,53 +294,60 @@ bool zFunction::parseFromStream(std::istream& in) {
                 std::string token_trimmed = trimCopy(token);
                 if (token_trimmed.empty()) continue;
                 unsigned long long value = std::strtoull(token_trimmed.c_str(), nullptr, 0);
+#if VM_FUNCTION_DIAGNOSTICS
                 // 行级缓存（用于回写格式）。
                 words.push_back(static_cast<uint32_t>(value));
+#endif
                 // 扁平缓存（用于执行）。
-                inst_words_.push_back(static_cast<uint32_t>(value));
+                parsed_inst_words.push_back(static_cast<uint32_t>(value));
             }
 
+#if VM_FUNCTION_DIAGNOSTICS
             // 非空行写入逐行缓存。
             if (!words.empty()) {
                 inst_lines_.push_back(std::move(words));
             }
+#endif
         }
     }
 
     // 关键字段至少要有寄存器/类型/指令。
-    if (register_ids_.empty() || type_tags_.empty() || inst_words_.empty()) {
+    if (parsed_register_ids.empty() || parsed_type_tags.empty() || parsed_inst_words.empty()) {
         return false;
     }
 
     // 允许无分支函数：branch_id_count 为 0 时，branch_id_list 允许为空。
-    if (branch_id_count > 0 && branch_words_.empty()) {
+    if (branch_id_count > 0 && parsed_branch_words.empty()) {
         return false;
     }
 
     // 与文本计数字段交叉校验。
-    if (reg_id_count != 0 && reg_id_count != static_cast<uint32_t>(register_ids_.size())) return false;
-    if (type_id_count != 0 && type_id_count != static_cast<uint32_t>(type_tags_.size())) return false;
-    if (branch_id_count != static_cast<uint32_t>(branch_words_.size())) return false;
-    if (inst_id_count != 0 && inst_id_count != static_cast<uint32_t>(inst_words_.size())) return false;
+    if (reg_id_count != 0 && reg_id_count != static_cast<uint32_t>(parsed_register_ids.size())) return false;
+    if (type_id_count != 0 && type_id_count != static_cast<uint32_t>(parsed_type_tags.size())) return false;
+    if (branch_id_count != static_cast<uint32_t>(parsed_branch_words.size())) return false;
+    if (inst_id_count != 0 && inst_id_count != static_cast<uint32_t>(parsed_inst_words.size())) return false;
 
     // 将文本解析结果同步到 zFunctionData 字段，统一后续执行入口。
     marker = 0;
-    register_count = static_cast<uint32_t>(register_ids_.size());
+    register_count = static_cast<uint32_t>(parsed_register_ids.size());
     first_inst_count = 0;
     first_inst_opcodes.clear();
     external_init_words.clear();
-    type_count = static_cast<uint32_t>(type_tags_.size());
-    type_tags = type_tags_;
+    type_count = static_cast<uint32_t>(parsed_type_tags.size());
+    type_tags = std::move(parsed_type_tags);
     init_value_count = 0;
     init_value_words.clear();
-    inst_count = static_cast<uint32_t>(inst_words_.size());
-    inst_words = inst_words_;
-    branch_count = static_cast<uint32_t>(branch_words_.size());
-    branch_words = branch_words_;
+    inst_count = static_cast<uint32_t>(parsed_inst_words.size());
+    inst_words = std::move(parsed_inst_words);
+    branch_count = static_cast<uint32_t>(parsed_branch_words.size());
+    branch_words = std::move(parsed_branch_words);
     branch_lookup_words.clear();
     branch_lookup_addrs.clear();
-    zFunctionData::branch_addrs = branch_addrs_;
+    zFunctionData::branch_addrs = std::move(parsed_branch_addrs);
     function_offset = fun_addr_;
+#if VM_FUNCTION_DIAGNOSTICS
+    register_ids_ = parsed_register_ids;
+#endif
 
     // 直接构建运行态数组，保证文本/编码两条加载路径走同一执行入口。
     if (register_count > 0) {
@@ -318,25 +355,21 @@ bool zFunction::parseFromStream(std::istream& in) {
         register_list = new VMRegSlot[register_count];
         std::memset(register_list, 0, sizeof(VMRegSlot) * register_count);
     }
+    // 文本格式没有寄存器初值：整段都需清零。
+    buildRegisterZeroRuns();
 
-    // 每个函数独立类型池，避免跨函数共享状态。
-    std::unique_ptr<zTypeManager> typePool = std::make_unique<zTypeManager>();
-    zType** typeList = nullptr;
+    // 类型码直接映射到进程级驻留描述符，函数之间共享，无需逐项分配。
+    const zType** typeList = nullptr;
     if (type_count > 0) {
         // 分配类型表指针数组。
-        typeList = new zType*[type_count]();
+        typeList = new const zType*[type_count]();
         for (uint32_t i = 0; i < type_count; i++) {
-            // 由类型码构造类型对象。
-            typeList[i] = typePool->createFromCode(type_tags[i]);
+            typeList[i] = zTypeManager::internFromCode(type_tags[i]);
         }
     }
 
-    // 首类型是函数签名结构时，缓存到 function_sig_type。
-    if (type_count > 0 && typeList && typeList[0] && typeList[0]->kind == TYPE_KIND_STRUCT) {
-        function_sig_type = reinterpret_cast<FunctionStructType*>(typeList[0]);
-    } else {
-        function_sig_type = nullptr;
-    }
+    // 驻留表只含标量描述符：函数签名结构体需经 setTypePool 注入的类型池创建。
+    function_sig_type = nullptr;
 
     // 固化 inst_list。
     if (inst_count > 0) {
@@ -350,10 +383,12 @@ bool zFunction::parseFromStream(std::istream& in) {
     }
     // 绑定运行时类型表。
     type_list = typeList;
-    // 转移类型池所有权，供后续释放。
-    setTypePool(std::move(typePool));
-    // ext_list 指向分支地址缓存（为空则置空）。
-    ext_list = !branch_addrs_.empty() ? branch_addrs_.data() : nullptr;
+    // ext_list 指向分支地址表（为空则置空）。
+    ext_list = !zFunctionData::branch_addrs.empty() ? zFunctionData::branch_addrs.data() : nullptr;
+#if !VM_FUNCTION_DIAGNOSTICS
+    // 运行态数组已固化：编码字段不再需要。
+    releaseEncodedPayload();
+#endif
 
     return true;
 }
@@ -374,10 +409,8 @@ bool zFunction::loadEncodedData(const uint8_t* data, uint64_t len, uint64_t* ext
         LOGE("deserializeEncoded failed: %s", decode_error.c_str());
         return false;
     }
-    // 覆盖当前对象的编码字段。
-    static_cast<zFunctionData&>(*this) = decoded_data;
-    // 同步 branch 地址缓存。
-    branch_addrs_ = zFunctionData::branch_addrs;
+    // 覆盖当前对象的编码字段（移动，不留第二份）。
+    static_cast<zFunctionData&>(*this) = std::move(decoded_data);
 
     // 2) 准备寄存器初值缓存。
     std::unique_ptr<VMRegSlot[]> tempRegisters;
@@ -402,14 +435,13 @@ bool zFunction::loadEncodedData(const uint8_t* data, uint64_t len, uint64_t* ext
         }
     }
 
-    // 4) 构建本函数独立类型池与 type_list。
-    std::unique_ptr<zTypeManager> typePool = std::make_unique<zTypeManager>();
-    zType** typeList = nullptr;
+    // 4) 构建 type_list：元素指向进程级驻留描述符，所有函数共享。
+    const zType** typeList = nullptr;
     if (type_count > 0) {
-        typeList = new zType*[type_count]();
+        typeList = new const zType*[type_count]();
         for (uint32_t i = 0; i < type_count; i++) {
-            // 按类型码构造运行时类型对象。
-            typeList[i] = typePool->createFromCode(type_tags[i]);
+            // 按类型码取驻留描述符。
+            typeList[i] = zTypeManager::internFromCode(type_tags[i]);
         }
     }
 
@@ -472,23 +504,23 @@ bool zFunction::loadEncodedData(const uint8_t* data, uint64_t len, uint64_t* ext
     // 6) 恢复函数地址（fun_addr）。
     setFunctionAddress(function_offset);
 
-    // 7) 从 type_list 按约定推导 function_sig_type（首元素为函数签名结构体类型）。
-    FunctionStructType* functionList = nullptr;
-    if (type_count > 0 && typeList && typeList[0]) {
-        // 约定：type_list[0] 若为 STRUCT 则可视为函数签名类型。
-        if (typeList[0]->kind == TYPE_KIND_STRUCT) {
-            functionList = reinterpret_cast<FunctionStructType*>(typeList[0]);
-        }
-    }
-
-    function_sig_type = functionList;
+    // 7) 驻留表只含标量描述符，function_sig_type 不从 type_list 推导（需经 setTypePool 注入）。
+    function_sig_type = nullptr;
 
     // 8) 固化运行态数组：register/inst/branch/type。
     if (register_count > 0 && tempRegisters) {
         // 把临时寄存器初值固化为运行态寄存器数组。
         register_list = new VMRegSlot[register_count];
         std::memcpy(register_list, tempRegisters.get(), sizeof(VMRegSlot) * register_count);
+        // 记录非零槽位，执行时按下标稀疏复制。
+        for (uint32_t regIdx = 0; regIdx < register_count; ++regIdx) {
+            const VMRegSlot& slot = register_list[regIdx];
+            if (slot.value != 0 || slot.reserved != 0 || slot.ownership != 0) {
+                register_init_list.push_back(regIdx);
+            }
+        }
     }
+    buildRegisterZeroRuns();
 
     // 先用 unique_ptr 承接，避免中途异常泄漏。
     std::unique_ptr<uint32_t[]> instList;
@@ -506,26 +538,97 @@ bool zFunction::loadEncodedData(const uint8_t* data, uint64_t len, uint64_t* ext
     inst_list = instList.release();
     branch_words_ptr = branchList.release();
     type_list = typeList;
-    setTypePool(std::move(typePool));
-    // 优先使用解析出的 branch_addrs_，回退 externalInitArray 兼容旧逻辑。
-    ext_list = !branch_addrs_.empty() ? branch_addrs_.data() : externalInitArray;
+    // 优先使用解析出的 branch_addrs，回退 externalInitArray 兼容旧逻辑。
+    ext_list = !zFunctionData::branch_addrs.empty() ? zFunctionData::branch_addrs.data() : externalInitArray;
+#if !VM_FUNCTION_DIAGNOSTICS
+    // 运行态数组已固化：指令/分支 word、类型码与初值流不再需要。
+    releaseEncodedPayload();
+#endif
 
     return true;
 }
 
 // 判断当前是否没有解析到任何指令数据。
 bool zFunction::empty() const {
-    // 只要运行态有有效 inst_list 与 inst_count，就不算空。
-    if (inst_count > 0 && inst_list != nullptr) {
+    // 运行态有有效指令流（word 或紧凑形式）与 inst_count 才不算空；编码字段可能已释放，不作判断依据。
+    return inst_count == 0 || (inst_list == nullptr && inst_compact == nullptr);
+}
+
+// 释放编码字段：swap 到临时对象保证容量真正归还。
+void zFunction::releaseEncodedPayload() {
+    std::string().swap(function_name);
+    std::vector<uint8_t>().swap(function_bytes);
+    std::vector<uint32_t>().swap(first_inst_opcodes);
+    std::vector<uint32_t>().swap(external_init_words);
+    std::vector<uint32_t>().swap(type_tags);
+    std::vector<uint32_t>().swap(init_value_words);
+    std::vector<uint32_t>().swap(inst_words);
+    std::vector<uint32_t>().swap(branch_words);
+}
+
+// register_init_list 升序：相邻预设下标之间的空隙即为需清零的区间。
+void zFunction::buildRegisterZeroRuns() {
+    register_zero_runs.clear();
+    uint32_t begin = 0;
+    for (uint32_t regIdx : register_init_list) {
+        if (regIdx > begin) {
+            register_zero_runs.push_back(begin);
+            register_zero_runs.push_back(regIdx);
+        }
+        begin = regIdx + 1;
+    }
+    if (register_count > begin) {
+        register_zero_runs.push_back(begin);
+        register_zero_runs.push_back(register_count);
+    }
+}
+
+// 构建间接跳转稠密索引：函数地址连续且按 4 字节对齐，按偏移直接下标寻址。
+bool zFunction::buildBranchLookupIndex() {
+    branch_lookup_dense.clear();
+    branch_lookup_base = 0;
+    const size_t count = branch_lookup_addrs.size();
+    if (count == 0 || branch_lookup_words.size() != count) {
+        return false;
+    }
+
+    // 地址跨度决定数组长度。
+    const auto range = std::minmax_element(branch_lookup_addrs.begin(), branch_lookup_addrs.end());
+    const uint64_t base = *range.first;
+    const uint64_t span = *range.second - base;
+    // 跨度远大于表项数（非连续地址）时不建索引，避免稀疏大数组。
+    const uint64_t maxSlots = static_cast<uint64_t>(count) * 4u + 256u;
+    if ((span >> 2) >= maxSlots) {
+        LOGW("buildBranchLookupIndex skipped: sparse span=0x%llx count=%zu fun_addr=0x%llx",
+             static_cast<unsigned long long>(span), count, static_cast<unsigned long long>(fun_addr_));
         return false;
     }
-    // 否则按解析缓存 inst_words_ 是否为空判断。
-    return inst_words_.empty();
+
+    std::vector<uint32_t> dense(static_cast<size_t>(span >> 2) + 1u, VM_BRANCH_LOOKUP_MISS);
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t delta = branch_lookup_addrs[i] - base;
+        if ((delta & 3u) != 0) {
+            // 未对齐地址无法按槽位寻址，整体回退线性表。
+            LOGW("buildBranchLookupIndex skipped: unaligned addr=0x%llx fun_addr=0x%llx",
+                 static_cast<unsigned long long>(branch_lookup_addrs[i]),
+                 static_cast<unsigned long long>(fun_addr_));
+            return false;
+        }
+        uint32_t& slot = dense[static_cast<size_t>(delta >> 2)];
+        // 重复地址保留首项，与线性表“首个命中”语义一致。
+        if (slot == VM_BRANCH_LOOKUP_MISS) {
+            slot = branch_lookup_words[i];
+        }
+    }
+
+    branch_lookup_dense = std::move(dense);
+    branch_lookup_base = base;
+    return true;
 }
 
 // 只读访问分支地址列表。
 const std::vector<uint64_t>& zFunction::branchAddrs() const {
-    return branch_addrs_;
+    return zFunctionData::branch_addrs;
 }
 
 uint64_t zFunction::functionAddress() const {
@@ -543,14 +646,30 @@ void zFunction::setTypePool(std::unique_ptr<zTypeManager> pool) {
     type_pool_ = std::move(pool);
 }
 
+// 摘除 arena 数组：只置空指针，内存由 arena 整体回收；计数字段留给后续 reset/destroy 处理。
+void zFunction::detachArenaStorage() {
+    if (!arena_backed) {
+        return;
+    }
+    register_list = nullptr;
+    inst_list = nullptr;
+    inst_compact = nullptr;
+    inst_wide_pool = nullptr;
+    branch_words_ptr = nullptr;
+    type_list = nullptr;
+    decoded_list = nullptr;
+    decoded_pc_index = nullptr;
+    decoded_switch_pool = nullptr;
+    arena_backed = false;
+}
+
 void zFunction::releaseTypeResources() {
-    // type_list 非空时先释放其元素。
+    // type_list 非空时释放指针数组（驻留描述符常驻；池内对象随 type_pool_ 释放）。
     if (type_list != nullptr) {
         if (type_pool_) {
             // 有类型池时由类型池统一释放，保持创建/销毁路径一致。
             type_pool_->freeTypeList(type_list, type_count);
         } else {
-            // 无类型池时退化为仅释放指针数组（元素生命周期由外部兜底）。
             delete[] type_list;
         }
         type_list = nullptr;
@@ -10,6 +10,7 @@
 
 #include "zFunctionData.h"  // 编码字段与序列化能力。
 
+#include <atomic>   // JIT 调用计数与发布。
 #include <cstddef>  // size_t。
 #include <cstdint>  // 固定宽度整数类型。
 #include <istream>  // std::istream。
@@ -17,10 +18,21 @@
 #include <string>   // std::string。
 #include <vector>   // std::vector。
 
+// 诊断构建开关：开启时函数对象保留完整编码字段与文本逐行指令缓存（调试/回写用）；
+// 默认关闭，加载完成后只保留执行所需的运行态数据。
+#ifndef VM_FUNCTION_DIAGNOSTICS
+#define VM_FUNCTION_DIAGNOSTICS 0
+#endif
+
 struct VMRegSlot;         // VM 寄存器槽结构（在 zVmEngine.h 定义）。
 class zType;              // 类型系统基类。
 class FunctionStructType; // 函数签名结构类型。
 class zTypeManager;       // 类型池管理器。
+struct VMDecodedInst;     // 预解码记录（在 zVmDecoded.h 定义）。
+struct VMCallSiteCache;   // 调用点内联缓存（在 zVmDecoded.h 定义）。
+struct zVmJitCode;        // 基线 JIT 编译产物（在 zVmJit.h 定义）。
+struct zVmModule;         // 模块执行上下文（在 zVmEngine.h 定义）。
+struct zVmModuleState;    // 模块状态快照（在 zVmEngine.h 定义）。
 
 class zFunction : public zFunctionData {
 public:
@@ -29,14 +41,60 @@ public:
     FunctionStructType* function_sig_type = nullptr;
     // 运行时寄存器数组。
     VMRegSlot* register_list = nullptr;
-    // 扁平化指令流。
+    // 扁平化指令流（转码为紧凑流后释放为空）。
     uint32_t* inst_list = nullptr;
+    // 16 位紧凑指令流（与 inst_list 槽位一一对应，见 zVmCompact.h；为空表示使用 inst_list）。
+    uint16_t* inst_compact = nullptr;
+    // 紧凑流宽值池（槽位 >= VM_COMPACT_ESCAPE 时按下标取值）。
+    uint32_t* inst_wide_pool = nullptr;
+    // 宽值池项数。
+    uint32_t inst_wide_count = 0;
     // 分支 ID -> PC 映射数组。
     uint32_t* branch_words_ptr = nullptr;
-    // 运行时类型表。
-    zType** type_list = nullptr;
-    // 分支地址表指针（通常指向 branch_addrs_ 内存）。
+    // 运行时类型表（元素通常指向 zTypeManager::internFromCode 驻留描述符）。
+    const zType** type_list = nullptr;
+    // 分支地址表指针（通常指向 zFunctionData::branch_addrs 内存）。
     uint64_t* ext_list = nullptr;
+    // 预解码记录数组（末尾附带一条哨兵记录；为空表示仅 word 解释）。
+    VMDecodedInst* decoded_list = nullptr;
+    // 预解码记录条数（不含哨兵）。
+    uint32_t decoded_count = 0;
+    // word pc -> 记录下标（长度 inst_count）。
+    uint32_t* decoded_pc_index = nullptr;
+    // OP_SWITCH 预解码 case 表池（跳转表/有序表/线性表，按记录 operands 偏移寻址；无 switch 时为空）。
+    uint32_t* decoded_switch_pool = nullptr;
+    // case 表池 word 数。
+    uint32_t decoded_switch_pool_size = 0;
+    // OP_CALL 调用点内联缓存（按记录 target 寻址；运行期被多线程并发填充；无调用点时为空）。
+    VMCallSiteCache* decoded_call_sites = nullptr;
+    // 调用点缓存个数。
+    uint32_t decoded_call_site_count = 0;
+    // 指令流已通过加载期校验（verifyFunction），执行时可走免检处理函数。
+    bool verified = false;
+    // 只读运行态数组（寄存器镜像/指令流/分支表/类型表/预解码记录）位于模块 arena：随 arena 整体释放，不能逐个 delete[]。
+    bool arena_backed = false;
+    // 预设阶段写入过的寄存器下标（执行时只复制这些槽位，其余保持清零）。
+    std::vector<uint32_t> register_init_list;
+    // 预设阶段不写入的寄存器区间，[begin, end) 成对存放：复用帧时只清零这些槽位的值。
+    std::vector<uint32_t> register_zero_runs;
+    // 间接跳转稠密索引：(地址 - branch_lookup_base) / 4 -> 目标 pc，空洞为 VM_BRANCH_LOOKUP_MISS。
+    std::vector<uint32_t> branch_lookup_dense;
+    // 稠密索引起始地址（branch_lookup_addrs 最小值，模块相对）。
+    uint64_t branch_lookup_base = 0;
+    // 基线 JIT：累计调用次数（达到引擎阈值后触发一次编译）。
+    std::atomic<uint32_t> jit_calls{0};
+    // 基线 JIT 编译状态（VM_JIT_STATE_*）。
+    std::atomic<uint8_t> jit_state{0};
+    // 已发布的编译产物（为空表示解释执行）。
+    std::atomic<zVmJitCode*> jit_code{nullptr};
+    // 所属模块执行上下文（cacheFunction 绑定；为空时执行期按 so 名查找）。
+    const zVmModule* module = nullptr;
+    // 绑定模块时叠加基址后的私有 branch 地址表（模块无共享表时使用）。
+    std::vector<uint64_t> module_branch_addrs;
+    // module_branch_addrs 重定位所用基址（模块基址变化后不再直接使用）。
+    uint64_t module_branch_base = 0;
+    // 热替换发布的函数固定引用构建时的模块状态（随所在代函数集一起退役；为空时跟随模块当前状态）。
+    const zVmModuleState* module_state = nullptr;
 
     // 从内存文本中加载程序数据（用于 Android assets 读取后直接解析）。
     bool loadUnencodedText(const char* text, size_t len);
@@ -48,6 +106,9 @@ public:
     // 判断当前对象是否还没有可执行指令数据。
     bool empty() const;
 
+    // 由 branch_lookup_addrs/words 构建间接跳转稠密索引；地址非 4 字节对齐或跨度过稀时保持为空（回退线性表）。
+    bool buildBranchLookupIndex();
+
     // 以只读引用方式返回解析后的分支地址列表。
     const std::vector<uint64_t>& branchAddrs() const;
     // 返回当前函数地址标识（fun_addr）。
@@ -55,6 +116,13 @@ public:
     // 设置当前函数地址标识（fun_addr）。
     void setFunctionAddress(uint64_t functionAddress);
 
+    // 释放只在加载/序列化阶段使用的编码字段（指令 word、分支 word、类型码、初值流等），运行态数组建立后调用；
+    // 保留执行仍需的 branch_addrs 与间接跳转查找表。诊断构建下加载流程不调用它。
+    void releaseEncodedPayload();
+
+    // 摘除位于模块 arena 的数组指针（不释放；arena 负责回收），之后的释放流程只处理堆上资源。
+    void detachArenaStorage();
+
     // 注入类型池所有权（用于释放 type_list）。
     void setTypePool(std::unique_ptr<zTypeManager> pool);
     // 释放 type_list 与类型池资源。
@@ -77,21 +145,18 @@ private:
     // 从输入流执行完整解析流程（供文件加载与内存加载复用）。
     bool parseFromStream(std::istream& in);
 
+    // 按 register_init_list 求补集，重建 register_zero_runs。
+    void buildRegisterZeroRuns();
+
 private:
-    // 类型池对象，负责 type_list 元素生命周期。
+    // 类型池对象，负责注入的组合类型（结构体/调用签名等）生命周期；标量类型走驻留表无需类型池。
     std::unique_ptr<zTypeManager> type_pool_;
+#if VM_FUNCTION_DIAGNOSTICS
     // 文本导出中的寄存器 ID 列表缓存。
     std::vector<uint32_t> register_ids_;
-    // 文本导出中的类型标签列表缓存。
-    std::vector<uint32_t> type_tags_;
-    // 文本导出中的分支 word 列表缓存。
-    std::vector<uint32_t> branch_words_;
-    // 文本导出中的分支地址列表缓存。
-    std::vector<uint64_t> branch_addrs_;
-    // 文本导出中的扁平指令流缓存。
-    std::vector<uint32_t> inst_words_;
     // 文本导出中的逐行指令缓存（调试/回写用）。
     std::vector<std::vector<uint32_t>> inst_lines_;
+#endif
     // 函数地址缓存。
     uint64_t fun_addr_ = 0;
 };
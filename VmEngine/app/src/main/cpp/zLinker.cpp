@@ -55,6 +55,31 @@ inline ElfW(Addr) PageEnd(ElfW(Addr) addr) {
     return PageStart(addr + kPageSize - 1);
 }
 
+// AArch64 PLT 桩指令模板（lld/bfd 一致）：
+//   [bti c]
+//   adrp x16, GOT页
+//   ldr  x17, [x16, #槽位页内偏移]
+//   add  x16, x16, #槽位页内偏移
+//   br   x17
+constexpr uint32_t kInsnBtiC = 0xD503245Fu;
+// adrp x16：op=1, Rd=16（immlo/immhi 置零后比较）。
+constexpr uint32_t kInsnAdrpX16Mask = 0x9F00001Fu;
+constexpr uint32_t kInsnAdrpX16 = 0x90000010u;
+// ldr x17, [x16, #imm12*8]：imm12 置零后比较。
+constexpr uint32_t kInsnLdrX17X16Mask = 0xFFC003FFu;
+constexpr uint32_t kInsnLdrX17X16 = 0xF9400211u;
+// br x17。
+constexpr uint32_t kInsnBrX17 = 0xD61F0220u;
+
+// 解码 adrp 的页偏移（有符号 21 位页号 << 12）。
+inline int64_t DecodeAdrpPageOffset(uint32_t insn) {
+    const uint64_t immlo = (insn >> 29) & 0x3u;
+    const uint64_t immhi = (insn >> 5) & 0x7FFFFu;
+    // 先拼成 21 位页号，再符号扩展。
+    const int64_t imm = static_cast<int64_t>(((immhi << 2) | immlo) << 43) >> 43;
+    return imm * static_cast<int64_t>(kPageSize);
+}
+
 inline int PFlagsToProt(ElfW(Word) flags) {
     // ELF 的 PF_R/PF_W/PF_X 转换为 mprotect 所需 PROT 位。
     return ((flags & PF_R) ? PROT_READ : 0) |
@@ -1131,6 +1156,50 @@ bool zLinker::LoadLibraryFromMemory(const char* soName, const uint8_t* soBytes,
     return LoadPreparedElf(soName);
 }
 
+bool zLinker::ResolvePltTarget(const soinfo* si, ElfW(Addr) address, ElfW(Addr)* outTarget) {
+    if (si == nullptr || outTarget == nullptr || si->plt_rela == nullptr || si->plt_rela_count == 0) {
+        return false;
+    }
+    // 桩最长 5 条指令，必须完整落在映像内。
+    constexpr size_t kMaxStubBytes = 5 * sizeof(uint32_t);
+    if (address < si->base || address >= si->base + si->size ||
+        si->base + si->size - address < kMaxStubBytes ||
+        (address & 0x3u) != 0) {
+        return false;
+    }
+    const uint32_t* insn = reinterpret_cast<const uint32_t*>(address);
+    ElfW(Addr) pc = address;
+    // 开启 BTI 的产物在桩首多一条 bti c。
+    if (insn[0] == kInsnBtiC) {
+        ++insn;
+        pc += sizeof(uint32_t);
+    }
+    if ((insn[0] & kInsnAdrpX16Mask) != kInsnAdrpX16 ||
+        (insn[1] & kInsnLdrX17X16Mask) != kInsnLdrX17X16 ||
+        insn[3] != kInsnBrX17) {
+        return false;
+    }
+    // GOT 槽位 = adrp 页基址 + ldr 的 8 字节缩放偏移。
+    const ElfW(Addr) page = (pc & kPageMask) + static_cast<ElfW(Addr)>(DecodeAdrpPageOffset(insn[0]));
+    const ElfW(Addr) slot = page + static_cast<ElfW(Addr)>(((insn[1] >> 10) & 0xFFFu) * sizeof(uint64_t));
+    // 槽位必须是本 so 的 JUMP_SLOT 重定位目标：保证读到的是已由 RelocateImage 写回的最终地址。
+    for (size_t i = 0; i < si->plt_rela_count; ++i) {
+        const ElfW(Rela)& rela = si->plt_rela[i];
+        if (ELFW(R_TYPE)(rela.r_info) != kRelAarch64JumpSlot ||
+            static_cast<ElfW(Addr)>(rela.r_offset + si->load_bias) != slot) {
+            continue;
+        }
+        const ElfW(Addr) target = *reinterpret_cast<const ElfW(Addr)*>(slot);
+        // 符号未解析时槽位只剩 addend，视为失败交给调用方回退。
+        if (target == 0) {
+            return false;
+        }
+        *outTarget = target;
+        return true;
+    }
+    return false;
+}
+
 soinfo* zLinker::GetSoinfo(const char* name) {
     // 只读查询接口：供外部按库名获取已加载 soinfo。
     if (name == nullptr || name[0] == '\0') {
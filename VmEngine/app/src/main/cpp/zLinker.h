@@ -121,6 +121,10 @@ public:
     // 按 so 名称查询已加载模块信息（不触发加载）。
     soinfo* GetSoinfo(const char* name);
 
+    // 若 address（运行时地址）是 si 内的 AArch64 PLT 桩，经已重定位的 GOT 槽位取其最终目标。
+    // 只认槽位为本 so JUMP_SLOT 重定位目标的标准桩；不是桩或符号未解析时返回 false。
+    static bool ResolvePltTarget(const soinfo* si, ElfW(Addr) address, ElfW(Addr)* outTarget);
+
 private:
     // ELF 文件读取阶段。
     // 打开并映射输入 ELF 文件。
@@ -9,6 +9,7 @@
 
 #include "zFileBytes.h"
 #include "zLog.h"
+#include "shared/bundle/zSoBinBundleProtocol.h"
 
 #include <cstring>
 #include <unordered_set>
@@ -49,8 +50,6 @@ struct SoBinBundleFooter {
 constexpr uint32_t kSoBinBundleHeaderMagic = 0x48424D56; // 'VMBH'
 // 尾部标识。
 constexpr uint32_t kSoBinBundleFooterMagic = 0x46424D56; // 'VMBF'
-// 当前支持的 bundle 版本。
-constexpr uint32_t kSoBinBundleVersion = 1;
 
 } // namespace
 
@@ -76,9 +75,10 @@ bool parseExpandedSoBundleBytes(
         LOGE("readFromExpandedSo failed to read footer");
         return false;
     }
-    // 校验尾部魔数与版本。
-    if (footer.magic != kSoBinBundleFooterMagic || footer.version != kSoBinBundleVersion) {
-        LOGE("readFromExpandedSo invalid footer magic/version");
+    // 校验尾部魔数与版本（接受 v1..当前版本，旧 bundle 只是没有 VM 目标标记表项）。
+    if (footer.magic != kSoBinBundleFooterMagic ||
+        !vmp::bundle::protocol::isSupportedSoBinBundleVersion(footer.version)) {
+        LOGE("readFromExpandedSo invalid footer magic/version: version=%u", footer.version);
         return false;
     }
 
@@ -100,9 +100,9 @@ bool parseExpandedSoBundleBytes(
         LOGE("readFromExpandedSo failed to read header");
         return false;
     }
-    // 校验头部魔数与版本。
-    if (header.magic != kSoBinBundleHeaderMagic || header.version != kSoBinBundleVersion) {
-        LOGE("readFromExpandedSo invalid header magic/version");
+    // 校验头部魔数与版本（必须与尾部一致）。
+    if (header.magic != kSoBinBundleHeaderMagic || header.version != footer.version) {
+        LOGE("readFromExpandedSo invalid header magic/version: header=%u footer=%u", header.version, footer.version);
         return false;
     }
 
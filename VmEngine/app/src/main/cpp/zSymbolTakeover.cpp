@@ -1,16 +1,16 @@
 ﻿/*
  * [VMP_FLOW_NOTE] 文件级流程注释
- * - 导出符号接管实现：key 跳板 -> vm_takeover_dispatch_by_key -> VM 执行。
+ * - 导出符号接管实现：key 跳板 -> vm_takeover_entry（寄存器帧）-> vm_takeover_dispatch_frame -> 直连槽位 / 按 key 分发 -> VM 执行。
  * - 加固链路位置：route4 L2（符号接管层）。
- * - 输入：soId + symbolKey + (a,b) 参数。
+ * - 输入：soId + symbolKey + AArch64 PCS 参数寄存器帧（x0..x7 / x8 / q0..q7）。
  * - 输出：对应 VM 函数执行结果。
  */
 #include "zSymbolTakeover.h"
 
+// 直连槽位原子指针。
+#include <atomic>
 // 互斥锁。
 #include <mutex>
-// std::string。
-#include <string>
 // 哈希映射。
 #include <unordered_map>
 
@@ -18,6 +18,10 @@
 #include "zLog.h"
 // VM 引擎执行入口。
 #include "zVmEngine.h"
+// epoch 读者临界区与回收域（保护路由表与槽位中的直连绑定）。
+#include "zVmEpoch.h"
+// 直连槽位容量（与离线跳板生成共用）。
+#include "shared/patchbay/zPatchbayProtocol.h"
 
 // 由 zVmInitLifecycle.cpp 导出的 C 接口。
 extern "C" int vm_init();
@@ -28,16 +32,22 @@ namespace {
 // vm_init 就绪状态值（与生命周期模块保持一致）。
 constexpr int kVmInitStateReady = 2;
 
+// soId -> 模块执行上下文（引擎内地址稳定）的不可变路由表：注册时复制并整体发布，分发路径只做一次原子加载。
+using zTakeoverRouteTable = std::unordered_map<uint32_t, const zVmModule*>;
+
 // 接管模块的全局运行状态。
 struct zTakeoverState {
-    // 状态锁：保护以下成员的并发访问。
+    // 写者串行化（注册/清理复制并发布新路由表）。
     std::mutex mutex;
-    // soId -> soName 映射。
-    std::unordered_map<uint32_t, std::string> soNameById;
-    // 初始化完成标记。
-    bool ready = false;
+    // 当前路由表（为空表示未就绪）；重复初始化时新表整体替换旧表，期间分发不会看到空表。
+    std::atomic<const zTakeoverRouteTable*> routes{nullptr};
+    // 旧路由表的延迟回收域。
+    zVmEpochDomain reclaim;
 };
 
+// 跳板直连槽位：下标 = 跳板字面量中的槽位号 - 1；常量初始化，首次按 key 分发成功后回填。
+std::atomic<const zVmBoundCall*> g_takeover_bind_slots[vmp::patchbay::protocol::kTakeoverBindSlotCap];
+
 // 访问单例状态对象。
 zTakeoverState& getTakeoverState() {
     // 函数静态对象：进程内仅一份。
@@ -45,6 +55,19 @@ zTakeoverState& getTakeoverState() {
     return state;
 }
 
+// epoch 回收释放函数：旧路由表。
+void deleteRouteTable(void* object) {
+    delete static_cast<zTakeoverRouteTable*>(object);
+}
+
+// 发布新路由表并退役旧表（调用方持有 state.mutex）。
+void publishRoutesLocked(zTakeoverState& state, const zTakeoverRouteTable* routes) {
+    const zTakeoverRouteTable* previous = state.routes.exchange(routes, std::memory_order_acq_rel);
+    if (previous != nullptr) {
+        state.reclaim.retire(const_cast<zTakeoverRouteTable*>(previous), deleteRouteTable);
+    }
+}
+
 // 判断 C 字符串是否为非空有效文本。
 bool isValidText(const char* value) {
     return value != nullptr && value[0] != '\0';
@@ -56,54 +79,87 @@ uint64_t toVmArg(int value) {
     return static_cast<uint64_t>(static_cast<int64_t>(value));
 }
 
-// 按 (soId, symbolKey) 分发执行；失败统一返回 0。
-int dispatchByKeyOrZero(uint64_t symbolKey, uint32_t soId, int a, int b) {
+// 槽位号 -> 槽位（无槽位或越界返回 nullptr）。
+std::atomic<const zVmBoundCall*>* bindSlotAt(uint32_t bindSlot) {
+    if (bindSlot == 0 || bindSlot > vmp::patchbay::protocol::kTakeoverBindSlotCap) {
+        return nullptr;
+    }
+    return &g_takeover_bind_slots[bindSlot - 1];
+}
+
+// 把 (module, symbolKey) 的新绑定装入槽位；observed 为分发前读到的旧值，竞争失败时丢弃本次绑定。
+void rebindSlot(std::atomic<const zVmBoundCall*>* slot,
+                const zVmBoundCall* observed,
+                const zVmModule* module,
+                uint64_t symbolKey) {
+    zVmEngine& engine = zVmEngine::getInstance();
+    const zVmBoundCall* fresh = engine.bindCall(module, symbolKey);
+    if (fresh == nullptr) {
+        return;
+    }
+    const zVmBoundCall* expected = observed;
+    if (slot->compare_exchange_strong(expected, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        engine.releaseBoundCall(observed);
+    } else {
+        engine.releaseBoundCall(fresh);
+    }
+}
+
+// 按 (soId, symbolKey) 分发执行，结果写回寄存器帧；失败时返回 false（帧中返回寄存器不变）。
+// outModule 非空时带回命中的模块，供回填直连槽位。
+bool dispatchFrame(zTakeoverFrame* frame, uint64_t symbolKey, uint32_t soId, const zVmModule** outModule = nullptr) {
     // 参数快速校验。
-    if (symbolKey == 0 || soId == 0) {
+    if (frame == nullptr || symbolKey == 0 || soId == 0) {
         LOGE("[route_symbol_takeover] dispatch failed: invalid route key, so_id=%u key=0x%llx",
              soId,
              static_cast<unsigned long long>(symbolKey));
-        return 0;
+        return false;
     }
 
-    // 先在锁内取快照，减少锁持有时间。
-    std::string soName;
+    // 读者临界区内只取模块指针（对象由引擎持有且不删除），出临界区后执行。
+    const zVmModule* module = nullptr;
     {
-        // 拿到全局状态对象。
-        zTakeoverState& state = getTakeoverState();
-        // 加锁读取。
-        std::lock_guard<std::mutex> lock(state.mutex);
+        zVmEpochDomain::Guard guard;
+        const zTakeoverRouteTable* routes = getTakeoverState().routes.load(std::memory_order_acquire);
         // 未初始化直接失败。
-        if (!state.ready) {
+        if (routes == nullptr) {
             LOGE("[route_symbol_takeover] dispatch failed: takeover not ready, so_id=%u", soId);
-            return 0;
+            return false;
         }
-        // 查找模块 soName。
-        auto it = state.soNameById.find(soId);
-        if (it == state.soNameById.end() || it->second.empty()) {
+        // 查找模块。
+        auto it = routes->find(soId);
+        if (it == routes->end() || it->second == nullptr) {
             LOGE("[route_symbol_takeover] dispatch failed: so_id not registered, so_id=%u", soId);
-            return 0;
+            return false;
         }
-        // 拷贝快照到栈变量。
-        soName = it->second;
+        module = it->second;
     }
 
-    // 快照校验：so 名称必须非空。
-    if (soName.empty()) {
-        LOGE("[route_symbol_takeover] dispatch failed: empty so name, so_id=%u", soId);
-        return 0;
+    // 进入 VM 执行路径：参数直接取自寄存器帧，返回值写回 x0/x1。
+    zVmEngine& engine = zVmEngine::getInstance();
+    if (!engine.executeFrame(module, symbolKey, frame->x, frame->x8, frame->x[0], frame->x[1])) {
+        return false;
     }
+    if (outModule != nullptr) {
+        *outModule = module;
+    }
+    return true;
+}
 
-    // 进入 VM 执行路径。
-    zVmEngine& engine = zVmEngine::getInstance();
-    // VM 返回值缓冲。
-    uint64_t vmResult = 0;
-    // 组装二元参数列表。
-    const zParams params({toVmArg(a), toVmArg(b)});
-    // 执行对应 VM 函数。
-    vmResult = engine.execute(&vmResult, soName.c_str(), symbolKey, params);
-    // 约定以 int 返回给 native 调用方。
-    return static_cast<int>(vmResult);
+// 惰性初始化：vmengine 未就绪时先尝试 vm_init。
+bool ensureVmReady(uint64_t symbolKey, uint32_t soId) {
+    if (vm_get_init_state() == kVmInitStateReady) {
+        return true;
+    }
+    const int initOk = vm_init();
+    if (initOk == 0) {
+        LOGE("[route_symbol_takeover] vm_init failed before dispatch: so_id=%u key=0x%llx state=%d",
+             soId,
+             static_cast<unsigned long long>(symbolKey),
+             vm_get_init_state());
+        return false;
+    }
+    return true;
 }
 
 } // namespace
@@ -118,24 +174,27 @@ bool zSymbolTakeoverRegisterModule(uint32_t soId, const char* soName) {
         return false;
     }
 
-    // 校验 so 必须存在并已被链接器感知。
+    // 校验 so 必须存在并已被链接器感知，同时取得模块执行上下文。
     zVmEngine& engine = zVmEngine::getInstance();
-    if (engine.GetSoinfo(soName) == nullptr) {
+    const zVmModule* module = engine.registerModule(soName);
+    if (module == nullptr) {
         LOGE("[route_symbol_takeover] register failed: so unavailable so_id=%u so_name=%s",
              soId,
              soName);
         return false;
     }
 
-    // 提交到全局状态。
+    // 复制当前路由表、写入后整体发布：并发分发只会看到旧表或新表。
     zTakeoverState& state = getTakeoverState();
     std::lock_guard<std::mutex> lock(state.mutex);
-    state.soNameById[soId] = soName;
-    state.ready = !state.soNameById.empty();
+    const zTakeoverRouteTable* current = state.routes.load(std::memory_order_relaxed);
+    zTakeoverRouteTable* routes = current != nullptr ? new zTakeoverRouteTable(*current) : new zTakeoverRouteTable();
+    (*routes)[soId] = module;
+    publishRoutesLocked(state, routes);
     LOGI("[route_symbol_takeover] register ready: so_id=%u so_name=%s module_count=%llu",
          soId,
          soName,
-         static_cast<unsigned long long>(state.soNameById.size()));
+         static_cast<unsigned long long>(routes->size()));
     return true;
 }
 
@@ -143,27 +202,59 @@ bool zSymbolTakeoverRegisterModule(uint32_t soId, const char* soName) {
 void zSymbolTakeoverClear() {
     zTakeoverState& state = getTakeoverState();
     std::lock_guard<std::mutex> lock(state.mutex);
-    // 清空模块映射。
-    state.soNameById.clear();
-    // 回到未就绪状态。
-    state.ready = false;
+    // 摘除路由表：回到未就绪状态。
+    publishRoutesLocked(state, nullptr);
+    // 摘除全部直连绑定：之后的调用回到按 key 分发（未就绪时直接失败）。
+    zVmEngine& engine = zVmEngine::getInstance();
+    for (std::atomic<const zVmBoundCall*>& slot : g_takeover_bind_slots) {
+        engine.releaseBoundCall(slot.exchange(nullptr, std::memory_order_acq_rel));
+    }
 }
 
-// 所有通用 key 跳板最终都调用该入口。
+// vm_takeover_entry 保存寄存器帧后调用该函数（仅汇编入口使用，不导出）。
+extern "C" __attribute__((visibility("hidden"))) void vm_takeover_dispatch_frame(zTakeoverFrame* frame,
+                                                                                 uint64_t symbolKey,
+                                                                                 uint32_t soId,
+                                                                                 uint32_t bindSlot) {
+    std::atomic<const zVmBoundCall*>* slot = bindSlotAt(bindSlot);
+    const zVmBoundCall* observed = nullptr;
+    if (slot != nullptr) {
+        // 热路径：槽位已绑定且缓存未变化时一次加载即执行，跳过就绪检查、模块表加锁与 key 查找。
+        // 读者临界区覆盖槽位读取，保证读到的绑定在执行期间不被回收。
+        zVmEpochDomain::Guard guard;
+        observed = slot->load(std::memory_order_acquire);
+        if (observed != nullptr &&
+            zVmEngine::getInstance().executeBound(observed, frame->x, frame->x8, frame->x[0], frame->x[1])) {
+            return;
+        }
+    }
+    // 冷路径：x0/x1 仍是调用方参数，分发成功由引擎写回返回值；只有失败分支才清零（失败统一返回 0）。
+    const zVmModule* module = nullptr;
+    if (ensureVmReady(symbolKey, soId) && dispatchFrame(frame, symbolKey, soId, &module)) {
+        if (slot != nullptr) {
+            // 分发成功说明 vm_init 已完成且函数就绪：回填直连绑定供后续调用使用。
+            rebindSlot(slot, observed, module, symbolKey);
+        }
+        return;
+    }
+    frame->x[0] = 0;
+    frame->x[1] = 0;
+}
+
+// 旧版跳板入口：两个 int 参数装入栈上寄存器帧后走同一分发路径。
 extern "C" __attribute__((visibility("default"))) int vm_takeover_dispatch_by_key(int a,
                                                                                      int b,
                                                                                      uint64_t symbolKey,
                                                                                      uint32_t soId) {
-    // 若 vmengine 未就绪，先尝试惰性初始化。
-    if (vm_get_init_state() != kVmInitStateReady) {
-        const int initOk = vm_init();
-        if (initOk == 0) {
-            LOGE("[route_symbol_takeover] vm_init failed before dispatch: so_id=%u key=0x%llx state=%d",
-                 soId,
-                 static_cast<unsigned long long>(symbolKey),
-                 vm_get_init_state());
-            return 0;
-        }
+    if (!ensureVmReady(symbolKey, soId)) {
+        return 0;
     }
-    return dispatchByKeyOrZero(symbolKey, soId, a, b);
+    zTakeoverFrame frame{};
+    frame.x[0] = toVmArg(a);
+    frame.x[1] = toVmArg(b);
+    if (!dispatchFrame(&frame, symbolKey, soId)) {
+        return 0;
+    }
+    // 约定以 int 返回给 native 调用方。
+    return static_cast<int>(frame.x[0]);
 }
@@ -8,15 +8,36 @@
 #ifndef Z_SYMBOL_TAKEOVER_H
 #define Z_SYMBOL_TAKEOVER_H
 
+#include <cstddef>
 #include <cstdint>
 
-// 注册接管模块：soId -> soName。
+// 注册（或刷新）接管模块：soId -> soName；路由表复制后整体发布，运行中重复注册不会打断并发分发。
 bool zSymbolTakeoverRegisterModule(uint32_t soId, const char* soName);
 
-// 清理运行态接管状态（映射、句柄、缓存），用于回归/重复初始化场景。
+// 清理运行态接管状态（映射、句柄、缓存），用于回归测试；清理后到重新注册前的调用会失败，热替换无需调用。
 void zSymbolTakeoverClear();
 
-// 汇编符号桩统一跳转到该入口（a,b 保持在 x0/x1，symbol_key 走 x2，so_id 走 w3）。
+// 接管入口寄存器帧：vm_takeover_entry 在自己的栈帧上保存 AArch64 PCS 的全部参数寄存器，按指针交给 VM；
+// 返回前从同一帧取回 x0/x1（q0 清零：VM 不产生浮点结果）。字段偏移与 zSymbolTakeoverArm64.S 硬编码一致，改动需同步。
+struct zTakeoverFrame {
+    uint64_t x[8];      // x0..x7 整型参数；返回时 x[0]/x[1] 写回 x0/x1
+    uint64_t x8;        // 间接返回地址（sret）
+    uint64_t reserved;  // 填充，使 q 寄存器区 16 字节对齐
+    uint64_t v[8][2];   // q0..q7 浮点/向量参数（只读，不回写）
+};
+static_assert(offsetof(zTakeoverFrame, x8) == 64, "zTakeoverFrame layout must match vm_takeover_entry");
+static_assert(offsetof(zTakeoverFrame, v) == 80, "zTakeoverFrame layout must match vm_takeover_entry");
+static_assert(sizeof(zTakeoverFrame) == 208, "zTakeoverFrame layout must match vm_takeover_entry");
+
+// 合成跳板统一跳转到该汇编入口：参数寄存器原样保留，路由 key 经 x16 指向的跳板字面量
+// {symbolKey, soId, bindSlot} 带外传入。
+extern "C" void vm_takeover_entry();
+
+// vm_takeover_entry 调用的分发函数：执行结果写回 frame（失败时 x0/x1 置 0）。
+// bindSlot 非 0 时先走槽位中的直连绑定（一次加载即执行）；未绑定或已失效时按 key 分发并回填槽位。
+extern "C" void vm_takeover_dispatch_frame(zTakeoverFrame* frame, uint64_t symbolKey, uint32_t soId, uint32_t bindSlot);
+
+// 旧版跳板入口（a,b 在 x0/x1，symbol_key 走 x2，so_id 走 w3）；保留给直接调用方，内部同样走寄存器帧路径。
 extern "C" int vm_takeover_dispatch_by_key(int a, int b, uint64_t symbolKey, uint32_t soId);
 
 #endif // Z_SYMBOL_TAKEOVER_H
@@ -3,7 +3,7 @@
  * - VM 运行时类型系统实现：基础类型、组合类型、布局计算与生命周期管理。
  * - 加固链路位置：VmEngine 类型支撑层。
  * - 输入：类型标签/参数。
- * - 输出：可直接被解释器与对象布局逻辑使用的 zType 体系对象。
+ * - 输出：可直接被解释器与对象布局逻辑使用的 zType 描述符（标量类型进程级驻留共享）。
  */
 #include "zTypeManager.h"
 
@@ -20,12 +20,28 @@ zTypeManager::zTypeManager() {
 
 // 析构函数：统一释放托管列表中的所有类型对象。
 zTypeManager::~zTypeManager() {
-    // allocatedTypes_ 中每个对象可能是派生类型，需走多态析构。
+    // 基类无虚析构：各列表以派生类型指针删除，保证附属数组随之释放。
     for (auto* type : allocatedTypes_) {
-        freeType(type);
+        delete type;
+    }
+    for (auto* type : allocatedStructTypes_) {
+        delete type;
+    }
+    for (auto* type : allocatedPointerTypes_) {
+        delete type;
+    }
+    for (auto* type : allocatedArrayTypes_) {
+        delete type;
+    }
+    for (auto* type : allocatedCallTypes_) {
+        delete type;
     }
     // 清空托管列表，防止悬挂指针残留。
     allocatedTypes_.clear();
+    allocatedStructTypes_.clear();
+    allocatedPointerTypes_.clear();
+    allocatedArrayTypes_.clear();
+    allocatedCallTypes_.clear();
 }
 
 // 分配基础类型对象并纳入托管。
@@ -43,8 +59,8 @@ FunctionStructType* zTypeManager::allocFunctionStructType() {
     FunctionStructType* type = new FunctionStructType();
     // 标记 kind 为结构体/函数类型。
     type->kind = TYPE_KIND_STRUCT;
-    // 以基类指针形式放入托管列表。
-    allocatedTypes_.push_back(reinterpret_cast<zType*>(type));
+    // 放入结构体托管列表。
+    allocatedStructTypes_.push_back(type);
     return type;
 }
 
@@ -54,10 +70,11 @@ PointerType* zTypeManager::allocPointerType() {
     PointerType* type = new PointerType();
     // 标记 kind 为指针类型描述。
     type->kind = TYPE_KIND_PTR_TYPE;
-    // 64 位进程下指针大小固定 8。
+    // 64 位进程下指针大小与对齐固定 8。
     type->size = 8;
-    // 放入统一托管容器。
-    allocatedTypes_.push_back(reinterpret_cast<zType*>(type));
+    type->alignment = 8;
+    // 放入指针托管列表。
+    allocatedPointerTypes_.push_back(type);
     return type;
 }
 
@@ -65,8 +82,8 @@ PointerType* zTypeManager::allocPointerType() {
 ArrayType* zTypeManager::allocArrayType() {
     // 构造派生对象。
     ArrayType* type = new ArrayType();
-    // 放入托管容器。
-    allocatedTypes_.push_back(reinterpret_cast<zType*>(type));
+    // 放入数组托管列表。
+    allocatedArrayTypes_.push_back(type);
     return type;
 }
 
@@ -76,8 +93,11 @@ CallType* zTypeManager::allocCallType() {
     CallType* type = new CallType();
     // 标记 kind 为调用类型。
     type->kind = TYPE_KIND_CALL_TYPE;
-    // 放入托管容器。
-    allocatedTypes_.push_back(reinterpret_cast<zType*>(type));
+    // 调用签名按函数指针处理：大小与对齐固定 8。
+    type->size = 8;
+    type->alignment = 8;
+    // 放入调用类型托管列表。
+    allocatedCallTypes_.push_back(type);
     return type;
 }
 
@@ -270,10 +290,9 @@ ArrayType* zTypeManager::createArrayType(uint32_t elementCount, zType* elementTy
     type->element_count = elementCount;
     // 记录元素类型。
     type->element_type = elementType;
-    // 元素类型有效时预计算总大小。
-    if (elementType) {
-        type->size = elementCount * getTypeSize(elementType);
-    }
+    // 大小与对齐在创建时固化：总大小 = 元素数 * 元素大小，对齐沿用元素对齐（元素为空时为 0 / 1）。
+    type->size = elementType ? elementCount * getTypeSize(elementType) : 0;
+    type->alignment = elementType ? getTypeAlignment(elementType) : 1;
     return type;
 }
 
@@ -327,17 +346,100 @@ zType* zTypeManager::createFromCode(uint32_t code) {
     }
 }
 
+// 进程级驻留描述符：按类型码常量初始化，无运行期构造、无锁。
+namespace {
+// 驻留表下标。
+enum InternedTypeSlot : uint32_t {
+    INTERNED_INT8_SIGNED = 0,
+    INTERNED_INT8_UNSIGNED,
+    INTERNED_INT16_SIGNED,
+    INTERNED_INT16_UNSIGNED,
+    INTERNED_INT32_SIGNED,
+    INTERNED_INT32_UNSIGNED,
+    INTERNED_INT64_SIGNED,
+    INTERNED_INT64_UNSIGNED,
+    INTERNED_FLOAT32,
+    INTERNED_FLOAT64,
+    INTERNED_POINTER,
+    INTERNED_SLOT_COUNT,
+};
+
+// 字段取值与 createInt8/createFloat32/createPointer 等逐项一致。
+// 字段顺序：kind, size, bit_width, alignment, is_signed, is_float。
+const zType kInternedTypes[INTERNED_SLOT_COUNT] = {
+    {TYPE_KIND_INT8_SIGNED,    1, 8,  1, true,  false},
+    {TYPE_KIND_INT8_UNSIGNED,  1, 8,  1, false, false},
+    {TYPE_KIND_INT16_SIGNED,   2, 16, 2, true,  false},
+    {TYPE_KIND_INT16_UNSIGNED, 2, 16, 2, false, false},
+    {TYPE_KIND_INT32_SIGNED,   4, 32, 4, true,  false},
+    {TYPE_KIND_INT32_UNSIGNED, 4, 32, 4, false, false},
+    {TYPE_KIND_INT64_SIGNED,   8, 64, 8, true,  false},
+    {TYPE_KIND_INT64_UNSIGNED, 8, 64, 8, false, false},
+    {TYPE_KIND_FLOAT32,        4, 32, 4, true,  true},
+    {TYPE_KIND_FLOAT64,        8, 64, 8, true,  true},
+    {TYPE_KIND_POINTER,        8, 64, 8, false, false},
+};
+} // namespace
+
+// 类型码 -> 驻留描述符（映射与 createFromCode 一致）。
+const zType* zTypeManager::internFromCode(uint32_t code) {
+    switch (code) {
+        case TYPE_TAG_INT8_SIGNED:
+            return &kInternedTypes[INTERNED_INT8_SIGNED];
+        case TYPE_TAG_INT16_SIGNED:
+            return &kInternedTypes[INTERNED_INT16_SIGNED];
+        case TYPE_TAG_INT64_UNSIGNED:
+            return &kInternedTypes[INTERNED_INT64_UNSIGNED];
+        case TYPE_TAG_INT32_SIGNED_2:
+            return &kInternedTypes[INTERNED_INT32_SIGNED];
+        case TYPE_TAG_POINTER:
+            return &kInternedTypes[INTERNED_POINTER];
+        case TYPE_TAG_INT16_UNSIGNED:
+            return &kInternedTypes[INTERNED_INT16_UNSIGNED];
+        case TYPE_TAG_INT32_UNSIGNED:
+            return &kInternedTypes[INTERNED_INT32_UNSIGNED];
+        case TYPE_TAG_INT64_SIGNED:
+            return &kInternedTypes[INTERNED_INT64_SIGNED];
+        case TYPE_TAG_FLOAT32:
+            return &kInternedTypes[INTERNED_FLOAT32];
+        case TYPE_TAG_FLOAT64:
+            return &kInternedTypes[INTERNED_FLOAT64];
+        case TYPE_TAG_INT8_UNSIGNED:
+            return &kInternedTypes[INTERNED_INT8_UNSIGNED];
+        default:
+            // 未知编码回退到 uint64（沿用 createFromCode 行为）。
+            return &kInternedTypes[INTERNED_INT64_UNSIGNED];
+    }
+}
+
 // 释放单个类型对象。
 void zTypeManager::freeType(zType* type) {
     // 空指针直接返回。
     if (!type) return;
 
-    // 通过虚析构自动释放派生对象附带资源。
-    delete type;
+    // 基类无虚析构：按 kind 还原派生类型，保证附属数组随之释放。
+    switch (type->kind) {
+        case TYPE_KIND_STRUCT:
+            delete static_cast<FunctionStructType*>(type);
+            return;
+        case TYPE_KIND_CALL_TYPE:
+            delete static_cast<CallType*>(type);
+            return;
+        case TYPE_KIND_PTR_TYPE:
+            delete static_cast<PointerType*>(type);
+            return;
+        case TYPE_KIND_ARRAY_ELEM:
+        case TYPE_KIND_ARRAY_DIM:
+            delete static_cast<ArrayType*>(type);
+            return;
+        default:
+            delete type;
+            return;
+    }
 }
 
 // 释放类型数组容器（不重复释放对象本体）。
-void zTypeManager::freeTypeList(zType** types, uint32_t count) {
+void zTypeManager::freeTypeList(const zType** types, uint32_t count) {
     // count 在当前实现中无需使用，保留签名兼容上层调用。
     (void)count;
     // 仅释放数组内存本体。
@@ -347,18 +449,18 @@ void zTypeManager::freeTypeList(zType** types, uint32_t count) {
 }
 
 // 查询类型大小。
-uint32_t zTypeManager::getTypeSize(zType* type) {
+uint32_t zTypeManager::getTypeSize(const zType* type) {
     // 空类型默认返回 8（与原行为一致）。
     if (!type) return 8;
-    // 走多态接口。
+    // 直接读描述符字段。
     return type->getSize();
 }
 
 // 查询类型对齐。
-uint32_t zTypeManager::getTypeAlignment(zType* type) {
+uint32_t zTypeManager::getTypeAlignment(const zType* type) {
     // 空类型默认返回 8（与原行为一致）。
     if (!type) return 8;
-    // 走多态接口。
+    // 直接读描述符字段。
     return type->getAlignment();
 }
 
@@ -368,7 +470,7 @@ void zTypeManager::calcStructAlignment(zType* type) {
     if (!type || type->kind != TYPE_KIND_STRUCT) return;
 
     // 转为结构体类型对象。
-    FunctionStructType* fst = reinterpret_cast<FunctionStructType*>(type);
+    FunctionStructType* fst = static_cast<FunctionStructType*>(type);
     // 非完整类型或无成员时无需计算。
     if (!fst->is_complete || fst->param_count == 0) return;
 
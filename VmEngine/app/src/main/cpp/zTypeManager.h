@@ -8,8 +8,9 @@
 #ifndef Z_TYPE_SYSTEM_H
 #define Z_TYPE_SYSTEM_H
 
-#include <cstdint> // 固定宽度整数类型。
-#include <vector>  // 类型对象托管容器。
+#include <cstdint>     // 固定宽度整数类型。
+#include <type_traits> // 描述符平凡可复制约束。
+#include <vector>      // 类型对象托管容器。
 
 
 // ============================================================================
@@ -62,13 +63,13 @@ enum TypeTag : uint32_t {
 
 
 // ============================================================================
-// 基础类型对象
+// 基础类型描述符
 // ============================================================================
+// 平凡可复制的 POD 描述符：解释器热路径只读字段，不走虚调用。
+// 组合类型（结构体/指针/数组/调用签名）以派生类附带额外信息，但 kind/size/alignment
+// 必须在创建时写入基类字段，保证按基类读取即得正确值。
 class zType {
 public:
-    // 虚析构保证派生类型通过基类指针删除时资源正确释放。
-    virtual ~zType() = default;
-
     uint32_t kind = 0;            // 类型种类
     uint32_t size = 0;            // 类型大小（字节）
     uint32_t bit_width = 0;       // 对于整数类型，位宽
@@ -77,31 +78,34 @@ public:
     bool     is_float = false;    // 是否浮点
     uint8_t  padding[2] = {0, 0}; // 对齐填充
 
-    // 获取类型大小（默认返回 size 字段）。
-    virtual uint32_t getSize() const { return size; }
+    // 获取类型大小。
+    uint32_t getSize() const { return size; }
 
-    // 获取类型种类（默认返回 kind 字段）。
-    virtual uint32_t getKind() const { return kind; }
+    // 获取类型种类。
+    uint32_t getKind() const { return kind; }
 
     // 获取类型对齐（alignment=0 时回退到 size）。
-    virtual uint32_t getAlignment() const { return alignment > 0 ? alignment : getSize(); }
+    uint32_t getAlignment() const { return alignment > 0 ? alignment : size; }
 };
 
+static_assert(std::is_trivially_copyable<zType>::value, "zType must stay a trivially copyable descriptor");
+
 // ============================================================================
 // 函数/结构体类型（kind = 13）
 // ============================================================================
 class FunctionStructType : public zType {
 public:
-    uint8_t  has_return;      // 偏移 12: 是否有返回值
-    uint8_t  is_vararg;       // 偏移 13: 是否变参
-    uint8_t  is_complete;     // 偏移 14: 是否完整
+    uint8_t  has_return;      // 是否有返回值
+    uint8_t  is_vararg;       // 是否变参
+    uint8_t  is_complete;     // 是否完整
     uint8_t  _pad;
-    uint32_t param_count;     // 偏移 16: 参数数量
-    zType** param_list;       // 偏移 24: 参数类型列表
-    uint32_t* param_offsets;  // 偏移 32/40: 参数偏移列表
-    char* name;               // 偏移 40/48: 名称
+    uint32_t param_count;     // 参数数量
+    zType** param_list;       // 参数类型列表
+    uint32_t* param_offsets;  // 参数偏移列表
+    char* name;               // 名称
 
-    ~FunctionStructType() override {
+    // 仅由 zTypeManager 以派生类型指针删除（基类无虚析构）。
+    ~FunctionStructType() {
         // 参数类型数组由本对象拥有。
         delete[] param_list;
         // 参数偏移数组由本对象拥有。
@@ -109,9 +113,6 @@ public:
         // 名称字符串由本对象拥有。
         delete[] name;
     }
-
-    uint32_t getKind() const override { return TYPE_KIND_STRUCT; }
-    uint32_t getSize() const override { return size; }
 };
 
 // ============================================================================
@@ -119,11 +120,7 @@ public:
 // ============================================================================
 class PointerType : public zType {
 public:
-    zType* pointee_type; // 偏移 16: 指向的类型
-
-    uint32_t getKind() const override { return TYPE_KIND_PTR_TYPE; }
-    uint32_t getSize() const override { return 8; }
-    uint32_t getAlignment() const override { return 8; }
+    zType* pointee_type; // 指向的类型
 };
 
 // ============================================================================
@@ -131,14 +128,8 @@ public:
 // ============================================================================
 class ArrayType : public zType {
 public:
-    uint32_t element_count;   // 偏移 12: 元素数量
-    zType* element_type; // 偏移 16: 元素类型
-
-    uint32_t getKind() const override { return kind; }
-    // 数组大小 = 元素数 * 元素大小（元素为空时为 0）。
-    uint32_t getSize() const override { return element_type ? element_count * element_type->getSize() : 0; }
-    // 数组对齐沿用元素对齐（元素为空时回退 1）。
-    uint32_t getAlignment() const override { return element_type ? element_type->getAlignment() : 1; }
+    uint32_t element_count;   // 元素数量
+    zType* element_type; // 元素类型
 };
 
 // ============================================================================
@@ -146,29 +137,17 @@ public:
 // ============================================================================
 class CallType : public zType {
 public:
-    uint8_t  has_return;      // 偏移 12: 是否有返回值
+    uint8_t  has_return;      // 是否有返回值
     uint8_t  _pad[3];
-    zType* return_type;  // 偏移 16: 返回类型
-    uint32_t param_count;     // 偏移 24: 参数数量
-    zType** param_list;  // 偏移 32: 参数类型列表
+    zType* return_type;  // 返回类型
+    uint32_t param_count;     // 参数数量
+    zType** param_list;  // 参数类型列表
 
-    ~CallType() override {
+    // 仅由 zTypeManager 以派生类型指针删除（基类无虚析构）。
+    ~CallType() {
         // 参数类型数组由本对象拥有。
         delete[] param_list;
     }
-
-    uint32_t getKind() const override { return TYPE_KIND_CALL_TYPE; }
-    uint32_t getSize() const override { return 8; }
-    uint32_t getAlignment() const override { return 8; }
-};
-
-// ============================================================================
-// 带位宽的整数类型（kind = 11）
-// ============================================================================
-class IntegerWidthType : public zType {
-public:
-    // bit_width 字段已在基类中定义
-    uint32_t getKind() const override { return TYPE_KIND_INTEGER_WIDTH; }
 };
 
 // ============================================================================
@@ -214,19 +193,23 @@ public:
     // 根据外部编码值快速创建对应基础类型。
     zType* createFromCode(uint32_t code);
 
+    // 进程级驻留表：同一类型码在所有函数间共享同一只读描述符，无需分配。
+    // 未知编码与 createFromCode 一致回退到 uint64。
+    static const zType* internFromCode(uint32_t code);
+
     // 释放类型（释放对象或数组容器）。
-    // 释放单个类型对象及其内部附属内存。
+    // 释放单个类型对象及其内部附属内存（按 kind 还原派生类型后删除）。
     void freeType(zType* type);
     // 释放类型数组容器（不重复释放由类型系统托管的对象）。
-    void freeTypeList(zType** types, uint32_t count);
+    void freeTypeList(const zType** types, uint32_t count);
 
     // 获取类型大小。
     // 获取类型的字节大小（null 时给出默认宽度）。
-    static uint32_t getTypeSize(zType* type);
+    static uint32_t getTypeSize(const zType* type);
 
     // 获取类型对齐。
-    // 获取类型对齐值（优先使用类型自身多态实现，缺省回退到大小）。
-    static uint32_t getTypeAlignment(zType* type);
+    // 获取类型对齐值（缺省回退到大小）。
+    static uint32_t getTypeAlignment(const zType* type);
     
     // 计算结构体对齐（对应 vm_calc_alignment_1）
     // 计算结构体成员偏移、最终大小与最大对齐。
@@ -244,8 +227,12 @@ private:
     // 分配调用类型对象并纳入托管列表。
     CallType* allocCallType();
     
-    // 托管所有已分配类型对象，析构时统一释放。
+    // 托管已分配类型对象，析构时按各自派生类型释放（基类无虚析构）。
     std::vector<zType*> allocatedTypes_;
+    std::vector<FunctionStructType*> allocatedStructTypes_;
+    std::vector<PointerType*> allocatedPointerTypes_;
+    std::vector<ArrayType*> allocatedArrayTypes_;
+    std::vector<CallType*> allocatedCallTypes_;
 };
 
 
@@ -0,0 +1,101 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 紧凑指令流转码：32 位 word 逐槽位压到 16 位，超出范围的值去重后放入宽值池。
+ * - 加固链路位置：cacheFunction 前的一次性准备阶段（位于 verifyFunction / buildDecodedFunction 之后）。
+ * - 输入：verified=true 的 zFunction。
+ * - 输出：zFunction::inst_compact / inst_wide_pool / inst_wide_count。
+ */
+#include "zVmCompact.h"
+
+// zFunction 运行态数组。
+#include "zFunction.h"
+// 日志。
+#include "zLog.h"
+// memcpy。
+#include <cstring>
+// std::unique_ptr。
+#include <memory>
+// 宽值去重。
+#include <unordered_map>
+
+// 转码：槽位与 word 一一对应，只有宽值需要查池。
+bool buildCompactFunction(zFunction* function) {
+    if (function == nullptr || function->inst_list == nullptr || function->inst_count == 0) {
+        return false;
+    }
+    // 紧凑处理函数只实例化了免检变体：未通过校验的函数保持 word 流与检查模式。
+    if (!function->verified) {
+        return false;
+    }
+    // 重建前释放旧紧凑流。
+    releaseCompactFunction(function);
+
+    const uint32_t instCount = function->inst_count;
+    const uint32_t* code = function->inst_list;
+    std::unique_ptr<uint16_t[]> slots(new uint16_t[instCount]);
+    std::vector<uint32_t> widePool;
+    std::unordered_map<uint32_t, uint32_t> wideIndex;
+    for (uint32_t pc = 0; pc < instCount; ++pc) {
+        const uint32_t word = code[pc];
+        if (word < VM_COMPACT_ESCAPE) {
+            slots[pc] = static_cast<uint16_t>(word);
+            continue;
+        }
+        // 宽值去重：同一函数内反复出现的零寄存器哨兵 / 负偏移只占一个池项。
+        auto it = wideIndex.find(word);
+        if (it == wideIndex.end()) {
+            if (widePool.size() >= VM_COMPACT_MAX_WIDE) {
+                LOGW("buildCompactFunction skipped: wide pool overflow at pc=%u fun_addr=0x%llx",
+                     pc,
+                     static_cast<unsigned long long>(function->functionAddress()));
+                return false;
+            }
+            it = wideIndex.emplace(word, static_cast<uint32_t>(widePool.size())).first;
+            widePool.push_back(word);
+        }
+        slots[pc] = static_cast<uint16_t>(VM_COMPACT_ESCAPE + it->second);
+    }
+
+    // 固化到函数对象，并释放 32 位 word 流（预解码记录与分支表不引用 inst_list）。
+    if (!widePool.empty()) {
+        function->inst_wide_pool = new uint32_t[widePool.size()];
+        std::memcpy(function->inst_wide_pool, widePool.data(), sizeof(uint32_t) * widePool.size());
+    }
+    function->inst_wide_count = static_cast<uint32_t>(widePool.size());
+    function->inst_compact = slots.release();
+    delete[] function->inst_list;
+    function->inst_list = nullptr;
+    return true;
+}
+
+// 释放紧凑流。
+void releaseCompactFunction(zFunction* function) {
+    if (function == nullptr) {
+        return;
+    }
+    delete[] function->inst_compact;
+    function->inst_compact = nullptr;
+    delete[] function->inst_wide_pool;
+    function->inst_wide_pool = nullptr;
+    function->inst_wide_count = 0;
+}
+
+// 还原 word 流。
+bool expandFunctionWords(const zFunction* function, std::vector<uint32_t>& out) {
+    out.clear();
+    if (function == nullptr || function->inst_count == 0) {
+        return false;
+    }
+    if (function->inst_list != nullptr) {
+        out.assign(function->inst_list, function->inst_list + function->inst_count);
+        return true;
+    }
+    if (function->inst_compact == nullptr) {
+        return false;
+    }
+    out.resize(function->inst_count);
+    for (uint32_t pc = 0; pc < function->inst_count; ++pc) {
+        out[pc] = vmCompactWord(function->inst_compact, function->inst_wide_pool, pc);
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 紧凑指令流声明：把 32 位 word 指令流转码为 16 位槽位 + 宽值池。
+ * - 加固链路位置：执行前准备层（cacheFunction 在校验/预解码之后一次性转码）。
+ * - 输入：verified=true 的 zFunction（inst_list 运行态数组）。
+ * - 输出：inst_compact / inst_wide_pool；成功后释放 inst_list，执行走紧凑处理函数变体。
+ */
+#ifndef Z_VM_COMPACT_H
+#define Z_VM_COMPACT_H
+
+#include <cstdint>
+#include <vector>
+
+// 紧凑指令流开关（默认编译进来；关闭时函数始终保持 32 位 word 流）。
+#ifndef VM_COMPACT_BYTECODE
+#define VM_COMPACT_BYTECODE 1
+#endif
+
+class zFunction;
+
+// 槽位编码：与 word 流一一对应（pc、跳转目标、预解码反查表均不变）。
+// 槽位值 < VM_COMPACT_ESCAPE 即 word 本身；否则为宽值池下标 + VM_COMPACT_ESCAPE（大立即数、负偏移、零寄存器哨兵等）。
+#define VM_COMPACT_ESCAPE    0xF000u
+// 宽值池容量上限（去重后超过则放弃转码）。
+#define VM_COMPACT_MAX_WIDE  (0x10000u - VM_COMPACT_ESCAPE)
+
+// 读取紧凑流第 index 个槽位对应的 32 位 word。
+inline uint32_t vmCompactWord(const uint16_t* slots, const uint32_t* widePool, uint32_t index) {
+    const uint32_t slot = slots[index];
+#if defined(__GNUC__) || defined(__clang__)
+    // 窄值占绝大多数：把宽值查池放到冷路径。
+    if (__builtin_expect(slot < VM_COMPACT_ESCAPE, 1)) {
+        return slot;
+    }
+    return widePool[slot - VM_COMPACT_ESCAPE];
+#else
+    return slot < VM_COMPACT_ESCAPE ? slot : widePool[slot - VM_COMPACT_ESCAPE];
+#endif
+}
+
+// 把已校验函数的 inst_list 转码为紧凑流并释放 inst_list；
+// 未校验（紧凑处理函数仅有免检变体）或宽值超出池容量时返回 false，函数保持 word 流。
+bool buildCompactFunction(zFunction* function);
+
+// 释放紧凑流与宽值池。
+void releaseCompactFunction(zFunction* function);
+
+// 还原函数的 32 位 word 流（inst_list 存在时直接复制，否则从紧凑流解码）；供 JIT 等离线消费者使用。
+bool expandFunctionWords(const zFunction* function, std::vector<uint32_t>& out);
+
+#endif // Z_VM_COMPACT_H
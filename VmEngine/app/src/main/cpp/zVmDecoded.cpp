@@ -0,0 +1,438 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 预解码构建：把 word 指令流线性切分为定长记录，预取操作数、预解析类型与跳转目标。
+ * - 加固链路位置：cacheFunction 前的一次性降级（lowering）阶段。
+ * - 输入：已 loadEncodedData 的 zFunction。
+ * - 输出：zFunction::decoded_list / decoded_pc_index / decoded_switch_pool / decoded_call_sites。
+ */
+#include "zVmDecoded.h"
+
+// opcode 常量与 g_opcode_table。
+#include "zVmOpcodes.h"
+// 日志。
+#include "zLog.h"
+// memcpy。
+#include <cstring>
+// std::unique_ptr。
+#include <memory>
+// std::vector。
+#include <vector>
+// std::stable_sort / std::copy。
+#include <algorithm>
+
+// 计算单条指令长度：规则与翻译端共用（shared/bytecode/zVmBytecodeProtocol.h）。
+uint32_t vmInstructionLength(const uint32_t* instructions, uint32_t instCount, uint32_t pc) {
+    if (instructions == nullptr || pc >= instCount) {
+        return 0;
+    }
+    return vmp::bytecode::protocol::instructionLength(instructions + pc, instCount - pc);
+}
+
+namespace {
+
+// 单函数构建上下文：集中做寄存器/类型/分支目标解析。
+struct DecodeScope {
+    const zFunction* function;
+    const uint32_t* code;
+    const std::vector<uint32_t>& pcIndex;
+    // OP_SWITCH case 表池（构建期追加，结束后固化到 decoded_switch_pool）。
+    std::vector<uint32_t>* switchPool;
+    // OP_CALL 调用点参数寄存器（每个调用点一段；结束后固化到 decoded_call_sites）。
+    std::vector<std::vector<uint32_t>>* callSites;
+
+    // 寄存器下标是否合法。
+    bool reg(uint32_t idx) const {
+        return idx < function->register_count;
+    }
+
+    // 类型下标解析（与 GET_TYPE 语义一致：越界为 nullptr）。
+    const zType* type(uint32_t idx) const {
+        return (idx < function->type_count && function->type_list != nullptr) ? function->type_list[idx] : nullptr;
+    }
+
+    // branchId -> 目标 pc；id 越界返回 false。
+    bool branchPc(uint32_t branchId, uint32_t& outPc) const {
+        if (function->branch_words_ptr == nullptr || branchId >= function->branch_count) {
+            return false;
+        }
+        outPc = function->branch_words_ptr[branchId];
+        return true;
+    }
+
+    // 目标 pc -> 记录下标；目标不是指令起点时返回 false。
+    bool recordAt(uint32_t targetPc, uint32_t& outIndex) const {
+        if (targetPc >= pcIndex.size() || pcIndex[targetPc] == kVmDecodedInvalidIndex) {
+            return false;
+        }
+        outIndex = pcIndex[targetPc];
+        return true;
+    }
+};
+
+// case 数不超过该值时保留线性比较（跳转表/二分的常数开销不划算）。
+constexpr uint32_t kVmSwitchLinearMaxCases = 4;
+// 值域跨度不超过 2 * case 数 + 该余量时视为稠密，展开为直接跳转表。
+constexpr uint64_t kVmSwitchDenseSlack = 8;
+
+// OP_SWITCH 降级：把 [value, target_pc] 表解析为记录下标，并按值域分布选择线性/跳转表/二分形态。
+// 任一目标落在指令中间时返回 false（保留通用回退）。
+bool lowerSwitch(const DecodeScope& scope, uint32_t pc, uint32_t index, VMDecodedInst& out) {
+    const uint32_t* w = scope.code + pc;
+    const uint32_t caseCount = w[3];
+    // 与 op_switch 一致：目标 pc 越界时顺序执行到下一条记录。
+    auto resolveTarget = [&](uint32_t targetPc, uint32_t& record) -> bool {
+        if (targetPc >= scope.function->inst_count) {
+            record = index + 1;
+            return true;
+        }
+        return scope.recordAt(targetPc, record);
+    };
+    if (!scope.reg(w[1]) || !resolveTarget(w[2], out.target)) {
+        return false;
+    }
+
+    // 解析 case；重复 value 只保留首项（与线性扫描“首个命中”一致）。
+    std::vector<std::pair<uint32_t, uint32_t>> cases;
+    cases.reserve(caseCount);
+    for (uint32_t i = 0; i < caseCount; ++i) {
+        uint32_t record = 0;
+        if (!resolveTarget(w[4 + i * 2 + 1], record)) {
+            return false;
+        }
+        cases.emplace_back(w[4 + i * 2], record);
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> sorted = cases;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+                         return a.first < b.first;
+                     });
+    sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                             [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+                                 return a.first == b.first;
+                             }),
+                 sorted.end());
+
+    std::vector<uint32_t>& pool = *scope.switchPool;
+    out.operands[0] = w[1];
+    out.operands[2] = static_cast<uint32_t>(pool.size());
+    const uint64_t range = sorted.empty() ? 0 : static_cast<uint64_t>(sorted.back().first) - sorted.front().first + 1u;
+    if (sorted.size() <= kVmSwitchLinearMaxCases) {
+        // 线性：保持原 case 顺序。
+        out.operands[1] = VM_SWITCH_LINEAR;
+        out.operands[3] = caseCount;
+        for (const auto& entry : cases) {
+            pool.push_back(entry.first);
+            pool.push_back(entry.second);
+        }
+    } else if (range <= sorted.size() * 2u + kVmSwitchDenseSlack) {
+        // 跳转表：[min][record...]，空洞填默认目标。
+        out.operands[1] = VM_SWITCH_DENSE;
+        out.operands[3] = static_cast<uint32_t>(range);
+        const size_t base = pool.size() + 1;
+        pool.push_back(sorted.front().first);
+        pool.resize(base + static_cast<size_t>(range), out.target);
+        for (const auto& entry : sorted) {
+            pool[base + (entry.first - sorted.front().first)] = entry.second;
+        }
+    } else {
+        // 有序表：[value, record] 升序，运行时二分。
+        out.operands[1] = VM_SWITCH_SPARSE;
+        out.operands[3] = static_cast<uint32_t>(sorted.size());
+        for (const auto& entry : sorted) {
+            pool.push_back(entry.first);
+            pool.push_back(entry.second);
+        }
+    }
+    out.handler = vm::op_switch_decoded;
+    return true;
+}
+
+// OP_CALL / OP_CALL_INDIRECT 降级：校验寄存器并分配调用点缓存；参数过多时保留通用回退。
+bool lowerCall(const DecodeScope& scope, uint32_t pc, VMDecodedInst& out) {
+    const uint32_t* w = scope.code + pc;
+    const uint32_t paramCount = w[2];
+    const uint32_t typeMask = w[3];
+    if (paramCount > kVmCallSiteMaxParams || !scope.reg(w[5]) || ((typeMask & 0x1) && !scope.reg(w[4]))) {
+        return false;
+    }
+    std::vector<uint32_t> paramRegs(w + 6, w + 6 + paramCount);
+    for (uint32_t reg : paramRegs) {
+        if (!scope.reg(reg)) {
+            return false;
+        }
+    }
+    out.operands[0] = paramCount;
+    out.operands[1] = typeMask;
+    out.operands[2] = w[4];
+    out.operands[3] = w[5];
+    out.target = static_cast<uint32_t>(scope.callSites->size());
+    scope.callSites->push_back(std::move(paramRegs));
+    out.handler = vm::op_call_decoded;
+    return true;
+}
+
+// 把单条指令降级为记录；任何操作数无法在构建期证明合法时保留通用回退。
+void lowerInstruction(const DecodeScope& scope, uint32_t pc, uint32_t index, VMDecodedInst& out) {
+    const uint32_t* w = scope.code + pc;
+    out.opcode = w[0];
+    out.pc = pc;
+    out.type = nullptr;
+    out.target = 0;
+    out.alt_target = 0;
+    out.handler = vm::op_generic_decoded;
+
+    switch (w[0]) {
+        case OP_NOP:
+        case OP_PHI:
+            out.handler = vm::op_next_decoded;
+            break;
+        case OP_END:
+            out.handler = vm::op_end_decoded;
+            break;
+        case OP_RETURN:
+            // 无返回值或返回寄存器合法时可直达。
+            if (w[1] == 0 || scope.reg(w[2])) {
+                out.operands[0] = w[1];
+                out.operands[1] = w[1] ? w[2] : 0;
+                out.handler = vm::op_return_decoded;
+            }
+            break;
+        case OP_MOV:
+            if (scope.reg(w[1]) && scope.reg(w[2])) {
+                out.operands[0] = w[1];
+                out.operands[1] = w[2];
+                out.handler = vm::op_mov_decoded;
+            }
+            break;
+        case OP_LOAD_IMM:
+            if (scope.reg(w[1])) {
+                out.operands[0] = w[1];
+                out.operands[1] = w[2];
+                out.handler = vm::op_load_imm_decoded;
+            }
+            break;
+        case OP_LOAD_CONST:
+        case OP_LOAD_CONST64:
+            if (scope.reg(w[1])) {
+                out.operands[0] = w[1];
+                out.operands[1] = w[2];
+                out.operands[2] = (w[0] == OP_LOAD_CONST64) ? w[3] : 0;
+                out.handler = vm::op_load_const_decoded;
+            }
+            break;
+        case OP_BINARY:
+            if (scope.reg(w[3]) && scope.reg(w[4]) && scope.reg(w[5])) {
+                out.type = scope.type(w[2]);
+                out.operands[0] = w[1];
+                out.operands[1] = w[3];
+                out.operands[2] = w[4];
+                out.operands[3] = w[5];
+                out.handler = vm::op_binary_decoded;
+            }
+            break;
+        case OP_BINARY_IMM:
+            if (scope.reg(w[3]) && scope.reg(w[5])) {
+                out.type = scope.type(w[2]);
+                out.operands[0] = w[1];
+                out.operands[1] = w[3];
+                out.operands[2] = w[4];
+                out.operands[3] = w[5];
+                out.handler = vm::op_binary_imm_decoded;
+            }
+            break;
+        case OP_CMP:
+            if (scope.reg(w[2]) && scope.reg(w[3]) && scope.reg(w[4])) {
+                out.type = scope.type(w[1]);
+                out.operands[0] = w[2];
+                out.operands[1] = w[3];
+                out.operands[2] = w[4];
+                out.operands[3] = w[5];
+                out.handler = vm::op_cmp_decoded;
+            }
+            break;
+        case OP_GET_FIELD:
+            if (scope.reg(w[2]) && scope.reg(w[4])) {
+                out.type = scope.type(w[1]);
+                out.operands[0] = w[2];
+                out.operands[1] = w[3];
+                out.operands[2] = w[4];
+                out.handler = vm::op_get_field_decoded;
+            }
+            break;
+        case OP_SET_FIELD:
+            // value_reg 越界是零寄存器语义，无需校验。
+            if (scope.reg(w[2])) {
+                out.type = scope.type(w[1]);
+                out.operands[0] = w[2];
+                out.operands[1] = w[3];
+                out.operands[2] = w[4];
+                out.handler = vm::op_set_field_decoded;
+            }
+            break;
+        case OP_READ:
+            if (scope.reg(w[2]) && scope.reg(w[3])) {
+                out.type = scope.type(w[1]);
+                out.operands[0] = w[2];
+                out.operands[1] = w[3];
+                out.handler = vm::op_read_decoded;
+            }
+            break;
+        case OP_WRITE:
+            if (scope.reg(w[2]) && scope.reg(w[3])) {
+                out.type = scope.type(w[1]);
+                out.operands[0] = w[2];
+                out.operands[1] = w[3];
+                out.handler = vm::op_write_decoded;
+            }
+            break;
+        case OP_BRANCH: {
+            uint32_t targetPc = 0;
+            if (!scope.branchPc(w[1], targetPc)) {
+                break;
+            }
+            if (targetPc >= scope.function->inst_count) {
+                // 与 op_branch 一致：目标越界即停机。
+                out.handler = vm::op_stop_decoded;
+            } else if (scope.recordAt(targetPc, out.target)) {
+                out.handler = vm::op_branch_decoded;
+            }
+            break;
+        }
+        case OP_BRANCH_IF: {
+            uint32_t truePc = 0;
+            uint32_t falsePc = 0;
+            if (scope.reg(w[1]) &&
+                scope.branchPc(w[2], truePc) &&
+                scope.branchPc(w[3], falsePc) &&
+                scope.recordAt(truePc, out.target) &&
+                scope.recordAt(falsePc, out.alt_target)) {
+                out.operands[0] = w[1];
+                out.handler = vm::op_branch_if_decoded;
+            }
+            break;
+        }
+        case OP_BRANCH_IF_CC: {
+            uint32_t targetPc = 0;
+            out.operands[0] = w[1];
+            if (!scope.branchPc(w[2], targetPc) || targetPc >= scope.function->inst_count) {
+                // 与 op_branch_if_cc 一致：目标无效时命中也按顺序执行。
+                out.target = index + 1;
+                out.handler = vm::op_branch_if_cc_decoded;
+            } else if (scope.recordAt(targetPc, out.target)) {
+                out.handler = vm::op_branch_if_cc_decoded;
+            }
+            break;
+        }
+        case OP_SWITCH:
+            lowerSwitch(scope, pc, index, out);
+            break;
+        case OP_CALL:
+        case OP_CALL_INDIRECT:
+            lowerCall(scope, pc, out);
+            break;
+        default: {
+            // 类型特化 opcode：[op][a][b][c]，寄存器操作数按形态校验（store 的 value 越界表示零寄存器）。
+            const vm::VMTypedOpcodeInfo* typed = vm::getTypedOpcodeInfo(w[0]);
+            if (typed != nullptr &&
+                scope.reg(w[1]) &&
+                (typed->kind != VM_TYPED_BINARY || scope.reg(w[2])) &&
+                (typed->kind == VM_TYPED_STORE || scope.reg(w[3]))) {
+                out.operands[0] = w[1];
+                out.operands[1] = w[2];
+                out.operands[2] = w[3];
+                out.handler = vm::getTypedDecodedHandler(w[0]);
+            }
+            // 其余 opcode 走通用回退（语义完全复用 word 处理函数）。
+            break;
+        }
+    }
+}
+
+} // namespace
+
+// 构建函数的预解码表示。
+bool buildDecodedFunction(zFunction* function) {
+    if (function == nullptr || function->inst_list == nullptr || function->inst_count == 0) {
+        return false;
+    }
+    // 重建前释放旧记录。
+    releaseDecodedFunction(function);
+
+    const uint32_t instCount = function->inst_count;
+    const uint32_t* code = function->inst_list;
+
+    // 1) 线性切分：记录每条指令起点，并建立 pc -> 记录下标反查表。
+    std::vector<uint32_t> pcIndex(instCount, kVmDecodedInvalidIndex);
+    std::vector<uint32_t> heads;
+    heads.reserve(instCount / 3 + 1);
+    for (uint32_t pc = 0; pc < instCount;) {
+        const uint32_t length = vmInstructionLength(code, instCount, pc);
+        if (length == 0) {
+            LOGW("buildDecodedFunction skipped: undecodable opcode=%u at pc=%u fun_addr=0x%llx",
+                 code[pc],
+                 pc,
+                 static_cast<unsigned long long>(function->functionAddress()));
+            return false;
+        }
+        pcIndex[pc] = static_cast<uint32_t>(heads.size());
+        heads.push_back(pc);
+        pc += length;
+    }
+
+    // 2) 逐条降级；末尾追加哨兵，顺序执行越过最后一条时正常结束。
+    const uint32_t recordCount = static_cast<uint32_t>(heads.size());
+    std::unique_ptr<VMDecodedInst[]> records(new VMDecodedInst[recordCount + 1]());
+    std::vector<uint32_t> switchPool;
+    std::vector<std::vector<uint32_t>> callSites;
+    const DecodeScope scope{function, code, pcIndex, &switchPool, &callSites};
+    for (uint32_t i = 0; i < recordCount; ++i) {
+        lowerInstruction(scope, heads[i], i, records[i]);
+    }
+    VMDecodedInst& sentinel = records[recordCount];
+    sentinel.handler = vm::op_halt_decoded;
+    sentinel.opcode = OP_END;
+    sentinel.pc = instCount;
+
+    // 3) 固化到函数对象。
+    std::unique_ptr<uint32_t[]> pcIndexList(new uint32_t[instCount]);
+    std::memcpy(pcIndexList.get(), pcIndex.data(), sizeof(uint32_t) * instCount);
+    function->decoded_list = records.release();
+    function->decoded_count = recordCount;
+    function->decoded_pc_index = pcIndexList.release();
+    if (!switchPool.empty()) {
+        function->decoded_switch_pool = new uint32_t[switchPool.size()];
+        std::memcpy(function->decoded_switch_pool, switchPool.data(), sizeof(uint32_t) * switchPool.size());
+        function->decoded_switch_pool_size = static_cast<uint32_t>(switchPool.size());
+    }
+    if (!callSites.empty()) {
+        // 零初始化即空缓存；thunk 与参数寄存器在此一次性写定。
+        VMCallSiteCache* sites = new VMCallSiteCache[callSites.size()]();
+        for (size_t i = 0; i < callSites.size(); ++i) {
+            const uint32_t paramCount = static_cast<uint32_t>(callSites[i].size());
+            sites[i].param_count = paramCount;
+            sites[i].thunk = vm::selectCallThunk(paramCount);
+            std::copy(callSites[i].begin(), callSites[i].end(), sites[i].param_regs);
+        }
+        function->decoded_call_sites = sites;
+        function->decoded_call_site_count = static_cast<uint32_t>(callSites.size());
+    }
+    return true;
+}
+
+// 释放预解码记录。
+void releaseDecodedFunction(zFunction* function) {
+    if (function == nullptr) {
+        return;
+    }
+    delete[] function->decoded_list;
+    function->decoded_list = nullptr;
+    delete[] function->decoded_pc_index;
+    function->decoded_pc_index = nullptr;
+    delete[] function->decoded_switch_pool;
+    function->decoded_switch_pool = nullptr;
+    function->decoded_switch_pool_size = 0;
+    delete[] function->decoded_call_sites;
+    function->decoded_call_sites = nullptr;
+    function->decoded_call_site_count = 0;
+    function->decoded_count = 0;
+}
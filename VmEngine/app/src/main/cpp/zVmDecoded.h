@@ -0,0 +1,156 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 预解码（closure-threaded）函数表示声明。
+ * - 加固链路位置：执行前准备层（cacheFunction 时一次性构建）。
+ * - 输入：zFunction 的 inst_list/branch/type 运行态数组。
+ * - 输出：定长记录数组 + pc 反查表，供热循环免查表执行。
+ */
+#ifndef Z_VM_DECODED_H
+#define Z_VM_DECODED_H
+
+#include "zVmEngine.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace vm {
+// 预解码处理函数：执行一条记录并返回下一条记录；返回 nullptr 表示离开预解码循环。
+typedef const VMDecodedInst* (*DecodedHandler)(VMContext* ctx, const VMDecodedInst* inst);
+} // namespace vm
+
+// ============================================================================
+// 预解码记录：48 字节定长
+// ============================================================================
+// 操作数在构建期完成边界校验；跳转目标已由 branchId 解析为记录下标。
+struct VMDecodedInst {
+    vm::DecodedHandler handler;   // 快速处理函数（或通用回退）
+    const zType* type;            // 预解析类型（无类型指令为 nullptr）
+    uint32_t opcode;              // 原始 opcode
+    uint32_t pc;                  // 原始 word pc（回退路径与日志使用）
+    uint32_t operands[4];         // 预取操作数（寄存器下标/立即数/子操作码，按 opcode 约定）
+    uint32_t target;              // 主跳转目标记录下标
+    uint32_t alt_target;          // 备选跳转目标记录下标（BRANCH_IF false 分支）
+};
+
+static_assert(sizeof(VMDecodedInst) == 48, "VMDecodedInst must be 48 bytes");
+
+// pc 反查表中“非指令起点”的占位值。
+constexpr uint32_t kVmDecodedInvalidIndex = 0xFFFFFFFFu;
+
+// OP_SWITCH 预解码形态（记录 operands[1]）；case 表位于 zFunction::decoded_switch_pool。
+enum VMSwitchKind : uint32_t {
+    VM_SWITCH_LINEAR = 0,   // 少量 case：[value, record] 按原顺序线性比较
+    VM_SWITCH_DENSE = 1,    // 值域稠密：[min_value][record x range] 直接下标跳转
+    VM_SWITCH_SPARSE = 2,   // 值域稀疏：[value, record] 按 value 升序二分查找
+};
+
+// ============================================================================
+// OP_CALL / OP_CALL_INDIRECT 调用点内联缓存
+// ============================================================================
+// 每个调用点一份（位于 zFunction::decoded_call_sites，记录 target 字段为其下标）。
+// 槽位只追加不替换：空槽经 CAS 占用后写入类别/载荷，最后 release 发布目标地址，读者 acquire 比较命中后即可读取其余字段。
+// 槽位写满后仍未命中即标记为超多态，此后未命中直接走通用处理函数。
+
+// 单个调用点最多缓存的目标数（单态站点只占第一个槽）。
+constexpr uint32_t kVmCallSiteWays = 4;
+// 预解码调用点内联携带的参数寄存器上限（超过时保留通用回退）。
+constexpr uint32_t kVmCallSiteMaxParams = 8;
+// 槽位占用中的目标占位值（不会作为真实目标缓存）。
+constexpr uint64_t kVmCallSiteFilling = ~0ull;
+
+// 缓存目标类别。
+enum VMCallTargetKind : uint32_t {
+    VM_CALL_TARGET_LOCAL = 1,      // 函数内 branchId：payload = 目标记录下标
+    VM_CALL_TARGET_PROTECTED = 2,  // 本模块受保护函数：payload = fun_addr，嵌套 VM 调用
+    VM_CALL_TARGET_NATIVE = 3,     // 普通原生函数：经调用点预选的 thunk 直接调用
+};
+
+// 原生调用 thunk：按参数个数固定签名，构建期按调用点 param_count 选定。
+typedef uint64_t (*VMCallThunk)(uint64_t target, const uint64_t* args);
+
+// 缓存槽。
+struct VMCallSiteEntry {
+    std::atomic<uint64_t> target;  // 目标地址（0=空，kVmCallSiteFilling=占用中）
+    uint64_t payload;              // 按类别解释
+    uint32_t kind;                 // VMCallTargetKind
+};
+
+// 调用点缓存（new[]() 零初始化即为空缓存）。
+struct VMCallSiteCache {
+    VMCallSiteEntry entries[kVmCallSiteWays];
+    std::atomic<uint32_t> megamorphic;               // 非 0：槽位已满，未命中不再解析
+    VMCallThunk thunk;                               // 原生目标调用 thunk
+    uint32_t param_count;                            // 参数个数
+    uint32_t param_regs[kVmCallSiteMaxParams];       // 参数寄存器下标（构建期已校验）
+};
+
+// 计算 pc 处整条指令的 word 长度；未知 opcode 或越界返回 0。
+uint32_t vmInstructionLength(const uint32_t* instructions, uint32_t instCount, uint32_t pc);
+
+// 为函数构建预解码记录；无法完整线性切分时返回 false，函数保持 word 解释模式。
+bool buildDecodedFunction(zFunction* function);
+
+// 释放函数的预解码记录与 pc 反查表。
+void releaseDecodedFunction(zFunction* function);
+
+namespace vm {
+
+// ============================================================================
+// 预解码快速处理函数（实现位于 zVmOpcodes.cpp，与 word 处理函数共享辅助逻辑）
+// ============================================================================
+
+// 通用回退：按原 pc 调用 g_opcode_table，再经 pc 反查表回到记录流。
+const VMDecodedInst* op_generic_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// 顺序后继（OP_NOP / OP_PHI）。
+const VMDecodedInst* op_next_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// 末尾哨兵：pc 推到 inst_count，正常结束。
+const VMDecodedInst* op_halt_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// 停机（OP_BRANCH 目标越界）。
+const VMDecodedInst* op_stop_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_END。
+const VMDecodedInst* op_end_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_RETURN：operands = {has_value, value_reg}。
+const VMDecodedInst* op_return_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_MOV：operands = {src_reg, dst_reg}。
+const VMDecodedInst* op_mov_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_LOAD_IMM：operands = {dst_reg, imm}。
+const VMDecodedInst* op_load_imm_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_LOAD_CONST / OP_LOAD_CONST64：operands = {dst_reg, low32, high32}。
+const VMDecodedInst* op_load_const_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_BINARY：operands = {sub_op, lhs_reg, rhs_reg, dst_reg}。
+const VMDecodedInst* op_binary_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_BINARY_IMM：operands = {sub_op, lhs_reg, imm, dst_reg}。
+const VMDecodedInst* op_binary_imm_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_CMP：operands = {lhs_reg, rhs_reg, result_reg, cmp_op}。
+const VMDecodedInst* op_cmp_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_GET_FIELD：operands = {base_reg, offset, dst_reg}。
+const VMDecodedInst* op_get_field_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_SET_FIELD：operands = {base_reg, offset, value_reg}（value_reg 越界表示零寄存器）。
+const VMDecodedInst* op_set_field_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// 类型特化 opcode（VM_TYPED_OPCODE_LIST）的预解码处理函数：operands = {a, b, c}，与指令 word 1..3 同序；
+// 非特化 opcode 返回 nullptr。
+DecodedHandler getTypedDecodedHandler(uint32_t opcode);
+// OP_READ：operands = {dst_reg, addr_reg}。
+const VMDecodedInst* op_read_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_WRITE：operands = {addr_reg, value_reg}。
+const VMDecodedInst* op_write_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_BRANCH：target 为目标记录下标。
+const VMDecodedInst* op_branch_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_BRANCH_IF：operands = {cond_reg}，target/alt_target 为真/假目标记录下标。
+const VMDecodedInst* op_branch_if_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_BRANCH_IF_CC：operands = {cc}，target 为命中目标记录下标（未命中顺序执行）。
+const VMDecodedInst* op_branch_if_cc_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_SWITCH：operands = {value_reg, kind, pool_offset, entry_count}，target 为默认目标记录下标。
+const VMDecodedInst* op_switch_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// OP_CALL / OP_CALL_INDIRECT：operands = {param_count, type_mask, result_reg, func_ptr_reg}，target 为调用点缓存下标。
+const VMDecodedInst* op_call_decoded(VMContext* ctx, const VMDecodedInst* inst);
+// 按参数个数选择原生调用 thunk（与 op_call 的参数截断规则一致）。
+VMCallThunk selectCallThunk(uint32_t paramCount);
+
+// 预解码解释循环：从 ctx->pc 对应记录开始执行；
+// 返回时要么已停机，要么 ctx->pc 指向记录流无法承接的位置，由 word 解释循环继续。
+void runDecoded(VMContext* ctx);
+
+} // namespace vm
+
+#endif // Z_VM_DECODED_H
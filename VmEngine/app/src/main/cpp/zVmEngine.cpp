@@ -9,18 +9,43 @@
 
 // opcode 分发表与处理函数。
 #include "zVmOpcodes.h"
+// 预解码记录构建与执行。
+#include "zVmDecoded.h"
+// 加载期字节码校验。
+#include "zVmVerifier.h"
+// 16 位紧凑指令流。
+#include "zVmCompact.h"
+// 基线 JIT 层。
+#include "zVmJit.h"
+// 线程本地寄存器帧栈。
+#include "zVmFrame.h"
+// 批量执行线程池。
+#include "zVmWorkerPool.h"
+// 模块级只读 arena（bundle 函数运行态数组）。
+#include "zVmModuleArena.h"
 // 日志。
 #include "zLog.h"
+// bundle 跨端协议（branch 地址 VM 目标标记）。
+#include "shared/bundle/zSoBinBundleProtocol.h"
 // memset / memcpy。
 #include <cstring>
+// snprintf。
+#include <cstdio>
 // calloc / free。
 #include <cstdlib>
+// hardware_concurrency。
+#include <thread>
 
 // 追踪开关（默认关闭）。
 #ifndef VM_TRACE
 #define VM_TRACE 0
 #endif
 
+// 线程化分发开关（默认开启）；trace 打开时仍走逐条 dispatch 以保留单步日志。
+#ifndef VM_THREADED_DISPATCH
+#define VM_THREADED_DISPATCH 1
+#endif
+
 // trace 打开时输出详细执行日志。
 #if VM_TRACE
 #define VM_TRACE_LOGD(...) LOGD(__VA_ARGS__)
@@ -33,14 +58,17 @@
 // 寄存器管理器辅助函数
 // ============================================================================
 
-// 分配寄存器管理器（头部 + 柔性数组一次性分配）。
+// 分配寄存器管理器（头部 + SoA 存储一次性分配）。
 RegManager* allocRegManager(uint32_t count) {
-    // 每个寄存器槽固定 24 字节。
-    size_t size = sizeof(RegManager) + 24 * count;
-    // 零初始化分配，确保未写字段默认值为 0。
+    // 值数组、释放基址与 ownership 侧表共用一块存储。
+    size_t size = sizeof(RegManager) + VMRegFile::storageUnits(count) * sizeof(uint64_t);
+    // 零初始化分配，确保值与侧表默认值为 0。
     RegManager* mgr = static_cast<RegManager*>(calloc(1, size));
-    // 记录槽位数量。
-    mgr->count = count;
+    if (mgr == nullptr) {
+        return nullptr;
+    }
+    // 建立指向柔性数组区的视图。
+    mgr->regs = VMRegFile::bind(mgr->storage, count);
     return mgr;
 }
 
@@ -48,14 +76,15 @@ RegManager* allocRegManager(uint32_t count) {
 void freeRegManager(RegManager* mgr) {
     // 空指针直接返回。
     if (mgr) {
-        // 遍历全部寄存器槽。
-        for (uint32_t i = 0; i < mgr->count; i++) {
-            // 仅处理 ownership=1 的需要回收槽位。
-            if (mgr->slots[i].ownership == 1) {
-                // 优先使用 reserved 作为可释放基址；否则回退到 value。
-                const uint64_t freePtr = (mgr->slots[i].reserved != 0)
-                                         ? mgr->slots[i].reserved
-                                         : mgr->slots[i].value;
+        const VMRegFile& regs = mgr->regs;
+        // 只扫描 1 字节/寄存器的 ownership 侧表。
+        for (uint32_t i = 0; i < regs.count; i++) {
+            // 仅处理 ownership=1 的需要回收寄存器。
+            if (regs.owned[i] == 1) {
+                // 优先使用 free_base 作为可释放基址；否则回退到值本身。
+                const uint64_t freePtr = (regs.free_base[i] != 0)
+                                         ? regs.free_base[i]
+                                         : regs.values[i];
                 // 非空指针才执行 free。
                 if (freePtr != 0) {
                     free(reinterpret_cast<void*>(freePtr));
@@ -78,15 +107,219 @@ zVmEngine& zVmEngine::getInstance() {
     return instance;
 }
 
-// 构造函数：初始化 opcode 表与缓存容量。
+// ============================================================================
+// 函数缓存快照
+// ============================================================================
+// 不可变开放寻址表：写者复制旧表插入新项后整体发布，读者只做一次原子加载 + 线性探测。
+// 键为 fun_addr（0 非法，用作空槽标记）；装载因子不超过 1/2。
+struct zVmFunctionTable {
+    struct Entry {
+        uint64_t key;          // fun_addr（0=空槽）
+        zFunction* function;   // 缓存函数
+    };
+
+    uint32_t mask = 0;         // 槽数 - 1（槽数为 2 的幂）
+    uint32_t count = 0;        // 已占用槽数
+    Entry* entries = nullptr;  // 槽数组
+    // 热替换发布的函数固定引用的模块状态：随复制沿用到新表，整代函数退役时一并释放。
+    std::vector<const zVmModuleState*> pinned_states;
+    // 热替换发布的函数所在模块 arena：同样随复制沿用，整代函数销毁后按块释放。
+    std::vector<zVmModuleArena*> arenas;
+
+    ~zVmFunctionTable() {
+        delete[] entries;
+    }
+
+    // 起始探测槽：乘法散列取高位，避免函数地址低位对齐造成聚集。
+    uint32_t slotOf(uint64_t key) const {
+        return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    }
+
+    // 查找；未命中返回 nullptr。
+    zFunction* find(uint64_t key) const {
+        for (uint32_t slot = slotOf(key);; slot = (slot + 1) & mask) {
+            const Entry& entry = entries[slot];
+            if (entry.key == key) {
+                return entry.function;
+            }
+            if (entry.key == 0) {
+                return nullptr;
+            }
+        }
+    }
+
+    // 插入或替换；返回被替换的旧函数（无则 nullptr）。仅用于尚未发布的新表。
+    zFunction* insert(uint64_t key, zFunction* function) {
+        for (uint32_t slot = slotOf(key);; slot = (slot + 1) & mask) {
+            Entry& entry = entries[slot];
+            if (entry.key == key) {
+                zFunction* previous = entry.function;
+                entry.function = function;
+                return previous;
+            }
+            if (entry.key == 0) {
+                entry.key = key;
+                entry.function = function;
+                ++count;
+                return nullptr;
+            }
+        }
+    }
+
+    // 创建能容纳 capacityHint 项的空表。
+    static zVmFunctionTable* create(uint32_t capacityHint) {
+        uint32_t slots = 16;
+        while (slots < capacityHint * 2) {
+            slots <<= 1;
+        }
+        zVmFunctionTable* table = new zVmFunctionTable();
+        table->mask = slots - 1;
+        table->entries = new Entry[slots]();
+        return table;
+    }
+};
+
+// 热替换暂存区：发布前只由构建线程访问。
+struct zVmBundleStage {
+    // 本代模块：状态与 arena 在发布时转为新快照表持有。
+    struct Module {
+        zVmModule* module = nullptr;
+        std::unique_ptr<zVmModuleState> state;
+        std::unique_ptr<zVmModuleArena> arena;
+    };
+    std::vector<Module> modules;
+    // 本代函数（已准备并绑定到本代模块状态，按 bundle 顺序）。
+    std::vector<zFunction*> functions;
+
+    // 按模块名查找本代模块。
+    Module* findModule(const char* soName) {
+        for (Module& staged : modules) {
+            if (staged.module->so_name == soName) {
+                return &staged;
+            }
+        }
+        return nullptr;
+    }
+};
+
+namespace {
+
+// epoch 回收释放函数：旧快照表本体（函数对象仍由新表持有）。
+void deleteFunctionTable(void* object) {
+    delete static_cast<zVmFunctionTable*>(object);
+}
+
+// 把函数的只读运行态数组搬入模块 arena：按暂存（bundle）顺序追加，每个函数从新的 cache line 开始，
+// 热数据在前（预解码记录、pc 反查表每条指令都要读）。arena 空间不足时返回 false，函数保持堆上数组不变。
+bool moveFunctionToArena(zFunction* function, zVmModuleArena& arena) {
+    bool ok = true;
+    size_t align = zVmModuleArena::kLineAlign;
+    // 首个数组按 cache line 对齐，其后紧密排列（8 字节对齐）。
+    auto place = [&arena, &ok, &align](const auto* src, size_t count) {
+        auto* dst = arena.copyArray(src, count, align, ok);
+        if (dst != nullptr) {
+            align = sizeof(uint64_t);
+        }
+        return dst;
+    };
+    VMDecodedInst* decodedList =
+        place(function->decoded_list, function->decoded_list != nullptr ? function->decoded_count + 1 : 0);
+    uint32_t* decodedPcIndex = place(function->decoded_pc_index, function->inst_count);
+    uint32_t* switchPool = place(function->decoded_switch_pool, function->decoded_switch_pool_size);
+    VMRegSlot* registerList = place(function->register_list, function->register_count);
+    uint16_t* instCompact = place(function->inst_compact, function->inst_count);
+    uint32_t* widePool = place(function->inst_wide_pool, function->inst_wide_count);
+    uint32_t* instList = place(function->inst_list, function->inst_count);
+    uint32_t* branchWords = place(function->branch_words_ptr, function->branch_count);
+    const zType** typeList = place(function->type_list, function->type_count);
+    if (!ok) {
+        return false;
+    }
+
+    // 替换为 arena 副本并释放堆上原件。
+    delete[] function->decoded_list;
+    function->decoded_list = decodedList;
+    delete[] function->decoded_pc_index;
+    function->decoded_pc_index = decodedPcIndex;
+    delete[] function->decoded_switch_pool;
+    function->decoded_switch_pool = switchPool;
+    delete[] function->register_list;
+    function->register_list = registerList;
+    delete[] function->inst_compact;
+    function->inst_compact = instCompact;
+    delete[] function->inst_wide_pool;
+    function->inst_wide_pool = widePool;
+    delete[] function->inst_list;
+    function->inst_list = instList;
+    delete[] function->branch_words_ptr;
+    function->branch_words_ptr = branchWords;
+    delete[] function->type_list;
+    function->type_list = typeList;
+    function->arena_backed = true;
+    return true;
+}
+
+// epoch 回收释放函数：旧模块状态快照。
+void deleteModuleState(void* object) {
+    delete static_cast<const zVmModuleState*>(object);
+}
+
+// epoch 回收释放函数：被换下的接管直连绑定。
+void deleteBoundCall(void* object) {
+    delete static_cast<zVmBoundCall*>(object);
+}
+
+// 批量执行任务描述（run 期间只读，各参与者共享）。
+struct zVmBatchJob {
+    zVmEngine* engine;
+    zFunction* function;
+    const zVmModule* module;
+    const uint64_t* params;
+    uint32_t arg_count;
+    uint64_t* results;
+};
+
+// 批量执行单块下标数：足够摊薄取块开销，又给窃取留出粒度。
+constexpr size_t kVmBatchGrain = 64;
+
+// 运行态是否完整（寄存器/指令/类型均已就绪）。
+bool isFunctionRunnable(const zFunction* function) {
+    return function != nullptr &&
+           function->register_count != 0 &&
+           function->inst_count != 0 &&
+           function->register_list != nullptr &&
+           (function->inst_list != nullptr || function->inst_compact != nullptr) &&
+           function->type_list != nullptr;
+}
+
+// 帧寄存器初态：只清零预设阶段不写入、也不会被实参覆盖的槽位，再复制预设寄存器。
+// ownership/free_base 侧表不整体清零：帧路径只读取经 trackOwned 登记的下标（登记前必先写入），
+// 帧回收时登记项复位为 0，未登记槽位的残留值不会被读取。
+void resetFrameRegisters(const zFunction* function, const VMRegFile& registers, uint32_t paramCount) {
+    const std::vector<uint32_t>& runs = function->register_zero_runs;
+    for (size_t i = 0; i + 1 < runs.size(); i += 2) {
+        // x0..x(paramCount-1) 随后由实参写入，跳过。
+        const uint32_t begin = runs[i] > paramCount ? runs[i] : paramCount;
+        const uint32_t end = runs[i + 1];
+        if (end > begin) {
+            memset(registers.values + begin, 0, static_cast<size_t>(end - begin) * sizeof(uint64_t));
+        }
+    }
+    // 只复制预设阶段实际写入的寄存器（AoS 镜像拆分到 SoA 帧）。
+    for (uint32_t regIdx : function->register_init_list) {
+        registers.load(regIdx, function->register_list[regIdx]);
+    }
+}
+
+} // namespace
+
+// 构造函数：初始化 opcode 表。
 zVmEngine::zVmEngine() {
     // 初始化 opcode 跳转表。
     vm::initOpcodeTable();
-    // 预留缓存容量，降低扩容开销。
-    cache_.reserve(256);
 }
 
-// 析构函数：释放缓存中的函数对象。
+// 析构函数：退役缓存中的函数对象（回收域析构时统一释放）。
 zVmEngine::~zVmEngine() {
     clearCache();
 }
@@ -97,23 +330,60 @@ void zVmEngine::destroyFunction(zFunction* function) {
     if (function == nullptr) {
         return;
     }
+    // arena 中的数组随 arena 整体释放，这里只摘除指针。
+    function->detachArenaStorage();
     // 释放寄存器初值数组。
     delete[] function->register_list;
     function->register_list = nullptr;
     // 释放指令数组。
     delete[] function->inst_list;
     function->inst_list = nullptr;
+    // 释放紧凑指令流。
+    releaseCompactFunction(function);
     // 释放 branch_id 列表。
     delete[] function->branch_words_ptr;
     function->branch_words_ptr = nullptr;
+    // 释放预解码记录。
+    releaseDecodedFunction(function);
+    // 释放基线 JIT 产物。
+    releaseJitCode(function->jit_code.exchange(nullptr));
     // 释放类型系统相关资源。
     function->releaseTypeResources();
     // 释放对象本体。
     delete function;
 }
 
+// epoch 回收释放函数：被替换的单个函数。
+void zVmEngine::deleteRetiredFunction(void* object) {
+    destroyFunction(static_cast<zFunction*>(object));
+}
+
+// epoch 回收释放函数：清空缓存时的整张表连同其中所有函数。
+void zVmEngine::deleteFunctionTableAndFunctions(void* object) {
+    zVmFunctionTable* table = static_cast<zVmFunctionTable*>(object);
+    for (uint32_t slot = 0; slot <= table->mask; ++slot) {
+        if (table->entries[slot].key != 0) {
+            destroyFunction(table->entries[slot].function);
+        }
+    }
+    for (const zVmModuleState* state : table->pinned_states) {
+        delete state;
+    }
+    // 函数对象已销毁：各模块 arena 按块一次释放。
+    for (zVmModuleArena* arena : table->arenas) {
+        delete arena;
+    }
+    delete table;
+}
+
+// 在当前快照中查找函数。
+zFunction* zVmEngine::findFunction(uint64_t funAddr) const {
+    const zVmFunctionTable* table = function_table_.load(std::memory_order_acquire);
+    return table != nullptr ? table->find(funAddr) : nullptr;
+}
+
 // 把函数对象缓存到引擎中（key = fun_addr）。
-bool zVmEngine::cacheFunction(std::unique_ptr<zFunction> function) {
+bool zVmEngine::cacheFunction(std::unique_ptr<zFunction> function, const char* soName) {
     // 空对象或空内容直接拒绝。
     if (!function || function->empty()) {
         return false;
@@ -126,19 +396,199 @@ bool zVmEngine::cacheFunction(std::unique_ptr<zFunction> function) {
         return false;
     }
 
-    // 写缓存需要独占锁。
-    std::unique_lock<std::shared_timed_mutex> lock(cache_mutex_);
-    // 若存在同 key 旧函数，先释放旧对象。
-    auto it = cache_.find(key);
-    if (it != cache_.end()) {
-        destroyFunction(it->second);
+    // 锁外完成一次性准备。
+    prepareFunction(function.get());
+
+    // 指定模块时一次性绑定：执行期直接取模块基址与已重定位分支表。
+    if (soName != nullptr && soName[0] != '\0') {
+        std::lock_guard<std::mutex> moduleLock(module_mutex_);
+        const zVmModule* module = findOrCreateModuleLocked(soName);
+        if (module == nullptr) {
+            LOGW("cacheFunction: module %s not loaded, binding deferred to execute", soName);
+        } else {
+            bindFunctionModule(function.get(), module, *module->state.load(std::memory_order_acquire));
+        }
     }
 
-    // 接管 unique_ptr 所有权并写入缓存。
-    cache_[key] = function.release();
+    zFunction* replaced = nullptr;
+    const zVmFunctionTable* oldTable = nullptr;
+    {
+        // 写者串行化：复制当前快照、插入新项后发布。
+        std::lock_guard<std::mutex> lock(cache_write_mutex_);
+        oldTable = function_table_.load(std::memory_order_relaxed);
+        const uint32_t oldCount = oldTable != nullptr ? oldTable->count : 0;
+        zVmFunctionTable* newTable = zVmFunctionTable::create(oldCount + 1);
+        if (oldTable != nullptr) {
+            newTable->pinned_states = oldTable->pinned_states;
+            newTable->arenas = oldTable->arenas;
+            for (uint32_t slot = 0; slot <= oldTable->mask; ++slot) {
+                const zVmFunctionTable::Entry& entry = oldTable->entries[slot];
+                if (entry.key != 0) {
+                    newTable->insert(entry.key, entry.function);
+                }
+            }
+        }
+        // 接管 unique_ptr 所有权并写入新快照。
+        replaced = newTable->insert(key, function.release());
+        function_table_.store(newTable, std::memory_order_release);
+        // 替换已有函数：发布后推进代数（先于退役），持有旧函数的直连绑定随之失效。
+        if (replaced != nullptr) {
+            cache_generation_.fetch_add(1, std::memory_order_seq_cst);
+        }
+    }
+    // 旧快照与被替换函数可能仍被执行中的读者引用：交给 epoch 回收。
+    if (oldTable != nullptr) {
+        reclaim_domain_.retire(const_cast<zVmFunctionTable*>(oldTable), deleteFunctionTable);
+    }
+    if (replaced != nullptr) {
+        reclaim_domain_.retire(replaced, deleteRetiredFunction);
+    }
     return true;
 }
 
+// 缓存前的一次性准备。
+void zVmEngine::prepareFunction(zFunction* function) {
+    // 一次性校验：通过的函数执行时跳过逐操作数检查，失败则保持检查模式。
+    function->verified = verifyFunction(function);
+    // 间接跳转稠密索引：OP_BRANCH_REG 常数时间定位目标 pc。
+    function->buildBranchLookupIndex();
+    // 一次性预解码；失败时函数仍可走 word 解释。
+    buildDecodedFunction(function);
+#if VM_COMPACT_BYTECODE
+    // 最后转码为 16 位紧凑流并释放 word 流（依赖 inst_list 的准备步骤必须在此之前完成）。
+    buildCompactFunction(function);
+#endif
+}
+
+// 开始构建新一代 bundle。
+zVmBundleStage* zVmEngine::beginBundle() {
+    return new zVmBundleStage();
+}
+
+// 暂存模块状态：按 so 当前映像（可能刚重新加载）重新绑定，不触碰当前代正在使用的状态。
+bool zVmEngine::stageModule(zVmBundleStage* stage, const char* soName, std::vector<uint64_t> branchEntries) {
+    if (stage == nullptr || soName == nullptr || soName[0] == '\0') {
+        return false;
+    }
+    if (stage->findModule(soName) != nullptr) {
+        LOGE("stageModule failed: module %s already staged", soName);
+        return false;
+    }
+    std::lock_guard<std::mutex> moduleLock(module_mutex_);
+    // 模块对象身份稳定（跨代复用），代与代之间只替换状态。
+    zVmModule* module = findOrCreateModuleLocked(soName);
+    soinfo* soInfo = GetSoinfo(soName);
+    if (module == nullptr || soInfo == nullptr) {
+        LOGE("stageModule failed: module %s not loaded", soName);
+        return false;
+    }
+    std::unique_ptr<zVmModuleState> state = std::make_unique<zVmModuleState>();
+    state->so_info = soInfo;
+    state->base = soInfo->base;
+    state->branch_entries = std::move(branchEntries);
+    const size_t boundCount = buildSharedBranchTable(*state);
+    LOGI("stageModule: so=%s branch_count=%zu got_bound=%zu",
+         soName,
+         state->branch_addrs.size(),
+         boundCount);
+    zVmBundleStage::Module staged;
+    staged.module = module;
+    staged.state = std::move(state);
+    staged.arena = std::make_unique<zVmModuleArena>();
+    stage->modules.push_back(std::move(staged));
+    return true;
+}
+
+// 暂存函数：准备与绑定都在暂存区内完成，执行路径不可见。
+bool zVmEngine::stageFunction(zVmBundleStage* stage, std::unique_ptr<zFunction> function, const char* soName) {
+    if (stage == nullptr || !function || function->empty() || function->functionAddress() == 0) {
+        return false;
+    }
+    zVmBundleStage::Module* staged = soName != nullptr ? stage->findModule(soName) : nullptr;
+    if (staged == nullptr) {
+        LOGE("stageFunction failed: module %s not staged, fun_addr=0x%llx",
+             soName == nullptr ? "(null)" : soName,
+             static_cast<unsigned long long>(function->functionAddress()));
+        return false;
+    }
+    prepareFunction(function.get());
+    // 固定引用本代状态：发布后即使模块状态再被替换，本代函数仍使用与自身 branch id 对应的共享表。
+    bindFunctionModule(function.get(), staged->module, *staged->state);
+    function->module_state = staged->state.get();
+    // 只读运行态数组搬入模块 arena；失败时保留堆上数组，函数照常可用。
+    if (!moveFunctionToArena(function.get(), *staged->arena)) {
+        LOGW("stageFunction: arena placement failed, keeping heap arrays, fun_addr=0x%llx",
+             static_cast<unsigned long long>(function->functionAddress()));
+    }
+    stage->functions.push_back(function.release());
+    return true;
+}
+
+// 发布新一代：函数快照整体替换（一次原子存储），旧代整表连同函数与固定状态经 epoch 回收。
+void zVmEngine::publishBundle(zVmBundleStage* stage) {
+    if (stage == nullptr) {
+        return;
+    }
+    // 锁外建表：新表只含本代函数（同 key 后者覆盖前者）。
+    zVmFunctionTable* newTable = zVmFunctionTable::create(static_cast<uint32_t>(stage->functions.size()));
+    for (zFunction* function : stage->functions) {
+        zFunction* duplicate = newTable->insert(function->functionAddress(), function);
+        if (duplicate != nullptr) {
+            destroyFunction(duplicate);
+        }
+    }
+    // 模块 arena 封存为只读：此后执行路径对指令流/预解码记录的任何写入都会立即暴露。
+    size_t arenaBytes = 0;
+    size_t arenaChunks = 0;
+    newTable->pinned_states.reserve(stage->modules.size());
+    newTable->arenas.reserve(stage->modules.size());
+    for (zVmBundleStage::Module& staged : stage->modules) {
+        newTable->pinned_states.push_back(staged.state.get());
+        staged.arena->seal();
+        arenaBytes += staged.arena->usedBytes();
+        arenaChunks += staged.arena->chunkCount();
+        // 所有权转给新快照表。
+        newTable->arenas.push_back(staged.arena.release());
+    }
+
+    const zVmFunctionTable* oldTable = nullptr;
+    {
+        std::lock_guard<std::mutex> moduleLock(module_mutex_);
+        // 模块当前状态同步为本代（供未固定状态的路径使用）；本代函数已固定引用暂存状态，两者先后无关。
+        for (zVmBundleStage::Module& staged : stage->modules) {
+            publishModuleStateLocked(staged.module, std::make_unique<zVmModuleState>(*staged.state));
+            // 所有权转给新快照表。
+            staged.state.release();
+        }
+        std::lock_guard<std::mutex> lock(cache_write_mutex_);
+        oldTable = function_table_.exchange(newTable, std::memory_order_acq_rel);
+        // 旧代函数即将退役：直连绑定整体失效，下次调用按 key 分发后绑定到新代。
+        cache_generation_.fetch_add(1, std::memory_order_seq_cst);
+    }
+    LOGI("publishBundle: modules=%zu functions=%u arena_bytes=%zu arena_chunks=%zu",
+         stage->modules.size(),
+         newTable->count,
+         arenaBytes,
+         arenaChunks);
+    delete stage;
+    // 执行中的调用可能仍在旧代上：宽限期后回收。
+    if (oldTable != nullptr) {
+        reclaim_domain_.retire(const_cast<zVmFunctionTable*>(oldTable), deleteFunctionTableAndFunctions);
+    }
+}
+
+// 放弃暂存内容（从未发布，可直接释放）。
+void zVmEngine::discardBundle(zVmBundleStage* stage) {
+    if (stage == nullptr) {
+        return;
+    }
+    // 先销毁函数（只摘除 arena 指针），再随暂存区释放 arena。
+    for (zFunction* function : stage->functions) {
+        destroyFunction(function);
+    }
+    delete stage;
+}
+
 // 加载 so（通过 zLinker）。
 bool zVmEngine::LoadLibrary(const char* path) {
     // 链接器内部状态修改需串行化。
@@ -175,16 +625,146 @@ soinfo* zVmEngine::GetSoinfo(const char* name) {
     return linker_->GetSoinfo(name);
 }
 
+// 查找或创建模块上下文（调用方持有 module_mutex_）。
+zVmModule* zVmEngine::findOrCreateModuleLocked(const char* soName) {
+    auto it = modules_.find(soName);
+    if (it != modules_.end()) {
+        return it->second.get();
+    }
+    // 仅在 so 已被链接器加载时创建，保证模块状态中的基址始终有效。
+    soinfo* soInfo = GetSoinfo(soName);
+    if (soInfo == nullptr) {
+        return nullptr;
+    }
+    zVmModuleState* state = new zVmModuleState();
+    state->so_info = soInfo;
+    state->base = soInfo->base;
+    std::unique_ptr<zVmModule>& slot = modules_[soName];
+    slot = std::make_unique<zVmModule>();
+    slot->so_name = soName;
+    slot->state.store(state, std::memory_order_release);
+    return slot.get();
+}
+
+// 发布模块新状态，旧状态交给 epoch 回收。
+void zVmEngine::publishModuleStateLocked(zVmModule* module, std::unique_ptr<zVmModuleState> state) {
+    const zVmModuleState* previous = module->state.exchange(state.release(), std::memory_order_acq_rel);
+    if (previous != nullptr) {
+        reclaim_domain_.retire(const_cast<zVmModuleState*>(previous), deleteModuleState);
+    }
+}
+
+// 绑定函数到模块：私有 branch 地址表在此按状态基址一次性重定位。
+void zVmEngine::bindFunctionModule(zFunction* function, const zVmModule* module, const zVmModuleState& state) {
+    function->module = module;
+    function->module_branch_base = state.base;
+    function->module_branch_addrs = function->branchAddrs();
+    for (uint64_t& addr : function->module_branch_addrs) {
+        addr = bindBranchTarget(state, addr, nullptr);
+    }
+}
+
+// 绑定单个 OP_BL 目标：导入函数在展开 so 中表现为 PLT 桩，直接取链接器已写回的 GOT 槽位，省去每次调用的桩跳转。
+uint64_t zVmEngine::bindBranchTarget(const zVmModuleState& state, uint64_t offset, bool* bound) {
+    const uint64_t address = state.base + offset;
+    ElfW(Addr) target = 0;
+    if (zLinker::ResolvePltTarget(state.so_info, static_cast<ElfW(Addr)>(address), &target)) {
+        if (bound != nullptr) {
+            *bound = true;
+        }
+        return static_cast<uint64_t>(target);
+    }
+    // 本模块函数或无法识别的桩：保持原地址（经 PLT 调用语义不变）。
+    if (bound != nullptr) {
+        *bound = false;
+    }
+    return address;
+}
+
+// 重建共享表。
+size_t zVmEngine::buildSharedBranchTable(zVmModuleState& state) {
+    const size_t count = state.branch_entries.size();
+    state.branch_addrs.assign(count, 0);
+    state.branch_vm_keys.clear();
+    // 带 VM 目标标记的表项：剥离标记后仍保留原生地址（嵌套调用未命中时回退），另记 fun_addr 供 OP_BL 直连。
+    for (uint64_t entry : state.branch_entries) {
+        if (vmp::bundle::protocol::isVmTargetBranchAddr(entry)) {
+            state.branch_vm_keys.assign(count, 0);
+            break;
+        }
+    }
+    size_t boundCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t entry = state.branch_entries[i];
+        const uint64_t offset = vmp::bundle::protocol::branchAddrOffset(entry);
+        if (vmp::bundle::protocol::isVmTargetBranchAddr(entry)) {
+            // 受保护函数在本模块内，不会是 PLT 桩。
+            state.branch_vm_keys[i] = offset;
+            state.branch_addrs[i] = state.base + offset;
+            continue;
+        }
+        bool bound = false;
+        state.branch_addrs[i] = bindBranchTarget(state, offset, &bound);
+        boundCount += bound ? 1 : 0;
+    }
+    return boundCount;
+}
+
+// 注册或刷新模块上下文。
+const zVmModule* zVmEngine::registerModule(const char* soName) {
+    // so 名不能为空。
+    if (soName == nullptr || soName[0] == '\0') {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> moduleLock(module_mutex_);
+    zVmModule* module = findOrCreateModuleLocked(soName);
+    if (module == nullptr) {
+        LOGE("registerModule failed: soinfo not found for %s", soName);
+        return nullptr;
+    }
+    // so 重新加载后基址可能变化：发布按新映像重新绑定的状态（GOT 目标随重定位变化，不能按基址差平移）；
+    // 已绑定函数的私有表随之按基址比对失效。
+    const zVmModuleState* current = module->state.load(std::memory_order_acquire);
+    soinfo* soInfo = GetSoinfo(soName);
+    if (soInfo != nullptr && soInfo->base != current->base) {
+        std::unique_ptr<zVmModuleState> state = std::make_unique<zVmModuleState>();
+        state->so_info = soInfo;
+        state->base = soInfo->base;
+        state->branch_entries = current->branch_entries;
+        buildSharedBranchTable(*state);
+        publishModuleStateLocked(module, std::move(state));
+    }
+    return module;
+}
+
 // 设置模块级共享 branch 地址列表。
 void zVmEngine::setSharedBranchAddrs(const char* soName, std::vector<uint64_t> branchAddrs) {
     // so 名不能为空。
     if (soName == nullptr || soName[0] == '\0') {
         return;
     }
-    // 写入共享映射需要加锁。
-    std::lock_guard<std::mutex> lock(shared_branch_mutex_);
-    // 覆盖或新增。
-    shared_branch_addrs_map_[soName] = std::move(branchAddrs);
+    // 先注册模块（解析/刷新基址）。
+    if (registerModule(soName) == nullptr) {
+        LOGE("setSharedBranchAddrs failed: module %s not loaded", soName);
+        return;
+    }
+    std::lock_guard<std::mutex> moduleLock(module_mutex_);
+    zVmModule* module = findOrCreateModuleLocked(soName);
+    if (module == nullptr) {
+        return;
+    }
+    // 加载期一次性绑定：PLT 桩解析到最终符号地址，其余叠加模块基址，执行期直接引用。
+    const zVmModuleState* current = module->state.load(std::memory_order_acquire);
+    std::unique_ptr<zVmModuleState> state = std::make_unique<zVmModuleState>();
+    state->so_info = current->so_info;
+    state->base = current->base;
+    state->branch_entries = std::move(branchAddrs);
+    const size_t boundCount = buildSharedBranchTable(*state);
+    LOGI("setSharedBranchAddrs: so=%s branch_count=%zu got_bound=%zu",
+         soName,
+         state->branch_addrs.size(),
+         boundCount);
+    publishModuleStateLocked(module, std::move(state));
 }
 
 // 清理单个模块的共享 branch 地址列表。
@@ -193,72 +773,257 @@ void zVmEngine::clearSharedBranchAddrs(const char* soName) {
     if (soName == nullptr || soName[0] == '\0') {
         return;
     }
-    // 删除映射项。
-    std::lock_guard<std::mutex> lock(shared_branch_mutex_);
-    shared_branch_addrs_map_.erase(soName);
+    // 模块对象保留（已绑定函数仍持有指针），只发布不含共享表的新状态。
+    std::lock_guard<std::mutex> moduleLock(module_mutex_);
+    auto it = modules_.find(soName);
+    if (it == modules_.end()) {
+        return;
+    }
+    const zVmModuleState* current = it->second->state.load(std::memory_order_acquire);
+    if (current->branch_addrs.empty()) {
+        return;
+    }
+    std::unique_ptr<zVmModuleState> state = std::make_unique<zVmModuleState>();
+    state->so_info = current->so_info;
+    state->base = current->base;
+    publishModuleStateLocked(it->second.get(), std::move(state));
+}
+
+// 设置基线 JIT 触发阈值（仅影响之后的调用；已编译函数保持本机代码）。
+void zVmEngine::setJitThreshold(uint32_t threshold) {
+    jit_threshold_.store(threshold, std::memory_order_relaxed);
+}
+
+#if VM_JIT && !VM_TRACE
+namespace {
+
+// 差分校验的一侧执行结果。
+struct JitDiffRun {
+    uint64_t ret = 0;
+    uint8_t nzcv = 0;
+    std::vector<uint64_t> regs;
+};
+
+// 由条件码求值还原 NZCV（惰性标志也按消费时的语义比较），位序与 VMContext::nzcv 一致。
+uint8_t observeNzcv(VMContext* ctx) {
+    return static_cast<uint8_t>((vm::evaluateConditionCode(ctx, CC_MI) ? 1u : 0u) |
+                                (vm::evaluateConditionCode(ctx, CC_EQ) ? 2u : 0u) |
+                                (vm::evaluateConditionCode(ctx, CC_HS) ? 4u : 0u) |
+                                (vm::evaluateConditionCode(ctx, CC_VS) ? 8u : 0u));
+}
+
+// 写出差分报告（report 可为空）。
+void writeJitDiffReport(std::string* report, size_t argSet, const char* what, uint32_t index,
+                        uint64_t interp, uint64_t jit) {
+    if (report == nullptr) {
+        return;
+    }
+    char buffer[160];
+    snprintf(buffer, sizeof(buffer), "args[%zu] %s[%u] interp=0x%llx jit=0x%llx",
+             argSet, what, index,
+             static_cast<unsigned long long>(interp),
+             static_cast<unsigned long long>(jit));
+    *report = buffer;
+}
+
+// 比较两侧结果：返回值 -> NZCV -> 寄存器。
+bool compareJitDiffRuns(const JitDiffRun& interp, const JitDiffRun& jit, size_t argSet, std::string* report) {
+    if (interp.ret != jit.ret) {
+        writeJitDiffReport(report, argSet, "ret", 0, interp.ret, jit.ret);
+        return false;
+    }
+    if (interp.nzcv != jit.nzcv) {
+        writeJitDiffReport(report, argSet, "nzcv", 0, interp.nzcv, jit.nzcv);
+        return false;
+    }
+    for (size_t i = 0; i < interp.regs.size() && i < jit.regs.size(); ++i) {
+        if (interp.regs[i] != jit.regs[i]) {
+            writeJitDiffReport(report, argSet, "x", static_cast<uint32_t>(i), interp.regs[i], jit.regs[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+#endif
+
+// 基线 JIT 差分校验。
+bool zVmEngine::diffCheckJit(const std::vector<uint32_t>& words,
+                             const std::vector<uint32_t>& branchWords,
+                             const std::vector<std::vector<uint64_t>>& argSets,
+                             std::string* report) {
+#if VM_JIT && !VM_TRACE
+    // 自检函数固定 x0..x30 + sp；类型表提供 int64 / int32 / pointer 三项。
+    constexpr uint32_t kDiffRegisterCount = 32;
+    static const uint32_t kDiffTypeCodes[] = {TYPE_TAG_INT64_SIGNED, TYPE_TAG_INT32_SIGNED_2, TYPE_TAG_POINTER};
+    if (words.empty()) {
+        if (report != nullptr) {
+            *report = "empty word stream";
+        }
+        return false;
+    }
+
+    // 临时函数：数组全部堆分配，走与缓存相同的准备流程，结束后由 destroyFunction 释放。
+    zFunction* function = new zFunction();
+    function->register_count = kDiffRegisterCount;
+    function->type_count = static_cast<uint32_t>(sizeof(kDiffTypeCodes) / sizeof(kDiffTypeCodes[0]));
+    const zType** types = new const zType*[function->type_count];
+    for (uint32_t i = 0; i < function->type_count; ++i) {
+        types[i] = zTypeManager::internFromCode(kDiffTypeCodes[i]);
+    }
+    function->type_list = types;
+    function->inst_count = static_cast<uint32_t>(words.size());
+    function->inst_list = new uint32_t[words.size()];
+    std::memcpy(function->inst_list, words.data(), words.size() * sizeof(uint32_t));
+    function->branch_count = static_cast<uint32_t>(branchWords.size());
+    if (!branchWords.empty()) {
+        function->branch_words_ptr = new uint32_t[branchWords.size()];
+        std::memcpy(function->branch_words_ptr, branchWords.data(), branchWords.size() * sizeof(uint32_t));
+    }
+    prepareFunction(function);
+
+    zVmJitCode* jitCode = function->verified ? compileJitFunction(function) : nullptr;
+    if (jitCode == nullptr) {
+        if (report != nullptr) {
+            *report = function->verified ? "jit compile failed" : "verify failed";
+        }
+        destroyFunction(function);
+        return false;
+    }
+
+    bool same = true;
+    for (size_t argSet = 0; same && argSet < argSets.size(); ++argSet) {
+        const std::vector<uint64_t>& args = argSets[argSet];
+        // 两侧各用一块全新寄存器区（ownership 由 freeRegManager 回收），只有 jit_code 不同。
+        JitDiffRun runs[2];
+        for (int side = 0; side < 2; ++side) {
+            RegManager* mgr = allocRegManager(function->register_count);
+            if (mgr == nullptr) {
+                if (report != nullptr) {
+                    *report = "register alloc failed";
+                }
+                same = false;
+                break;
+            }
+            for (size_t i = 0; i < args.size() && i < function->register_count; ++i) {
+                mgr->regs.values[i] = args[i];
+            }
+            VMContext ctx{};
+            ctx.register_count = function->register_count;
+            ctx.registers = mgr->regs.values;
+            ctx.reg_owned = mgr->regs.owned;
+            ctx.reg_free_base = mgr->regs.free_base;
+            ctx.type_count = function->type_count;
+            ctx.types = function->type_list;
+            ctx.inst_count = function->inst_count;
+            ctx.instructions = function->inst_list;
+            ctx.compact_instructions = function->inst_compact;
+            ctx.compact_wide_pool = function->inst_wide_pool;
+            ctx.branch_count = function->branch_count;
+            ctx.branch_id_list = function->branch_words_ptr;
+            ctx.decoded_list = function->decoded_list;
+            ctx.decoded_pc_index = function->decoded_pc_index;
+            ctx.decoded_switch_pool = function->decoded_switch_pool;
+            ctx.call_sites = function->decoded_call_sites;
+            ctx.verified = function->verified;
+            ctx.frame_arena = nullptr;
+            ctx.jit_code = side == 0 ? nullptr : jitCode;
+            runs[side].ret = executeContext(ctx);
+            runs[side].nzcv = observeNzcv(&ctx);
+            runs[side].regs.assign(mgr->regs.values, mgr->regs.values + function->register_count);
+            freeRegManager(mgr);
+        }
+        same = same && compareJitDiffRuns(runs[0], runs[1], argSet, report);
+    }
+    releaseJitCode(jitCode);
+    destroyFunction(function);
+    return same;
+#else
+    (void)words;
+    (void)branchWords;
+    (void)argSets;
+    if (report != nullptr) {
+        *report = "jit disabled in this build";
+    }
+    return false;
+#endif
 }
 
 // 清空函数缓存。
 void zVmEngine::clearCache() {
-    // 清缓存需独占锁。
-    std::unique_lock<std::shared_timed_mutex> lock(cache_mutex_);
-    // 逐个释放函数对象。
-    for (auto& pair : cache_) {
-        destroyFunction(pair.second);
+    const zVmFunctionTable* oldTable = nullptr;
+    {
+        // 发布空快照。
+        std::lock_guard<std::mutex> lock(cache_write_mutex_);
+        oldTable = function_table_.exchange(nullptr, std::memory_order_acq_rel);
+        // 全部函数即将退役：直连绑定整体失效。
+        cache_generation_.fetch_add(1, std::memory_order_seq_cst);
+    }
+    // 执行中的调用可能仍在使用旧函数：整表连同函数交给 epoch 回收。
+    if (oldTable != nullptr) {
+        reclaim_domain_.retire(const_cast<zVmFunctionTable*>(oldTable), deleteFunctionTableAndFunctions);
     }
-    // 清空哈希表。
-    cache_.clear();
 }
 
 // 执行已缓存函数的“运行态版本”。
 uint64_t zVmEngine::executeState(
     zFunction* function,
-    VMRegSlot* registers,
+    const VMRegFile& registers,
     void* retBuffer,
-    const char* soName
+    const zVmModule* module,
+    zVmFrameArena* frameArena
 ) {
-    // 函数对象不能为空。
-    if (function == nullptr) {
-        return 0;
-    }
-    // so 名不能为空。
-    if (soName == nullptr || soName[0] == '\0') {
-        LOGE("executeState failed: invalid soName");
+    // 函数对象与模块上下文不能为空。
+    if (function == nullptr || module == nullptr) {
         return 0;
     }
+    VMContext ctx{};
+    std::vector<uint64_t> unboundBranchAddrs;
+    prepareContext(function, registers, retBuffer, module, frameArena, ctx, unboundBranchAddrs);
+    // 进入核心执行循环。
+    return executeContext(ctx);
+}
 
-    // 先解析模块基址（供 OP_ADRP 和分支地址归一化使用）。
-    soinfo* soInfo = GetSoinfo(soName);
-    if (soInfo == nullptr) {
-        LOGE("executeState failed: soinfo not found for %s", soName);
-        return 0;
-    }
-    vm::setVmModuleBase(soInfo->base);
+// 组装函数的执行上下文（不含执行）。
+void zVmEngine::prepareContext(
+    zFunction* function,
+    const VMRegFile& registers,
+    void* retBuffer,
+    const zVmModule* module,
+    zVmFrameArena* frameArena,
+    VMContext& ctx,
+    std::vector<uint64_t>& unboundBranchAddrs
+) {
+    // 模块状态快照：热替换发布的函数用构建时固定的状态（与函数同代），其余取模块当前状态；
+    // 调用方处于 Guard 内，整个执行期间保持有效。
+    const zVmModuleState* state = function->module == module && function->module_state != nullptr
+                                      ? function->module_state
+                                      : module->state.load(std::memory_order_acquire);
 
-    // 默认使用函数自带 ext_list（branch_addr_list）。
+    // 分支地址表：模块共享表 > 函数绑定时重定位的私有表 > 函数自带 ext_list。
+    // 两张表都在注册/绑定时叠加过基址，这里只取视图。
     uint64_t* branchAddrPtr = function->ext_list;
-    // 临时可写分支地址列表（用于叠加 base）。
-    std::vector<uint64_t> branchAddrsList;
-    {
-        // 读取共享分支映射。
-        std::lock_guard<std::mutex> lock(shared_branch_mutex_);
-        auto it = shared_branch_addrs_map_.find(soName);
-        if (it != shared_branch_addrs_map_.end()) {
-            branchAddrsList = it->second;
+    uint32_t branchAddrCount = function->branch_count;
+    const uint64_t* branchVmKeys = nullptr;
+    if (!state->branch_addrs.empty()) {
+        branchAddrPtr = const_cast<uint64_t*>(state->branch_addrs.data());
+        branchAddrCount = static_cast<uint32_t>(state->branch_addrs.size());
+        // VM 目标标记只存在于模块共享表。
+        branchVmKeys = state->branch_vm_keys.empty() ? nullptr : state->branch_vm_keys.data();
+    } else if (function->module == module && function->module_branch_base == state->base) {
+        if (!function->module_branch_addrs.empty()) {
+            branchAddrPtr = function->module_branch_addrs.data();
+            branchAddrCount = static_cast<uint32_t>(function->module_branch_addrs.size());
         }
-    }
-    // 共享映射缺失时回退函数私有列表。
-    if (branchAddrsList.empty()) {
-        branchAddrsList = function->branchAddrs();
-    }
-    // 若存在分支地址列表，需要把相对地址加上模块基址。
-    if (!branchAddrsList.empty()) {
-        // 把每个相对地址转换为进程内绝对地址。
-        for (uint64_t& addr : branchAddrsList) {
-            addr += soInfo->base;
+    } else if (!function->branchAddrs().empty()) {
+        // 未绑定模块的函数（缓存时未给 so 名），或模块重载后基址已变：逐次重定位私有表。
+        unboundBranchAddrs = function->branchAddrs();
+        for (uint64_t& addr : unboundBranchAddrs) {
+            addr += state->base;
         }
-        // 指向本地临时数组。
-        branchAddrPtr = branchAddrsList.data();
+        branchAddrPtr = unboundBranchAddrs.data();
+        branchAddrCount = static_cast<uint32_t>(unboundBranchAddrs.size());
     }
 
     // 间接跳转查找表（地址 -> pc）：从函数编码数据直接取视图。
@@ -266,24 +1031,47 @@ uint64_t zVmEngine::executeState(
     uint32_t* branchLookupWords = branchLookupCount > 0 ? function->branch_lookup_words.data() : nullptr;
     uint64_t* branchLookupAddrs = branchLookupCount > 0 ? function->branch_lookup_addrs.data() : nullptr;
 
-    // 进入核心执行入口（低层上下文版本）。
-    return execute(
-        retBuffer,
-        function->register_count,
-        registers,
-        function->type_count,
-        function->type_list,
-        function->inst_count,
-        function->inst_list,
-        function->branch_count,
-        function->branch_words_ptr,
-        // 使用共享列表时按其长度传入；否则沿用函数 branch_count。
-        branchAddrsList.empty() ? function->branch_count : static_cast<uint32_t>(branchAddrsList.size()),
-        branchAddrPtr,
-        branchLookupCount,
-        branchLookupWords,
-        branchLookupAddrs
-    );
+    // 组装上下文：运行态数组 + 预解码记录。
+    ctx = VMContext{};
+    ctx.ret_buffer = retBuffer;
+    ctx.register_count = function->register_count;
+    ctx.registers = registers.values;
+    ctx.reg_owned = registers.owned;
+    ctx.reg_free_base = registers.free_base;
+    ctx.type_count = function->type_count;
+    ctx.types = function->type_list;
+    ctx.inst_count = function->inst_count;
+    ctx.instructions = function->inst_list;
+    ctx.compact_instructions = function->inst_compact;
+    ctx.compact_wide_pool = function->inst_wide_pool;
+    ctx.branch_count = function->branch_count;
+    ctx.branch_id_list = function->branch_words_ptr;
+    ctx.branch_addr_count = branchAddrCount;
+    ctx.branch_addr_list = branchAddrPtr;
+    ctx.branch_vm_keys = branchVmKeys;
+    ctx.module = module;
+    ctx.module_base = state->base;
+    ctx.branch_lookup_count = branchLookupCount;
+    ctx.branch_lookup_words = branchLookupWords;
+    ctx.branch_lookup_addrs = branchLookupAddrs;
+    ctx.branch_lookup_base = function->branch_lookup_base;
+    ctx.branch_lookup_dense_count = static_cast<uint32_t>(function->branch_lookup_dense.size());
+    ctx.branch_lookup_dense = function->branch_lookup_dense.empty() ? nullptr : function->branch_lookup_dense.data();
+    ctx.decoded_list = function->decoded_list;
+    ctx.decoded_pc_index = function->decoded_pc_index;
+    ctx.decoded_switch_pool = function->decoded_switch_pool;
+    ctx.call_sites = function->decoded_call_sites;
+    ctx.verified = function->verified;
+    ctx.frame_arena = frameArena;
+    ctx.jit_code = nullptr;
+#if VM_JIT && !VM_TRACE
+    // 基线 JIT：热函数达到阈值后一次性编译，之后每次调用直接进入本机代码。
+    const uint32_t jitThreshold = jit_threshold_.load(std::memory_order_relaxed);
+    if (jitThreshold != 0 && function->verified) {
+        maybeCompileJit(function, jitThreshold);
+        ctx.jit_code = function->jit_code.load(std::memory_order_acquire);
+    }
+#endif
 }
 
 // 执行入口（按 soName + funAddr 查缓存并执行）。
@@ -300,68 +1088,328 @@ uint64_t zVmEngine::execute(
         return 0;
     }
 
-    // 读缓存使用共享锁。
-    std::shared_lock<std::shared_timed_mutex> lock(cache_mutex_);
-    // 定位函数对象。
-    auto it = cache_.find(funAddr);
-    if (it == cache_.end() || it->second == nullptr) {
+    // 读者临界区：覆盖查找、执行与帧回收，期间函数对象与模块状态不会被回收。
+    zVmEpochDomain::Guard guard;
+    // 定位函数对象（快照查找，无锁）。
+    zFunction* function = findFunction(funAddr);
+    if (function == nullptr) {
         LOGE("execute by fun_addr failed: not found, fun_addr=0x%llx", static_cast<unsigned long long>(funAddr));
         return 0;
     }
 
-    // 取出目标函数。
-    zFunction* function = it->second;
-
-    // 基本运行态完整性检查。
-    if (function->register_count == 0 ||
-        function->inst_count == 0 ||
-        function->register_list == nullptr ||
-        function->inst_list == nullptr ||
-        function->type_list == nullptr) {
+    // 基本运行态完整性检查（与 executeFrame/executeNested/executeBatch 共用同一判定）。
+    if (!isFunctionRunnable(function)) {
         LOGE("execute by fun_addr failed: runtime state incomplete, fun_addr=0x%llx",
              static_cast<unsigned long long>(funAddr));
         return 0;
     }
 
-    // 分配寄存器管理器并复制函数默认寄存器快照。
-    RegManager* regMgr = allocRegManager(function->register_count);
-    VMRegSlot* registers = regMgr->slots;
-    // 显式清零，确保未覆盖字段处于已知状态。
-    memset(registers, 0, 24 * function->register_count);
-    // 复制函数预设寄存器。
-    memcpy(registers, function->register_list, 24 * function->register_count);
-
-    // 计算实际可写入参数数量（取 min(params, register_count)）。
-    const uint32_t paramSize = static_cast<uint32_t>(params.values.size());
-    const uint32_t paramCount = (paramSize < function->register_count) ? paramSize : function->register_count;
-    if (paramCount > 0) {
-        // 逐个写入 x0..xN。
-        for (uint32_t i = 0; i < paramCount; ++i) {
-            registers[i].value = params.values[i];
-            // 参数来源于调用方，不由 VM 释放。
-            registers[i].ownership = 0;
-        }
+    // 模块上下文：已绑定函数直接取用（无锁、无字符串构造）；未绑定时按 so 名查找一次。
+    const zVmModule* module = function->module;
+    if (module == nullptr) {
+        std::lock_guard<std::mutex> moduleLock(module_mutex_);
+        module = findOrCreateModuleLocked(soName);
+    }
+    if (module == nullptr) {
+        LOGE("execute by fun_addr failed: soinfo not found for %s", soName);
+        return 0;
     }
+
     // 约定把调用方 retBuffer 写入 x8，供 sret 场景使用。
-    if (retBuffer != nullptr && function->register_count > 8) {
-        registers[8].value = reinterpret_cast<uint64_t>(retBuffer);
-        registers[8].ownership = 0;
+    const uint32_t paramCount = static_cast<uint32_t>(params.values.size());
+    return invokeFunction(function,
+                          module,
+                          zVmFrameArena::current(),
+                          retBuffer,
+                          paramCount > 0 ? params.values.data() : nullptr,
+                          paramCount,
+                          retBuffer != nullptr,
+                          reinterpret_cast<uint64_t>(retBuffer));
+}
+
+// takeover 寄存器帧入口：模块由调用方直接给出，省去按 so 名查找与参数容器构造。
+bool zVmEngine::executeFrame(
+    const zVmModule* module,
+    uint64_t funAddr,
+    const uint64_t args[8],
+    uint64_t x8,
+    uint64_t& outX0,
+    uint64_t& outX1
+) {
+    if (module == nullptr) {
+        LOGE("executeFrame failed: module is null, fun_addr=0x%llx", static_cast<unsigned long long>(funAddr));
+        return false;
+    }
+    // 读者临界区：覆盖查找、执行与帧回收。
+    zVmEpochDomain::Guard guard;
+    zFunction* function = findFunction(funAddr);
+    if (!isFunctionRunnable(function)) {
+        LOGE("executeFrame failed: not found or incomplete, so=%s fun_addr=0x%llx",
+             module->so_name.c_str(),
+             static_cast<unsigned long long>(funAddr));
+        return false;
+    }
+    // 已绑定函数以自己的模块为准（同一 soId 下两者一致）。
+    invokeFrame(function, function->module != nullptr ? function->module : module, args, x8, outX0, outX1);
+    return true;
+}
+
+// 帧参数执行。
+void zVmEngine::invokeFrame(
+    zFunction* function,
+    const zVmModule* module,
+    const uint64_t args[8],
+    uint64_t x8,
+    uint64_t& outX0,
+    uint64_t& outX1
+) {
+    // 返回缓冲用本地槽位（OP_ALLOC_MEMORY 会回填它，不能指向调用方的 sret 内存）；x8 原样透传。
+    uint64_t retSlot = 0;
+    uint64_t x1 = 0;
+    outX0 = invokeFunction(function, module, zVmFrameArena::current(), &retSlot, args, 8, true, x8, &x1);
+    outX1 = x1;
+}
+
+// 创建直连绑定：先取代数再查快照，保证记录的函数不会比代数更旧。
+const zVmBoundCall* zVmEngine::bindCall(const zVmModule* module, uint64_t funAddr) {
+    if (module == nullptr) {
+        return nullptr;
+    }
+    zVmEpochDomain::Guard guard;
+    const uint64_t generation = cache_generation_.load(std::memory_order_acquire);
+    zFunction* function = findFunction(funAddr);
+    if (!isFunctionRunnable(function)) {
+        return nullptr;
+    }
+    zVmBoundCall* binding = new zVmBoundCall();
+    binding->module = function->module != nullptr ? function->module : module;
+    binding->function = function;
+    binding->generation = generation;
+    return binding;
+}
+
+// 直连执行：代数一致说明绑定的函数尚未退役；调用方的 Guard 保证其在本次调用内不被回收。
+bool zVmEngine::executeBound(
+    const zVmBoundCall* binding,
+    const uint64_t args[8],
+    uint64_t x8,
+    uint64_t& outX0,
+    uint64_t& outX1
+) {
+    if (binding == nullptr || binding->generation != cache_generation_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    invokeFrame(binding->function, binding->module, args, x8, outX0, outX1);
+    return true;
+}
+
+// 批量执行：查找、模块解析只做一次，下标区间交给线程池。
+bool zVmEngine::executeBatch(
+    const char* soName,
+    uint64_t funAddr,
+    const uint64_t* params,
+    uint32_t argCount,
+    size_t count,
+    uint64_t* results,
+    uint32_t parallelism
+) {
+    if (soName == nullptr || soName[0] == '\0' || results == nullptr || argCount > 8 ||
+        (argCount > 0 && params == nullptr)) {
+        LOGE("executeBatch failed: invalid args, fun_addr=0x%llx arg_count=%u",
+             static_cast<unsigned long long>(funAddr),
+             argCount);
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    // 读者临界区覆盖整批：各工作线程引用的函数与模块状态在 run 返回前不会被回收。
+    zVmEpochDomain::Guard guard;
+    zFunction* function = findFunction(funAddr);
+    if (!isFunctionRunnable(function)) {
+        LOGE("executeBatch failed: not found or incomplete, fun_addr=0x%llx", static_cast<unsigned long long>(funAddr));
+        return false;
+    }
+    const zVmModule* module = function->module;
+    if (module == nullptr) {
+        std::lock_guard<std::mutex> moduleLock(module_mutex_);
+        module = findOrCreateModuleLocked(soName);
+    }
+    if (module == nullptr) {
+        LOGE("executeBatch failed: soinfo not found for %s", soName);
+        return false;
+    }
+
+    zVmBatchJob job{this, function, module, params, argCount, results};
+    workerPool().run(count, kVmBatchGrain, parallelism, runBatchWorker, &job);
+    return true;
+}
+
+// 按需创建线程池：常驻线程数 = CPU 核数 - 1（调用线程自身也参与）。
+zVmWorkerPool& zVmEngine::workerPool() {
+    std::lock_guard<std::mutex> lock(worker_pool_mutex_);
+    if (!worker_pool_) {
+        const uint32_t cores = std::thread::hardware_concurrency();
+        worker_pool_ = std::make_unique<zVmWorkerPool>(cores > 1 ? cores - 1 : 0);
+    }
+    return *worker_pool_;
+}
+
+// 批量执行参与者。
+void zVmEngine::runBatchWorker(void* context, zVmWorkCursor& cursor) {
+    const zVmBatchJob& job = *static_cast<const zVmBatchJob*>(context);
+    zFunction* function = job.function;
+    // 工作线程各自进入读者临界区（调用线程的 Guard 已覆盖整批，这里让嵌套直连调用同样成立）。
+    zVmEpochDomain::Guard guard;
+    // 每个参与者一份帧：整批复用，只在每次调用间清理 ownership 与虚拟栈。
+    zVmFrameArena& frameArena = zVmFrameArena::current();
+    VMFrame frame{};
+    if (!frameArena.acquire(function->register_count, frame)) {
+        LOGE("executeBatch worker failed: frame alloc failed, fun_addr=0x%llx",
+             static_cast<unsigned long long>(function->functionAddress()));
+        // 分到的下标仍需写回确定值。
+        size_t begin = 0;
+        size_t end = 0;
+        while (cursor.next(begin, end)) {
+            for (size_t i = begin; i < end; ++i) {
+                job.results[i] = 0;
+            }
+        }
+        return;
+    }
+    const VMRegFile& registers = frame.regs;
+    // 上下文同样只组装一次：分支表视图、预解码记录、JIT 入口对整批不变。
+    uint64_t retSlot = 0;
+    VMContext prepared{};
+    std::vector<uint64_t> unboundBranchAddrs;
+    job.engine->prepareContext(function, registers, &retSlot, job.module, &frameArena, prepared, unboundBranchAddrs);
+
+    const uint32_t paramCount = job.arg_count < function->register_count ? job.arg_count : function->register_count;
+    size_t begin = 0;
+    size_t end = 0;
+    while (cursor.next(begin, end)) {
+        for (size_t i = begin; i < end; ++i) {
+            // 与单次调用相同的寄存器初态：清零区间、预设寄存器、实参。
+            resetFrameRegisters(function, registers, paramCount);
+            const uint64_t* args = job.params + i * job.arg_count;
+            for (uint32_t reg = 0; reg < paramCount; ++reg) {
+                registers.values[reg] = args[reg];
+            }
+            retSlot = 0;
+            // executeContext 会推进 pc 等状态：每次从准备好的模板复制。
+            VMContext ctx = prepared;
+            job.results[i] = job.engine->executeContext(ctx);
+            // 释放本次调用登记的 ownership 指针与虚拟栈，寄存器区留给下一次。
+            frameArena.recycle(frame);
+        }
+    }
+    frameArena.release(frame);
+}
+
+// 释放直连绑定：执行中的读者可能刚从槽位读到它。
+void zVmEngine::releaseBoundCall(const zVmBoundCall* binding) {
+    if (binding != nullptr) {
+        reclaim_domain_.retire(const_cast<zVmBoundCall*>(binding), deleteBoundCall);
+    }
+}
+
+// 受保护函数之间的 OP_BL 直连：跳过原生跳板与 takeover 分发，直接在同一帧栈上嵌套执行。
+bool zVmEngine::executeNested(
+    const VMContext* caller,
+    uint64_t funAddr,
+    const uint64_t args[8],
+    uint64_t x8,
+    uint64_t& result
+) {
+    // 调用方仍在 execute 的 Guard 内：快照查找到的函数在本次调用期间有效。
+    zFunction* function = findFunction(funAddr);
+    // 运行态不完整（指令流/类型表缺失）时不进解释器，交由调用方回退原生调用。
+    if (!isFunctionRunnable(function)) {
+        return false;
+    }
+    // 被调函数若绑定了模块则用自己的模块，否则沿用调用方模块（同一 bundle 内两者一致）。
+    const zVmModule* module = function->module != nullptr ? function->module : caller->module;
+    if (module == nullptr) {
+        return false;
+    }
+    zVmFrameArena& frameArena = caller->frame_arena != nullptr ? *caller->frame_arena : zVmFrameArena::current();
+    // 与原生跳板路径一致：返回缓冲使用本地槽位，x8 按 AArch64 约定透传调用方的 x8。
+    uint64_t retSlot = 0;
+    result = invokeFunction(function, module, frameArena, &retSlot, args, 8, true, x8);
+    return true;
+}
+
+// 原生地址 -> 受保护函数：按调用方上下文基址归一化后查快照。
+bool zVmEngine::resolveProtectedTarget(const VMContext* caller, uint64_t address, uint64_t& funAddr) const {
+    if (caller == nullptr || caller->module == nullptr) {
+        return false;
+    }
+    // 用调用方上下文的基址（与其分支表同代），而非模块当前状态。
+    if (address <= caller->module_base) {
+        return false;
+    }
+    const uint64_t key = address - caller->module_base;
+    if (findFunction(key) == nullptr) {
+        return false;
+    }
+    funAddr = key;
+    return true;
+}
+
+// 帧准备 + 执行 + 帧回收。
+uint64_t zVmEngine::invokeFunction(
+    zFunction* function,
+    const zVmModule* module,
+    zVmFrameArena& frameArena,
+    void* retBuffer,
+    const uint64_t* args,
+    uint32_t argCount,
+    bool hasX8,
+    uint64_t x8Value,
+    uint64_t* outX1
+) {
+    // 从线程本地帧栈取寄存器区：复用存储，嵌套调用按 LIFO 入栈。
+    VMFrame frame{};
+    if (!frameArena.acquire(function->register_count, frame)) {
+        LOGE("execute by fun_addr failed: frame alloc failed, fun_addr=0x%llx",
+             static_cast<unsigned long long>(function->functionAddress()));
+        return 0;
+    }
+    const VMRegFile& registers = frame.regs;
+    // 计算实际可写入参数数量（取 min(args, register_count)）。
+    const uint32_t paramCount = (argCount < function->register_count) ? argCount : function->register_count;
+    // 复用的帧带有上次调用残留：按函数清零区间与预设寄存器重建初态。
+    resetFrameRegisters(function, registers, paramCount);
+    // 逐个写入 x0..xN。
+    for (uint32_t i = 0; i < paramCount; ++i) {
+        registers.values[i] = args[i];
+        // 参数来源于调用方，不由 VM 释放。
+        registers.owned[i] = 0;
+    }
+    // x8 传递隐藏参数（sret 等）。
+    if (hasX8 && function->register_count > 8) {
+        registers.values[8] = x8Value;
+        registers.owned[8] = 0;
     }
 
     // 执行并拿到结果。
-    const uint64_t result = executeState(function, registers, retBuffer, soName);
-    // 释放寄存器管理器。
-    freeRegManager(regMgr);
+    const uint64_t result = executeState(function, registers, retBuffer, module, &frameArena);
+    // 16 字节聚合返回的高半部分在 x1（与入参同一寄存器约定）。
+    if (outX1 != nullptr) {
+        *outX1 = function->register_count > 1 ? registers.values[1] : 0;
+    }
+    // 回收帧：仅释放本帧登记的 ownership 槽位。
+    frameArena.release(frame);
     return result;
 }
 
 // 执行入口（底层上下文版本）。
 uint64_t zVmEngine::execute(
     void* retBuffer,
-    uint32_t registerCount,
-    VMRegSlot* registers,
+    RegManager* registers,
     uint32_t typeCount,
-    zType** types,
+    const zType* const* types,
     uint32_t instCount,
     uint32_t* instructions,
     uint32_t branchCount,
@@ -372,30 +1420,55 @@ uint64_t zVmEngine::execute(
     uint32_t* branchLookupWords,
     uint64_t* branchLookupAddrs
 ) {
-    // 无指令流直接返回 0。
-    if (instCount == 0 || instructions == nullptr) return 0;
-
-    // 协议约束：首条必须是 OP_ALLOC_RETURN。
-    if (instructions[0] != OP_ALLOC_RETURN) {
-        return 0;
-    }
-
-    // 组装 VM 上下文。
+    // 组装 VM 上下文（低层入口不携带预解码记录）。
     VMContext ctx{};
     ctx.ret_buffer = retBuffer;
-    ctx.register_count = registerCount;
-    ctx.registers = registers;
+    ctx.register_count = registers != nullptr ? registers->regs.count : 0;
+    ctx.registers = registers != nullptr ? registers->regs.values : nullptr;
+    ctx.reg_owned = registers != nullptr ? registers->regs.owned : nullptr;
+    ctx.reg_free_base = registers != nullptr ? registers->regs.free_base : nullptr;
     ctx.type_count = typeCount;
     ctx.types = types;
     ctx.inst_count = instCount;
     ctx.instructions = instructions;
+    // 低层入口只接受 32 位 word 流。
+    ctx.compact_instructions = nullptr;
+    ctx.compact_wide_pool = nullptr;
     ctx.branch_count = branchCount;
     ctx.branch_id_list = branch_id_list;
     ctx.branch_addr_count = branchAddrCount;
     ctx.branch_addr_list = branch_addr_list;
+    // 低层入口不绑定模块：地址表由调用方给出绝对值。
+    ctx.module_base = 0;
     ctx.branch_lookup_count = branchLookupCount;
     ctx.branch_lookup_words = branchLookupWords;
     ctx.branch_lookup_addrs = branchLookupAddrs;
+    // 低层入口只有线性表（ctx{} 已把稠密索引置空）。
+    ctx.decoded_list = nullptr;
+    ctx.decoded_pc_index = nullptr;
+    ctx.decoded_switch_pool = nullptr;
+    ctx.call_sites = nullptr;
+    ctx.jit_code = nullptr;
+    // 低层入口的数组未经校验，始终走检查模式。
+    ctx.verified = false;
+    // 寄存器区由调用方提供，ownership 由其 freeRegManager 全量回收。
+    ctx.frame_arena = nullptr;
+    return executeContext(ctx);
+}
+
+// 校验并运行已组装的上下文。
+uint64_t zVmEngine::executeContext(VMContext& ctx) {
+    // 无指令流直接返回 0。
+    if (ctx.inst_count == 0 || (ctx.instructions == nullptr && ctx.compact_instructions == nullptr)) return 0;
+
+    // 协议约束：首条必须是 OP_ALLOC_RETURN。
+    const uint32_t firstOpcode = ctx.compact_instructions != nullptr
+                                 ? vmCompactWord(ctx.compact_instructions, ctx.compact_wide_pool, 0)
+                                 : ctx.instructions[0];
+    if (firstOpcode != OP_ALLOC_RETURN) {
+        return 0;
+    }
+
     // 初始 pc=0。
     ctx.pc = 0;
     // 分支状态初始值。
@@ -405,13 +1478,33 @@ uint64_t zVmEngine::execute(
     ctx.ret_value = 0;
     // 标记运行态开始。
     ctx.running = true;
-    // NZCV 初始清零。
+    // NZCV 初始清零（已物化状态）。
     ctx.nzcv = 0;
+    ctx.flags_kind = VM_FLAGS_MATERIALIZED;
+
+#if VM_JIT && !VM_TRACE
+    // 基线 JIT 优先：返回时若仍在运行，说明跳到了生成代码无法承接的 pc，交给解释循环继续。
+    if (ctx.jit_code != nullptr) {
+        vm::runJit(&ctx);
+    }
+#endif
 
+#if !VM_TRACE
+    // 预解码循环优先：返回时若仍在运行，说明跳到了记录流无法承接的 pc，交给 word 循环继续。
+    if (ctx.decoded_list != nullptr) {
+        vm::runDecoded(&ctx);
+    }
+#endif
+
+#if VM_THREADED_DISPATCH && !VM_TRACE
+    // 主解释循环（线程化）：处理函数之间直接跳转，不再经过 dispatch。
+    vm::runThreaded(&ctx);
+#else
     // 主解释循环：running 且 pc 未越界。
     while (ctx.running && ctx.pc < ctx.inst_count) {
         dispatch(&ctx);
     }
+#endif
 
     // 返回最终 ret_value。
     return ctx.ret_value;
@@ -431,14 +1524,17 @@ void zVmEngine::dispatch(VMContext* ctx) {
         return;
     }
 
-    // 读取当前 opcode。
-    uint32_t opcode = ctx->instructions[ctx->pc];
+    // 读取当前 opcode（紧凑流按槽位解码）。
+    uint32_t opcode = ctx->compact_instructions != nullptr
+                      ? vmCompactWord(ctx->compact_instructions, ctx->compact_wide_pool, ctx->pc)
+                      : ctx->instructions[ctx->pc];
     // 记录执行前 pc 便于 trace。
     uint32_t pc_before = ctx->pc;
 
-    // 命中分发表则调用对应处理函数。
-    if (opcode < OP_MAX && vm::g_opcode_table[opcode]) {
-        vm::g_opcode_table[opcode](ctx);
+    // 命中分发表则调用对应处理函数（紧凑流 / 已校验函数取对应变体）。
+    const vm::OpcodeHandler* table = vm::selectOpcodeTable(ctx);
+    if (opcode < OP_MAX && table[opcode]) {
+        table[opcode](ctx);
     } else {
         // 未知 opcode 走统一陷阱处理。
         vm::op_unknown(ctx);
@@ -11,11 +11,13 @@
 #include "zFunction.h"
 #include "zTypeManager.h"
 #include "zLinker.h"
+#include "zVmEpoch.h"
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <mutex>
-#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -23,7 +25,7 @@
 
 
 // ============================================================================
-// 寄存器槽：24 字节
+// 寄存器槽：24 字节（函数预设寄存器镜像的存储格式；执行期改用 VMRegFile）
 // ============================================================================
 struct VMRegSlot {
     uint64_t value;          // 偏移 0：值或指针
@@ -35,12 +37,51 @@ struct VMRegSlot {
 static_assert(sizeof(VMRegSlot) == 24, "VMRegSlot must be 24 bytes");
 
 // ============================================================================
-// 寄存器管理器
+// SoA 寄存器文件
+// ============================================================================
+// 执行期寄存器区按结构数组布局：值数组稠密排列（32 个寄存器仅占 4 条 cache line），
+// ownership 标志与释放基址作为冷侧表，只在分配/转移/回收时访问。
+// 单块存储布局：[values: count * 8][free_base: count * 8][owned: count 字节，按 8 字节补齐]。
+struct VMRegFile {
+    uint64_t* values;      // 寄存器值
+    uint64_t* free_base;   // ownership=1 时可释放的 base 指针（0 表示回退 value）
+    uint8_t*  owned;       // 1=需 VM free 该寄存器指向的内存，0=否
+    uint32_t  count;       // 寄存器个数
+
+    // count 个寄存器所需的 8 字节存储单元数。
+    static size_t storageUnits(uint32_t count) {
+        return static_cast<size_t>(count) * 2 + (static_cast<size_t>(count) + 7) / 8;
+    }
+
+    // 在 storage（至少 storageUnits(count) 个单元）上建立视图。
+    static VMRegFile bind(uint64_t* storage, uint32_t count) {
+        VMRegFile file;
+        file.values = storage;
+        file.free_base = storage + count;
+        file.owned = reinterpret_cast<uint8_t*>(storage + static_cast<size_t>(count) * 2);
+        file.count = count;
+        return file;
+    }
+
+    // 清零全部值与侧表。
+    void clear() const {
+        memset(values, 0, storageUnits(count) * sizeof(uint64_t));
+    }
+
+    // 从 AoS 槽位写入单个寄存器（函数预设寄存器镜像 -> 执行帧）。
+    void load(uint32_t idx, const VMRegSlot& slot) const {
+        values[idx] = slot.value;
+        free_base[idx] = slot.reserved;
+        owned[idx] = slot.ownership;
+    }
+};
+
+// ============================================================================
+// 寄存器管理器（低层 execute 入口使用）
 // ============================================================================
 struct RegManager {
-    uint32_t count;           // 寄存器个数
-    uint32_t _pad;
-    VMRegSlot slots[];        // 24 * count 字节（柔性数组）
+    VMRegFile regs;           // 指向 storage 的 SoA 视图
+    uint64_t  storage[];      // VMRegFile::storageUnits(count) 个单元（柔性数组）
 };
 
 // 轻量参数容器：按寄存器顺序写入 x0..xN/w0..wN。
@@ -61,28 +102,108 @@ struct zParams {
 #define VM_FLAG_C  4u
 #define VM_FLAG_V  8u
 
+// 惰性标志：最近一次置标志运算的类别（VMContext::flags_kind）。
+#define VM_FLAGS_MATERIALIZED 0u   // nzcv 字段即当前标志
+#define VM_FLAGS_SUB          1u   // SUBS/CMP：按 lhs - rhs 计算 NZCV
+#define VM_FLAGS_ADD          2u   // ADDS/CMN：按 lhs + rhs 计算 NZCV
+#define VM_FLAGS_LOGIC        3u   // 逻辑运算：仅按结果计算 N/Z，C/V 清零
+
+// 间接跳转稠密索引中的空洞标记（该地址不是可跳转的指令起点）。
+#define VM_BRANCH_LOOKUP_MISS 0xFFFFFFFFu
+
+// ============================================================================
+// 模块执行上下文
+// ============================================================================
+// 每个 so 一份，注册时一次性解析：执行期直接取基址与已重定位分支表，无需查 soinfo、加锁或复制。
+// 对象一经创建地址不变（引擎生命周期内不删除），缓存函数通过 zFunction::module 引用。
+// 可变部分放在不可变状态快照中：写者整体替换并经 epoch 回收旧快照，读者在 Guard 内取一次指针即可。
+struct zVmModuleState {
+    soinfo* so_info = nullptr;           // 链接器记录
+    uint64_t base = 0;                   // 模块加载基址
+    std::vector<uint64_t> branch_entries; // 共享 branch_addr_list 原始表项（模块相对、可带 VM 目标标记），基址变化时据此重建
+    std::vector<uint64_t> branch_addrs;  // 共享 branch_addr_list 运行时地址：PLT 桩已经 GOT 绑定到最终目标，其余叠加 base（为空表示使用函数私有表）
+    std::vector<uint64_t> branch_vm_keys; // 与 branch_addrs 等长：非 0 表示目标为本模块受保护函数（值为其 fun_addr）；无此类目标时为空
+};
+
+struct zVmModule {
+    std::string so_name;                           // 模块 so 名
+    std::atomic<const zVmModuleState*> state{nullptr}; // 当前状态快照（创建后始终非空）
+
+    ~zVmModule() {
+        delete state.load(std::memory_order_relaxed);
+    }
+};
+
+// 接管直连绑定：由跳板槽位持有，执行时免去 so_id / symbolKey 查找。
+// 创建后不可变；缓存代数变化（函数被替换或缓存清空）即失效，由持有方换新并经 epoch 回收旧对象。
+struct zVmBoundCall {
+    const zVmModule* module = nullptr;   // 执行模块
+    zFunction* function = nullptr;       // 绑定时的缓存函数
+    uint64_t generation = 0;             // 绑定时的缓存代数
+};
+
+// 函数缓存快照（不可变开放寻址表，在 zVmEngine.cpp 定义）。
+struct zVmFunctionTable;
+// 热替换暂存区：一代 bundle 的函数集与模块状态（在 zVmEngine.cpp 定义）。
+struct zVmBundleStage;
+
+// 预解码记录（在 zVmDecoded.h 定义）。
+struct VMDecodedInst;
+// 调用点内联缓存（在 zVmDecoded.h 定义）。
+struct VMCallSiteCache;
+// 线程本地寄存器帧栈（在 zVmFrame.h 定义）。
+class zVmFrameArena;
+// 批量执行的工作窃取线程池（在 zVmWorkerPool.h 定义）。
+class zVmWorkerPool;
+class zVmWorkCursor;
+// 基线 JIT 编译产物（在 zVmJit.h 定义）。
+struct zVmJitCode;
+
 struct VMContext {
     void*        ret_buffer;       // 返回值缓冲区
     uint32_t     register_count;   // 寄存器数量
-    VMRegSlot*   registers;        // 寄存器数组
+    uint64_t*    registers;        // 寄存器值数组（VMRegFile::values）
+    uint8_t*     reg_owned;        // ownership 侧表（VMRegFile::owned）
+    uint64_t*    reg_free_base;    // 释放基址侧表（VMRegFile::free_base）
     uint32_t     type_count;       // 类型数量
-    zType**      types;            // 类型数组
+    const zType* const* types;     // 类型数组（标量类型指向进程级驻留表）
     uint32_t     inst_count;       // 指令数量
-    uint32_t*    instructions;     // 指令数组
+    uint32_t*    instructions;     // 指令数组（紧凑执行时为空）
+    const uint16_t* compact_instructions; // 16 位紧凑指令流（非空时走紧凑处理函数变体，见 zVmCompact.h）
+    const uint32_t* compact_wide_pool;    // 紧凑流宽值池
     uint32_t     branch_count;     // 分支表项数
     uint32_t*    branch_id_list;   // 分支表：branch_id -> 目标 pc
     uint32_t     branch_addr_count;// 外部调用地址表项数（供 OP_BL 使用）
     uint64_t*    branch_addr_list; // 分支表：branch_id -> 目标原生地址（可选）
+    const uint64_t* branch_vm_keys; // 与 branch_addr_list 等长：非 0 时 OP_BL 直接嵌套执行该 fun_addr 的缓存函数（可选）
+    const zVmModule* module;       // 所属模块上下文（嵌套 VM 调用沿用；低层入口为空）
+    uint64_t     module_base;      // 所属模块基址（OP_ADRP / 间接跳转地址归一化；0 表示无模块）
     uint32_t     branch_lookup_count; // 间接跳转查找表项数（供 OP_BRANCH_REG 使用）
     uint32_t*    branch_lookup_words; // 查找表：lookup_id -> 目标 pc
     uint64_t*    branch_lookup_addrs; // 查找表：lookup_id -> 目标 ARM 地址
+    uint64_t     branch_lookup_base;  // 稠密索引起始地址（模块相对）
+    uint32_t     branch_lookup_dense_count; // 稠密索引项数（0 表示仅线性查找）
+    const uint32_t* branch_lookup_dense;    // 稠密索引：(地址 - base) / 4 -> 目标 pc
 
     uint32_t     pc;               // 程序计数器
     uint32_t     branch_id;        // 当前分支 ID
     uint32_t     saved_branch_id;  // 保存的分支 ID
     uint64_t     ret_value;        // 返回值
     bool         running;          // 是否继续运行
-    uint8_t      nzcv;             // 标志寄存器：N=bit0, Z=bit1, C=bit2, V=bit3（与 ARM64 一致）
+    uint8_t      nzcv;             // 标志寄存器：N=bit0, Z=bit1, C=bit2, V=bit3（与 ARM64 一致；仅 flags_kind=MATERIALIZED 时有效）
+    uint8_t      flags_kind;       // 最近一次置标志运算类别（VM_FLAGS_*），消费时再物化到 nzcv
+    bool         flags_is64;       // 置标志运算位宽
+    uint64_t     flags_lhs;        // 置标志运算左操作数
+    uint64_t     flags_rhs;        // 置标志运算右操作数
+    uint64_t     flags_result;     // 置标志运算结果
+
+    const VMDecodedInst* decoded_list;     // 预解码记录数组（为空表示仅 word 解释）
+    const uint32_t*      decoded_pc_index; // word pc -> 记录下标
+    const uint32_t*      decoded_switch_pool; // OP_SWITCH 预解码 case 表池
+    VMCallSiteCache*     call_sites;       // OP_CALL 调用点内联缓存（随预解码记录一起存在）
+    const zVmJitCode*    jit_code;         // 基线 JIT 编译产物（为空表示仅解释执行）
+    bool                 verified;         // 指令流已通过加载期校验（true 时走免检处理函数）
+    zVmFrameArena*       frame_arena;      // 寄存器所在帧栈（为空表示由调用方全量回收 ownership）
 };
 
 
@@ -91,7 +212,7 @@ struct VMContext {
 // ============================================================================
 // 为指定寄存器数量分配连续寄存器管理块（含柔性数组区）。
 RegManager* allocRegManager(uint32_t count);
-// 释放寄存器管理块，并回收 ownership=1 槽位指向的堆内存。
+// 释放寄存器管理块，并回收 ownership=1 寄存器指向的堆内存。
 void freeRegManager(RegManager* mgr);
 
 // ============================================================================
@@ -105,10 +226,9 @@ public:
     // 执行已解码程序：输入寄存器/类型/指令/分支等运行时数据并返回执行结果。
     uint64_t execute(
         void* retBuffer,
-        uint32_t registerCount,
-        VMRegSlot* registers,
+        RegManager* registers,
         uint32_t typeCount,
-        zType** types,
+        const zType* const* types,
         uint32_t instCount,
         uint32_t* instructions,
         uint32_t branchCount,
@@ -128,8 +248,66 @@ public:
         const zParams& params
     );
 
-    // 将解析后的函数缓存到引擎（key = fun_addr）。
-    bool cacheFunction(std::unique_ptr<zFunction> function);
+    // takeover 寄存器帧入口：在 module 中执行 funAddr 对应的缓存函数，x0..x7 / x8 按 AArch64 PCS 传入，
+    // 结果写回 outX0/outX1（16 字节以内的聚合返回）。全程不做堆分配；函数未命中时返回 false 且不写输出。
+    bool executeFrame(
+        const zVmModule* module,
+        uint64_t funAddr,
+        const uint64_t args[8],
+        uint64_t x8,
+        uint64_t& outX0,
+        uint64_t& outX1
+    );
+
+    // 批量执行：对同一函数依次代入 count 组参数（params 行主序，每组 argCount 个，argCount <= 8 依次写入 x0..），
+    // results[i] 为第 i 组的返回值，与调度顺序无关。函数只查找一次，每个工作线程复用一份已准备好的帧与上下文，
+    // 由工作窃取线程池在最多 parallelism 个线程（含调用线程，0 表示按 CPU 核数）上并行执行。
+    // 被执行函数需可重入（不依赖跨调用的共享可变状态）；函数未命中或参数非法时返回 false。
+    bool executeBatch(
+        const char* soName,
+        uint64_t funAddr,
+        const uint64_t* params,
+        uint32_t argCount,
+        size_t count,
+        uint64_t* results,
+        uint32_t parallelism
+    );
+
+    // 为 (module, funAddr) 创建直连绑定（冷路径）；函数不在缓存中时返回 nullptr。
+    const zVmBoundCall* bindCall(const zVmModule* module, uint64_t funAddr);
+    // 经直连绑定执行（调用方需处于 zVmEpochDomain::Guard 内，且绑定指针在 Guard 内读取）；
+    // 绑定已失效时返回 false 且不写输出，由调用方走按 key 分发并重新绑定。
+    bool executeBound(
+        const zVmBoundCall* binding,
+        const uint64_t args[8],
+        uint64_t x8,
+        uint64_t& outX0,
+        uint64_t& outX1
+    );
+    // 释放不再被槽位引用的直连绑定（经 epoch 延迟回收）。
+    void releaseBoundCall(const zVmBoundCall* binding);
+
+    // OP_BL 目标为受保护函数时的直连入口：在调用方线程的帧栈上嵌套执行 funAddr 对应的缓存函数，
+    // x0..x7 / x8 按 AArch64 约定传入。调用方需处于 execute 的读者临界区内；未命中缓存时返回 false，由调用方回退原生调用。
+    bool executeNested(const VMContext* caller, uint64_t funAddr, const uint64_t args[8], uint64_t x8, uint64_t& result);
+    // 判断原生地址是否为调用方所属模块中的受保护函数入口；是则输出其 fun_addr（调用方需处于读者临界区内）。
+    bool resolveProtectedTarget(const VMContext* caller, uint64_t address, uint64_t& funAddr) const;
+
+    // 将解析后的函数缓存到引擎（key = fun_addr）；soName 非空时同时绑定到该模块上下文。
+    bool cacheFunction(std::unique_ptr<zFunction> function, const char* soName = nullptr);
+
+    // bundle 热替换（RCU）：在执行路径之外构建完整的一代函数集与模块状态，publishBundle 一次原子发布。
+    // 发布前旧代照常服务；发布后执行中的调用在旧代上跑完，旧代经 epoch 宽限期后回收。
+    // 开始构建新一代（暂存区由 publishBundle / discardBundle 释放）。
+    zVmBundleStage* beginBundle();
+    // 暂存模块状态：按 so 当前映像绑定共享 branch 表（表项模块相对、可带 VM 目标标记）；so 未加载时返回 false。
+    bool stageModule(zVmBundleStage* stage, const char* soName, std::vector<uint64_t> branchEntries);
+    // 暂存函数：完成校验/预解码并绑定到本代模块状态（soName 须先 stageModule）。
+    bool stageFunction(zVmBundleStage* stage, std::unique_ptr<zFunction> function, const char* soName);
+    // 发布：整体替换函数快照与模块状态，已有直连绑定随之失效；旧代函数在宽限期后回收。
+    void publishBundle(zVmBundleStage* stage);
+    // 放弃：释放暂存内容，当前代不受影响。
+    void discardBundle(zVmBundleStage* stage);
 
     // 使用 zLinker 加载 so。
     bool LoadLibrary(const char* path);
@@ -137,7 +315,9 @@ public:
     bool LoadLibraryFromMemory(const char* soName, const uint8_t* soBytes, size_t soSize);
     // 查询已加载 so 的 soinfo。
     soinfo* GetSoinfo(const char* name);
-    // 设置模块级共享 branch_addr_list（覆盖函数内同名数据）。
+    // 注册（或刷新）模块执行上下文：解析 soinfo 基址，返回稳定指针；so 未加载时返回 nullptr。
+    const zVmModule* registerModule(const char* soName);
+    // 设置模块级共享 branch_addr_list（覆盖函数内同名数据；写入时一次性叠加模块基址）。
     void setSharedBranchAddrs(const char* soName, std::vector<uint64_t> branchAddrs);
     // 清理模块级共享 branch_addr_list。
     void clearSharedBranchAddrs(const char* soName);
@@ -145,6 +325,18 @@ public:
     // 清除缓存并释放函数对象及其附属资源。
     void clearCache();
 
+    // 设置基线 JIT 触发阈值：已校验函数调用次数达到 threshold 后编译为本机代码；0 表示关闭。
+    // vm_init 按构建期 VM_JIT_THRESHOLD 写入默认值。
+    void setJitThreshold(uint32_t threshold);
+
+    // 基线 JIT 差分校验：按缓存同一准备流程由 word 流构建临时函数并编译一次，对每组入参从相同寄存器初值
+    // 分别解释执行与 JIT 执行，比较全部寄存器、NZCV 与返回值；不一致或无法编译时返回 false 并写出首个差异。
+    // 两次执行共享内存，只用于不依赖执行前内存内容的自检语料（见 zVmJitDiff.cpp）。
+    bool diffCheckJit(const std::vector<uint32_t>& words,
+                      const std::vector<uint32_t>& branchWords,
+                      const std::vector<std::vector<uint64_t>>& argSets,
+                      std::string* report);
+
 private:
     // 单例：禁止外部构造/析构与拷贝移动。
     zVmEngine();
@@ -154,24 +346,97 @@ private:
     zVmEngine(zVmEngine&&) = delete;
     zVmEngine& operator=(zVmEngine&&) = delete;
 
-    // 函数地址 -> 已解码函数对象（缓存命中后可直接执行）。
-    std::unordered_map<uint64_t, zFunction*> cache_;
+    // 函数地址 -> 已解码函数对象的当前快照（为空表示无缓存）；读路径只做一次原子加载，不加锁。
+    std::atomic<const zVmFunctionTable*> function_table_{nullptr};
+    // 写者串行化（cacheFunction / clearCache 复制并发布新快照）。
+    std::mutex cache_write_mutex_;
+    // 缓存代数：已有函数被替换或缓存清空时在发布新快照后递增，使直连绑定失效。
+    std::atomic<uint64_t> cache_generation_{1};
+    // 旧快照、被替换函数与旧模块状态的延迟回收域。
+    zVmEpochDomain reclaim_domain_;
     std::unique_ptr<zLinker> linker_;
-    mutable std::shared_timed_mutex cache_mutex_;
     mutable std::mutex linker_mutex_;
-    mutable std::mutex shared_branch_mutex_;
-    std::unordered_map<std::string, std::vector<uint64_t>> shared_branch_addrs_map_;
+    // 保护 modules_ 映射与模块状态替换（写路径及未绑定函数的查找）。
+    mutable std::mutex module_mutex_;
+    // so 名 -> 模块执行上下文。
+    std::unordered_map<std::string, std::unique_ptr<zVmModule>> modules_;
+    // 基线 JIT 触发阈值（0=关闭）。
+    std::atomic<uint32_t> jit_threshold_{0};
+    // 批量执行线程池（首次 executeBatch 时按 CPU 核数创建）。
+    std::unique_ptr<zVmWorkerPool> worker_pool_;
+    std::mutex worker_pool_mutex_;
 
     // 使用指定寄存器区执行已解码状态，并写入返回缓冲。
     uint64_t executeState(
         zFunction* function,
-        VMRegSlot* registers,
+        const VMRegFile& registers,
+        void* retBuffer,
+        const zVmModule* module,
+        zVmFrameArena* frameArena
+    );
+
+    // 在帧栈上为函数分配寄存器区、写入实参并执行（execute / executeNested 共用）。
+    // argCount 个实参写入 x0..；hasX8 为 true 时另把 x8Value 写入 x8；outX1 非空时带回返回时的 x1。
+    uint64_t invokeFunction(
+        zFunction* function,
+        const zVmModule* module,
+        zVmFrameArena& frameArena,
+        void* retBuffer,
+        const uint64_t* args,
+        uint32_t argCount,
+        bool hasX8,
+        uint64_t x8Value,
+        uint64_t* outX1 = nullptr
+    );
+
+    // 组装函数的执行上下文（executeState 与批量执行共用）；unboundBranchAddrs 承载临时重定位表，需与 ctx 同生命周期。
+    void prepareContext(
+        zFunction* function,
+        const VMRegFile& registers,
         void* retBuffer,
-        const char* soName
+        const zVmModule* module,
+        zVmFrameArena* frameArena,
+        VMContext& ctx,
+        std::vector<uint64_t>& unboundBranchAddrs
+    );
+    // 取得批量执行线程池（按需创建）。
+    zVmWorkerPool& workerPool();
+    // 批量执行参与者：准备一次帧与上下文，循环处理游标分到的下标区间。
+    static void runBatchWorker(void* context, zVmWorkCursor& cursor);
+
+    // 以帧参数执行已定位的函数，写回 x0/x1（executeFrame / executeBound 共用）。
+    void invokeFrame(
+        zFunction* function,
+        const zVmModule* module,
+        const uint64_t args[8],
+        uint64_t x8,
+        uint64_t& outX0,
+        uint64_t& outX1
     );
 
+    // 查找或创建模块上下文（调用方需持有 module_mutex_）；新建时解析 soinfo。
+    zVmModule* findOrCreateModuleLocked(const char* soName);
+    // 发布模块新状态并退役旧状态（调用方需持有 module_mutex_）。
+    void publishModuleStateLocked(zVmModule* module, std::unique_ptr<zVmModuleState> state);
+    // 缓存前的一次性准备：校验、间接跳转索引、预解码与紧凑转码（cacheFunction / stageFunction 共用）。
+    static void prepareFunction(zFunction* function);
+    // 按模块状态基址预重定位函数私有 branch 地址表，并记录绑定关系。
+    static void bindFunctionModule(zFunction* function, const zVmModule* module, const zVmModuleState& state);
+    // 把模块相对的 OP_BL 目标绑定为运行时地址：PLT 桩经已重定位 GOT 取最终符号地址，失败时保留桩地址。
+    static uint64_t bindBranchTarget(const zVmModuleState& state, uint64_t offset, bool* bound);
+    // 按 branch_entries 与当前基址重建共享表（branch_addrs / branch_vm_keys）；返回经 GOT 绑定的表项数。
+    static size_t buildSharedBranchTable(zVmModuleState& state);
+    // 在当前快照中查找函数（调用方需处于 zVmEpochDomain::Guard 内）。
+    zFunction* findFunction(uint64_t funAddr) const;
+
+    // 校验并运行已组装的上下文（预解码循环优先，word 解释循环兜底）。
+    uint64_t executeContext(VMContext& ctx);
+
     // 释放单个函数对象及其附属资源。
-    void destroyFunction(zFunction* function);
+    static void destroyFunction(zFunction* function);
+    // epoch 回收释放函数：被替换的单个函数 / 整张快照表连同其中函数。
+    static void deleteRetiredFunction(void* object);
+    static void deleteFunctionTableAndFunctions(void* object);
 
     // 取当前 pc 的 opcode 并分发到处理函数。
     void dispatch(VMContext* ctx);
@@ -0,0 +1,221 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - epoch 延迟回收实现：进程级线程记录表 + 全局 epoch，回收域按退役 epoch 判定安全点。
+ * - 加固链路位置：执行核心的并发基础设施。
+ * - 输入：读者 Guard 进入/离开，写者 retire。
+ * - 输出：无读者可能引用时释放退役对象。
+ */
+#include "zVmEpoch.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+// 每线程一条公布记录，独占 cache line，避免读者之间伪共享。
+struct alignas(64) EpochRecord {
+    std::atomic<uint64_t> epoch{0};       // 读者公布的 epoch（0=静止）
+    std::atomic<bool> in_use{false};      // 是否被某线程占用
+    uint32_t depth = 0;                   // 嵌套深度（仅所属线程访问）
+    EpochRecord* next = nullptr;          // 链表后继（插入后不再修改）
+};
+
+// 全局 epoch（常量初始化，永不析构）。
+std::atomic<uint64_t> g_vm_epoch{1};
+// 线程记录链表头：记录只增不删，线程退出后归还复用；始终可达，不计为泄漏。
+std::atomic<EpochRecord*> g_vm_epoch_records{nullptr};
+// 各域待回收对象中最新的退役 epoch（0=无待回收）：读者离开时公布值不大于它才可能挡住回收。
+std::atomic<uint64_t> g_vm_epoch_newest_pending{0};
+// 读者离开触发的重试回收进行中（释放函数内再次进出读者临界区时不重入）。
+thread_local bool t_vm_epoch_reclaiming = false;
+
+// 进程级回收域登记表（永不析构，避免与单例析构顺序耦合）。
+struct EpochDomainRegistry {
+    std::mutex mutex;
+    std::vector<zVmEpochDomain*> domains;
+};
+
+EpochDomainRegistry& epochDomainRegistry() {
+    static EpochDomainRegistry* registry = new EpochDomainRegistry();
+    return *registry;
+}
+
+// 上调最新待回收 epoch（只增）。
+void raiseNewestPendingEpoch(uint64_t epoch) {
+    uint64_t current = g_vm_epoch_newest_pending.load(std::memory_order_relaxed);
+    while (current < epoch &&
+           !g_vm_epoch_newest_pending.compare_exchange_weak(current, epoch, std::memory_order_seq_cst)) {
+    }
+}
+
+// 线程退出时归还记录。
+struct EpochThreadSlot {
+    EpochRecord* record = nullptr;
+
+    ~EpochThreadSlot() {
+        if (record != nullptr) {
+            record->depth = 0;
+            record->epoch.store(0, std::memory_order_release);
+            record->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local EpochThreadSlot t_vm_epoch_slot;
+
+// 取得本线程记录：优先复用已归还的记录，否则新建并挂到链表头。只在线程首次进入时发生。
+EpochRecord* acquireThreadRecord() {
+    for (EpochRecord* record = g_vm_epoch_records.load(std::memory_order_acquire);
+         record != nullptr;
+         record = record->next) {
+        bool expected = false;
+        if (!record->in_use.load(std::memory_order_relaxed) &&
+            record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return record;
+        }
+    }
+    EpochRecord* record = new EpochRecord();
+    record->in_use.store(true, std::memory_order_relaxed);
+    EpochRecord* head = g_vm_epoch_records.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!g_vm_epoch_records.compare_exchange_weak(head, record,
+                                                       std::memory_order_release,
+                                                       std::memory_order_relaxed));
+    return record;
+}
+
+// 当前活跃读者公布的最小 epoch（无活跃读者时为 UINT64_MAX）。
+uint64_t minActiveEpoch() {
+    // 与读者公布后的 seq_cst 栅栏配对：要么看到读者的公布值，要么读者看到新快照。
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t minEpoch = UINT64_MAX;
+    for (EpochRecord* record = g_vm_epoch_records.load(std::memory_order_acquire);
+         record != nullptr;
+         record = record->next) {
+        const uint64_t epoch = record->epoch.load(std::memory_order_acquire);
+        if (epoch != 0 && epoch < minEpoch) {
+            minEpoch = epoch;
+        }
+    }
+    return minEpoch;
+}
+
+} // namespace
+
+// 进入读者临界区：只有最外层公布 epoch。
+zVmEpochDomain::Guard::Guard() {
+    EpochRecord* record = t_vm_epoch_slot.record;
+    if (record == nullptr) {
+        record = acquireThreadRecord();
+        t_vm_epoch_slot.record = record;
+    }
+    if (record->depth++ == 0) {
+        // acquire：读到某次 retire 推进后的 epoch 时，同时看到该写者此前发布的新快照。
+        record->epoch.store(g_vm_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+        // 公布必须先于随后对快照指针的读取被写者观察到。
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+// 离开读者临界区：最外层离开时回到静止状态；本读者可能挡住过待回收对象时顺带重试回收。
+zVmEpochDomain::Guard::~Guard() {
+    EpochRecord* record = t_vm_epoch_slot.record;
+    if (--record->depth == 0) {
+        const uint64_t epoch = record->epoch.load(std::memory_order_relaxed);
+        // seq_cst 存取与 retire 侧“上调 newest -> 栅栏 -> 扫描读者”配对：
+        // 要么写者扫描时已看到本读者静止，要么本读者读到新的待回收 epoch 并负责重试。
+        record->epoch.store(0, std::memory_order_seq_cst);
+        if (epoch <= g_vm_epoch_newest_pending.load(std::memory_order_seq_cst) && !t_vm_epoch_reclaiming) {
+            reclaimPendingDomains();
+        }
+    }
+}
+
+// 登记到进程级域表。
+zVmEpochDomain::zVmEpochDomain() {
+    EpochDomainRegistry& registry = epochDomainRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.domains.push_back(this);
+}
+
+// 对所有登记域重试回收；期间没有新的退役时下调最新待回收 epoch。
+void zVmEpochDomain::reclaimPendingDomains() {
+    t_vm_epoch_reclaiming = true;
+    uint64_t observed = g_vm_epoch_newest_pending.load(std::memory_order_seq_cst);
+    uint64_t newest = 0;
+    {
+        EpochDomainRegistry& registry = epochDomainRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (zVmEpochDomain* domain : registry.domains) {
+            domain->reclaim();
+            newest = std::max(newest, domain->newestPendingEpoch());
+        }
+    }
+    // 退役 epoch 单调递增：并发 retire 会先把 newest 上调到更大的值，这里的 CAS 随之失败，不会丢失待回收标记。
+    g_vm_epoch_newest_pending.compare_exchange_strong(observed, newest, std::memory_order_seq_cst);
+    t_vm_epoch_reclaiming = false;
+}
+
+// 待回收对象中最新的退役 epoch。
+uint64_t zVmEpochDomain::newestPendingEpoch() {
+    std::lock_guard<std::mutex> lock(retire_mutex_);
+    uint64_t newest = 0;
+    for (const Retired& retired : retired_) {
+        newest = std::max(newest, retired.epoch);
+    }
+    return newest;
+}
+
+// 析构：摘除登记；此时不再有读者，直接释放全部退役对象。
+zVmEpochDomain::~zVmEpochDomain() {
+    {
+        EpochDomainRegistry& registry = epochDomainRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.domains.erase(std::remove(registry.domains.begin(), registry.domains.end(), this),
+                               registry.domains.end());
+    }
+    std::lock_guard<std::mutex> lock(retire_mutex_);
+    for (const Retired& retired : retired_) {
+        retired.deleter(retired.object);
+    }
+    retired_.clear();
+}
+
+// 退役对象并顺带尝试回收。
+void zVmEpochDomain::retire(void* object, Deleter deleter) {
+    if (object == nullptr || deleter == nullptr) {
+        return;
+    }
+    uint64_t epoch = 0;
+    {
+        std::lock_guard<std::mutex> lock(retire_mutex_);
+        // 推进全局 epoch：此后进入的读者公布值必然大于本对象的退役 epoch。
+        epoch = g_vm_epoch.fetch_add(1, std::memory_order_seq_cst);
+        retired_.push_back(Retired{object, deleter, epoch});
+    }
+    // 先公布待回收 epoch 再扫描读者：本次没能释放时，挡住它的读者离开时会看到并重试。
+    raiseNewestPendingEpoch(epoch);
+    reclaim();
+}
+
+// 回收所有退役 epoch 小于最小活跃公布值的对象。
+size_t zVmEpochDomain::reclaim() {
+    std::vector<Retired> ready;
+    size_t pending = 0;
+    {
+        std::lock_guard<std::mutex> lock(retire_mutex_);
+        const uint64_t minEpoch = minActiveEpoch();
+        auto split = std::partition(retired_.begin(), retired_.end(), [minEpoch](const Retired& retired) {
+            return retired.epoch >= minEpoch;
+        });
+        ready.assign(split, retired_.end());
+        retired_.erase(split, retired_.end());
+        pending = retired_.size();
+    }
+    // 释放函数在锁外执行，允许其内部再次 retire。
+    for (const Retired& retired : ready) {
+        retired.deleter(retired.object);
+    }
+    return pending;
+}
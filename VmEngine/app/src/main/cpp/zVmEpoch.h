@@ -0,0 +1,69 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 基于 epoch 的延迟回收域声明：读路径无锁发布/读取快照，写路径退役旧对象并在安全时释放。
+ * - 加固链路位置：执行核心的并发基础设施（函数缓存快照、模块状态快照）。
+ * - 输入：读者进入/离开临界区；写者退役对象（对象指针 + 释放函数）。
+ * - 输出：所有可能持有旧指针的读者离开后，调用释放函数回收对象。
+ */
+#ifndef Z_VM_EPOCH_H
+#define Z_VM_EPOCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// 延迟回收域。
+// 读者：进入时把当前全局 epoch 公布到本线程记录（只写本线程独占的 cache line，无锁、无共享原子读改写），
+//       离开时清零；同线程嵌套进入只计数，不重复公布。
+// 写者：先用原子指针发布新快照，再 retire 旧对象；对象带上退役时的 epoch，
+//       当所有活跃读者公布的 epoch 都大于它时释放（读者必然已看到新快照）。
+// 线程记录与全局 epoch 为进程级（永不释放），各回收域只持有自己的待回收列表；
+// 多个域共享读者公布值只会让回收更保守，不影响正确性。
+// 回收时机：retire 时尝试一次；仍有对象被活跃读者挡住时，可能挡住它的读者在最外层离开时重试
+// （只比较一次进程级“最新待回收 epoch”，无待回收对象时不做额外工作），退役对象不依赖后续 retire 才释放。
+class zVmEpochDomain {
+public:
+    // 对象释放函数。
+    using Deleter = void (*)(void* object);
+
+    // 构造时登记到进程级域表，供读者离开时重试回收。
+    zVmEpochDomain();
+    // 析构时摘除登记并释放全部待回收对象（调用方保证此时已无读者）。
+    ~zVmEpochDomain();
+    zVmEpochDomain(const zVmEpochDomain&) = delete;
+    zVmEpochDomain& operator=(const zVmEpochDomain&) = delete;
+
+    // 读者临界区（RAII）：生命周期内读取的快照指针保持有效。
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    // 退役对象：调用前必须已把它从所有读者可达的位置摘除。
+    void retire(void* object, Deleter deleter);
+    // 尝试回收已安全的退役对象；返回仍待回收的数量。
+    size_t reclaim();
+
+private:
+    // 读者最外层离开时调用：对所有登记域重试回收，并下调进程级最新待回收 epoch。
+    static void reclaimPendingDomains();
+    // 待回收对象中最新的退役 epoch（无待回收对象时为 0）。
+    uint64_t newestPendingEpoch();
+
+    // 待回收对象。
+    struct Retired {
+        void* object;
+        Deleter deleter;
+        uint64_t epoch;   // 退役时的全局 epoch
+    };
+
+    // 写者侧：保护 retired_。
+    std::mutex retire_mutex_;
+    std::vector<Retired> retired_;
+};
+
+#endif // Z_VM_EPOCH_H
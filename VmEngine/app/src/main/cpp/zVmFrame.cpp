@@ -0,0 +1,68 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 线程本地寄存器帧栈与虚拟栈池实现。
+ * - 加固链路位置：execute(soName, funAddr) 调用帧准备/回收。
+ * - 输入：函数寄存器数量、处理函数登记的 ownership 槽位、OP_ALLOC_VSP 栈请求。
+ * - 输出：免 malloc/free 的寄存器区与虚拟栈，O(owned) 帧回收。
+ */
+#include "zVmFrame.h"
+
+// free。
+#include <cstdlib>
+
+zVmFrameArena& zVmFrameArena::current() {
+    // 每线程一份，线程退出时随 thread_local 析构释放全部 chunk。
+    static thread_local zVmFrameArena arena;
+    return arena;
+}
+
+bool zVmFrameArena::acquire(uint32_t count, VMFrame& frame) {
+    frame.slot_mark = slots_.mark();
+    frame.stack_mark = stack_.mark();
+    frame.owned_mark = owned_.size();
+    uint64_t* storage = slots_.push(VMRegFile::storageUnits(count));
+    if (storage == nullptr) {
+        return false;
+    }
+    frame.regs = VMRegFile::bind(storage, count);
+    return true;
+}
+
+void zVmFrameArena::release(const VMFrame& frame) {
+    releaseOwnedAndStack(frame);
+    slots_.rewind(frame.slot_mark);
+}
+
+void zVmFrameArena::recycle(const VMFrame& frame) {
+    releaseOwnedAndStack(frame);
+}
+
+void zVmFrameArena::releaseOwnedAndStack(const VMFrame& frame) {
+    // 只遍历本帧登记的寄存器；重复登记或已转移（ownership=0）的寄存器自然跳过。
+    const VMRegFile& regs = frame.regs;
+    for (size_t i = frame.owned_mark; i < owned_.size(); ++i) {
+        const uint32_t regIdx = owned_[i];
+        if (regs.owned[regIdx] != 1) {
+            continue;
+        }
+        // 与 freeRegManager 一致：优先 free_base 作为可释放基址，否则回退值本身。
+        const uint64_t freePtr = regs.free_base[regIdx] != 0 ? regs.free_base[regIdx] : regs.values[regIdx];
+        if (freePtr != 0) {
+            free(reinterpret_cast<void*>(freePtr));
+        }
+        regs.owned[regIdx] = 0;
+    }
+    owned_.resize(frame.owned_mark);
+
+    // 恢复栈顶（LIFO）：本帧期间分配的虚拟栈一并归还。
+    stack_.rewind(frame.stack_mark);
+}
+
+void zVmFrameArena::trackOwned(uint32_t regIdx) {
+    owned_.push_back(regIdx);
+}
+
+void* zVmFrameArena::allocStack(size_t bytes) {
+    const size_t units = (bytes + sizeof(VMStackUnit) - 1) / sizeof(VMStackUnit);
+    return stack_.push(units == 0 ? 1 : units);
+}
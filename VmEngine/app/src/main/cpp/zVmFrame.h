@@ -0,0 +1,137 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 线程本地寄存器帧栈与虚拟栈池声明。
+ * - 加固链路位置：execute(soName, funAddr) 调用帧准备/回收。
+ * - 输入：函数寄存器数量、OP_ALLOC_VSP 声明的栈大小。
+ * - 输出：复用的寄存器区/虚拟栈 + 按帧回收的 ownership 侧表。
+ */
+#ifndef Z_VM_FRAME_H
+#define Z_VM_FRAME_H
+
+#include "zVmEngine.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// 按 chunk 做 bump 分配的 LIFO 栈：单次分配保证连续，超出默认容量的请求单独占一个 chunk。
+// 复用期间不释放存储，线程退出时随所属对象析构。
+template <typename T, size_t kChunkUnits>
+class zVmBumpStack {
+public:
+    // 栈位置快照：rewind 到该位置即释放其后的全部分配。
+    struct Mark {
+        uint32_t chunk = 0;
+        size_t   top = 0;
+    };
+
+    // 当前栈位置。
+    Mark mark() const {
+        Mark result;
+        result.chunk = active_;
+        result.top = active_ < chunks_.size() ? chunks_[active_].top : 0;
+        return result;
+    }
+
+    // 分配 count 个连续单元；内存不足返回 nullptr。
+    T* push(size_t count) {
+        // 活动 chunk 放不下时顺延到下一个（后续 chunk 必然为空）。
+        uint32_t index = active_;
+        if (index < chunks_.size() && chunks_[index].top + count > chunks_[index].capacity) {
+            ++index;
+        }
+        if (index >= chunks_.size()) {
+            chunks_.emplace_back();
+        }
+        Chunk& chunk = chunks_[index];
+        if (chunk.capacity < count) {
+            // 走到这里的 chunk 一定为空：新建或替换为足够大的存储。
+            const size_t capacity = count > kChunkUnits ? count : kChunkUnits;
+            chunk.units.reset(new (std::nothrow) T[capacity]);
+            if (!chunk.units) {
+                chunk.capacity = 0;
+                return nullptr;
+            }
+            chunk.capacity = capacity;
+            chunk.top = 0;
+        }
+        T* result = chunk.units.get() + chunk.top;
+        chunk.top += count;
+        active_ = index;
+        return result;
+    }
+
+    // 回退到 mark：其后 chunk 全部清空，活动 chunk 恢复到快照栈顶。
+    void rewind(const Mark& mark) {
+        for (size_t i = static_cast<size_t>(mark.chunk) + 1; i <= active_ && i < chunks_.size(); ++i) {
+            chunks_[i].top = 0;
+        }
+        if (mark.chunk < chunks_.size()) {
+            chunks_[mark.chunk].top = mark.top;
+        }
+        active_ = mark.chunk;
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<T[]> units;  // 单元存储
+        size_t capacity = 0;         // 单元容量
+        size_t top = 0;              // 已分配单元数
+    };
+
+    // chunk 列表：active_ 之后的 chunk 均为空闲，可直接复用。
+    std::vector<Chunk> chunks_;
+    // 当前分配所在 chunk。
+    uint32_t active_ = 0;
+};
+
+// 虚拟栈分配单元：16 字节对齐，与 AArch64 sp 对齐要求一致。
+struct alignas(16) VMStackUnit {
+    uint8_t bytes[16];
+};
+
+// 单次调用占用的帧：由 zVmFrameArena::acquire/release 成对使用（严格 LIFO）。
+struct VMFrame {
+    VMRegFile  regs;          // 本帧 SoA 寄存器区（内容未初始化，由调用方写入）
+    zVmBumpStack<uint64_t, 4096>::Mark    slot_mark;   // 分配前寄存器栈位置
+    zVmBumpStack<VMStackUnit, 4096>::Mark stack_mark;  // 分配前虚拟栈位置（本帧内 OP_ALLOC_VSP 一并回收）
+    size_t     owned_mark;    // 分配前 ownership 侧表长度
+};
+
+// 线程本地帧栈：寄存器区与虚拟栈各自按 chunk 做 bump 分配，嵌套调用（VM -> native -> VM）自然入栈；
+// ownership=1 寄存器下标登记在侧表中，帧回收只遍历本帧登记项。
+class zVmFrameArena {
+public:
+    // 当前线程的帧栈（首次使用时创建，线程退出时释放全部 chunk）。
+    static zVmFrameArena& current();
+
+    // 为 count 个寄存器分配一帧；内存不足时返回 false。
+    bool acquire(uint32_t count, VMFrame& frame);
+    // 回收一帧：释放本帧登记且仍持有 ownership 的指针，并恢复寄存器栈与虚拟栈栈顶。
+    void release(const VMFrame& frame);
+    // 复用一帧：与 release 相同地释放 ownership 指针并归还虚拟栈，但保留寄存器区供下一次调用（批量执行）。
+    void recycle(const VMFrame& frame);
+    // 登记当前帧 ownership=1 的寄存器下标（由 OP_ALLOC_MEMORY 调用；OP_ALLOC_VSP 改走 allocStack）。
+    void trackOwned(uint32_t regIdx);
+    // 在当前帧内分配 bytes 字节虚拟栈（16 字节对齐），随帧回收；失败返回 nullptr。
+    void* allocStack(size_t bytes);
+
+private:
+    zVmFrameArena() = default;
+    zVmFrameArena(const zVmFrameArena&) = delete;
+    zVmFrameArena& operator=(const zVmFrameArena&) = delete;
+
+    // 释放本帧登记的 ownership 指针并恢复虚拟栈栈顶（release / recycle 共用）。
+    void releaseOwnedAndStack(const VMFrame& frame);
+
+    // 寄存器栈：按 8 字节单元存放 VMRegFile 单块布局，默认 chunk 4096 单元（32KB）。
+    zVmBumpStack<uint64_t, 4096> slots_;
+    // 虚拟栈：默认 chunk 64KB。
+    zVmBumpStack<VMStackUnit, 4096> stack_;
+    // ownership 登记表：按帧顺序追加寄存器下标，回收时截断到帧起点。
+    std::vector<uint32_t> owned_;
+};
+
+#endif // Z_VM_FRAME_H
@@ -23,6 +23,8 @@
 #include "zSymbolTakeover.h"
 // VM 引擎单例。
 #include "zVmEngine.h"
+// 基线 JIT 阈值与差分自检。
+#include "zVmJit.h"
 
 namespace {
 
@@ -54,7 +56,7 @@ bool resolveCurrentLibraryPath(void* symbol, std::string& out_path) {
     return true;
 }
 
-// 把 expand so 中的已编码函数批量预加载到 VM 引擎缓存。
+// 把 expand so 中的已编码函数构建为新一代 bundle 并整体发布（重复初始化时替换旧代，调用不中断）。
 bool preloadExpandedSoBundle(
     zVmEngine& engine,
     const char* so_name,
@@ -81,10 +83,16 @@ bool preloadExpandedSoBundle(
         return false;
     }
 
-    // 先把共享分支表挂到引擎，后续函数执行按 so 名称取表。
-    engine.setSharedBranchAddrs(so_name, std::move(shared_branch_addrs));
+    // 新一代在暂存区离线构建：发布前旧代照常服务，任一步失败都整体放弃。
+    zVmBundleStage* stage = engine.beginBundle();
+    // 先暂存模块状态并挂上共享分支表（一次性叠加基址），后续函数暂存时直接绑定。
+    if (!engine.stageModule(stage, so_name, std::move(shared_branch_addrs))) {
+        LOGE("[%s] preload stageModule failed: %s", route_tag, so_name);
+        engine.discardBundle(stage);
+        return false;
+    }
 
-    // 逐条 payload 反序列化并写入引擎缓存。
+    // 逐条 payload 反序列化并写入暂存区。
     for (const zSoBinEntry& entry : entries) {
         // 每条 payload 对应一个 zFunction 实例。
         std::unique_ptr<zFunction> function = std::make_unique<zFunction>();
@@ -93,18 +101,22 @@ bool preloadExpandedSoBundle(
             LOGE("[%s] preload loadEncodedData failed: fun_addr=0x%llx",
                  route_tag,
                  static_cast<unsigned long long>(entry.fun_addr));
+            engine.discardBundle(stage);
             return false;
         }
         // 记录函数原始地址，用于 dispatch 时定位。
         function->setFunctionAddress(entry.fun_addr);
-        // 放入引擎缓存，后续可按地址命中。
-        if (!engine.cacheFunction(std::move(function))) {
-            LOGE("[%s] preload cacheFunction failed: fun_addr=0x%llx",
+        // 放入暂存区并绑定本代模块状态，发布后可按地址命中。
+        if (!engine.stageFunction(stage, std::move(function), so_name)) {
+            LOGE("[%s] preload stageFunction failed: fun_addr=0x%llx",
                  route_tag,
                  static_cast<unsigned long long>(entry.fun_addr));
+            engine.discardBundle(stage);
             return false;
         }
     }
+    // 一次原子发布：执行中的调用在旧代上跑完，旧代宽限期后回收。
+    engine.publishBundle(stage);
     // 打印加载成功统计。
     LOGI("[%s] preload success: cached_entries=%llu",
          route_tag,
@@ -187,14 +199,17 @@ bool runVmInitCore(JNIEnv* env) {
 
     // 获取 VM 引擎单例。
     zVmEngine& engine = zVmEngine::getInstance();
-    // 清理旧缓存，避免二次初始化残留。
-    engine.clearCache();
-    // 清理各 so 的共享分支地址表。
+    // 基线 JIT 触发阈值取构建期默认值（未编译 JIT 时保持不触发）。
+    engine.setJitThreshold(VM_JIT ? VM_JIT_THRESHOLD : 0);
+#if VM_JIT_DIFF_CHECK
+    // 回归构建：先跑解释/JIT 差分自检，结论由 route_jit_diff 日志给出，不影响后续路由。
+    runJitDiffCheck();
+#endif
+    // 清理不再使用的 asset 路由模块的共享分支地址表。
+    // embedded 模块的函数集、共享表与 takeover 路由不在这里清空：新一代整体发布后替换旧代，
+    // 重复初始化期间并发的接管调用继续由旧代服务，不会出现“未找到/未就绪”窗口。
     engine.clearSharedBranchAddrs(kAssetBaseSo);
     engine.clearSharedBranchAddrs(kAssetExpandSo);
-    engine.clearSharedBranchAddrs(kEmbeddedExpandSoName);
-    // 清空 takeover 全局表。
-    zSymbolTakeoverClear();
 
     // 先执行 embedded expand so 路由。
     const EmbeddedExpandRouteStatus embedded_status = test_loadEmbeddedExpandedSo(env, engine);
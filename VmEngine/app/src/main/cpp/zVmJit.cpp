@@ -0,0 +1,381 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 基线 JIT 驱动：线性切分指令流，逐条选择后端模板，拷贝到可执行内存并建立 pc 表。
+ * - 加固链路位置：执行前准备层（函数调用次数达到阈值后一次性编译）。
+ * - 输入：verified=true 的 zFunction。
+ * - 输出：zVmJitCode（发布到 zFunction::jit_code，由 executeContext 优先进入）。
+ */
+#include "zVmJit.h"
+
+// zFunction 运行态数组与 JIT 状态字段。
+#include "zFunction.h"
+// opcode 常量、类型特化描述与 g_opcode_table_unchecked / g_opcode_table_compact。
+#include "zVmOpcodes.h"
+// 紧凑指令流还原。
+#include "zVmCompact.h"
+// vmInstructionLength。
+#include "zVmDecoded.h"
+// zType（置标志运算按类型判定位宽/浮点）。
+#include "zTypeManager.h"
+// 日志。
+#include "zLog.h"
+// offsetof。
+#include <cstddef>
+// memcpy。
+#include <cstring>
+// mmap / mprotect / munmap。
+#include <sys/mman.h>
+// sysconf(_SC_PAGESIZE)。
+#include <unistd.h>
+
+// ============================================================================
+// 后端公共部分
+// ============================================================================
+
+// 标记 word pc 对应的本机代码起点（pc 表按需扩容）。
+void zVmJitEmitter::bindPc(uint32_t pc) {
+    if (pc >= pc_offsets_.size()) {
+        pc_offsets_.resize(static_cast<size_t>(pc) + 1, kVmJitNoOffset);
+    }
+    pc_offsets_[pc] = static_cast<uint32_t>(code_.size());
+}
+
+// 跳转目标 -> 代码偏移：特殊目标取桩偏移，普通目标取已绑定的指令起点。
+bool zVmJitEmitter::labelOffset(uint32_t target, size_t& offset) const {
+    if (target == kLabelExit) {
+        offset = exit_offset_;
+        return true;
+    }
+    if (target == kLabelDispatch) {
+        offset = dispatch_offset_;
+        return true;
+    }
+    if (target >= pc_offsets_.size() || pc_offsets_[target] == kVmJitNoOffset) {
+        return false;
+    }
+    offset = pc_offsets_[target];
+    return true;
+}
+
+// 按编译目标架构选择后端。
+std::unique_ptr<zVmJitEmitter> createNativeJitEmitter() {
+#if defined(__aarch64__)
+    return createJitEmitterArm64();
+#elif defined(__x86_64__)
+    return createJitEmitterX64();
+#else
+    return nullptr;
+#endif
+}
+
+namespace {
+
+// 分支 ID -> 目标 pc；branch_id 越界返回 false。
+bool resolveBranchPc(const zFunction* function, uint32_t branchId, uint32_t& targetPc) {
+    if (function->branch_words_ptr == nullptr || branchId >= function->branch_count) {
+        return false;
+    }
+    targetPc = function->branch_words_ptr[branchId];
+    return true;
+}
+
+// 读取类型表项（越界为 nullptr，与 GET_TYPE 一致）。
+const zType* typeAt(const zFunction* function, uint32_t typeIdx) {
+    if (function->type_list == nullptr || typeIdx >= function->type_count) {
+        return nullptr;
+    }
+    return function->type_list[typeIdx];
+}
+
+// 单条指令的编译上下文。
+struct JitScope {
+    const zFunction* function;
+    const uint32_t* code;             // 还原后的 word 流（函数可能只保留紧凑流）
+    const std::vector<bool>& heads;   // word pc 是否为指令起点
+
+    // 目标 pc 是生成代码内可直达的指令起点。
+    bool isHead(uint32_t pc) const {
+        return pc < heads.size() && heads[pc];
+    }
+};
+
+// 回调解释器：优先复用预解码快速处理函数（跳转表 switch、直达分支等），
+// 其余回调 word 处理函数；处理函数缺失时离开生成代码，由解释循环报告未知 opcode。
+void emitGeneric(zVmJitEmitter& emitter, const zFunction* function, uint32_t opcode, uint32_t pc, uint32_t nextPc) {
+    if (function->decoded_list != nullptr && function->decoded_pc_index != nullptr) {
+        const uint32_t index = function->decoded_pc_index[pc];
+        if (index != kVmDecodedInvalidIndex && function->decoded_list[index].handler != vm::op_generic_decoded) {
+            emitter.emitCallDecoded(&function->decoded_list[index], pc, nextPc);
+            return;
+        }
+    }
+    // 回调处理函数的变体需与执行时 ctx 的指令流一致：紧凑函数的 instructions 为空。
+    const vm::OpcodeHandler* table = function->inst_compact != nullptr
+                                     ? vm::g_opcode_table_compact
+                                     : vm::g_opcode_table_unchecked;
+    vm::OpcodeHandler handler = opcode < OP_MAX ? table[opcode] : nullptr;
+    if (handler == nullptr) {
+        emitter.emitExit(pc);
+        return;
+    }
+    emitter.emitCallHandler(handler, pc, nextPc);
+}
+
+// 置标志加减：仅整数（或无类型）的 SUB/ADD 内联，其它组合回调处理函数。
+bool emitFlagBinary(zVmJitEmitter& emitter, const JitScope& scope, const uint32_t* w, bool rhsIsImm) {
+    const uint32_t subOp = w[1];
+    const uint32_t actualOp = subOp & 0x3Fu;
+    if ((subOp & BIN_UPDATE_FLAGS) == 0 || (actualOp != BIN_SUB && actualOp != BIN_ADD)) {
+        return false;
+    }
+    const zType* type = typeAt(scope.function, w[2]);
+    if (type != nullptr && type->is_float) {
+        return false;
+    }
+    const bool is64 = type != nullptr && type->size == 8;
+    emitter.emitFlagArith(actualOp == BIN_SUB, is64, w[3], w[4], rhsIsImm, w[5]);
+    return true;
+}
+
+// 为 pc 处一条指令选择模板。
+void emitInstruction(zVmJitEmitter& emitter, const JitScope& scope, uint32_t pc, uint32_t length) {
+    const zFunction* function = scope.function;
+    const uint32_t* w = scope.code + pc;
+    const uint32_t nextPc = pc + length;
+
+    switch (w[0]) {
+        case OP_NOP:
+        case OP_PHI:
+            return;
+        case OP_MOV:
+            emitter.emitMov(w[1], w[2]);
+            return;
+        case OP_LOAD_IMM:
+            emitter.emitLoadImm(w[1], w[2]);
+            return;
+        case OP_BINARY:
+        case OP_BINARY_IMM:
+            if (emitFlagBinary(emitter, scope, w, w[0] == OP_BINARY_IMM)) {
+                return;
+            }
+            break;
+        case OP_BRANCH: {
+            // 目标越界（停机）或落在指令中间时交给处理函数。
+            uint32_t targetPc = 0;
+            if (resolveBranchPc(function, w[1], targetPc) && scope.isHead(targetPc)) {
+                emitter.emitJump(targetPc);
+                return;
+            }
+            break;
+        }
+        case OP_BRANCH_IF_CC: {
+            uint32_t targetPc = 0;
+            if (!resolveBranchPc(function, w[2], targetPc) || targetPc >= function->inst_count) {
+                // 与 op_branch_if_cc 一致：目标无效时命中也按顺序执行。
+                return;
+            }
+            if (scope.isHead(targetPc)) {
+                emitter.emitConditionalJump(w[1], targetPc);
+                return;
+            }
+            break;
+        }
+        default: {
+            const vm::VMTypedOpcodeInfo* typed = vm::getTypedOpcodeInfo(w[0]);
+            if (typed == nullptr) {
+                break;
+            }
+            const bool isSigned = typed->is_signed != 0;
+            switch (typed->kind) {
+                case VM_TYPED_BINARY:
+                case VM_TYPED_BINARY_IMM:
+                    if (emitter.emitTypedBinary(typed->bin_op, typed->width, isSigned,
+                                                w[1], w[2], typed->kind == VM_TYPED_BINARY_IMM, w[3])) {
+                        return;
+                    }
+                    break;
+                case VM_TYPED_LOAD:
+                    emitter.emitTypedLoad(typed->width, isSigned, w[1], static_cast<int32_t>(w[2]), w[3]);
+                    return;
+                default:
+                    emitter.emitTypedStore(typed->width, w[1], static_cast<int32_t>(w[2]), w[3],
+                                           w[3] >= function->register_count);
+                    return;
+            }
+            break;
+        }
+    }
+    emitGeneric(emitter, function, w[0], pc, nextPc);
+}
+
+// 生成代码访问的 VMContext 字段偏移。
+VMJitLayout buildLayout(const zFunction* function) {
+    VMJitLayout layout{};
+    layout.ctx_pc = static_cast<uint32_t>(offsetof(VMContext, pc));
+    layout.ctx_running = static_cast<uint32_t>(offsetof(VMContext, running));
+    layout.ctx_registers = static_cast<uint32_t>(offsetof(VMContext, registers));
+    layout.ctx_reg_owned = static_cast<uint32_t>(offsetof(VMContext, reg_owned));
+    layout.ctx_flags_kind = static_cast<uint32_t>(offsetof(VMContext, flags_kind));
+    layout.ctx_flags_is64 = static_cast<uint32_t>(offsetof(VMContext, flags_is64));
+    layout.ctx_flags_lhs = static_cast<uint32_t>(offsetof(VMContext, flags_lhs));
+    layout.ctx_flags_rhs = static_cast<uint32_t>(offsetof(VMContext, flags_rhs));
+    layout.ctx_flags_result = static_cast<uint32_t>(offsetof(VMContext, flags_result));
+    layout.inst_count = function->inst_count;
+    return layout;
+}
+
+// 申请可写映射并拷入机器码，随后切换为只读可执行（W^X）。
+bool mapJitCode(const std::vector<uint8_t>& bytes, zVmJitCode& code) {
+    const long pageSizeValue = sysconf(_SC_PAGESIZE);
+    const size_t pageSize = pageSizeValue > 0 ? static_cast<size_t>(pageSizeValue) : 4096u;
+    const size_t mappedSize = (bytes.size() + pageSize - 1) / pageSize * pageSize;
+    void* memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    std::memcpy(memory, bytes.data(), bytes.size());
+    if (mprotect(memory, mappedSize, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, mappedSize);
+        return false;
+    }
+#if defined(__aarch64__)
+    // AArch64 指令缓存与数据缓存不一致，写入后需显式同步。
+    __builtin___clear_cache(static_cast<char*>(memory), static_cast<char*>(memory) + bytes.size());
+#endif
+    code.memory = memory;
+    code.mapped_size = mappedSize;
+    code.entry = reinterpret_cast<VMJitEntry>(memory);
+    return true;
+}
+
+} // namespace
+
+// 编译已校验函数。
+zVmJitCode* compileJitFunction(const zFunction* function) {
+    if (function == nullptr || !function->verified || function->inst_count == 0) {
+        return nullptr;
+    }
+    // 模板选择按 word 读取操作数；紧凑函数先还原一份临时 word 流。
+    std::vector<uint32_t> words;
+    if (!expandFunctionWords(function, words)) {
+        return nullptr;
+    }
+    std::unique_ptr<zVmJitEmitter> emitter = createNativeJitEmitter();
+    if (!emitter) {
+        return nullptr;
+    }
+
+    const uint32_t instCount = function->inst_count;
+    const uint32_t* code = words.data();
+
+    // 1) 线性切分：标记指令起点（跳转只允许落在起点上）。
+    std::vector<bool> heads(instCount, false);
+    std::vector<uint32_t> lengths;
+    lengths.reserve(instCount / 3 + 1);
+    for (uint32_t pc = 0; pc < instCount;) {
+        const uint32_t length = vmInstructionLength(code, instCount, pc);
+        if (length == 0) {
+            LOGW("compileJitFunction skipped: undecodable opcode=%u at pc=%u fun_addr=0x%llx",
+                 code[pc],
+                 pc,
+                 static_cast<unsigned long long>(function->functionAddress()));
+            return nullptr;
+        }
+        heads[pc] = true;
+        lengths.push_back(length);
+        pc += length;
+    }
+
+    // 2) 逐条拼接模板；顺序执行越过末尾时写回 pc=inst_count 正常结束。
+    const JitScope scope{function, code, heads};
+    emitter->emitPrologue(buildLayout(function));
+    uint32_t pc = 0;
+    for (uint32_t length : lengths) {
+        emitter->bindPc(pc);
+        emitInstruction(*emitter, scope, pc, length);
+        pc += length;
+    }
+    emitter->emitExit(instCount);
+    if (!emitter->finish()) {
+        LOGW("compileJitFunction skipped: %s branch out of range fun_addr=0x%llx",
+             emitter->name(),
+             static_cast<unsigned long long>(function->functionAddress()));
+        return nullptr;
+    }
+
+    // 3) 映射为可执行内存并建立 pc 表。
+    std::unique_ptr<zVmJitCode> jitCode(new zVmJitCode());
+    if (!mapJitCode(emitter->code(), *jitCode)) {
+        LOGE("compileJitFunction failed: map %zu bytes fun_addr=0x%llx",
+             emitter->code().size(),
+             static_cast<unsigned long long>(function->functionAddress()));
+        return nullptr;
+    }
+    const std::vector<uint32_t>& offsets = emitter->pcOffsets();
+    jitCode->pc_table.assign(instCount, 0);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(jitCode->memory);
+    for (uint32_t i = 0; i < instCount && i < offsets.size(); ++i) {
+        if (offsets[i] != zVmJitEmitter::kVmJitNoOffset) {
+            jitCode->pc_table[i] = base + offsets[i];
+        }
+    }
+    return jitCode.release();
+}
+
+// 释放编译产物。
+void releaseJitCode(zVmJitCode* code) {
+    if (code == nullptr) {
+        return;
+    }
+    if (code->memory != nullptr) {
+        munmap(code->memory, code->mapped_size);
+    }
+    delete code;
+}
+
+// 调用计数达到阈值时编译一次；失败同样记为已尝试，避免每次调用重复编译。
+void maybeCompileJit(zFunction* function, uint32_t threshold) {
+    if (function == nullptr || threshold == 0 || !function->verified) {
+        return;
+    }
+    if (function->jit_state.load(std::memory_order_acquire) != VM_JIT_STATE_COLD) {
+        return;
+    }
+    const uint32_t calls = function->jit_calls.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (calls < threshold) {
+        return;
+    }
+    // 只允许一个线程进入编译；其它线程继续解释执行。
+    uint8_t expected = VM_JIT_STATE_COLD;
+    if (!function->jit_state.compare_exchange_strong(expected, VM_JIT_STATE_COMPILING,
+                                                     std::memory_order_acq_rel)) {
+        return;
+    }
+    zVmJitCode* code = compileJitFunction(function);
+    function->jit_code.store(code, std::memory_order_release);
+    function->jit_state.store(code != nullptr ? VM_JIT_STATE_READY : VM_JIT_STATE_FAILED,
+                              std::memory_order_release);
+}
+
+namespace vm {
+
+// 从 ctx->pc 进入生成代码。
+void runJit(VMContext* ctx) {
+    if (ctx == nullptr || ctx->jit_code == nullptr) {
+        return;
+    }
+    if (!ctx->running || ctx->pc >= ctx->inst_count) {
+        return;
+    }
+    ctx->jit_code->entry(ctx, ctx->jit_code->pc_table.data());
+}
+
+// 生成代码回调单条预解码记录。
+void runJitDecodedRecord(VMContext* ctx, const VMDecodedInst* inst) {
+    const VMDecodedInst* next = inst->handler(ctx, inst);
+    if (next != nullptr) {
+        ctx->pc = next->pc;
+    }
+}
+
+} // namespace vm
@@ -0,0 +1,165 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 基线 JIT 层声明：把已校验函数的指令流逐条展开为本机代码（模板拼接）。
+ * - 加固链路位置：执行前准备层（executeState 达到调用阈值后一次性编译）。
+ * - 输入：verified=true 的 zFunction（inst_list 或紧凑流 + branch/type 运行态数组）。
+ * - 输出：可执行代码块 + word pc -> 本机地址表；复杂 opcode 回调解释器处理函数。
+ */
+#ifndef Z_VM_JIT_H
+#define Z_VM_JIT_H
+
+#include "zVmEngine.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 基线 JIT 开关（默认编译进来；vm_init 按 VM_JIT_THRESHOLD 调用 zVmEngine::setJitThreshold 打开）。
+#ifndef VM_JIT
+#define VM_JIT 1
+#endif
+
+// 基线 JIT 默认触发阈值：vm_init 时写入引擎；0 表示只编译不触发。
+#ifndef VM_JIT_THRESHOLD
+#define VM_JIT_THRESHOLD 256
+#endif
+
+// 解释/JIT 差分自检开关（回归用）：开启时 vm_init 运行 runJitDiffCheck 并输出 route_jit_diff 日志。
+#ifndef VM_JIT_DIFF_CHECK
+#define VM_JIT_DIFF_CHECK 0
+#endif
+
+class zFunction;
+
+// zFunction::jit_state 取值。
+#define VM_JIT_STATE_COLD       0u   // 尚未达到调用阈值
+#define VM_JIT_STATE_COMPILING  1u   // 某个线程正在编译
+#define VM_JIT_STATE_READY      2u   // 已发布 jit_code
+#define VM_JIT_STATE_FAILED     3u   // 编译失败，保持解释执行
+
+// 生成代码入口：从 ctx->pc 对应位置开始执行；
+// 返回时要么已停机，要么 ctx->pc 指向生成代码无法承接的位置，由解释循环继续。
+typedef void (*VMJitEntry)(VMContext* ctx, const uintptr_t* pcTable);
+
+// 一个函数的编译产物。
+struct zVmJitCode {
+    void*       memory = nullptr;       // 可执行映射起点（mmap）
+    size_t      mapped_size = 0;        // 映射长度（页对齐）
+    VMJitEntry  entry = nullptr;        // 入口（位于 memory 起点）
+    std::vector<uintptr_t> pc_table;    // word pc -> 本机地址（非指令起点为 0）
+};
+
+// 生成代码访问的 VMContext 字段偏移（由驱动层用 offsetof 填写，后端只管编码）。
+struct VMJitLayout {
+    uint32_t ctx_pc;
+    uint32_t ctx_running;
+    uint32_t ctx_registers;
+    uint32_t ctx_reg_owned;
+    uint32_t ctx_flags_kind;
+    uint32_t ctx_flags_is64;
+    uint32_t ctx_flags_lhs;
+    uint32_t ctx_flags_rhs;
+    uint32_t ctx_flags_result;
+    uint32_t inst_count;
+};
+
+// ============================================================================
+// 后端接口：每个方法对应一条 VM 指令的机器码模板
+// ============================================================================
+// 约定：生成代码常驻 ctx / 寄存器值数组 / ownership 数组 / pc 表四个指针；
+// 内联模板不维护 ctx->pc，只有回调处理函数与离开生成代码前才写回。
+class zVmJitEmitter {
+public:
+    virtual ~zVmJitEmitter() = default;
+
+    // 后端名称（日志用）。
+    virtual const char* name() const = 0;
+
+    // 序言：保存被调用者寄存器、缓存常驻指针，然后按 ctx->pc 分发。
+    virtual void emitPrologue(const VMJitLayout& layout) = 0;
+    // 标记 word pc 对应的本机代码起点。
+    void bindPc(uint32_t pc);
+
+    // OP_MOV：dst = src，清 ownership。
+    virtual void emitMov(uint32_t srcReg, uint32_t dstReg) = 0;
+    // OP_LOAD_IMM：dst = imm（零扩展），清 ownership。
+    virtual void emitLoadImm(uint32_t dstReg, uint32_t imm) = 0;
+    // 类型特化二元运算（寄存器/立即数形态）；后端无法内联时返回 false（改走处理函数回调）。
+    virtual bool emitTypedBinary(uint32_t binOp, uint32_t width, bool isSigned,
+                                 uint32_t lhsReg, uint32_t rhs, bool rhsIsImm, uint32_t dstReg) = 0;
+    // 类型特化读取：空基址读出 0 并清 ownership。
+    virtual void emitTypedLoad(uint32_t width, bool isSigned, uint32_t baseReg, int32_t offset, uint32_t dstReg) = 0;
+    // 类型特化写入：空基址跳过；valueIsZero 表示零寄存器。
+    virtual void emitTypedStore(uint32_t width, uint32_t baseReg, int32_t offset, uint32_t valueReg, bool valueIsZero) = 0;
+    // 置标志加减（SUBS/ADDS/CMP 的整数形态）：64 位槽运算 + 记录惰性标志。
+    virtual void emitFlagArith(bool isSub, bool is64, uint32_t lhsReg, uint32_t rhs, bool rhsIsImm, uint32_t dstReg) = 0;
+    // 无条件跳到 targetPc。
+    virtual void emitJump(uint32_t targetPc) = 0;
+    // 条件码成立时跳到 targetPc，否则顺序执行。
+    virtual void emitConditionalJump(uint32_t cc, uint32_t targetPc) = 0;
+    // 回调处理函数：写回 ctx->pc，调用后停机则退出，pc 不等于 nextPc 则经 pc 表分发。
+    virtual void emitCallHandler(void (*handler)(VMContext*), uint32_t pc, uint32_t nextPc) = 0;
+    // 回调预解码记录（经 vm::runJitDecodedRecord），出口检查与 emitCallHandler 相同。
+    virtual void emitCallDecoded(const VMDecodedInst* inst, uint32_t pc, uint32_t nextPc) = 0;
+    // 写回 ctx->pc 后离开生成代码（顺序执行越过末尾时使用）。
+    virtual void emitExit(uint32_t pc) = 0;
+    // 追加分发桩/退出桩并回填跳转；跳转距离超出编码范围时返回 false。
+    virtual bool finish() = 0;
+
+    // 生成的机器码。
+    const std::vector<uint8_t>& code() const { return code_; }
+    // word pc -> 代码偏移（非指令起点为 kVmJitNoOffset）。
+    const std::vector<uint32_t>& pcOffsets() const { return pc_offsets_; }
+
+    static constexpr uint32_t kVmJitNoOffset = 0xFFFFFFFFu;
+
+protected:
+    // 特殊跳转目标：退出桩 / 分发桩（普通目标为 word pc）。
+    static constexpr uint32_t kLabelExit = 0xFFFFFFFEu;
+    static constexpr uint32_t kLabelDispatch = 0xFFFFFFFDu;
+
+    // 待回填跳转：at 为指令（或位移字段）偏移，kind 由后端解释。
+    struct Fixup {
+        size_t   at;
+        uint32_t target;
+        uint32_t kind;
+    };
+
+    // 跳转目标 -> 代码偏移；未绑定返回 false。
+    bool labelOffset(uint32_t target, size_t& offset) const;
+
+    VMJitLayout layout_{};
+    std::vector<uint8_t> code_;
+    std::vector<uint32_t> pc_offsets_;
+    std::vector<Fixup> fixups_;
+    size_t exit_offset_ = 0;
+    size_t dispatch_offset_ = 0;
+};
+
+// x86-64（System V）后端：便于在 Linux 主机上测试与对比。
+std::unique_ptr<zVmJitEmitter> createJitEmitterX64();
+// AArch64（AAPCS64）后端：随 arm64-v8a 发布。
+std::unique_ptr<zVmJitEmitter> createJitEmitterArm64();
+// 当前进程架构对应的后端；不支持的架构返回空。
+std::unique_ptr<zVmJitEmitter> createNativeJitEmitter();
+
+// 编译已校验函数；未校验、后端不支持或映射失败时返回 nullptr（函数继续解释执行）。
+zVmJitCode* compileJitFunction(const zFunction* function);
+// 释放编译产物（解除可执行映射）。
+void releaseJitCode(zVmJitCode* code);
+// 调用计数达到 threshold 时编译并发布到 function->jit_code（每个函数最多尝试一次）。
+void maybeCompileJit(zFunction* function, uint32_t threshold);
+
+// 差分自检：内置语料（类型特化运算全集、置标志分支、定宽读写、回调处理函数）逐例经 zVmEngine::diffCheckJit
+// 比较解释执行与当前后端的 JIT 执行；全部一致返回 true，首个不一致逐例记日志。
+bool runJitDiffCheck();
+
+namespace vm {
+// 从 ctx->pc 进入生成代码；ctx->jit_code 为空时直接返回。
+void runJit(VMContext* ctx);
+// 生成代码回调单条预解码记录：执行后把 ctx->pc 对齐到后继记录（无后继时处理函数已写回 pc）。
+void runJitDecodedRecord(VMContext* ctx, const VMDecodedInst* inst);
+} // namespace vm
+
+#endif // Z_VM_JIT_H
@@ -0,0 +1,380 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 基线 JIT 的 AArch64 后端：AAPCS64 调用约定下的指令模板编码。
+ * - 加固链路位置：执行前准备层（arm64-v8a 发布产物使用）。
+ * - 输入：驱动层逐条下发的 VM 指令语义（寄存器下标、立即数、跳转目标 pc）。
+ * - 输出：机器码字节 + pc 偏移表；纯编码逻辑，可在任意主机上编译。
+ */
+#include "zVmJit.h"
+
+// opcode / 二元算子常量。
+#include "zVmOpcodes.h"
+// memcpy。
+#include <cstring>
+
+namespace {
+
+// 常驻寄存器分配（均为被调用者保存寄存器，回调处理函数后无需重新加载）：
+//   x19 = ctx，x20 = 寄存器值数组，x21 = ownership 数组，x22 = pc 表；
+//   x0..x3 为模板临时寄存器，x9/x10 为地址与比较临时寄存器，x16 为回调目标（IP0）。
+constexpr uint32_t kCtx = 19;
+constexpr uint32_t kRegs = 20;
+constexpr uint32_t kOwned = 21;
+constexpr uint32_t kPcTable = 22;
+constexpr uint32_t kScratch = 9;
+constexpr uint32_t kScratch2 = 10;
+constexpr uint32_t kCallTarget = 16;
+// Rt/Rm 字段为 31 时表示零寄存器（wzr/xzr）。
+constexpr uint32_t kZr = 31;
+
+// 待回填跳转类型。
+enum Arm64FixupKind : uint32_t {
+    ARM64_IMM26 = 0,   // B：±128MB
+    ARM64_IMM19 = 1,   // B.cond / CBZ / CBNZ：±1MB
+};
+
+// 条件码编码（B.cond）。
+constexpr uint32_t kCondNe = 1;
+constexpr uint32_t kCondHs = 2;
+
+class zVmJitEmitterArm64 final : public zVmJitEmitter {
+public:
+    const char* name() const override { return "arm64"; }
+
+    // 建 48 字节栈帧保存 fp/lr 与 x19..x22，缓存常驻指针后进入分发桩。
+    void emitPrologue(const VMJitLayout& layout) override {
+        layout_ = layout;
+        emit(0xA9BD7BFDu);                              // stp x29, x30, [sp, #-48]!
+        emit(0x910003FDu);                              // mov x29, sp
+        emit(0xA90153F3u);                              // stp x19, x20, [sp, #16]
+        emit(0xA9025BF5u);                              // stp x21, x22, [sp, #32]
+        movReg(kCtx, 0);                                // mov x19, x0
+        ldrCtx64(kRegs, layout_.ctx_registers);
+        ldrCtx64(kOwned, layout_.ctx_reg_owned);
+        movReg(kPcTable, 1);                            // mov x22, x1
+        branch(kLabelDispatch);
+    }
+
+    void emitMov(uint32_t srcReg, uint32_t dstReg) override {
+        loadVm(0, srcReg);
+        storeVm(0, dstReg);
+        clearOwned(dstReg);
+    }
+
+    void emitLoadImm(uint32_t dstReg, uint32_t imm) override {
+        movImm(0, imm, false);
+        storeVm(0, dstReg);
+        clearOwned(dstReg);
+    }
+
+    bool emitTypedBinary(uint32_t binOp, uint32_t width, bool isSigned,
+                         uint32_t lhsReg, uint32_t rhs, bool rhsIsImm, uint32_t dstReg) override {
+        // W 形态结果自动零扩展、移位量按位宽取模、除零得 0、MIN/-1 得被除数，
+        // 与 execTypedBinary 的定宽语义逐项一致，除法也可直接内联。
+        const uint32_t sf = width == 8 ? 0x80000000u : 0u;
+        uint32_t base = 0;
+        switch (binOp) {
+            case BIN_ADD:  base = 0x0B000000u; break;              // add
+            case BIN_SUB:  base = 0x4B000000u; break;              // sub
+            case BIN_AND:  base = 0x0A000000u; break;              // and
+            case BIN_OR:   base = 0x2A000000u; break;              // orr
+            case BIN_XOR:  base = 0x4A000000u; break;              // eor
+            case BIN_MUL:  base = 0x1B007C00u; break;              // madd rd, rn, rm, zr
+            case BIN_SHL:  base = 0x1AC02000u; break;              // lslv
+            case BIN_LSR:  base = 0x1AC02400u; break;              // lsrv
+            case BIN_ASR:  base = 0x1AC02800u; break;              // asrv
+            case BIN_IDIV: base = isSigned ? 0x1AC00C00u : 0x1AC00800u; break;   // sdiv / udiv
+            default:
+                return false;
+        }
+        loadVm(0, lhsReg);
+        loadRhs(rhs, rhsIsImm);
+        emit(base | sf | (1u << 16) | (0u << 5) | 0u);      // op x0, x0, x1
+        storeVm(0, dstReg);
+        return true;
+    }
+
+    void emitTypedLoad(uint32_t width, bool isSigned, uint32_t baseReg, int32_t offset, uint32_t dstReg) override {
+        loadVm(0, baseReg);
+        const size_t nullJump = placeholder(0xB4000000u);   // cbz x0, .null
+        const uint32_t rm = loadOffset(offset);
+        uint32_t op = 0;
+        switch (width) {
+            case 1:  op = isSigned ? 0x38A06800u : 0x38606800u; break;   // ldrsb x / ldrb w
+            case 2:  op = isSigned ? 0x78A06800u : 0x78606800u; break;   // ldrsh x / ldrh w
+            case 4:  op = isSigned ? 0xB8A06800u : 0xB8606800u; break;   // ldrsw x / ldr w
+            default: op = 0xF8606800u; break;                             // ldr x
+        }
+        emit(op | (rm << 16) | (0u << 5) | 2u);              // ldr* x2, [x0, rm]
+        storeVm(2, dstReg);
+        const size_t doneJump = placeholder(0x14000000u);   // b .done
+        // .null：与 OP_GET_FIELD 一致读出 0 并清 ownership。
+        patchHere(nullJump, ARM64_IMM19);
+        storeVm(kZr, dstReg);
+        clearOwned(dstReg);
+        patchHere(doneJump, ARM64_IMM26);
+    }
+
+    void emitTypedStore(uint32_t width, uint32_t baseReg, int32_t offset, uint32_t valueReg, bool valueIsZero) override {
+        loadVm(0, baseReg);
+        const size_t doneJump = placeholder(0xB4000000u);   // cbz x0, .done（空基址跳过写入）
+        uint32_t rt = kZr;
+        if (!valueIsZero) {
+            loadVm(2, valueReg);
+            rt = 2;
+        }
+        const uint32_t rm = loadOffset(offset);
+        uint32_t op = 0;
+        switch (width) {
+            case 1:  op = 0x38206800u; break;                // strb w
+            case 2:  op = 0x78206800u; break;                // strh w
+            case 4:  op = 0xB8206800u; break;                // str w
+            default: op = 0xF8206800u; break;                // str x
+        }
+        emit(op | (rm << 16) | (0u << 5) | rt);             // str* rt, [x0, rm]
+        patchHere(doneJump, ARM64_IMM19);
+    }
+
+    void emitFlagArith(bool isSub, bool is64, uint32_t lhsReg, uint32_t rhs, bool rhsIsImm, uint32_t dstReg) override {
+        // x0=lhs，x1=rhs，x2=result（64 位槽运算，位宽只影响标志物化）。
+        loadVm(0, lhsReg);
+        loadRhs(rhs, rhsIsImm);
+        emit((isSub ? 0xCB000000u : 0x8B000000u) | (1u << 16) | (0u << 5) | 2u);   // sub/add x2, x0, x1
+        storeVm(2, dstReg);
+        // 记录惰性标志（与 recordFlags 字段一一对应）。
+        movImm(3, isSub ? VM_FLAGS_SUB : VM_FLAGS_ADD, false);
+        strbCtx(3, layout_.ctx_flags_kind);
+        if (is64) {
+            movImm(3, 1, false);
+            strbCtx(3, layout_.ctx_flags_is64);
+        } else {
+            strbCtx(kZr, layout_.ctx_flags_is64);
+        }
+        strCtx64(0, layout_.ctx_flags_lhs);
+        strCtx64(1, layout_.ctx_flags_rhs);
+        strCtx64(2, layout_.ctx_flags_result);
+    }
+
+    void emitJump(uint32_t targetPc) override {
+        branch(targetPc);
+    }
+
+    void emitConditionalJump(uint32_t cc, uint32_t targetPc) override {
+        // w0 = vm::evaluateConditionCode(ctx, cc)；bool 返回值只保证低 8 位有效。
+        movReg(0, kCtx);
+        movImm(1, cc, false);
+        callAbs(reinterpret_cast<uint64_t>(&vm::evaluateConditionCode));
+        emit(0x12001C00u);                              // and w0, w0, #0xff
+        fixups_.push_back(Fixup{code_.size(), targetPc, ARM64_IMM19});
+        emit(0x35000000u);                              // cbnz w0, target
+    }
+
+    void emitCallHandler(void (*handler)(VMContext*), uint32_t pc, uint32_t nextPc) override {
+        storeCtxPc(pc);
+        movReg(0, kCtx);
+        callAbs(reinterpret_cast<uint64_t>(handler));
+        emitCallEpilogue(nextPc);
+    }
+
+    void emitCallDecoded(const VMDecodedInst* inst, uint32_t pc, uint32_t nextPc) override {
+        storeCtxPc(pc);
+        movReg(0, kCtx);
+        movImm(1, reinterpret_cast<uint64_t>(inst), true);
+        callAbs(reinterpret_cast<uint64_t>(&vm::runJitDecodedRecord));
+        emitCallEpilogue(nextPc);
+    }
+
+    void emitExit(uint32_t pc) override {
+        storeCtxPc(pc);
+        branch(kLabelExit);
+    }
+
+    bool finish() override {
+        // 分发桩：pc 越界或不是已编译起点时退出，否则跳到 pc 表中的本机地址。
+        dispatch_offset_ = code_.size();
+        ldrCtx32(kScratch, layout_.ctx_pc);
+        movImm(kScratch2, layout_.inst_count, false);
+        cmp32(kScratch, kScratch2);
+        fixups_.push_back(Fixup{code_.size(), kLabelExit, ARM64_IMM19});
+        emit(0x54000000u | kCondHs);                                            // b.hs exit
+        emit(0xF8607800u | (kScratch << 16) | (kPcTable << 5) | kScratch2);     // ldr x10, [x22, x9, lsl #3]
+        fixups_.push_back(Fixup{code_.size(), kLabelExit, ARM64_IMM19});
+        emit(0xB4000000u | kScratch2);                                          // cbz x10, exit
+        emit(0xD61F0000u | (kScratch2 << 5));                                   // br x10
+
+        // 退出桩：恢复被调用者寄存器并返回。
+        exit_offset_ = code_.size();
+        emit(0xA9425BF5u);                              // ldp x21, x22, [sp, #32]
+        emit(0xA94153F3u);                              // ldp x19, x20, [sp, #16]
+        emit(0xA8C37BFDu);                              // ldp x29, x30, [sp], #48
+        emit(0xD65F03C0u);                              // ret
+
+        for (const Fixup& fixup : fixups_) {
+            size_t targetOffset = 0;
+            if (!labelOffset(fixup.target, targetOffset) || !patch(fixup.at, targetOffset, fixup.kind)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // 回调返回后：停机则退出；处理函数改写了 pc（跳转/调用返回点）时经 pc 表分发，否则顺序落到下一条模板。
+    void emitCallEpilogue(uint32_t nextPc) {
+        ldrbCtx(kScratch, layout_.ctx_running);
+        fixups_.push_back(Fixup{code_.size(), kLabelExit, ARM64_IMM19});
+        emit(0x34000000u | kScratch);                   // cbz w9, exit
+        ldrCtx32(kScratch, layout_.ctx_pc);
+        movImm(kScratch2, nextPc, false);
+        cmp32(kScratch, kScratch2);
+        fixups_.push_back(Fixup{code_.size(), kLabelDispatch, ARM64_IMM19});
+        emit(0x54000000u | kCondNe);                    // b.ne dispatch
+    }
+
+    void emit(uint32_t insn) {
+        uint8_t raw[4];
+        std::memcpy(raw, &insn, sizeof(raw));
+        code_.insert(code_.end(), raw, raw + sizeof(raw));
+    }
+
+    uint32_t readAt(size_t at) const {
+        uint32_t insn = 0;
+        std::memcpy(&insn, code_.data() + at, sizeof(insn));
+        return insn;
+    }
+
+    void writeAt(size_t at, uint32_t insn) {
+        std::memcpy(code_.data() + at, &insn, sizeof(insn));
+    }
+
+    // 回填 at 处跳转指令的位移字段；超出编码范围返回 false。
+    bool patch(size_t at, size_t targetOffset, uint32_t kind) {
+        const int64_t delta = (static_cast<int64_t>(targetOffset) - static_cast<int64_t>(at)) / 4;
+        if (kind == ARM64_IMM26) {
+            if (delta < -(int64_t(1) << 25) || delta >= (int64_t(1) << 25)) {
+                return false;
+            }
+            writeAt(at, readAt(at) | (static_cast<uint32_t>(delta) & 0x03FFFFFFu));
+            return true;
+        }
+        if (delta < -(int64_t(1) << 18) || delta >= (int64_t(1) << 18)) {
+            return false;
+        }
+        writeAt(at, readAt(at) | ((static_cast<uint32_t>(delta) & 0x7FFFFu) << 5));
+        return true;
+    }
+
+    // 模板内部短跳转：先写占位指令，再由 patchHere 指向当前位置（距离固定很短，不会越界）。
+    size_t placeholder(uint32_t insn) {
+        const size_t at = code_.size();
+        emit(insn);
+        return at;
+    }
+
+    void patchHere(size_t at, uint32_t kind) {
+        patch(at, code_.size(), kind);
+    }
+
+    // mov xd, xs（orr xd, xzr, xs）。
+    void movReg(uint32_t rd, uint32_t rs) {
+        emit(0xAA0003E0u | (rs << 16) | rd);
+    }
+
+    // movz + movk 物化立即数（is64=false 时写 W 寄存器，高 32 位清零）。
+    void movImm(uint32_t rd, uint64_t value, bool is64) {
+        const uint32_t halfCount = is64 ? 4u : 2u;
+        const uint32_t movz = is64 ? 0xD2800000u : 0x52800000u;
+        const uint32_t movk = is64 ? 0xF2800000u : 0x72800000u;
+        bool first = true;
+        for (uint32_t hw = 0; hw < halfCount; ++hw) {
+            const uint32_t part = static_cast<uint32_t>((value >> (hw * 16u)) & 0xFFFFu);
+            if (part == 0 && !(first && hw + 1 == halfCount)) {
+                continue;
+            }
+            emit((first ? movz : movk) | (hw << 21) | (part << 5) | rd);
+            first = false;
+        }
+    }
+
+    // 第二操作数装入 x1（立即数按 32 位零扩展）。
+    void loadRhs(uint32_t rhs, bool rhsIsImm) {
+        if (rhsIsImm) {
+            movImm(1, rhs, false);
+        } else {
+            loadVm(1, rhs);
+        }
+    }
+
+    // 访存偏移：0 直接用零寄存器，否则符号扩展后装入 x1；返回 Rm 编号。
+    uint32_t loadOffset(int32_t offset) {
+        if (offset == 0) {
+            return kZr;
+        }
+        movImm(1, static_cast<uint64_t>(static_cast<int64_t>(offset)), true);
+        return 1;
+    }
+
+    // VM 寄存器值槽：下标 < 4096 用 [x20, #idx*8]，否则经 x9 走寄存器偏移。
+    void loadVm(uint32_t rt, uint32_t idx) {
+        if (idx < 4096u) {
+            emit(0xF9400000u | (idx << 10) | (kRegs << 5) | rt);
+            return;
+        }
+        movImm(kScratch, idx, false);
+        emit(0xF8607800u | (kScratch << 16) | (kRegs << 5) | rt);   // ldr xt, [x20, x9, lsl #3]
+    }
+
+    void storeVm(uint32_t rt, uint32_t idx) {
+        if (idx < 4096u) {
+            emit(0xF9000000u | (idx << 10) | (kRegs << 5) | rt);
+            return;
+        }
+        movImm(kScratch, idx, false);
+        emit(0xF8207800u | (kScratch << 16) | (kRegs << 5) | rt);   // str xt, [x20, x9, lsl #3]
+    }
+
+    // ownership 侧表 byte [x21 + idx] = 0。
+    void clearOwned(uint32_t idx) {
+        if (idx < 4096u) {
+            emit(0x39000000u | (idx << 10) | (kOwned << 5) | kZr);
+            return;
+        }
+        movImm(kScratch, idx, false);
+        emit(0x38206800u | (kScratch << 16) | (kOwned << 5) | kZr); // strb wzr, [x21, x9]
+    }
+
+    // VMContext 字段访问（偏移远小于 4096 且自然对齐）。
+    void ldrCtx64(uint32_t rt, uint32_t offset) { emit(0xF9400000u | ((offset / 8u) << 10) | (kCtx << 5) | rt); }
+    void strCtx64(uint32_t rt, uint32_t offset) { emit(0xF9000000u | ((offset / 8u) << 10) | (kCtx << 5) | rt); }
+    void ldrCtx32(uint32_t rt, uint32_t offset) { emit(0xB9400000u | ((offset / 4u) << 10) | (kCtx << 5) | rt); }
+    void strCtx32(uint32_t rt, uint32_t offset) { emit(0xB9000000u | ((offset / 4u) << 10) | (kCtx << 5) | rt); }
+    void ldrbCtx(uint32_t rt, uint32_t offset) { emit(0x39400000u | (offset << 10) | (kCtx << 5) | rt); }
+    void strbCtx(uint32_t rt, uint32_t offset) { emit(0x39000000u | (offset << 10) | (kCtx << 5) | rt); }
+
+    void storeCtxPc(uint32_t pc) {
+        movImm(kScratch, pc, false);
+        strCtx32(kScratch, layout_.ctx_pc);
+    }
+
+    // cmp wn, wm（subs wzr, wn, wm）。
+    void cmp32(uint32_t rn, uint32_t rm) {
+        emit(0x6B000000u | (rm << 16) | (rn << 5) | kZr);
+    }
+
+    // 绝对地址调用：x16 = address; blr x16。
+    void callAbs(uint64_t address) {
+        movImm(kCallTarget, address, true);
+        emit(0xD63F0000u | (kCallTarget << 5));
+    }
+
+    void branch(uint32_t target) {
+        fixups_.push_back(Fixup{code_.size(), target, ARM64_IMM26});
+        emit(0x14000000u);
+    }
+};
+
+} // namespace
+
+std::unique_ptr<zVmJitEmitter> createJitEmitterArm64() {
+    return std::unique_ptr<zVmJitEmitter>(new zVmJitEmitterArm64());
+}
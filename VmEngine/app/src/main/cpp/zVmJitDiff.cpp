@@ -0,0 +1,231 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 基线 JIT 差分自检：内置小函数语料，逐例比较解释执行与 JIT 执行的寄存器、NZCV 与返回值。
+ * - 加固链路位置：回归自检层（VM_JIT_DIFF_CHECK=1 时由 vm_init 调用，tools/run_regression.py 判定日志）。
+ * - 输入：当前进程架构对应的 JIT 后端（arm64 设备 / x86_64 模拟器）。
+ * - 输出：route_jit_diff 日志 + 总体结论。
+ */
+#include "zVmJit.h"
+
+// opcode 常量与类型特化描述。
+#include "zVmOpcodes.h"
+// 日志。
+#include "zLog.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 自检函数固定 32 个寄存器；越界下标在定宽写入中表示零寄存器。
+constexpr uint32_t kDiffZeroReg = 255;
+
+// 运算边界值：零、±1、符号位、32 位边界、移位量越界与普通值。
+const uint64_t kEdgeValues[] = {
+    0, 1, 2, 7, 31, 32, 63, 64,
+    0x7FFFFFFFull, 0x80000000ull, 0xFFFFFFFFull, 0x100000000ull,
+    0x7FFFFFFFFFFFFFFFull, 0x8000000000000000ull, 0xFFFFFFFFFFFFFFFFull, 0xFFFFFFFFFFFFFFF9ull,
+    12345678901ull,
+};
+
+// 立即数形态的取值（立即数为 32 位零扩展）。
+const uint32_t kEdgeImms[] = {0, 1, 7, 31, 63, 0x80000000u, 0xFFFFFFFFu};
+
+// 一条自检用例：word 流 + 分支表 + 多组入参（x0 起依次写入）。
+struct JitDiffCase {
+    std::string name;
+    std::vector<uint32_t> words;
+    std::vector<uint32_t> branches;
+    std::vector<std::vector<uint64_t>> argSets;
+};
+
+// 函数头：协议要求首条为 OP_ALLOC_RETURN。
+std::vector<uint32_t> beginWords() {
+    return {OP_ALLOC_RETURN, 0, 0, 0, 0};
+}
+
+// x0 取遍边界值。
+std::vector<std::vector<uint64_t>> unaryArgSets() {
+    std::vector<std::vector<uint64_t>> sets;
+    for (uint64_t a : kEdgeValues) {
+        sets.push_back({a});
+    }
+    return sets;
+}
+
+// (x0, x1) 取遍边界值两两组合。
+std::vector<std::vector<uint64_t>> binaryArgSets() {
+    std::vector<std::vector<uint64_t>> sets;
+    for (uint64_t a : kEdgeValues) {
+        for (uint64_t b : kEdgeValues) {
+            sets.push_back({a, b});
+        }
+    }
+    return sets;
+}
+
+// 类型特化二元运算：寄存器形态 x2 = x0 op x1；立即数形态逐个立即数写入 x2.. 。
+void addTypedBinaryCases(std::vector<JitDiffCase>& cases) {
+    for (uint32_t opcode = kVmTypedOpcodeBegin; opcode < OP_TYPED_END; ++opcode) {
+        const vm::VMTypedOpcodeInfo* info = vm::getTypedOpcodeInfo(opcode);
+        if (info == nullptr) {
+            continue;
+        }
+        JitDiffCase c;
+        c.name = "typed_op_" + std::to_string(opcode);
+        c.words = beginWords();
+        if (info->kind == VM_TYPED_BINARY) {
+            c.words.insert(c.words.end(), {opcode, 0, 1, 2, OP_RETURN, 1, 2});
+            c.argSets = binaryArgSets();
+        } else if (info->kind == VM_TYPED_BINARY_IMM) {
+            uint32_t dst = 2;
+            for (uint32_t imm : kEdgeImms) {
+                c.words.insert(c.words.end(), {opcode, 0, imm, dst++});
+            }
+            c.words.insert(c.words.end(), {OP_RETURN, 1, dst - 1});
+            c.argSets = unaryArgSets();
+        } else {
+            continue;
+        }
+        cases.push_back(std::move(c));
+    }
+}
+
+// 置标志加减 + 全部条件码：x2 = x0 op x1 并置标志，x3..x16 记录 cc 0..13 是否命中（命中跳过置 1）。
+void addFlagCases(std::vector<JitDiffCase>& cases) {
+    const uint32_t subOps[] = {BIN_SUB, BIN_ADD};
+    // 类型表下标：0=int64，1=int32。
+    const uint32_t typeIndices[] = {0, 1};
+    for (uint32_t subOp : subOps) {
+        for (uint32_t typeIndex : typeIndices) {
+            for (int immForm = 0; immForm < 2; ++immForm) {
+                JitDiffCase c;
+                c.name = std::string("flags_") + (subOp == BIN_SUB ? "sub" : "add") +
+                         (typeIndex == 0 ? "_i64" : "_i32") + (immForm ? "_imm" : "");
+                c.words = beginWords();
+                // 第二操作数：寄存器形态为 x1，立即数形态为 1。
+                const uint32_t opcode = immForm ? static_cast<uint32_t>(OP_BINARY_IMM) : static_cast<uint32_t>(OP_BINARY);
+                c.words.insert(c.words.end(), {opcode, subOp | BIN_UPDATE_FLAGS, typeIndex, 0, 1, 2});
+                for (uint32_t cc = CC_EQ; cc <= CC_LE; ++cc) {
+                    const uint32_t dst = 3 + cc;
+                    c.words.insert(c.words.end(), {OP_LOAD_IMM, dst, 0, OP_BRANCH_IF_CC, cc, cc, OP_LOAD_IMM, dst, 1});
+                    // 分支目标：紧随其后的下一条指令。
+                    c.branches.push_back(static_cast<uint32_t>(c.words.size()));
+                }
+                c.words.insert(c.words.end(), {OP_RETURN, 1, 2});
+                c.argSets = binaryArgSets();
+                cases.push_back(std::move(c));
+            }
+        }
+    }
+}
+
+// 置标志回边循环：x1 = sum(1..x0)。
+void addLoopCase(std::vector<JitDiffCase>& cases) {
+    JitDiffCase c;
+    c.name = "flags_loop";
+    c.words = beginWords();
+    c.words.insert(c.words.end(), {OP_LOAD_IMM, 1, 0});
+    c.branches.push_back(static_cast<uint32_t>(c.words.size()));
+    c.words.insert(c.words.end(), {OP_BINARY, BIN_ADD, 0, 1, 0, 1,
+                                   OP_BINARY_IMM, BIN_SUB | BIN_UPDATE_FLAGS, 0, 0, 1, 0,
+                                   OP_BRANCH_IF_CC, CC_NE, 0,
+                                   OP_RETURN, 1, 1});
+    // x0=0 会回绕计数，语料只取正数。
+    c.argSets = {{1}, {2}, {10}, {1000}};
+    cases.push_back(std::move(c));
+}
+
+// 定宽读写：x0 指向暂存区，先写后读（不依赖执行前内容），含零寄存器写入与空基址读取。
+void addMemoryCase(std::vector<JitDiffCase>& cases, uint64_t* scratch) {
+    JitDiffCase c;
+    c.name = "typed_memory";
+    c.words = beginWords();
+    c.words.insert(c.words.end(), {
+        OP_STR_I64, 0, 0, 1,
+        OP_STR_I32, 0, 8, 1,
+        OP_STR_I16, 0, 12, 1,
+        OP_STR_I8, 0, 14, 1,
+        OP_STR_I64, 0, 16, kDiffZeroReg,
+        OP_LDR_U64, 0, 0, 2,
+        OP_LDR_I32, 0, 8, 3,
+        OP_LDR_U32, 0, 8, 4,
+        OP_LDR_I16, 0, 12, 5,
+        OP_LDR_U16, 0, 12, 6,
+        OP_LDR_I8, 0, 14, 7,
+        OP_LDR_U8, 0, 14, 8,
+        OP_LDR_U64, 0, 16, 9,
+        OP_LDR_U64, 10, 0, 11,
+        OP_ADD_I64, 2, 3, 12,
+        OP_ADD_I64, 12, 5, 12,
+        OP_ADD_I64, 12, 7, 12,
+        OP_RETURN, 1, 12,
+    });
+    for (uint64_t value : kEdgeValues) {
+        c.argSets.push_back({reinterpret_cast<uint64_t>(scratch), value});
+    }
+    cases.push_back(std::move(c));
+}
+
+// 回调路径：OP_SELECT 走 word 处理函数，OP_SWITCH 走预解码记录，OP_BRANCH 直达跳转。
+void addFallbackCase(std::vector<JitDiffCase>& cases) {
+    JitDiffCase c;
+    c.name = "handler_fallback";
+    c.words = beginWords();
+    c.words.insert(c.words.end(), {OP_SELECT, 0, 1, 2, 3, OP_MOV, 3, 4, OP_BRANCH, 0, OP_LOAD_IMM, 4, 99});
+    c.branches.push_back(static_cast<uint32_t>(c.words.size()));
+    const size_t switchPc = c.words.size();
+    c.words.insert(c.words.end(), {OP_SWITCH, 0, 0, 2, 1, 0, 2, 0});
+    uint32_t targets[3];
+    for (uint32_t k = 0; k < 3; ++k) {
+        targets[k] = static_cast<uint32_t>(c.words.size());
+        c.words.insert(c.words.end(), {OP_LOAD_IMM, 5, 100 + k, OP_BINARY, BIN_ADD, 0, 5, 4, 5, OP_RETURN, 1, 5});
+    }
+    // [opcode][value][default_target][case_count][(value, target)...]
+    c.words[switchPc + 2] = targets[2];
+    c.words[switchPc + 5] = targets[0];
+    c.words[switchPc + 7] = targets[1];
+    c.argSets = {{0, 5, 6}, {1, 5, 6}, {2, 5, 6}, {3, 5, 6}};
+    cases.push_back(std::move(c));
+}
+
+} // namespace
+
+// 差分自检入口。
+bool runJitDiffCheck() {
+#if VM_JIT && !VM_TRACE
+    std::unique_ptr<zVmJitEmitter> emitter = createNativeJitEmitter();
+    if (!emitter) {
+        LOGW("route_jit_diff skipped: no jit backend for this architecture");
+        return true;
+    }
+    // 定宽读写用例的暂存区（两侧执行都先写后读）。
+    uint64_t scratch[4] = {0, 0, 0, 0};
+    std::vector<JitDiffCase> cases;
+    addTypedBinaryCases(cases);
+    addFlagCases(cases);
+    addLoopCase(cases);
+    addMemoryCase(cases, scratch);
+    addFallbackCase(cases);
+
+    zVmEngine& engine = zVmEngine::getInstance();
+    uint32_t failed = 0;
+    for (const JitDiffCase& c : cases) {
+        std::string report;
+        if (!engine.diffCheckJit(c.words, c.branches, c.argSets, &report)) {
+            ++failed;
+            LOGE("route_jit_diff mismatch case=%s backend=%s %s", c.name.c_str(), emitter->name(), report.c_str());
+        }
+    }
+    LOGI("route_jit_diff result=%d backend=%s cases=%zu failed=%u",
+         failed == 0 ? 1 : 0,
+         emitter->name(),
+         cases.size(),
+         failed);
+    return failed == 0;
+#else
+    LOGW("route_jit_diff skipped: jit disabled in this build");
+    return true;
+#endif
+}
@@ -0,0 +1,401 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 基线 JIT 的 x86-64 后端：System V 调用约定下的指令模板编码。
+ * - 加固链路位置：执行前准备层（主机调试 / 模拟器 x86_64 进程使用）。
+ * - 输入：驱动层逐条下发的 VM 指令语义（寄存器下标、立即数、跳转目标 pc）。
+ * - 输出：机器码字节 + pc 偏移表；纯编码逻辑，可在任意主机上编译。
+ */
+#include "zVmJit.h"
+
+// opcode / 二元算子常量。
+#include "zVmOpcodes.h"
+// memcpy。
+#include <cstring>
+// std::initializer_list。
+#include <initializer_list>
+
+namespace {
+
+// 常驻寄存器分配：
+//   rbx = ctx，r12 = 寄存器值数组，r13 = ownership 数组，r14 = pc 表；
+//   rax / rcx / rdx 为模板临时寄存器，rdi / rsi 用于回调传参。
+enum X64Reg : int {
+    RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+    R12 = 12, R13 = 13, R14 = 14, R15 = 15,
+};
+
+// 待回填跳转类型。
+enum X64FixupKind : uint32_t {
+    X64_REL32 = 0,   // at 指向 4 字节相对位移（相对 at+4）
+};
+
+class zVmJitEmitterX64 final : public zVmJitEmitter {
+public:
+    const char* name() const override { return "x86_64"; }
+
+    // push rbx/r12/r13/r14/r15（5 次压栈后 rsp 恢复 16 字节对齐），缓存常驻指针后进入分发桩。
+    void emitPrologue(const VMJitLayout& layout) override {
+        layout_ = layout;
+        byte(0x53);                       // push rbx
+        bytes({0x41, 0x54});              // push r12
+        bytes({0x41, 0x55});              // push r13
+        bytes({0x41, 0x56});              // push r14
+        bytes({0x41, 0x57});              // push r15（仅用于栈对齐）
+        bytes({0x48, 0x89, 0xFB});        // mov rbx, rdi
+        mem({0x8B}, R12, RBX, static_cast<int32_t>(layout_.ctx_registers), true);
+        mem({0x8B}, R13, RBX, static_cast<int32_t>(layout_.ctx_reg_owned), true);
+        bytes({0x49, 0x89, 0xF6});        // mov r14, rsi
+        jmpRel32(kLabelDispatch);
+    }
+
+    void emitMov(uint32_t srcReg, uint32_t dstReg) override {
+        loadVm(RAX, srcReg);
+        storeVm(RAX, dstReg);
+        clearOwned(dstReg);
+    }
+
+    void emitLoadImm(uint32_t dstReg, uint32_t imm) override {
+        movImm32(RAX, imm);
+        storeVm(RAX, dstReg);
+        clearOwned(dstReg);
+    }
+
+    bool emitTypedBinary(uint32_t binOp, uint32_t width, bool isSigned,
+                         uint32_t lhsReg, uint32_t rhs, bool rhsIsImm, uint32_t dstReg) override {
+        // 4 字节宽度使用 32 位运算：结果自动零扩展，移位量按 31 取模，与 execTypedBinary 一致。
+        const bool w = width == 8;
+        loadVm(RAX, lhsReg);
+        loadRhs(rhs, rhsIsImm);
+        switch (binOp) {
+            case BIN_ADD: aluRR(0x01, RAX, RCX, w); break;
+            case BIN_SUB: aluRR(0x29, RAX, RCX, w); break;
+            case BIN_AND: aluRR(0x21, RAX, RCX, w); break;
+            case BIN_OR:  aluRR(0x09, RAX, RCX, w); break;
+            case BIN_XOR: aluRR(0x31, RAX, RCX, w); break;
+            case BIN_MUL:
+                // imul eax/rax, ecx/rcx。
+                rex(w, RAX, RCX);
+                bytes({0x0F, 0xAF, modrmRR(RAX, RCX)});
+                break;
+            case BIN_SHL: shiftCl(4, w); break;
+            case BIN_LSR: shiftCl(5, w); break;
+            case BIN_ASR: shiftCl(7, w); break;
+            case BIN_IDIV: emitDivide(isSigned, w); break;
+            default:
+                return false;
+        }
+        storeVm(RAX, dstReg);
+        return true;
+    }
+
+    void emitTypedLoad(uint32_t width, bool isSigned, uint32_t baseReg, int32_t offset, uint32_t dstReg) override {
+        loadVm(RAX, baseReg);
+        bytes({0x48, 0x85, 0xC0});              // test rax, rax
+        const size_t nullJump = jccRel8(0x74);  // jz .null
+        switch (width) {
+            case 1:
+                if (isSigned) mem({0x0F, 0xBE}, RCX, RAX, offset, true);   // movsx rcx, byte
+                else          mem({0x0F, 0xB6}, RCX, RAX, offset, false);  // movzx ecx, byte
+                break;
+            case 2:
+                if (isSigned) mem({0x0F, 0xBF}, RCX, RAX, offset, true);   // movsx rcx, word
+                else          mem({0x0F, 0xB7}, RCX, RAX, offset, false);  // movzx ecx, word
+                break;
+            case 4:
+                if (isSigned) mem({0x63}, RCX, RAX, offset, true);         // movsxd rcx, dword
+                else          mem({0x8B}, RCX, RAX, offset, false);        // mov ecx, dword
+                break;
+            default:
+                mem({0x8B}, RCX, RAX, offset, true);                        // mov rcx, qword
+                break;
+        }
+        storeVm(RCX, dstReg);
+        const size_t doneJump = jccRel8(0xEB);  // jmp .done
+        // .null：与 OP_GET_FIELD 一致读出 0 并清 ownership。
+        patchRel8(nullJump);
+        bytes({0x31, 0xC9});                    // xor ecx, ecx
+        storeVm(RCX, dstReg);
+        clearOwned(dstReg);
+        patchRel8(doneJump);
+    }
+
+    void emitTypedStore(uint32_t width, uint32_t baseReg, int32_t offset, uint32_t valueReg, bool valueIsZero) override {
+        loadVm(RAX, baseReg);
+        bytes({0x48, 0x85, 0xC0});              // test rax, rax
+        const size_t doneJump = jccRel8(0x74);  // jz .done（空基址跳过写入）
+        if (valueIsZero) {
+            bytes({0x31, 0xC9});                // xor ecx, ecx
+        } else {
+            loadVm(RCX, valueReg);
+        }
+        switch (width) {
+            case 1:  mem({0x88}, RCX, RAX, offset, false); break;         // mov byte [rax+off], cl
+            case 2:  mem({0x89}, RCX, RAX, offset, false, 0x66); break;   // mov word [rax+off], cx
+            case 4:  mem({0x89}, RCX, RAX, offset, false); break;         // mov dword [rax+off], ecx
+            default: mem({0x89}, RCX, RAX, offset, true); break;          // mov qword [rax+off], rcx
+        }
+        patchRel8(doneJump);
+    }
+
+    void emitFlagArith(bool isSub, bool is64, uint32_t lhsReg, uint32_t rhs, bool rhsIsImm, uint32_t dstReg) override {
+        // rax=lhs，rcx=rhs，rdx=result（64 位槽运算，位宽只影响标志物化）。
+        loadVm(RAX, lhsReg);
+        loadRhs(rhs, rhsIsImm);
+        bytes({0x48, 0x89, 0xC2});              // mov rdx, rax
+        aluRR(isSub ? 0x29 : 0x01, RDX, RCX, true);
+        storeVm(RDX, dstReg);
+        // 记录惰性标志（与 recordFlags 字段一一对应）。
+        mem({0xC6}, 0, RBX, static_cast<int32_t>(layout_.ctx_flags_kind), false);
+        byte(static_cast<uint8_t>(isSub ? VM_FLAGS_SUB : VM_FLAGS_ADD));
+        mem({0xC6}, 0, RBX, static_cast<int32_t>(layout_.ctx_flags_is64), false);
+        byte(is64 ? 1 : 0);
+        mem({0x89}, RAX, RBX, static_cast<int32_t>(layout_.ctx_flags_lhs), true);
+        mem({0x89}, RCX, RBX, static_cast<int32_t>(layout_.ctx_flags_rhs), true);
+        mem({0x89}, RDX, RBX, static_cast<int32_t>(layout_.ctx_flags_result), true);
+    }
+
+    void emitJump(uint32_t targetPc) override {
+        jmpRel32(targetPc);
+    }
+
+    void emitConditionalJump(uint32_t cc, uint32_t targetPc) override {
+        // al = vm::evaluateConditionCode(ctx, cc)。
+        bytes({0x48, 0x89, 0xDF});              // mov rdi, rbx
+        byte(0xBE);                             // mov esi, imm32
+        dword(cc);
+        callAbs(reinterpret_cast<uint64_t>(&vm::evaluateConditionCode));
+        bytes({0x84, 0xC0});                    // test al, al
+        jccRel32(0x85, targetPc);               // jnz target
+    }
+
+    void emitCallHandler(void (*handler)(VMContext*), uint32_t pc, uint32_t nextPc) override {
+        storeCtxPc(pc);
+        bytes({0x48, 0x89, 0xDF});              // mov rdi, rbx
+        callAbs(reinterpret_cast<uint64_t>(handler));
+        emitCallEpilogue(nextPc);
+    }
+
+    void emitCallDecoded(const VMDecodedInst* inst, uint32_t pc, uint32_t nextPc) override {
+        storeCtxPc(pc);
+        bytes({0x48, 0x89, 0xDF});              // mov rdi, rbx
+        bytes({0x48, 0xBE});                    // mov rsi, imm64
+        qword(reinterpret_cast<uint64_t>(inst));
+        callAbs(reinterpret_cast<uint64_t>(&vm::runJitDecodedRecord));
+        emitCallEpilogue(nextPc);
+    }
+
+    void emitExit(uint32_t pc) override {
+        storeCtxPc(pc);
+        jmpRel32(kLabelExit);
+    }
+
+    bool finish() override {
+        // 分发桩：pc 越界或不是已编译起点时退出，否则跳到 pc 表中的本机地址。
+        dispatch_offset_ = code_.size();
+        mem({0x8B}, RAX, RBX, static_cast<int32_t>(layout_.ctx_pc), false);      // mov eax, [rbx+pc]
+        byte(0x3D);                                                              // cmp eax, inst_count
+        dword(layout_.inst_count);
+        jccRel32(0x83, kLabelExit);                                              // jae exit
+        bytes({0x49, 0x8B, 0x04, 0xC6});                                         // mov rax, [r14+rax*8]
+        bytes({0x48, 0x85, 0xC0});                                               // test rax, rax
+        jccRel32(0x84, kLabelExit);                                              // jz exit
+        bytes({0xFF, 0xE0});                                                     // jmp rax
+
+        // 退出桩：恢复被调用者寄存器。
+        exit_offset_ = code_.size();
+        bytes({0x41, 0x5F});                    // pop r15
+        bytes({0x41, 0x5E});                    // pop r14
+        bytes({0x41, 0x5D});                    // pop r13
+        bytes({0x41, 0x5C});                    // pop r12
+        byte(0x5B);                             // pop rbx
+        byte(0xC3);                             // ret
+
+        for (const Fixup& fixup : fixups_) {
+            size_t targetOffset = 0;
+            if (!labelOffset(fixup.target, targetOffset)) {
+                return false;
+            }
+            const int64_t delta = static_cast<int64_t>(targetOffset) - static_cast<int64_t>(fixup.at + 4);
+            if (delta < INT32_MIN || delta > INT32_MAX) {
+                return false;
+            }
+            const int32_t rel = static_cast<int32_t>(delta);
+            std::memcpy(code_.data() + fixup.at, &rel, sizeof(rel));
+        }
+        return true;
+    }
+
+private:
+    // 回调返回后：停机则退出；处理函数改写了 pc（跳转/调用返回点）时经 pc 表分发，否则顺序落到下一条模板。
+    void emitCallEpilogue(uint32_t nextPc) {
+        mem({0x80}, 7, RBX, static_cast<int32_t>(layout_.ctx_running), false);   // cmp byte [rbx+running], 0
+        byte(0);
+        jccRel32(0x84, kLabelExit);
+        mem({0x81}, 7, RBX, static_cast<int32_t>(layout_.ctx_pc), false);        // cmp dword [rbx+pc], nextPc
+        dword(nextPc);
+        jccRel32(0x85, kLabelDispatch);
+    }
+
+    void byte(uint8_t value) {
+        code_.push_back(value);
+    }
+
+    void bytes(std::initializer_list<uint8_t> values) {
+        code_.insert(code_.end(), values.begin(), values.end());
+    }
+
+    void dword(uint32_t value) {
+        uint8_t raw[4];
+        std::memcpy(raw, &value, sizeof(raw));
+        code_.insert(code_.end(), raw, raw + sizeof(raw));
+    }
+
+    void qword(uint64_t value) {
+        dword(static_cast<uint32_t>(value));
+        dword(static_cast<uint32_t>(value >> 32));
+    }
+
+    // REX 前缀：W=64 位操作数，R 扩展 reg 字段，B 扩展 rm/base 字段；无需扩展时省略。
+    void rex(bool w, int reg, int base) {
+        const uint8_t value = static_cast<uint8_t>(0x40 | (w ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((base & 8) ? 0x01 : 0));
+        if (value != 0x40) {
+            byte(value);
+        }
+    }
+
+    static uint8_t modrmRR(int reg, int rm) {
+        return static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7));
+    }
+
+    // [base + disp32] 内存操作数（统一 mod=10；rsp/r12 作基址时补 SIB）。
+    void mem(std::initializer_list<uint8_t> opcode, int reg, int base, int32_t disp, bool w, uint8_t prefix = 0) {
+        if (prefix != 0) {
+            byte(prefix);
+        }
+        rex(w, reg, base);
+        bytes(opcode);
+        byte(static_cast<uint8_t>(0x80 | ((reg & 7) << 3) | (base & 7)));
+        if ((base & 7) == RSP) {
+            byte(0x24);
+        }
+        dword(static_cast<uint32_t>(disp));
+    }
+
+    // VM 寄存器值槽 [r12 + idx*8]。
+    void loadVm(int reg, uint32_t idx) {
+        mem({0x8B}, reg, R12, static_cast<int32_t>(idx * 8u), true);
+    }
+
+    void storeVm(int reg, uint32_t idx) {
+        mem({0x89}, reg, R12, static_cast<int32_t>(idx * 8u), true);
+    }
+
+    // ownership 侧表 byte [r13 + idx] = 0。
+    void clearOwned(uint32_t idx) {
+        mem({0xC6}, 0, R13, static_cast<int32_t>(idx), false);
+        byte(0);
+    }
+
+    // mov r32, imm32（高 32 位清零，与 VM 立即数零扩展语义一致）。
+    void movImm32(int reg, uint32_t imm) {
+        rex(false, 0, reg);
+        byte(static_cast<uint8_t>(0xB8 + (reg & 7)));
+        dword(imm);
+    }
+
+    // 第二操作数装入 rcx。
+    void loadRhs(uint32_t rhs, bool rhsIsImm) {
+        if (rhsIsImm) {
+            movImm32(RCX, rhs);
+        } else {
+            loadVm(RCX, rhs);
+        }
+    }
+
+    // op r/m, r（dst = dst op src）。
+    void aluRR(uint8_t opcode, int dst, int src, bool w) {
+        rex(w, src, dst);
+        byte(opcode);
+        byte(modrmRR(src, dst));
+    }
+
+    // rax = rax / rcx：除零得 0；有符号除以 -1 取负（MIN/-1 得被除数，避开 #DE），与 execTypedBinary 一致。
+    void emitDivide(bool isSigned, bool w) {
+        rex(w, RCX, RCX);
+        bytes({0x85, modrmRR(RCX, RCX)});       // test rcx, rcx
+        const size_t zeroJump = jccRel8(0x74);  // jz .zero
+        size_t negDone = 0;
+        if (isSigned) {
+            rex(w, 0, RCX);
+            bytes({0x83, modrmRR(7, RCX), 0xFF});   // cmp rcx, -1
+            const size_t divJump = jccRel8(0x75);   // jne .div
+            rex(w, 0, RAX);
+            bytes({0xF7, modrmRR(3, RAX)});         // neg rax
+            negDone = jccRel8(0xEB);                // jmp .done
+            patchRel8(divJump);
+            rex(w, 0, RAX);
+            byte(0x99);                             // cqo / cdq
+            rex(w, 0, RCX);
+            bytes({0xF7, modrmRR(7, RCX)});         // idiv rcx
+        } else {
+            bytes({0x31, 0xD2});                    // xor edx, edx
+            rex(w, 0, RCX);
+            bytes({0xF7, modrmRR(6, RCX)});         // div rcx
+        }
+        const size_t doneJump = jccRel8(0xEB);  // jmp .done
+        patchRel8(zeroJump);
+        bytes({0x31, 0xC0});                    // xor eax, eax
+        patchRel8(doneJump);
+        if (isSigned) {
+            patchRel8(negDone);
+        }
+    }
+
+    // shl/shr/sar rax, cl（ext 为 ModRM.reg 扩展码）。
+    void shiftCl(int ext, bool w) {
+        rex(w, 0, RAX);
+        byte(0xD3);
+        byte(modrmRR(ext, RAX));
+    }
+
+    // mov rax, imm64; call rax（rsp 在序言后保持 16 字节对齐）。
+    void callAbs(uint64_t address) {
+        bytes({0x48, 0xB8});
+        qword(address);
+        bytes({0xFF, 0xD0});
+    }
+
+    // mov dword [rbx+pc], imm32。
+    void storeCtxPc(uint32_t pc) {
+        mem({0xC7}, 0, RBX, static_cast<int32_t>(layout_.ctx_pc), false);
+        dword(pc);
+    }
+
+    void jmpRel32(uint32_t target) {
+        byte(0xE9);
+        fixups_.push_back(Fixup{code_.size(), target, X64_REL32});
+        dword(0);
+    }
+
+    void jccRel32(uint8_t cc, uint32_t target) {
+        bytes({0x0F, cc});
+        fixups_.push_back(Fixup{code_.size(), target, X64_REL32});
+        dword(0);
+    }
+
+    // 模板内部短跳转：返回位移字节偏移，由 patchRel8 指向当前位置。
+    size_t jccRel8(uint8_t opcode) {
+        bytes({opcode, 0x00});
+        return code_.size() - 1;
+    }
+
+    void patchRel8(size_t at) {
+        code_[at] = static_cast<uint8_t>(code_.size() - (at + 1));
+    }
+};
+
+} // namespace
+
+std::unique_ptr<zVmJitEmitter> createJitEmitterX64() {
+    return std::unique_ptr<zVmJitEmitter>(new zVmJitEmitterX64());
+}
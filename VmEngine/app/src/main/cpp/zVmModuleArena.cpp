@@ -0,0 +1,87 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 模块级只读 arena 实现：匿名 mmap 块 + bump 指针，封存时整体 mprotect 为只读。
+ * - 加固链路位置：执行核心的函数缓存存储。
+ * - 输入：allocate / seal。
+ * - 输出：连续的运行态数组存储；析构时按块 munmap。
+ */
+#include "zVmModuleArena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "zLog.h"
+
+namespace {
+
+// 系统页大小（块长度与 mprotect 边界）。
+size_t arenaPageSize() {
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return pageSize;
+}
+
+// 向上取整到 align（2 的幂）。
+inline size_t alignUp(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+} // namespace
+
+zVmModuleArena::zVmModuleArena(size_t chunkBytes)
+    : chunk_bytes_(alignUp(chunkBytes == 0 ? 1 : chunkBytes, arenaPageSize())) {
+}
+
+zVmModuleArena::~zVmModuleArena() {
+    for (const Chunk& chunk : chunks_) {
+        munmap(chunk.base, chunk.size);
+    }
+}
+
+bool zVmModuleArena::addChunk(size_t minBytes) {
+    const size_t size = minBytes > chunk_bytes_ ? alignUp(minBytes, arenaPageSize()) : chunk_bytes_;
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        LOGE("zVmModuleArena: mmap failed size=%zu", size);
+        return false;
+    }
+    chunks_.push_back(Chunk{static_cast<uint8_t*>(base), size});
+    top_ = 0;
+    return true;
+}
+
+void* zVmModuleArena::allocate(size_t bytes, size_t align) {
+    if (sealed_ || bytes == 0) {
+        return nullptr;
+    }
+    if (align == 0) {
+        align = 1;
+    }
+    // 块基址页对齐，块内偏移按 align 对齐即得到对齐地址。
+    size_t offset = chunks_.empty() ? 0 : alignUp(top_, align);
+    if (chunks_.empty() || offset + bytes > chunks_.back().size) {
+        // 当前块剩余空间放不下：另起一块（剩余空间不再回填，保持 bundle 顺序）。
+        if (!addChunk(bytes)) {
+            return nullptr;
+        }
+        offset = 0;
+    }
+    top_ = offset + bytes;
+    used_bytes_ += bytes;
+    return chunks_.back().base + offset;
+}
+
+bool zVmModuleArena::seal() {
+    if (sealed_) {
+        return true;
+    }
+    sealed_ = true;
+    bool ok = true;
+    for (const Chunk& chunk : chunks_) {
+        if (mprotect(chunk.base, chunk.size, PROT_READ) != 0) {
+            // 封存失败不影响正确性，只是失去误写保护。
+            LOGW("zVmModuleArena: mprotect read-only failed base=%p size=%zu", chunk.base, chunk.size);
+            ok = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,71 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 模块级只读 arena 声明：一个 bundle 模块内全部函数的运行态数组按 bundle 顺序连续存放。
+ * - 加固链路位置：执行核心的函数缓存存储（zVmEngine::stageFunction / publishBundle）。
+ * - 输入：暂存阶段逐函数的数组拷贝请求。
+ * - 输出：页对齐的连续块；发布前整体改为只读，整代退役时按块一次释放。
+ */
+#ifndef Z_VM_MODULE_ARENA_H
+#define Z_VM_MODULE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// bump 分配的 mmap 块链：单次分配保证连续，超出默认块大小的请求单独占一块。
+// 只在构建线程内分配（非线程安全）；seal 之后不可再分配，内容对执行路径只读。
+class zVmModuleArena {
+public:
+    // cache line 对齐：每个函数的首个数组从新的 cache line 开始。
+    static constexpr size_t kLineAlign = 64;
+
+    explicit zVmModuleArena(size_t chunkBytes = 256 * 1024);
+    // 按块 munmap：与函数个数无关。
+    ~zVmModuleArena();
+    zVmModuleArena(const zVmModuleArena&) = delete;
+    zVmModuleArena& operator=(const zVmModuleArena&) = delete;
+
+    // 分配 bytes 字节（align 须为 2 的幂）；已封存或映射失败返回 nullptr。
+    void* allocate(size_t bytes, size_t align);
+
+    // 拷贝 count 个元素到 arena；src 为空或 count 为 0 时返回 nullptr 且不算失败（ok 保持不变）。
+    template <typename T>
+    T* copyArray(const T* src, size_t count, size_t align, bool& ok) {
+        if (src == nullptr || count == 0) {
+            return nullptr;
+        }
+        const size_t unitAlign = align > alignof(T) ? align : alignof(T);
+        T* dst = static_cast<T*>(allocate(sizeof(T) * count, unitAlign));
+        if (dst == nullptr) {
+            ok = false;
+            return nullptr;
+        }
+        std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), sizeof(T) * count);
+        return dst;
+    }
+
+    // 封存：全部块改为只读（误写直接触发 SIGSEGV，而不是静默破坏指令流）。
+    bool seal();
+
+    // 已分配有效字节数（不含对齐填充）与块数，用于日志。
+    size_t usedBytes() const { return used_bytes_; }
+    size_t chunkCount() const { return chunks_.size(); }
+
+private:
+    struct Chunk {
+        uint8_t* base;   // mmap 起始地址（页对齐）
+        size_t size;     // 映射长度（页大小整数倍）
+    };
+
+    // 映射一个至少 minBytes 的新块并设为当前块。
+    bool addChunk(size_t minBytes);
+
+    std::vector<Chunk> chunks_;
+    size_t chunk_bytes_;     // 默认块大小
+    size_t top_ = 0;         // 当前块已用字节
+    size_t used_bytes_ = 0;  // 累计分配字节
+    bool sealed_ = false;
+};
+
+#endif // Z_VM_MODULE_ARENA_H
@@ -6,6 +6,9 @@
  * - 输出：寄存器/PC/标志位更新。
  */
 #include "zVmOpcodes.h"
+#include "zVmDecoded.h"
+#include "zVmCompact.h"
+#include "zVmFrame.h"
 #include "zLog.h"
 // memcpy。
 #include <cstring>
@@ -21,6 +24,10 @@
 #include <iostream>
 // 原子原语。
 #include <atomic>
+// 类型特化运算的有符号极值。
+#include <limits>
+// std::conditional / std::make_signed。
+#include <type_traits>
 
 #ifndef VM_TRACE
 #define VM_TRACE 0
@@ -38,44 +45,6 @@
 
 namespace vm {
 
-// GCC/Clang 原子操作封装：统一提供 32/64 位原子原语，供 VM 指令实现复用。
-// 32 位原子加：返回加之前的旧值。
-inline uint32_t atomic_fetch_add(uint32_t* ptr, uint32_t val) {
-    return __sync_fetch_and_add(ptr, val);
-}
-// 64 位原子加：返回加之前的旧值。
-inline uint64_t atomic_fetch_add(uint64_t* ptr, uint64_t val) {
-    return __sync_fetch_and_add(ptr, val);
-}
-// 32 位原子减：返回减之前的旧值。
-inline uint32_t atomic_fetch_sub(uint32_t* ptr, uint32_t val) {
-    return __sync_fetch_and_sub(ptr, val);
-}
-// 64 位原子减：返回减之前的旧值。
-inline uint64_t atomic_fetch_sub(uint64_t* ptr, uint64_t val) {
-    return __sync_fetch_and_sub(ptr, val);
-}
-// 32 位原子交换：写入新值并返回旧值。
-inline uint32_t atomic_exchange(uint32_t* ptr, uint32_t val) {
-    return __sync_lock_test_and_set(ptr, val);
-}
-// 64 位原子交换：写入新值并返回旧值。
-inline uint64_t atomic_exchange(uint64_t* ptr, uint64_t val) {
-    return __sync_lock_test_and_set(ptr, val);
-}
-// 32 位原子比较交换：若 *ptr == expected 则写入 desired，返回交换前值。
-inline uint32_t atomic_compare_exchange(uint32_t* ptr, uint32_t expected, uint32_t desired) {
-    return __sync_val_compare_and_swap(ptr, expected, desired);
-}
-// 64 位原子比较交换：若 *ptr == expected 则写入 desired，返回交换前值。
-inline uint64_t atomic_compare_exchange(uint64_t* ptr, uint64_t expected, uint64_t desired) {
-    return __sync_val_compare_and_swap(ptr, expected, desired);
-}
-// 全栅栏：保证该线程内存访问顺序在屏障两侧不会重排。
-inline void atomic_fence() {
-    __sync_synchronize();
-}
-
 // VM 内存序枚举到编译器原子内存序常量的映射。
 inline int atomic_order_from_vm(uint32_t order) {
     switch (order) {
@@ -88,6 +57,15 @@ inline int atomic_order_from_vm(uint32_t order) {
     }
 }
 
+// CAS 失败路径只做读取：release 语义降为 relaxed，acq_rel 降为 acquire（__atomic 要求失败序不强于成功序且不含 release）。
+inline int atomic_cas_failure_order(int order) {
+    switch (order) {
+        case __ATOMIC_RELEASE: return __ATOMIC_RELAXED;
+        case __ATOMIC_ACQ_REL: return __ATOMIC_ACQUIRE;
+        default: return order;
+    }
+}
+
 // 带内存序参数的原子读封装。
 template<typename T>
 inline T atomic_load_ordered(const void* ptr, int order) {
@@ -100,23 +78,43 @@ inline void atomic_store_ordered(void* ptr, T value, int order) {
     __atomic_store_n(static_cast<T*>(ptr), value, order);
 }
 
+// 带内存序参数的原子读-改-写封装（OP_ATOMIC_ADD/SUB/XCHG），返回修改前的旧值。
+// 以 -moutline-atomics 构建时 AArch64 上由运行时按 CPU 能力选择 LSE（LDADD/SWP）或 LL/SC 序列。
+template<typename T>
+inline T atomic_rmw_ordered(uint32_t opcode, void* ptr, T value, int order) {
+    T* target = static_cast<T*>(ptr);
+    switch (opcode) {
+        case OP_ATOMIC_ADD:
+            return __atomic_fetch_add(target, value, order);
+        case OP_ATOMIC_SUB:
+            return __atomic_fetch_sub(target, value, order);
+        default:
+            return __atomic_exchange_n(target, value, order);
+    }
+}
+
+// 带内存序参数的原子比较交换封装（LSE 下对应 CAS/CASA/CASL/CASAL），返回交换前的值。
+template<typename T>
+inline T atomic_cas_ordered(void* ptr, T expected, T desired, int order) {
+    // 失败时 __atomic_compare_exchange_n 把当前值写回 expected，成功时 expected 本身即旧值。
+    __atomic_compare_exchange_n(static_cast<T*>(ptr), &expected, desired, false,
+                                order, atomic_cas_failure_order(order));
+    return expected;
+}
+
 
 // ============================================================================
 // 全局 Opcode 跳转表
 // ============================================================================
 OpcodeHandler g_opcode_table[OP_MAX] = {nullptr};
-static uint64_t g_vm_module_base = 0;
 
-void setVmModuleBase(uint64_t base) {
-    // 保存当前模块基址，供 OP_ADRP 计算绝对地址。
-    g_vm_module_base = base;
-}
+static void initUncheckedOpcodeTable();
 
 // 初始化全局 opcode 跳转表，建立 opcode 到处理函数的映射关系。
 void initOpcodeTable() {
     // 建立 opcode 到处理函数的静态分发表，避免运行时大量 switch 判断。
     // 初始化为未知处理函数
-    for (int i = 0; i < OP_MAX; i++) {
+    for (uint32_t i = 0; i < OP_MAX; i++) {
         g_opcode_table[i] = op_unknown;
     }
 
@@ -188,10 +186,15 @@ void initOpcodeTable() {
     g_opcode_table[OP_BL]             = op_bl;
     g_opcode_table[OP_ADRP]           = op_adrp;
     g_opcode_table[OP_BRANCH_REG]     = op_branch_reg;
-}
+    // 类型特化 opcode 族：按 VM_TYPED_OPCODE_LIST 自动注册。
+#define VM_REGISTER_TYPED_HANDLER(opcode, handler, kind, binOp, width, isSigned) \
+    g_opcode_table[opcode] = handler;
+    VM_TYPED_OPCODE_LIST(VM_REGISTER_TYPED_HANDLER)
+#undef VM_REGISTER_TYPED_HANDLER
 
-// subOp 高位标记：0x40 表示本条运算需要更新 VM 标志寄存器（对应 ARM64 SUBS/ADDS）。
-#define BIN_UPDATE_FLAGS  0x40u
+    // 同步填充免检变体表（实现位于文件末尾，需在处理函数模板定义之后实例化）。
+    initUncheckedOpcodeTable();
+}
 
 // ============================================================================
 // 辅助宏
@@ -217,7 +220,7 @@ static inline uint32_t vmGetInstChecked(VMContext* ctx, uint32_t offset) {
         // 运行已停止时读取指令统一返回 0。
         return 0;
     }
-    if (ctx->instructions == nullptr) {
+    if (ctx->instructions == nullptr && ctx->compact_instructions == nullptr) {
         LOGE("[VM_BOUNDS] instruction buffer is null, pc=%u", ctx->pc);
         ctx->running = false;
         ctx->pc = ctx->inst_count;
@@ -230,40 +233,138 @@ static inline uint32_t vmGetInstChecked(VMContext* ctx, uint32_t offset) {
         vmTrapBounds(ctx, "inst", static_cast<uint32_t>(instIndex), ctx->inst_count);
         return 0;
     }
+    // 紧凑执行时非模板辅助函数（如 op_unknown）也经此读取。
+    if (ctx->instructions == nullptr) {
+        return vmCompactWord(ctx->compact_instructions, ctx->compact_wide_pool, static_cast<uint32_t>(instIndex));
+    }
     return ctx->instructions[instIndex];
 }
 
-static inline VMRegSlot& vmGetRegChecked(VMContext* ctx, uint32_t idx) {
-    // 越界时返回静态无效槽，避免返回引用悬垂。
-    static VMRegSlot invalidSlot{};
+// 检查寄存器下标与目标数组（值数组或侧表）是否可访问；失败时停机并返回 false。
+static inline bool vmCheckReg(VMContext* ctx, uint32_t idx, const void* array) {
     if (ctx == nullptr || !ctx->running) {
-        return invalidSlot;
+        return false;
     }
-    if (ctx->registers == nullptr) {
+    if (array == nullptr) {
         LOGE("[VM_BOUNDS] register buffer is null, pc=%u", ctx->pc);
         ctx->running = false;
         ctx->pc = ctx->inst_count;
-        return invalidSlot;
+        return false;
     }
     if (idx >= ctx->register_count) {
         // 统一记录越界并停机。
         vmTrapBounds(ctx, "reg", idx, ctx->register_count);
-        return invalidSlot;
+        return false;
+    }
+    return true;
+}
+
+static inline uint64_t& vmGetRegChecked(VMContext* ctx, uint32_t idx) {
+    // 越界时返回静态无效值，避免返回引用悬垂。
+    static uint64_t invalidValue = 0;
+    if (!vmCheckReg(ctx, idx, ctx != nullptr ? ctx->registers : nullptr)) {
+        return invalidValue;
+    }
+    return ctx->registers[idx];
+}
+
+static inline uint8_t& vmGetRegOwnedChecked(VMContext* ctx, uint32_t idx) {
+    // 越界时返回静态无效标志。
+    static uint8_t invalidOwned = 0;
+    if (!vmCheckReg(ctx, idx, ctx != nullptr ? ctx->reg_owned : nullptr)) {
+        return invalidOwned;
+    }
+    return ctx->reg_owned[idx];
+}
+
+static inline uint64_t& vmGetRegFreeBaseChecked(VMContext* ctx, uint32_t idx) {
+    // 越界时返回静态无效基址。
+    static uint64_t invalidFreeBase = 0;
+    if (!vmCheckReg(ctx, idx, ctx != nullptr ? ctx->reg_free_base : nullptr)) {
+        return invalidFreeBase;
+    }
+    return ctx->reg_free_base[idx];
+}
+
+// 处理函数以 kVmChecked 模板参数区分两种变体：
+// - true：逐操作数检查（未校验函数、低层 execute 入口）；
+// - false：免检直接访问，仅供已通过 verifyFunction 的函数使用（见 zVmVerifier.h）。
+// kVmCompact 为 true 时操作数改从 16 位紧凑流读取（只与免检变体组合，见 zVmCompact.h）。
+// 非模板辅助函数沿用此默认值，始终走检查路径。
+static constexpr bool kVmChecked = true;
+static constexpr bool kVmCompact = false;
+
+template <bool kChecked, bool kCompact>
+static inline uint32_t vmGetInst(VMContext* ctx, uint32_t offset) {
+    static_assert(!(kChecked && kCompact), "compact handlers are only instantiated unchecked");
+    if (kChecked) {
+        return vmGetInstChecked(ctx, offset);
     }
+    // 校验器已证明 pc + offset 落在当前指令内。
+    if (kCompact) {
+        return vmCompactWord(ctx->compact_instructions, ctx->compact_wide_pool, ctx->pc + offset);
+    }
+    return ctx->instructions[ctx->pc + offset];
+}
+
+template <bool kChecked>
+static inline uint64_t& vmGetReg(VMContext* ctx, uint32_t idx) {
+    if (kChecked) {
+        return vmGetRegChecked(ctx, idx);
+    }
+    // 校验器已证明寄存器下标 < register_count。
     return ctx->registers[idx];
 }
 
-// 读取当前指令流中的参数槽位（带边界检查）。
-#define GET_INST(offset) vmGetInstChecked(ctx, static_cast<uint32_t>(offset))
-// 读取寄存器槽（带边界检查，越界时返回静态空槽）。
-#define GET_REG(idx) vmGetRegChecked(ctx, static_cast<uint32_t>(idx))
-// 读取类型表项（无边界时返回 nullptr）。
-#define GET_TYPE(idx) (((idx) < ctx->type_count && ctx->types != nullptr) ? ctx->types[(idx)] : nullptr)
+template <bool kChecked>
+static inline uint8_t& vmGetRegOwned(VMContext* ctx, uint32_t idx) {
+    if (kChecked) {
+        return vmGetRegOwnedChecked(ctx, idx);
+    }
+    return ctx->reg_owned[idx];
+}
+
+template <bool kChecked>
+static inline uint64_t& vmGetRegFreeBase(VMContext* ctx, uint32_t idx) {
+    if (kChecked) {
+        return vmGetRegFreeBaseChecked(ctx, idx);
+    }
+    return ctx->reg_free_base[idx];
+}
+
+template <bool kChecked>
+static inline const zType* vmGetType(VMContext* ctx, uint32_t idx) {
+    if (kChecked) {
+        return (idx < ctx->type_count && ctx->types != nullptr) ? ctx->types[idx] : nullptr;
+    }
+    // 校验器已证明类型下标 < type_count（类型表随之非空）。
+    return ctx->types[idx];
+}
+
+// 读取当前指令流中的参数槽位（kVmChecked 为 true 时带边界检查）。
+#define GET_INST(offset) vmGetInst<kVmChecked, kVmCompact>(ctx, static_cast<uint32_t>(offset))
+// 读写寄存器值（kVmChecked 为 true 时带边界检查，越界时返回静态空值）。
+#define GET_REG(idx) vmGetReg<kVmChecked>(ctx, static_cast<uint32_t>(idx))
+// 读写寄存器 ownership 侧表标志（1=需 VM free）。
+#define REG_OWNED(idx) vmGetRegOwned<kVmChecked>(ctx, static_cast<uint32_t>(idx))
+// 读写寄存器释放基址侧表（仅 ownership=1 时有效）。
+#define REG_FREE_BASE(idx) vmGetRegFreeBase<kVmChecked>(ctx, static_cast<uint32_t>(idx))
+// 读取类型表项（kVmChecked 为 true 时越界返回 nullptr）。
+#define GET_TYPE(idx) vmGetType<kVmChecked>(ctx, static_cast<uint32_t>(idx))
+
+// 登记 ownership=1 寄存器：帧栈托管的执行在回收时只遍历登记项；
+// 未挂帧栈的入口（低层 execute）仍由 freeRegManager 全量扫描。
+// 停机后访问器返回静态空值，此时不登记。
+static inline void vmTrackOwnedReg(VMContext* ctx, uint32_t idx) {
+    if (ctx->frame_arena != nullptr && ctx->running) {
+        ctx->frame_arena->trackOwned(idx);
+    }
+}
 
 // 调试辅助：读取 x0 的当前值，便于关键路径打点。
 static inline uint64_t log_x0_deref(VMContext* ctx) {
     if (!ctx || ctx->register_count == 0) return 0;
-    return GET_REG(0).value;
+    return GET_REG(0);
 }
 
 // 将 opcode 数值转换为可读字符串，便于日志和调试输出。
@@ -334,6 +435,10 @@ const char* getOpcodeName(uint32_t opcode) {
         case OP_BL: return "OP_BL";
         case OP_ADRP: return "OP_ADRP";
         case OP_BRANCH_REG: return "OP_BRANCH_REG";
+        // 类型特化 opcode 族。
+#define VM_TYPED_OPCODE_NAME(opcode, handler, kind, binOp, width, isSigned) case opcode: return #opcode;
+        VM_TYPED_OPCODE_LIST(VM_TYPED_OPCODE_NAME)
+#undef VM_TYPED_OPCODE_NAME
         // 未收录 opcode 返回占位符。
         default: return "OP_???";  // 未识别 opcode。
     }
@@ -344,7 +449,7 @@ const char* getOpcodeName(uint32_t opcode) {
 // ============================================================================
 
 // 执行二元运算：根据类型信息选择整数或浮点路径。
-uint64_t execBinaryOp(uint32_t op, uint64_t lhs, uint64_t rhs, zType* type) {
+uint64_t execBinaryOp(uint32_t op, uint64_t lhs, uint64_t rhs, const zType* type) {
     // 浮点类型走浮点计算分支，保持与类型系统一致。
     if (type && type->is_float) {
         double l, r, result;
@@ -426,6 +531,90 @@ uint64_t execBinaryOp(uint32_t op, uint64_t lhs, uint64_t rhs, zType* type) {
     }
 }
 
+// ============================================================================
+// 类型特化运算（VM_TYPED_OPCODE_LIST）
+// ============================================================================
+
+// 类型特化 opcode 静态描述表：下标为 opcode - kVmTypedOpcodeBegin。
+#define VM_TYPED_OPCODE_INFO(opcode, handler, kind, binOp, width, isSigned) \
+    { static_cast<uint32_t>(kind), static_cast<uint32_t>(binOp), width, isSigned },
+static constexpr VMTypedOpcodeInfo kTypedOpcodeInfo[] = { VM_TYPED_OPCODE_LIST(VM_TYPED_OPCODE_INFO) };
+#undef VM_TYPED_OPCODE_INFO
+static_assert(sizeof(kTypedOpcodeInfo) / sizeof(kTypedOpcodeInfo[0]) == OP_TYPED_END - kVmTypedOpcodeBegin,
+              "typed opcode info table out of sync with VM_TYPED_OPCODE_LIST");
+
+const VMTypedOpcodeInfo* getTypedOpcodeInfo(uint32_t opcode) {
+    if (opcode < kVmTypedOpcodeBegin || opcode >= OP_TYPED_END) {
+        return nullptr;
+    }
+    return &kTypedOpcodeInfo[opcode - kVmTypedOpcodeBegin];
+}
+
+// 按宽度选择运算容器：4 字节走 uint32_t（结果零扩展，对齐 W 寄存器语义），其余走 uint64_t。
+template <uint32_t kWidth>
+using VMTypedUnit = typename std::conditional<kWidth == 4, uint32_t, uint64_t>::type;
+
+// 定宽二元运算：移位量按位宽取模，除零结果为 0，有符号最小值 / -1 按 AArch64 返回被除数。
+template <uint32_t kOp, uint32_t kWidth, bool kSigned>
+static inline uint64_t execTypedBinary(uint64_t lhs, uint64_t rhs) {
+    typedef VMTypedUnit<kWidth> U;
+    typedef typename std::make_signed<U>::type S;
+    const U l = static_cast<U>(lhs);
+    const U r = static_cast<U>(rhs);
+    const U shiftMask = static_cast<U>(sizeof(U) * 8u - 1u);
+    switch (kOp) {
+        case BIN_ADD: return static_cast<U>(l + r);
+        case BIN_SUB: return static_cast<U>(l - r);
+        case BIN_MUL: return static_cast<U>(l * r);
+        case BIN_AND: return static_cast<U>(l & r);
+        case BIN_OR:  return static_cast<U>(l | r);
+        case BIN_XOR: return static_cast<U>(l ^ r);
+        case BIN_SHL: return static_cast<U>(l << (r & shiftMask));
+        case BIN_LSR: return static_cast<U>(l >> (r & shiftMask));
+        case BIN_ASR: return static_cast<U>(static_cast<S>(l) >> (r & shiftMask));
+        case BIN_IDIV:
+            if (r == 0) return 0;
+            if (kSigned) {
+                if (static_cast<S>(l) == std::numeric_limits<S>::min() && static_cast<S>(r) == -1) {
+                    return l;
+                }
+                return static_cast<U>(static_cast<S>(l) / static_cast<S>(r));
+            }
+            return static_cast<U>(l / r);
+        default:
+            return 0;
+    }
+}
+
+// 定宽读取：有符号形态符号扩展到 64 位，无符号形态零扩展。
+template <uint32_t kWidth, bool kSigned>
+static inline uint64_t typedLoad(uint64_t addr) {
+    switch (kWidth) {
+        case 1:
+            return kSigned ? static_cast<uint64_t>(static_cast<int64_t>(*reinterpret_cast<int8_t*>(addr)))
+                           : *reinterpret_cast<uint8_t*>(addr);
+        case 2:
+            return kSigned ? static_cast<uint64_t>(static_cast<int64_t>(*reinterpret_cast<int16_t*>(addr)))
+                           : *reinterpret_cast<uint16_t*>(addr);
+        case 4:
+            return kSigned ? static_cast<uint64_t>(static_cast<int64_t>(*reinterpret_cast<int32_t*>(addr)))
+                           : *reinterpret_cast<uint32_t*>(addr);
+        default:
+            return *reinterpret_cast<uint64_t*>(addr);
+    }
+}
+
+// 定宽写入：截断到 kWidth 字节。
+template <uint32_t kWidth>
+static inline void typedStore(uint64_t addr, uint64_t value) {
+    switch (kWidth) {
+        case 1: *reinterpret_cast<uint8_t*>(addr) = static_cast<uint8_t>(value); break;
+        case 2: *reinterpret_cast<uint16_t*>(addr) = static_cast<uint16_t>(value); break;
+        case 4: *reinterpret_cast<uint32_t*>(addr) = static_cast<uint32_t>(value); break;
+        default: *reinterpret_cast<uint64_t*>(addr) = value; break;
+    }
+}
+
 // 统计 32 位整数前导零个数（value=0 时返回 32）。
 static uint32_t countLeadingZeros32(uint32_t value) {
     if (value == 0u) {
@@ -457,7 +646,7 @@ static uint32_t countLeadingZeros64(uint64_t value) {
 }
 
 // 执行一元运算：支持整数位运算与浮点数学运算。
-uint64_t execUnaryOp(uint32_t op, uint64_t src, zType* type) {
+uint64_t execUnaryOp(uint32_t op, uint64_t src, const zType* type) {
     // 浮点一元操作。
     if (type && type->is_float) {
         // 先按类型宽度把 src 解码成 double 语义值。
@@ -509,7 +698,7 @@ uint64_t execUnaryOp(uint32_t op, uint64_t src, zType* type) {
 }
 
 // 执行比较运算并返回布尔结果（0/1）。
-uint64_t execCompareOp(uint32_t op, uint64_t lhs, uint64_t rhs, zType* type) {
+uint64_t execCompareOp(uint32_t op, uint64_t lhs, uint64_t rhs, const zType* type) {
     // 浮点比较分支。
     if (type && type->is_float) {
         double l, r;
@@ -561,7 +750,7 @@ uint64_t execCompareOp(uint32_t op, uint64_t lhs, uint64_t rhs, zType* type) {
 }
 
 // 执行类型转换：按转换操作码在整数/浮点语义间转换。
-uint64_t execTypeConvert(uint32_t op, uint64_t src, zType* srcType, zType* dstType) {
+uint64_t execTypeConvert(uint32_t op, uint64_t src, const zType* srcType, const zType* dstType) {
     // op 是转换子码；src/srcType/dstType 决定转换路径。
     switch (op) {
         // COPY 系列：直接透传位模式。
@@ -681,11 +870,11 @@ uint64_t execTypeConvert(uint32_t op, uint64_t src, zType* srcType, zType* dstTy
     }
 }
 
-// 复制寄存器槽值；ARRAY_ELEM 走内存块拷贝，其它类型按宽度截断/复制。
-void copyValue(VMRegSlot* src, zType* type, VMRegSlot* dst) {
+// 复制寄存器值；ARRAY_ELEM 走内存块拷贝，其它类型按宽度截断/复制。
+void copyValue(const uint64_t* src, const zType* type, uint64_t* dst) {
     // 无类型时按 64 位槽直接复制。
     if (!type) {
-        dst->value = src->value;
+        *dst = *src;
         return;
     }
     
@@ -693,9 +882,9 @@ void copyValue(VMRegSlot* src, zType* type, VMRegSlot* dst) {
     
     // 特殊处理：type_kind == 14 (ARRAY_ELEM) 使用 memcpy
     if (typeKind == TYPE_KIND_ARRAY_ELEM) {
-        // ARRAY_ELEM 的 value 存的是地址：按类型大小做内存块复制。
-        void* srcPtr = reinterpret_cast<void*>(src->value);
-        void* dstPtr = reinterpret_cast<void*>(dst->value);
+        // ARRAY_ELEM 的寄存器值存的是地址：按类型大小做内存块复制。
+        void* srcPtr = reinterpret_cast<void*>(*src);
+        void* dstPtr = reinterpret_cast<void*>(*dst);
         if (srcPtr && dstPtr) {
             uint32_t size = type->getSize();
             memcpy(dstPtr, srcPtr, size);
@@ -707,27 +896,27 @@ void copyValue(VMRegSlot* src, zType* type, VMRegSlot* dst) {
     uint32_t size = type->getSize();
     // 普通标量按目标宽度截断后写入。
     switch (size) {
-        case 1: dst->value = static_cast<uint8_t>(src->value); break;
-        case 2: dst->value = static_cast<uint16_t>(src->value); break;
-        case 4: dst->value = static_cast<uint32_t>(src->value); break;
+        case 1: *dst = static_cast<uint8_t>(*src); break;
+        case 2: *dst = static_cast<uint16_t>(*src); break;
+        case 4: *dst = static_cast<uint32_t>(*src); break;
         case 8:
         default: 
-            dst->value = src->value; 
+            *dst = *src; 
             break;
     }
 }
 
-// 按类型宽度从地址读取值并写入目标槽位；ARRAY_ELEM 返回地址本身。
-void readValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* dst) {
-    // addrSlot.value 保存目标内存地址。
-    void* addr = reinterpret_cast<void*>(addrSlot->value);
+// 按类型宽度从地址读取值并写入目标寄存器；ARRAY_ELEM 返回地址本身（并清除 dstOwned）。
+void readValue(const uint64_t* addrValue, const zType* type, uint64_t* dst, uint8_t* dstOwned) {
+    // *addrValue 保存目标内存地址。
+    void* addr = reinterpret_cast<void*>(*addrValue);
     if (!addr) {
-        dst->value = 0;
+        *dst = 0;
         return;
     }
     if (!type) {
         // 无类型默认按 64 位读取。
-        dst->value = *static_cast<uint64_t*>(addr);
+        *dst = *static_cast<uint64_t*>(addr);
         return;
     }
     
@@ -737,8 +926,10 @@ void readValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* dst) {
     // 存储指针本身，不解引用
     if (typeKind == TYPE_KIND_ARRAY_ELEM) {
         // ARRAY_ELEM 语义下返回“地址本身”，由上层决定是否解引用。
-        dst->value = reinterpret_cast<uint64_t>(addr);
-        dst->ownership = 0;
+        *dst = reinterpret_cast<uint64_t>(addr);
+        if (dstOwned != nullptr) {
+            *dstOwned = 0;
+        }
         return;
     }
     
@@ -747,40 +938,40 @@ void readValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* dst) {
     switch (size) {
         case 1: 
             // 有符号扩展
-            dst->value = static_cast<uint64_t>(static_cast<int8_t>(*static_cast<uint8_t*>(addr))); 
+            *dst = static_cast<uint64_t>(static_cast<int8_t>(*static_cast<uint8_t*>(addr))); 
             break;
         case 2: 
             // 有符号扩展
-            dst->value = static_cast<uint64_t>(static_cast<int16_t>(*static_cast<uint16_t*>(addr))); 
+            *dst = static_cast<uint64_t>(static_cast<int16_t>(*static_cast<uint16_t*>(addr))); 
             break;
         case 4:
             if (type->is_float) {
                 // 4 字节浮点保持 bit pattern，不做数值 reinterpret_cast 到整数。
                 float f = *static_cast<float*>(addr);
-                dst->value = 0;
-                memcpy(&dst->value, &f, 4);
+                *dst = 0;
+                memcpy(dst, &f, 4);
             } else {
                 // 有符号扩展
-                dst->value = static_cast<uint64_t>(static_cast<int32_t>(*static_cast<uint32_t*>(addr)));
+                *dst = static_cast<uint64_t>(static_cast<int32_t>(*static_cast<uint32_t*>(addr)));
             }
             break;
         case 8:
         default:
-            dst->value = *static_cast<uint64_t*>(addr);
+            *dst = *static_cast<uint64_t*>(addr);
             break;
     }
 }
 
-// 按类型宽度将槽位值写入目标地址；ARRAY_ELEM 走内存块写入。
-void writeValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* valueSlot) {
-    // addrSlot.value 为写入地址。
-    void* addr = reinterpret_cast<void*>(addrSlot->value);
+// 按类型宽度将寄存器值写入目标地址；ARRAY_ELEM 走内存块写入。
+void writeValue(const uint64_t* addrValue, const zType* type, const uint64_t* valuePtr) {
+    // *addrValue 为写入地址。
+    void* addr = reinterpret_cast<void*>(*addrValue);
     // 地址为空直接返回，避免空指针写入。
     if (!addr) return;
 
     if (!type) {
         // 无类型默认按 64 位写回。
-        *static_cast<uint64_t*>(addr) = valueSlot->value;
+        *static_cast<uint64_t*>(addr) = *valuePtr;
         return;
     }
     
@@ -789,8 +980,8 @@ void writeValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* valueSlot) {
     
     // 特殊处理：type_kind == 14 (ARRAY_ELEM) 使用 memcpy
     if (typeKind == TYPE_KIND_ARRAY_ELEM) {
-        // ARRAY_ELEM：valueSlot.value 为源地址，按字节块拷贝。
-        void* srcPtr = reinterpret_cast<void*>(valueSlot->value);
+        // ARRAY_ELEM：*valuePtr 为源地址，按字节块拷贝。
+        void* srcPtr = reinterpret_cast<void*>(*valuePtr);
         if (srcPtr) {
             uint32_t size = type->getSize();
             memcpy(addr, srcPtr, size);
@@ -799,7 +990,7 @@ void writeValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* valueSlot) {
     }
     
     // 普通标量路径：按 size 执行窄写入。
-    uint64_t value = valueSlot->value;
+    uint64_t value = *valuePtr;
     uint32_t size = type->getSize();
     switch (size) {
         case 1: *static_cast<uint8_t*>(addr) = static_cast<uint8_t>(value); break;
@@ -815,21 +1006,23 @@ void writeValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* valueSlot) {
 // ============================================================================
 // NZCV 标志更新与条件判断（与 ARM64 一致）
 // ============================================================================
-// 根据减法结果更新 VM 的 NZCV 标志位。
-static void setFlagsFromSub(VMContext* ctx, uint64_t lhs, uint64_t rhs, uint64_t result, bool is64) {
+// 置标志指令只记录“最近一次运算”（类别、操作数、结果、位宽），
+// 由条件分支等消费方按需物化 NZCV；连续置标志时前一次的计算被直接丢弃。
+
+// 根据减法结果计算 NZCV。
+static inline uint8_t computeSubFlags(uint64_t lhs, uint64_t rhs, uint64_t result, bool is64) {
+    uint8_t nzcv = 0;
     if (is64) {
         // 64 位路径：直接按 int64/uint64 规则计算 NZCV。
         int64_t sl = static_cast<int64_t>(lhs);
         int64_t sr = static_cast<int64_t>(rhs);
         int64_t res = static_cast<int64_t>(result);
-        // 每次重算时先清空旧标志。
-        ctx->nzcv = 0;
         // N: 结果为负。
-        if (res < 0) ctx->nzcv |= VM_FLAG_N;
+        if (res < 0) nzcv |= VM_FLAG_N;
         // Z: 结果为零。
-        if (result == 0) ctx->nzcv |= VM_FLAG_Z;
-        if (lhs >= rhs) ctx->nzcv |= VM_FLAG_C;  // 无符号无借位
-        if (((sl ^ sr) & (sl ^ res)) < 0) ctx->nzcv |= VM_FLAG_V;  // 有符号溢出
+        if (result == 0) nzcv |= VM_FLAG_Z;
+        if (lhs >= rhs) nzcv |= VM_FLAG_C;  // 无符号无借位
+        if (((sl ^ sr) & (sl ^ res)) < 0) nzcv |= VM_FLAG_V;  // 有符号溢出
     } else {
         // 32 位路径：先截断到 32 位再计算标志。
         uint32_t l = static_cast<uint32_t>(lhs);
@@ -838,66 +1031,106 @@ static void setFlagsFromSub(VMContext* ctx, uint64_t lhs, uint64_t rhs, uint64_t
         int32_t sl = static_cast<int32_t>(l);
         int32_t sr = static_cast<int32_t>(r);
         int32_t sres = static_cast<int32_t>(res);
-        // 32 位路径同样先清空旧标志。
-        ctx->nzcv = 0;
-        if (sres < 0) ctx->nzcv |= VM_FLAG_N;
-        if (res == 0) ctx->nzcv |= VM_FLAG_Z;
-        if (l >= r) ctx->nzcv |= VM_FLAG_C;
-        if (((sl ^ sr) & (sl ^ sres)) < 0) ctx->nzcv |= VM_FLAG_V;
+        if (sres < 0) nzcv |= VM_FLAG_N;
+        if (res == 0) nzcv |= VM_FLAG_Z;
+        if (l >= r) nzcv |= VM_FLAG_C;
+        if (((sl ^ sr) & (sl ^ sres)) < 0) nzcv |= VM_FLAG_V;
     }
+    return nzcv;
 }
 
-// 根据加法结果更新 VM 的 NZCV 标志位。
-static void setFlagsFromAdd(VMContext* ctx, uint64_t lhs, uint64_t rhs, uint64_t result, bool is64) {
+// 根据加法结果计算 NZCV。
+static inline uint8_t computeAddFlags(uint64_t lhs, uint64_t rhs, uint64_t result, bool is64) {
+    uint8_t nzcv = 0;
     if (is64) {
-        // 64 位加法标志位更新。
+        // 64 位加法标志位。
         int64_t sl = static_cast<int64_t>(lhs);
         int64_t sr = static_cast<int64_t>(rhs);
         int64_t res = static_cast<int64_t>(result);
-        // 每次重算时先清空旧标志。
-        ctx->nzcv = 0;
-        if (res < 0) ctx->nzcv |= VM_FLAG_N;
-        if (result == 0) ctx->nzcv |= VM_FLAG_Z;
-        if (result < lhs) ctx->nzcv |= VM_FLAG_C;  // 无符号进位
-        if (((sl ^ res) & (sr ^ res)) < 0) ctx->nzcv |= VM_FLAG_V;  // 有符号溢出
+        if (res < 0) nzcv |= VM_FLAG_N;
+        if (result == 0) nzcv |= VM_FLAG_Z;
+        if (result < lhs) nzcv |= VM_FLAG_C;  // 无符号进位
+        if (((sl ^ res) & (sr ^ res)) < 0) nzcv |= VM_FLAG_V;  // 有符号溢出
     } else {
-        // 32 位加法标志位更新。
+        // 32 位加法标志位。
         uint32_t l = static_cast<uint32_t>(lhs);
         uint32_t r = static_cast<uint32_t>(rhs);
         uint32_t res = static_cast<uint32_t>(result);
         int32_t sl = static_cast<int32_t>(l);
         int32_t sr = static_cast<int32_t>(r);
         int32_t sres = static_cast<int32_t>(res);
-        // 32 位路径同样先清空旧标志。
-        ctx->nzcv = 0;
-        if (sres < 0) ctx->nzcv |= VM_FLAG_N;
-        if (res == 0) ctx->nzcv |= VM_FLAG_Z;
-        if (res < l) ctx->nzcv |= VM_FLAG_C;
-        if (((sl ^ sres) & (sr ^ sres)) < 0) ctx->nzcv |= VM_FLAG_V;
+        if (sres < 0) nzcv |= VM_FLAG_N;
+        if (res == 0) nzcv |= VM_FLAG_Z;
+        if (res < l) nzcv |= VM_FLAG_C;
+        if (((sl ^ sres) & (sr ^ sres)) < 0) nzcv |= VM_FLAG_V;
     }
+    return nzcv;
 }
 
-// 仅根据结果值更新 N/Z 标志位（不改动 C/V）。
-static void setFlagsFromResultNZ(VMContext* ctx, uint64_t result, zType* type) {
-    uint32_t size = type && type->size ? type->size : 8;
-    ctx->nzcv = 0;
-    if (size == 4) {
+// 仅根据结果值计算 N/Z（C/V 清零，与逻辑运算置标志一致）。
+static inline uint8_t computeResultNZFlags(uint64_t result, bool is64) {
+    uint8_t nzcv = 0;
+    if (!is64) {
         int32_t s = static_cast<int32_t>(static_cast<uint32_t>(result));
-        if (s < 0) ctx->nzcv |= VM_FLAG_N;
+        if (s < 0) nzcv |= VM_FLAG_N;
     } else {
-        if (static_cast<int64_t>(result) < 0) ctx->nzcv |= VM_FLAG_N;
+        if (static_cast<int64_t>(result) < 0) nzcv |= VM_FLAG_N;
+    }
+    if (result == 0) nzcv |= VM_FLAG_Z;
+    return nzcv;
+}
+
+// 记录一次置标志运算，延迟到消费时再计算 NZCV。
+static inline void recordFlags(VMContext* ctx, uint8_t kind, uint64_t lhs, uint64_t rhs, uint64_t result, bool is64) {
+    ctx->flags_kind = kind;
+    ctx->flags_is64 = is64;
+    ctx->flags_lhs = lhs;
+    ctx->flags_rhs = rhs;
+    ctx->flags_result = result;
+}
+
+// 记录减法置标志（SUBS/CMP）。
+static inline void setFlagsFromSub(VMContext* ctx, uint64_t lhs, uint64_t rhs, uint64_t result, bool is64) {
+    recordFlags(ctx, VM_FLAGS_SUB, lhs, rhs, result, is64);
+}
+
+// 记录加法置标志（ADDS/CMN）。
+static inline void setFlagsFromAdd(VMContext* ctx, uint64_t lhs, uint64_t rhs, uint64_t result, bool is64) {
+    recordFlags(ctx, VM_FLAGS_ADD, lhs, rhs, result, is64);
+}
+
+// 记录仅 N/Z 的置标志（ANDS/TST 等）；无类型时按 64 位处理。
+static inline void setFlagsFromResultNZ(VMContext* ctx, uint64_t result, const zType* type) {
+    uint32_t size = type && type->size ? type->size : 8;
+    recordFlags(ctx, VM_FLAGS_LOGIC, 0, 0, result, size != 4);
+}
+
+// 按记录计算 NZCV（不回写，供日志等只读场景使用）。
+static inline uint8_t peekFlags(const VMContext* ctx) {
+    switch (ctx->flags_kind) {
+        case VM_FLAGS_SUB: return computeSubFlags(ctx->flags_lhs, ctx->flags_rhs, ctx->flags_result, ctx->flags_is64);
+        case VM_FLAGS_ADD: return computeAddFlags(ctx->flags_lhs, ctx->flags_rhs, ctx->flags_result, ctx->flags_is64);
+        case VM_FLAGS_LOGIC: return computeResultNZFlags(ctx->flags_result, ctx->flags_is64);
+        default: return ctx->nzcv;
     }
-    if (result == 0) ctx->nzcv |= VM_FLAG_Z;
 }
 
-// 根据当前 nzcv 与条件码 cc（AArch64 编码 0..15）判断条件是否成立
-// 按 AArch64 条件码语义，用 nzcv 判定条件是否成立。
-static bool evaluateCondition(uint8_t nzcv, uint32_t cc) {
+// 物化 NZCV 并缓存：同一组标志被多次消费时只计算一次。
+static inline uint8_t materializeFlags(VMContext* ctx) {
+    if (ctx->flags_kind != VM_FLAGS_MATERIALIZED) {
+        ctx->nzcv = peekFlags(ctx);
+        ctx->flags_kind = VM_FLAGS_MATERIALIZED;
+    }
+    return ctx->nzcv;
+}
+
+// 按 AArch64 条件码语义，用 nzcv 判定条件是否成立（仅用于构建查找表）。
+static constexpr bool conditionHolds(uint32_t nzcv, uint32_t cc) {
     // 从 NZCV 字段拆出四个布尔标志位。
-    bool N = (nzcv & VM_FLAG_N) != 0;
-    bool Z = (nzcv & VM_FLAG_Z) != 0;
-    bool C = (nzcv & VM_FLAG_C) != 0;
-    bool V = (nzcv & VM_FLAG_V) != 0;
+    const bool N = (nzcv & VM_FLAG_N) != 0;
+    const bool Z = (nzcv & VM_FLAG_Z) != 0;
+    const bool C = (nzcv & VM_FLAG_C) != 0;
+    const bool V = (nzcv & VM_FLAG_V) != 0;
     // cc 编码遵循 AArch64 条件码定义。
     switch (cc) {
         case 0x0: return Z;                    // EQ: 相等
@@ -915,10 +1148,52 @@ static bool evaluateCondition(uint8_t nzcv, uint32_t cc) {
         case 0xc: return !Z && (N == V);       // GT
         case 0xd: return Z || (N != V);        // LE
         case 0xe: return true;                 // AL: 总是成立
-        case 0xf: return false;                 // NV
-        // 非法条件码按 false 处理，避免误跳转。
-        default: return false;
+        default: return false;                 // NV
+    }
+}
+
+// 条件码 cc 的真值掩码：bit[nzcv] = cc 在该 nzcv 下是否成立。
+static constexpr uint16_t conditionMask(uint32_t cc) {
+    uint16_t mask = 0;
+    for (uint32_t nzcv = 0; nzcv < 16; ++nzcv) {
+        if (conditionHolds(nzcv, cc)) {
+            mask = static_cast<uint16_t>(mask | (1u << nzcv));
+        }
+    }
+    return mask;
+}
+
+// cc x nzcv 查找表：条件判定退化为一次取表 + 移位。
+static constexpr uint16_t kConditionTable[16] = {
+        conditionMask(0x0), conditionMask(0x1), conditionMask(0x2), conditionMask(0x3),
+        conditionMask(0x4), conditionMask(0x5), conditionMask(0x6), conditionMask(0x7),
+        conditionMask(0x8), conditionMask(0x9), conditionMask(0xa), conditionMask(0xb),
+        conditionMask(0xc), conditionMask(0xd), conditionMask(0xe), conditionMask(0xf),
+};
+
+// 判定条件码 cc（AArch64 编码 0..15）是否成立；非法条件码按 false 处理，避免误跳转。
+// 最近一次置标志为减法（CMP/SUBS）时，EQ/NE/HS/LO 直接由操作数得出，无需物化 NZCV。
+static inline bool evaluateCondition(VMContext* ctx, uint32_t cc) {
+    if (cc >= 16) {
+        return false;
+    }
+    if (ctx->flags_kind == VM_FLAGS_SUB) {
+        const uint64_t result = ctx->flags_is64 ? ctx->flags_result : static_cast<uint32_t>(ctx->flags_result);
+        const uint64_t lhs = ctx->flags_is64 ? ctx->flags_lhs : static_cast<uint32_t>(ctx->flags_lhs);
+        const uint64_t rhs = ctx->flags_is64 ? ctx->flags_rhs : static_cast<uint32_t>(ctx->flags_rhs);
+        switch (cc) {
+            case 0x0: return result == 0;      // EQ
+            case 0x1: return result != 0;      // NE
+            case 0x2: return lhs >= rhs;       // HS
+            case 0x3: return lhs < rhs;        // LO
+            default: break;
+        }
     }
+    return ((kConditionTable[cc] >> materializeFlags(ctx)) & 1u) != 0;
+}
+
+bool evaluateConditionCode(VMContext* ctx, uint32_t cc) {
+    return evaluateCondition(ctx, cc);
 }
 
 // ============================================================================
@@ -926,11 +1201,13 @@ static bool evaluateCondition(uint8_t nzcv, uint32_t cc) {
 // ============================================================================
 
 // OP_END：停止解释循环。
+template <bool kVmChecked, bool kVmCompact>
 void op_end(VMContext* ctx) {
     ctx->running = false;
 }
 
 // OP_BINARY：执行寄存器-寄存器二元运算，可选更新 NZCV。
+template <bool kVmChecked, bool kVmCompact>
 void op_binary(VMContext* ctx) {
     // 布局: [0]=opcode, [1]=subOp, [2]=typeIdx, [3]=lhsReg, [4]=rhsReg, [5]=dstReg；语义 dstReg = type.op(lhsReg, rhsReg)
     // subOp 同时承载“具体算子编码 + 是否更新 NZCV 标志”。
@@ -943,13 +1220,13 @@ void op_binary(VMContext* ctx) {
     uint32_t dstReg = GET_INST(5);
 
     // 获取类型与参与运算的两个操作数。
-    zType* type = GET_TYPE(typeIdx);
+    const zType* type = GET_TYPE(typeIdx);
     uint32_t actualOp = subOp & 0x3Fu;
-    uint64_t lhs = GET_REG(lhsReg).value;
-    uint64_t rhs = GET_REG(rhsReg).value;
+    uint64_t lhs = GET_REG(lhsReg);
+    uint64_t rhs = GET_REG(rhsReg);
     // 执行运算并写回目标寄存器。
     uint64_t result = execBinaryOp(actualOp, lhs, rhs, type);
-    GET_REG(dstReg).value = result;
+    GET_REG(dstReg) = result;
 
     if (subOp & BIN_UPDATE_FLAGS) {
         // 标志位更新策略：
@@ -967,6 +1244,7 @@ void op_binary(VMContext* ctx) {
 }
 
 // OP_BINARY_IMM：执行寄存器与立即数二元运算，可选更新 NZCV。
+template <bool kVmChecked, bool kVmCompact>
 void op_binary_imm(VMContext* ctx) {
     // 布局: [0]=opcode(52), [1]=subOp, [2]=typeIdx, [3]=lhsReg, [4]=imm, [5]=dstReg；subOp 的 0x40 标记表示更新 NZCV
     // 该指令把第二操作数从寄存器改为立即数槽位。
@@ -977,13 +1255,13 @@ void op_binary_imm(VMContext* ctx) {
     uint32_t dstReg = GET_INST(5);
 
     // 立即数 rhs 统一扩展到 64 位槽语义。
-    zType* type = GET_TYPE(typeIdx);
+    const zType* type = GET_TYPE(typeIdx);
     uint32_t actualOp = subOp & 0x3Fu;
-    uint64_t lhs = GET_REG(lhsReg).value;
+    uint64_t lhs = GET_REG(lhsReg);
     uint64_t rhs = static_cast<uint64_t>(imm);
     // 复用统一算子执行函数，保证与 OP_BINARY 语义一致。
     uint64_t result = execBinaryOp(actualOp, lhs, rhs, type);
-    GET_REG(dstReg).value = result;
+    GET_REG(dstReg) = result;
 
     if (subOp & BIN_UPDATE_FLAGS) {
         // 与 op_binary 相同的标志位更新策略。
@@ -997,7 +1275,7 @@ void op_binary_imm(VMContext* ctx) {
         VM_TRACE_LOGD("[OP_BINARY_IMM] updateFlags subOp=0x%x result=%" PRIu64 " -> nzcv=0x%x *x0=%" PRIu64,
                       (unsigned)subOp,
                       (unsigned long long)result,
-                      (unsigned)ctx->nzcv,
+                      (unsigned)peekFlags(ctx),
                       (unsigned long long)log_x0_deref(ctx));
     }
     // 指令宽度固定 6 words。
@@ -1005,6 +1283,7 @@ void op_binary_imm(VMContext* ctx) {
 }
 
 // OP_TYPE_CONVERT：按 src/dst 类型执行转换并写入目标寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_type_convert(VMContext* ctx) {
     // 参数槽位：[pc+1]=sub_op, [pc+2]=dst_type, [pc+3]=src_type, [pc+4]=src_reg, [pc+5]=dst_reg
     // sub_op 决定转换方向（如 S2F/U2F/TRUNC/SEXT 等）。
@@ -1014,37 +1293,39 @@ void op_type_convert(VMContext* ctx) {
     uint32_t srcReg = GET_INST(4);
     uint32_t dstReg = GET_INST(5);
 
-    zType* srcType = GET_TYPE(srcTypeIdx);
-    zType* dstType = GET_TYPE(dstTypeIdx);
-    uint64_t src = GET_REG(srcReg).value;
+    const zType* srcType = GET_TYPE(srcTypeIdx);
+    const zType* dstType = GET_TYPE(dstTypeIdx);
+    uint64_t src = GET_REG(srcReg);
     uint64_t result = execTypeConvert(subOp, src, srcType, dstType);
-    GET_REG(dstReg).value = result;
+    GET_REG(dstReg) = result;
     // 转换结果是值语义，不接管外部内存所有权。
-    GET_REG(dstReg).ownership = 0;
+    REG_OWNED(dstReg) = 0;
 
     // 指令宽度固定 6 words。
     ctx->pc += 6;
 }
 
 // OP_LOAD_CONST：加载 32 位立即数到寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_load_const(VMContext* ctx) {
     // 参数槽位：[pc+1]=dst_reg, [pc+2]=value
     uint32_t dstReg = GET_INST(1);
     uint32_t value = GET_INST(2);
     // 直接按 32 位常量写入槽位。
-    GET_REG(dstReg).value = value;
+    GET_REG(dstReg) = value;
     ctx->pc += 3;
 }
 
 // OP_STORE_CONST：将立即数按类型写入目标地址。
+template <bool kVmChecked, bool kVmCompact>
 void op_store_const(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=addr_reg, [pc+3]=value
     uint32_t typeIdx = GET_INST(1);
     uint32_t addrReg = GET_INST(2);
     uint32_t value = GET_INST(3);
 
-    zType* type = GET_TYPE(typeIdx);
-    void* addr = reinterpret_cast<void*>(GET_REG(addrReg).value);
+    const zType* type = GET_TYPE(typeIdx);
+    void* addr = reinterpret_cast<void*>(GET_REG(addrReg));
     if (addr && type) {
         // 按目标类型宽度选择写回粒度。
         switch (type->size) {
@@ -1059,6 +1340,7 @@ void op_store_const(VMContext* ctx) {
 }
 
 // OP_GET_ELEMENT：按索引与元素大小计算元素地址/访问位置。
+template <bool kVmChecked, bool kVmCompact>
 void op_get_element(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=base_reg, [pc+3]=index_reg, [pc+4]=dst_reg
     uint32_t typeIdx = GET_INST(1);
@@ -1066,18 +1348,19 @@ void op_get_element(VMContext* ctx) {
     uint32_t indexReg = GET_INST(3);
     uint32_t dstReg = GET_INST(4);
 
-    zType* type = GET_TYPE(typeIdx);
-    uint64_t base = GET_REG(baseReg).value;
-    uint64_t index = GET_REG(indexReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    uint64_t base = GET_REG(baseReg);
+    uint64_t index = GET_REG(indexReg);
     // 类型缺失时退回 8 字节元素宽度。
     uint32_t elemSize = type ? type->size : 8;
 
     // 仅计算地址，不执行读取。
-    GET_REG(dstReg).value = base + index * elemSize;
+    GET_REG(dstReg) = base + index * elemSize;
     ctx->pc += 5;
 }
 
 // OP_ALLOC_RETURN：初始化返回缓冲相关寄存器语义。
+template <bool kVmChecked, bool kVmCompact>
 void op_alloc_return(VMContext* ctx) {
     // 布局: [opcode][result_type][size_type][size_reg][dst_reg]
     // 当前实现仅使用 dst_reg 槽位用于调试输出，其余字段保留协议兼容。
@@ -1094,14 +1377,20 @@ void op_alloc_return(VMContext* ctx) {
 }
 
 // OP_ALLOC_VSP：为虚拟栈分配空间并更新 SP/VSP 相关寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_alloc_vsp(VMContext* ctx) {
-    // 布局: [opcode][result_type][size_type][size_reg][fp_reg][sp_reg]
-    // 申请一块固定大小虚拟栈，把“栈顶地址”写入 fp/sp；仅 fp 槽携带 base 指针 ownership 负责释放。
+    // 布局: [opcode][result_type][size_type][stack_size][fp_reg][sp_reg]
+    // 申请一块虚拟栈，把“栈顶地址”写入 fp/sp：
+    // - stack_size 由翻译器按函数栈帧估算（字节）；0 表示旧格式，回退固定 1024；
+    // - 挂帧栈的执行从线程本地虚拟栈池切出，随帧 LIFO 归还；
+    // - 否则 malloc，并由 fp 寄存器的释放基址侧表携带 base 指针负责释放。
+    uint32_t stackSize = GET_INST(3);
     uint32_t fpReg = GET_INST(4);
     uint32_t spReg = GET_INST(5);
-    size_t kVspSize = 1024;
+    size_t kVspSize = stackSize != 0 ? ((static_cast<size_t>(stackSize) + 15u) & ~static_cast<size_t>(15u)) : 1024;
 
-    void* block = malloc(kVspSize);
+    const bool pooled = ctx->frame_arena != nullptr;
+    void* block = pooled ? ctx->frame_arena->allocStack(kVspSize) : malloc(kVspSize);
     if (!block) {
         // 申请失败时只推进 pc，避免解释器死循环。
         ctx->pc += 6;
@@ -1110,18 +1399,16 @@ void op_alloc_vsp(VMContext* ctx) {
     const uint64_t blockBase = reinterpret_cast<uint64_t>(block);
     const uint64_t vspValue = blockBase + kVspSize;
 
-    VMRegSlot& fpSlot = GET_REG(fpReg);
-    // fp 槽保存“当前栈顶值 + 底层基址 + ownership”。
-    fpSlot.value = vspValue;
-    fpSlot.reserved = blockBase;
-    fpSlot.ownership = 1;
+    // fp 保存“当前栈顶值”，侧表记录底层基址 + ownership；池化栈由帧回收，不持有释放责任。
+    GET_REG(fpReg) = vspValue;
+    REG_FREE_BASE(fpReg) = pooled ? 0 : blockBase;
+    REG_OWNED(fpReg) = pooled ? 0 : 1;
 
     if (spReg != fpReg) {
-        VMRegSlot& spSlot = GET_REG(spReg);
-        // sp 槽仅保存值，不持有释放责任。
-        spSlot.value = vspValue;
-        spSlot.reserved = 0;
-        spSlot.ownership = 0;
+        // sp 仅保存值，不持有释放责任。
+        GET_REG(spReg) = vspValue;
+        REG_FREE_BASE(spReg) = 0;
+        REG_OWNED(spReg) = 0;
     }
 
     VM_TRACE_LOGD("[OP_ALLOC_VSP] fpReg=%u spReg=%u vsp=0x%llx base=0x%llx *x0=0x%llx",
@@ -1134,47 +1421,52 @@ void op_alloc_vsp(VMContext* ctx) {
 }
 
 // OP_STORE：把源寄存器值写入目标地址。
+template <bool kVmChecked, bool kVmCompact>
 void op_store(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=addr_reg, [pc+3]=value_reg
     uint32_t typeIdx = GET_INST(1);
     uint32_t addrReg = GET_INST(2);
     uint32_t valueReg = GET_INST(3);
 
-    zType* type = GET_TYPE(typeIdx);
+    const zType* type = GET_TYPE(typeIdx);
     writeValue(&GET_REG(addrReg), type, &GET_REG(valueReg));
 
     ctx->pc += 4;
 }
 
 // OP_LOAD_CONST64：加载 64 位立即数到寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_load_const64(VMContext* ctx) {
     // 参数槽位：[pc+1]=dst_reg, [pc+2]=low32, [pc+3]=high32
     uint32_t dstReg = GET_INST(1);
     uint64_t low = GET_INST(2);
     uint64_t high = GET_INST(3);
-    GET_REG(dstReg).value = low | (high << 32);
+    GET_REG(dstReg) = low | (high << 32);
     ctx->pc += 4;
 }
 
 // OP_NOP：不做任何计算，仅推进程序计数器。
+template <bool kVmChecked, bool kVmCompact>
 void op_nop(VMContext* ctx) {
     ctx->pc += 1;
 }
 
 // OP_COPY：根据类型语义复制源寄存器到目标寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_copy(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=src_reg, [pc+3]=dst_reg
     uint32_t typeIdx = GET_INST(1);
     uint32_t srcReg = GET_INST(2);
     uint32_t dstReg = GET_INST(3);
 
-    zType* type = GET_TYPE(typeIdx);
+    const zType* type = GET_TYPE(typeIdx);
     copyValue(&GET_REG(srcReg), type, &GET_REG(dstReg));
 
     ctx->pc += 4;
 }
 
 // OP_GET_FIELD：按偏移从基址读取字段值。
+template <bool kVmChecked, bool kVmCompact>
 void op_get_field(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=base_reg, [pc+3]=offset, [pc+4]=dst_reg
     // typeIdx 指定字段读取宽度。
@@ -1186,12 +1478,12 @@ void op_get_field(VMContext* ctx) {
     // dstReg 为读取结果寄存器。
     uint32_t dstReg = GET_INST(4);
 
-    zType* type = GET_TYPE(typeIdx);
-    uint64_t base = GET_REG(baseReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    uint64_t base = GET_REG(baseReg);
     if (base == 0) {
         // 空基址读取结果按 0 处理。
-        GET_REG(dstReg).value = 0;
-        GET_REG(dstReg).ownership = 0;
+        GET_REG(dstReg) = 0;
+        REG_OWNED(dstReg) = 0;
         ctx->pc += 5;
         return;
     }
@@ -1201,10 +1493,10 @@ void op_get_field(VMContext* ctx) {
     if (fieldAddr && type) {
         // 按类型宽度读取字段值。
         switch (type->size) {
-            case 1: GET_REG(dstReg).value = *static_cast<uint8_t*>(fieldAddr); break;
-            case 2: GET_REG(dstReg).value = *static_cast<uint16_t*>(fieldAddr); break;
-            case 4: GET_REG(dstReg).value = *static_cast<uint32_t*>(fieldAddr); break;
-            default: GET_REG(dstReg).value = *static_cast<uint64_t*>(fieldAddr); break;
+            case 1: GET_REG(dstReg) = *static_cast<uint8_t*>(fieldAddr); break;
+            case 2: GET_REG(dstReg) = *static_cast<uint16_t*>(fieldAddr); break;
+            case 4: GET_REG(dstReg) = *static_cast<uint32_t*>(fieldAddr); break;
+            default: GET_REG(dstReg) = *static_cast<uint64_t*>(fieldAddr); break;
         }
     }
 
@@ -1213,6 +1505,7 @@ void op_get_field(VMContext* ctx) {
 }
 
 // OP_CMP：执行比较并写结果，必要时更新条件标志位。
+template <bool kVmChecked, bool kVmCompact>
 void op_cmp(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=lhs_reg, [pc+3]=rhs_reg, [pc+4]=result_reg, [pc+5]=cmp_op；同时按 lhs-rhs 更新 NZCV
     // typeIdx 决定比较语义（浮点/整数）。
@@ -1224,11 +1517,11 @@ void op_cmp(VMContext* ctx) {
     uint32_t resultReg = GET_INST(4);
     uint32_t cmpOp = GET_INST(5);
 
-    zType* type = GET_TYPE(typeIdx);
-    uint64_t lhs = GET_REG(lhsReg).value;
-    uint64_t rhs = GET_REG(rhsReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    uint64_t lhs = GET_REG(lhsReg);
+    uint64_t rhs = GET_REG(rhsReg);
     uint64_t result = execCompareOp(cmpOp, lhs, rhs, type);
-    GET_REG(resultReg).value = result;
+    GET_REG(resultReg) = result;
 
     if (type && !type->is_float) {
         // 非浮点比较时同步更新 NZCV，服务后续条件分支。
@@ -1240,7 +1533,7 @@ void op_cmp(VMContext* ctx) {
         VM_TRACE_LOGD("[OP_CMP] lhs=%" PRIu64 " rhs=%" PRIu64 " -> nzcv=0x%x *x0=%" PRIu64,
                       (unsigned long long)lhs,
                       (unsigned long long)rhs,
-                      (unsigned)ctx->nzcv,
+                      (unsigned)peekFlags(ctx),
                       (unsigned long long)log_x0_deref(ctx));
     }
     // 指令长度固定 6 words。
@@ -1248,6 +1541,7 @@ void op_cmp(VMContext* ctx) {
 }
 
 // OP_SET_FIELD：按偏移向基址写入字段值。
+template <bool kVmChecked, bool kVmCompact>
 void op_set_field(VMContext* ctx) {
 
     // 参数槽位：[pc+1]=type_idx, [pc+2]=base_reg, [pc+3]=offset, [pc+4]=value_reg（value_reg>=register_count 表示 str wzr/xzr，存 0）
@@ -1259,15 +1553,15 @@ void op_set_field(VMContext* ctx) {
     // valueReg 表示源值寄存器。
     uint32_t valueReg = GET_INST(4);
 
-    zType* type = GET_TYPE(typeIdx);
-    uint64_t base = GET_REG(baseReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    uint64_t base = GET_REG(baseReg);
     if (base == 0) {
         // 空基址直接跳过写入，避免无效指针访问。
         ctx->pc += 5;
         return;
     }
     // valueReg 越界视作零寄存器语义。
-    uint64_t value = (valueReg < ctx->register_count) ? GET_REG(valueReg).value : 0;
+    uint64_t value = (valueReg < ctx->register_count) ? GET_REG(valueReg) : 0;
     // 字段地址 = base + offset。
     void* fieldAddr = reinterpret_cast<void*>(base + offset);
 
@@ -1293,6 +1587,7 @@ void op_set_field(VMContext* ctx) {
 }
 
 // OP_RESTORE_REG：从保存区恢复寄存器值。
+template <bool kVmChecked, bool kVmCompact>
 void op_restore_reg(VMContext* ctx) {
     // 布局: [opcode][dst_slot][reserved][pair_count][pairs...]
     // 参数槽位：[pc+0]=opcode=14, [pc+1]=dst_slot, [pc+2]=reserved, [pc+3]=pair_count
@@ -1311,7 +1606,7 @@ void op_restore_reg(VMContext* ctx) {
         // 分支命中则把对应寄存器值恢复到 dstSlot。
         if (branchId == ctx->saved_branch_id) {
             // 命中当前分支后恢复目标槽值。
-            GET_REG(dstSlot).value = GET_REG(regIdx).value;
+            GET_REG(dstSlot) = GET_REG(regIdx);
             matched = true;
             break;
         }
@@ -1326,7 +1621,43 @@ void op_restore_reg(VMContext* ctx) {
     ctx->pc += 4 + pairCount * 2;
 }
 
+// 原生调用 thunk（简化 FFI）：当前只内建到 6 参数形态，超过则按前 6 个参数调用。
+static uint64_t callThunk0(uint64_t target, const uint64_t* args) {
+    (void)args;
+    return reinterpret_cast<uint64_t (*)()>(target)();
+}
+static uint64_t callThunk1(uint64_t target, const uint64_t* args) {
+    return reinterpret_cast<uint64_t (*)(uint64_t)>(target)(args[0]);
+}
+static uint64_t callThunk2(uint64_t target, const uint64_t* args) {
+    return reinterpret_cast<uint64_t (*)(uint64_t, uint64_t)>(target)(args[0], args[1]);
+}
+static uint64_t callThunk3(uint64_t target, const uint64_t* args) {
+    return reinterpret_cast<uint64_t (*)(uint64_t, uint64_t, uint64_t)>(target)(args[0], args[1], args[2]);
+}
+static uint64_t callThunk4(uint64_t target, const uint64_t* args) {
+    return reinterpret_cast<uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t)>(target)(
+            args[0], args[1], args[2], args[3]);
+}
+static uint64_t callThunk5(uint64_t target, const uint64_t* args) {
+    return reinterpret_cast<uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t)>(target)(
+            args[0], args[1], args[2], args[3], args[4]);
+}
+static uint64_t callThunk6(uint64_t target, const uint64_t* args) {
+    return reinterpret_cast<uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t)>(target)(
+            args[0], args[1], args[2], args[3], args[4], args[5]);
+}
+
+// 按参数个数选择原生调用 thunk。
+VMCallThunk selectCallThunk(uint32_t paramCount) {
+    static const VMCallThunk kThunks[] = {
+            callThunk0, callThunk1, callThunk2, callThunk3, callThunk4, callThunk5, callThunk6,
+    };
+    return kThunks[paramCount < 6 ? paramCount : 6];
+}
+
 // OP_CALL：执行直接调用并按约定处理返回值与现场。
+template <bool kVmChecked, bool kVmCompact>
 void op_call(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=param_count, [pc+3]=type_mask, [pc+4]=result_reg,
     // 参数槽位：[pc+5]=func_ptr_reg, [pc+6..]=param_regs
@@ -1335,12 +1666,12 @@ void op_call(VMContext* ctx) {
     uint32_t resultReg = GET_INST(4);
     uint32_t funcPtrReg = GET_INST(5);
 
-    uint64_t funcPtr = GET_REG(funcPtrReg).value;
+    uint64_t funcPtr = GET_REG(funcPtrReg);
 
     // 空函数指针：若有返回值位，则返回 0 并继续。
     if (funcPtr == 0) {
         if (typeMask & 0x1) {
-            GET_REG(resultReg).value = 0;
+            GET_REG(resultReg) = 0;
         }
         ctx->pc += 6 + paramCount;
         return;
@@ -1361,58 +1692,42 @@ void op_call(VMContext* ctx) {
     for (uint32_t i = 0; i < paramCount && i < 16; i++) {
         // 参数按顺序从 param_regs 收集。
         uint32_t paramReg = GET_INST(6 + i);
-        args[i] = GET_REG(paramReg).value;
+        args[i] = GET_REG(paramReg);
     }
 
-    // 调用函数（简化 FFI）
-    typedef uint64_t (*FuncPtr0)();
-    typedef uint64_t (*FuncPtr1)(uint64_t);
-    typedef uint64_t (*FuncPtr2)(uint64_t, uint64_t);
-    typedef uint64_t (*FuncPtr3)(uint64_t, uint64_t, uint64_t);
-    typedef uint64_t (*FuncPtr4)(uint64_t, uint64_t, uint64_t, uint64_t);
-    typedef uint64_t (*FuncPtr5)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t);
-    typedef uint64_t (*FuncPtr6)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t);
-
-    uint64_t callResult = 0;
-    // 当前只内建到 6 参数形态，超过则按前 6 个参数调用。
-    switch (paramCount) {
-        case 0: callResult = reinterpret_cast<FuncPtr0>(funcPtr)(); break;
-        case 1: callResult = reinterpret_cast<FuncPtr1>(funcPtr)(args[0]); break;
-        case 2: callResult = reinterpret_cast<FuncPtr2>(funcPtr)(args[0], args[1]); break;
-        case 3: callResult = reinterpret_cast<FuncPtr3>(funcPtr)(args[0], args[1], args[2]); break;
-        case 4: callResult = reinterpret_cast<FuncPtr4>(funcPtr)(args[0], args[1], args[2], args[3]); break;
-        case 5: callResult = reinterpret_cast<FuncPtr5>(funcPtr)(args[0], args[1], args[2], args[3], args[4]); break;
-        default: callResult = reinterpret_cast<FuncPtr6>(funcPtr)(args[0], args[1], args[2], args[3], args[4], args[5]); break;
-    }
+    // 调用函数（简化 FFI）：按参数个数选择固定签名 thunk。
+    const uint64_t callResult = selectCallThunk(paramCount)(funcPtr, args);
 
     if (typeMask & 0x1) {
         // typeMask bit0 表示该调用有返回值。
-        GET_REG(resultReg).value = callResult;
-        GET_REG(resultReg).ownership = 0;
+        GET_REG(resultReg) = callResult;
+        REG_OWNED(resultReg) = 0;
     }
 
     ctx->pc += 6 + paramCount;
 }
 
 // OP_RETURN：设置返回值并终止当前执行流。
+template <bool kVmChecked, bool kVmCompact>
 void op_return(VMContext* ctx) {
     // 参数槽位：[pc+1]=has_value, [pc+2]=value_reg（可选）
     uint32_t hasValue = GET_INST(1);
     if (hasValue) {
         uint32_t valueReg = GET_INST(2);
-        ctx->ret_value = GET_REG(valueReg).value;
+        ctx->ret_value = GET_REG(valueReg);
         VM_TRACE_LOGD("[OP_RETURN] valueReg=%u ret_value=%" PRIu64 " *x0=%" PRIu64,
                       (unsigned)valueReg,
                       (unsigned long long)ctx->ret_value,
                       (unsigned long long)log_x0_deref(ctx));
         // 返回值由 ret_value 统一承载，不再把 8 字节标量强制写回 ret_buffer，
         // 以免覆盖对象返回（如 std::string）的构造结果。
-        GET_REG(valueReg).ownership = 0;
+        REG_OWNED(valueReg) = 0;
     }
     ctx->running = false;
 }
 
 // OP_BRANCH：无条件跳转到分支表目标。
+template <bool kVmChecked, bool kVmCompact>
 void op_branch(VMContext* ctx) {
     // 参数槽位：[pc+1]=branchId；targetPc = ctx->branch_id_list[branchId]
     uint32_t branchId = GET_INST(1);
@@ -1433,6 +1748,7 @@ void op_branch(VMContext* ctx) {
 }
 
 // OP_BRANCH_IF：按条件寄存器值决定是否跳转。
+template <bool kVmChecked, bool kVmCompact>
 void op_branch_if(VMContext* ctx) {
     // 参数槽位：[pc+1]=cond_reg, [pc+2]=true_target, [pc+3]=false_target；
     // true_target/false_target 均按 branch_id_list 下标解析。
@@ -1440,7 +1756,7 @@ void op_branch_if(VMContext* ctx) {
     uint32_t trueTarget = GET_INST(2);
     uint32_t falseTarget = GET_INST(3);
 
-    uint64_t cond = GET_REG(condReg).value;
+    uint64_t cond = GET_REG(condReg);
     // cond!=0 走 trueTarget，否则走 falseTarget。
     uint32_t idx = cond ? trueTarget : falseTarget;
     if (ctx->branch_id_list == nullptr || idx >= ctx->branch_count) {
@@ -1458,15 +1774,26 @@ void op_branch_if(VMContext* ctx) {
     }
 }
 
+// 稠密索引查表：addr 落在索引范围内且对齐时返回 true 并写出目标 pc（可能为空洞标记）。
+static inline bool lookupDenseBranch(const VMContext* ctx, uint64_t addr, uint32_t& targetPc) {
+    const uint64_t delta = addr - ctx->branch_lookup_base;
+    if (addr < ctx->branch_lookup_base || (delta & 3u) != 0 || (delta >> 2) >= ctx->branch_lookup_dense_count) {
+        return false;
+    }
+    targetPc = ctx->branch_lookup_dense[delta >> 2];
+    return targetPc != VM_BRANCH_LOOKUP_MISS;
+}
+
 // OP_BRANCH_REG：按寄存器中的目标地址做函数内间接跳转。
+template <bool kVmChecked, bool kVmCompact>
 void op_branch_reg(VMContext* ctx) {
-    // [0]=opcode, [1]=targetReg；在 branch_lookup_addrs 中查目标地址并跳到对应 branch_lookup_words。
+    // [0]=opcode, [1]=targetReg；先查稠密索引（O(1)），未建索引时回退 branch_lookup_addrs 线性扫描。
     uint32_t targetReg = GET_INST(1);
     if (!ctx->running) {
         return;
     }
 
-    const uint64_t targetAddr = GET_REG(targetReg).value;
+    const uint64_t targetAddr = GET_REG(targetReg);
     if (ctx->branch_lookup_words == nullptr ||
         ctx->branch_lookup_addrs == nullptr ||
         ctx->branch_lookup_count == 0) {
@@ -1477,39 +1804,51 @@ void op_branch_reg(VMContext* ctx) {
         return;
     }
 
-    const bool hasModuleBase = (g_vm_module_base != 0 && targetAddr >= g_vm_module_base);
-    const uint64_t targetOffset = hasModuleBase ? (targetAddr - g_vm_module_base) : targetAddr;
-    for (uint32_t lookupIndex = 0; lookupIndex < ctx->branch_lookup_count; ++lookupIndex) {
-        const uint64_t lookupAddr = ctx->branch_lookup_addrs[lookupIndex];
-        if (lookupAddr != targetAddr && lookupAddr != targetOffset) {
-            continue;
+    const uint64_t moduleBase = ctx->module_base;
+    const bool hasModuleBase = (moduleBase != 0 && targetAddr >= moduleBase);
+    const uint64_t targetOffset = hasModuleBase ? (targetAddr - moduleBase) : targetAddr;
+    uint32_t targetPc = VM_BRANCH_LOOKUP_MISS;
+    if (ctx->branch_lookup_dense != nullptr) {
+        // 索引按模块相对地址建立：优先匹配偏移，再兼容表中直接存绝对地址的情形。
+        if (!lookupDenseBranch(ctx, targetOffset, targetPc) && targetOffset != targetAddr) {
+            lookupDenseBranch(ctx, targetAddr, targetPc);
         }
-        const uint32_t targetPc = ctx->branch_lookup_words[lookupIndex];
-        if (targetPc >= ctx->inst_count) {
-            LOGE("op_branch_reg target pc out of range: target_pc=%u inst_count=%u",
-                 targetPc,
-                 ctx->inst_count);
-            ctx->running = false;
-            return;
+    } else {
+        for (uint32_t lookupIndex = 0; lookupIndex < ctx->branch_lookup_count; ++lookupIndex) {
+            const uint64_t lookupAddr = ctx->branch_lookup_addrs[lookupIndex];
+            if (lookupAddr == targetAddr || lookupAddr == targetOffset) {
+                targetPc = ctx->branch_lookup_words[lookupIndex];
+                break;
+            }
         }
+    }
 
-        VM_TRACE_LOGD("[OP_BRANCH_REG] targetReg=%u targetAddr=0x%llx targetOffset=0x%llx targetPc=%u",
-                      targetReg,
-                      static_cast<unsigned long long>(targetAddr),
-                      static_cast<unsigned long long>(targetOffset),
-                      targetPc);
-        ctx->pc = targetPc;
+    if (targetPc == VM_BRANCH_LOOKUP_MISS) {
+        LOGE("op_branch_reg unresolved target: target=0x%llx offset=0x%llx lookup_count=%u",
+             static_cast<unsigned long long>(targetAddr),
+             static_cast<unsigned long long>(targetOffset),
+             ctx->branch_lookup_count);
+        ctx->running = false;
+        return;
+    }
+    if (targetPc >= ctx->inst_count) {
+        LOGE("op_branch_reg target pc out of range: target_pc=%u inst_count=%u",
+             targetPc,
+             ctx->inst_count);
+        ctx->running = false;
         return;
     }
 
-    LOGE("op_branch_reg unresolved target: target=0x%llx offset=0x%llx lookup_count=%u",
-         static_cast<unsigned long long>(targetAddr),
-         static_cast<unsigned long long>(targetOffset),
-         ctx->branch_lookup_count);
-    ctx->running = false;
+    VM_TRACE_LOGD("[OP_BRANCH_REG] targetReg=%u targetAddr=0x%llx targetOffset=0x%llx targetPc=%u",
+                  targetReg,
+                  static_cast<unsigned long long>(targetAddr),
+                  static_cast<unsigned long long>(targetOffset),
+                  targetPc);
+    ctx->pc = targetPc;
 }
 
 // OP_BRANCH_IF_CC：按 NZCV+条件码判定是否跳转。
+template <bool kVmChecked, bool kVmCompact>
 void op_branch_if_cc(VMContext* ctx) {
     // [0]=opcode, [1]=cc, [2]=branchId；若 nzcv 满足 cc 则 pc = branch_list[branchId]，否则 pc += 3（fall-through）
     uint32_t cc = GET_INST(1);
@@ -1517,13 +1856,13 @@ void op_branch_if_cc(VMContext* ctx) {
     // 默认顺序执行的下一条 PC。
     uint32_t fallthroughPc = ctx->pc + 3;
     // 根据 NZCV 计算是否命中条件跳转。
-    bool taken = evaluateCondition(ctx->nzcv, cc);
+    bool taken = evaluateCondition(ctx, cc);
     uint32_t targetPc = (ctx->branch_id_list && branchId < ctx->branch_count) ? ctx->branch_id_list[branchId] : fallthroughPc;
 
     VM_TRACE_LOGD("[OP_BRANCH_IF_CC] cc=%u branchId=%u nzcv=0x%x taken=%d targetPc=%u fallthrough=%u *x0=%" PRIu64,
                   (unsigned)cc,
                   (unsigned)branchId,
-                  (unsigned)ctx->nzcv,
+                  (unsigned)peekFlags(ctx),
                   (int)taken,
                   (unsigned)targetPc,
                   (unsigned)fallthroughPc,
@@ -1541,13 +1880,14 @@ void op_branch_if_cc(VMContext* ctx) {
 }
 
 // OP_SET_RETURN_PC：写入当前 PC 相对返回地址。
+template <bool kVmChecked, bool kVmCompact>
 void op_set_return_pc(VMContext* ctx) {
     // [0]=opcode, [1]=dstReg, [2]=offset；运行时设置 dstReg = 当前 pc + offset（用于 BL 的 LR）
     uint32_t dstReg = GET_INST(1);
     uint32_t offset = GET_INST(2);
     // 返回位点 = 当前 pc + 相对偏移。
     if (dstReg < ctx->register_count)
-        GET_REG(dstReg).value = ctx->pc + offset;
+        GET_REG(dstReg) = ctx->pc + offset;
     ctx->pc += 3;
 }
 
@@ -1591,15 +1931,16 @@ static uint64_t call_native_with_x8(uint64_t target_addr, const uint64_t args[8]
 }
 
 // OP_BL：带链接跳转，保存返回位点并跳转到目标。
+template <bool kVmChecked, bool kVmCompact>
 void op_bl(VMContext* ctx) {
-    // [0]=OP_BL, [1]=branchId；按 branch_addr_list[branchId] 走原生 blr 调用，并把返回值写回 x0。
+    // [0]=OP_BL, [1]=branchId；按 branch_addr_list[branchId] 走原生 blr 调用（VM 目标走嵌套执行），并把返回值写回 x0。
 #if VM_DEBUG_HOOK
     if (ctx->pc == 136) {
         static const char* str = "zLog";
         static const char* str2 = "fun_for_add ret: %d";
-        GET_REG(0).value = 6;
-        GET_REG(1).value = reinterpret_cast<uint64_t>(str);
-        GET_REG(2).value = reinterpret_cast<uint64_t>(str2);
+        GET_REG(0) = 6;
+        GET_REG(1) = reinterpret_cast<uint64_t>(str);
+        GET_REG(2) = reinterpret_cast<uint64_t>(str2);
     }
 #endif
 
@@ -1620,7 +1961,7 @@ void op_bl(VMContext* ctx) {
     uint64_t new_sp = 0;
     if (ctx->register_count > 31) {
         // x31 作为 SP 使用，当前对齐掩码与现有实现保持一致。
-        new_sp = GET_REG(31).value & 0xffffffffff;
+        new_sp = GET_REG(31) & 0xffffffffff;
     }
     // branchId 对应的原生函数地址。
     uint64_t new_addr = ctx->branch_addr_list[branchId];
@@ -1634,7 +1975,7 @@ void op_bl(VMContext* ctx) {
     const uint32_t argCount = (ctx->register_count < 8) ? ctx->register_count : 8;
     for (uint32_t i = 0; i < argCount; ++i) {
         // 顺序打包 x0..x7。
-        args[i] = GET_REG(i).value;
+        args[i] = GET_REG(i);
         if (!ctx->running) {
             return;
         }
@@ -1643,14 +1984,20 @@ void op_bl(VMContext* ctx) {
     uint64_t arg_x8 = 0;
     if (ctx->register_count > 8) {
         // x8 常用于隐藏参数（如返回缓冲地址）。
-        arg_x8 = GET_REG(8).value;
+        arg_x8 = GET_REG(8);
+    }
+    uint64_t value = 0;
+    // 目标为本模块受保护函数：直接嵌套 VM 调用，省去原生跳板 -> takeover 分发 -> 重新进入解释器的往返；
+    // 被调函数未命中缓存时回退原生调用。
+    const uint64_t vmKey = ctx->branch_vm_keys != nullptr ? ctx->branch_vm_keys[branchId] : 0;
+    if (vmKey == 0 || !zVmEngine::getInstance().executeNested(ctx, vmKey, args, arg_x8, value)) {
+        // 通过统一桥接函数执行原生调用。
+        value = call_native_with_x8(new_addr, args, arg_x8);
     }
-    // 通过统一桥接函数执行原生调用。
-    uint64_t value = call_native_with_x8(new_addr, args, arg_x8);
 
     if (ctx->register_count > 0) {
         // 按 AArch64 约定把返回值回写 x0。
-        GET_REG(0).value = value;
+        GET_REG(0) = value;
         if (!ctx->running) {
             return;
         }
@@ -1661,6 +2008,7 @@ void op_bl(VMContext* ctx) {
 }
 
 // OP_ADRP：基于模块基址 + offset 计算地址并写入目标寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_adrp(VMContext* ctx) {
     // 参数槽位：[pc+1]=dst_reg, [pc+2]=offset_low32, [pc+3]=offset_high32
     uint32_t dstReg = GET_INST(1);
@@ -1669,21 +2017,22 @@ void op_adrp(VMContext* ctx) {
     // 离线阶段拆分的 64 位偏移在运行时重组。
     uint64_t offset = static_cast<uint64_t>(low) | (static_cast<uint64_t>(high) << 32);
 
-    // 绝对地址 = 模块基址 + 页对齐偏移。
-    GET_REG(dstReg).value = g_vm_module_base + offset;
-    GET_REG(dstReg).ownership = 0;
+    // 绝对地址 = 本次执行所属模块基址 + 页对齐偏移。
+    GET_REG(dstReg) = ctx->module_base + offset;
+    REG_OWNED(dstReg) = 0;
 
     // OP_ADRP 指令长度固定 4 words。
     ctx->pc += 4;
 }
 
 // OP_ALLOC_MEMORY：按类型大小在堆上分配对象存储。
+template <bool kVmChecked, bool kVmCompact>
 void op_alloc_memory(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=dst_reg
     uint32_t typeIdx = GET_INST(1);
     uint32_t dstReg = GET_INST(2);
 
-    zType* type = GET_TYPE(typeIdx);
+    const zType* type = GET_TYPE(typeIdx);
     // 未知类型时默认分配 8 字节。
     uint32_t size = type ? type->size : 8;
     // calloc 置零，避免调用方读取未初始化内存。
@@ -1693,42 +2042,45 @@ void op_alloc_memory(VMContext* ctx) {
         // 若调用方提供返回缓冲，回填分配指针。
         *static_cast<uint64_t*>(ctx->ret_buffer) = reinterpret_cast<uint64_t>(ptr);
     }
-    VMRegSlot& dstSlot = GET_REG(dstReg);
-    dstSlot.value = reinterpret_cast<uint64_t>(ptr);
-    // reserved 记录分配基址，便于后续统一释放。
-    dstSlot.reserved = dstSlot.value;
-    // ownership=1 表示该槽持有释放责任。
-    dstSlot.ownership = 1;
+    GET_REG(dstReg) = reinterpret_cast<uint64_t>(ptr);
+    // 释放基址侧表记录分配基址，便于后续统一释放。
+    REG_FREE_BASE(dstReg) = reinterpret_cast<uint64_t>(ptr);
+    // ownership=1 表示该寄存器持有释放责任。
+    REG_OWNED(dstReg) = 1;
+    vmTrackOwnedReg(ctx, dstReg);
 
     // OP_ALLOC_MEMORY 指令长度固定 3 words。
     ctx->pc += 3;
 }
 
 // OP_MOV：将源寄存器值直接移动到目标寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_mov(VMContext* ctx) {
     // 参数槽位：[pc+1]=src_reg, [pc+2]=dst_reg
     uint32_t srcReg = GET_INST(1);
     uint32_t dstReg = GET_INST(2);
 
-    GET_REG(dstReg).value = GET_REG(srcReg).value;
-    GET_REG(dstReg).ownership = 0;
+    GET_REG(dstReg) = GET_REG(srcReg);
+    REG_OWNED(dstReg) = 0;
 
     ctx->pc += 3;
 }
 
 // OP_LOAD_IMM：加载立即数并做必要的位宽处理。
+template <bool kVmChecked, bool kVmCompact>
 void op_load_imm(VMContext* ctx) {
     // 参数槽位：[pc+1]=dst_reg, [pc+2]=imm_value
     uint32_t dstReg = GET_INST(1);
     uint32_t immValue = GET_INST(2);
 
-    GET_REG(dstReg).value = immValue;
-    GET_REG(dstReg).ownership = 0;
+    GET_REG(dstReg) = immValue;
+    REG_OWNED(dstReg) = 0;
 
     ctx->pc += 3;
 }
 
 // OP_DYNAMIC_CAST：执行运行时类型转换或兼容性检查。
+template <bool kVmChecked, bool kVmCompact>
 void op_dynamic_cast(VMContext* ctx) {
     // 布局: [opcode][cmp_reg][type_idx][default_branch][pair_count][pairs...]
     // 参数槽位：[pc+0]=opcode=22, [pc+1]=cmp_reg, [pc+2]=type_idx(取mask), [pc+3]=default_branch_idx, [pc+4]=pair_count
@@ -1741,8 +2093,8 @@ void op_dynamic_cast(VMContext* ctx) {
     uint32_t pairCount = GET_INST(4);
 
     // cmpReg 是待匹配值寄存器。
-    zType* type = GET_TYPE(typeIdx);
-    uint64_t cmpVal = GET_REG(cmpReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    uint64_t cmpVal = GET_REG(cmpReg);
     // 按 bit_width 构造比较掩码，支持低位宽类型比较。
     uint64_t mask = type && type->bit_width > 0 && type->bit_width < 64 
                    ? ((1ULL << type->bit_width) - 1) 
@@ -1754,7 +2106,7 @@ void op_dynamic_cast(VMContext* ctx) {
         // 逐对匹配 value_reg 与 branch_id。
         uint32_t valReg = GET_INST(5 + i * 2);
         uint32_t branchId = GET_INST(5 + i * 2 + 1);
-        uint64_t val = GET_REG(valReg).value;
+        uint64_t val = GET_REG(valReg);
         if (((cmpVal ^ val) & mask) == 0) {
             // 命中后立即采用该分支。
             targetBranchIdx = branchId;
@@ -1776,6 +2128,7 @@ void op_dynamic_cast(VMContext* ctx) {
 }
 
 // OP_UNARY：执行一元算子并写回目标寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_unary(VMContext* ctx) {
     // 参数槽位：[pc+1]=sub_op, [pc+2]=type_idx, [pc+3]=src_reg, [pc+4]=dst_reg
     // subOp 表示一元算子类型。
@@ -1784,22 +2137,24 @@ void op_unary(VMContext* ctx) {
     uint32_t srcReg = GET_INST(3);
     uint32_t dstReg = GET_INST(4);
 
-    zType* type = GET_TYPE(typeIdx);
-    uint64_t src = GET_REG(srcReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    uint64_t src = GET_REG(srcReg);
     uint64_t result = execUnaryOp(subOp, src, type);
-    GET_REG(dstReg).value = result;
+    GET_REG(dstReg) = result;
 
     // 指令长度固定 5 words。
     ctx->pc += 5;
 }
 
 // OP_PHI：在多前驱值中选择当前控制流对应的输入。
+template <bool kVmChecked, bool kVmCompact>
 void op_phi(VMContext* ctx) {
     // 目前仅保留占位语义：直接跳过，后续可按 SSA 前驱补全。
     ctx->pc += 1;
 }
 
 // OP_SELECT：基于条件寄存器选择两路值之一。
+template <bool kVmChecked, bool kVmCompact>
 void op_select(VMContext* ctx) {
     // 参数槽位：[pc+1]=cond_reg, [pc+2]=true_reg, [pc+3]=false_reg, [pc+4]=dst_reg
     uint32_t condReg = GET_INST(1);
@@ -1808,23 +2163,24 @@ void op_select(VMContext* ctx) {
     uint32_t dstReg = GET_INST(4);
 
     // cond != 0 选择 trueReg，否则选择 falseReg。
-    uint64_t cond = GET_REG(condReg).value;
-    GET_REG(dstReg).value = cond ? GET_REG(trueReg).value : GET_REG(falseReg).value;
+    uint64_t cond = GET_REG(condReg);
+    GET_REG(dstReg) = cond ? GET_REG(trueReg) : GET_REG(falseReg);
 
     // 指令长度固定 5 words。
     ctx->pc += 5;
 }
 
 // OP_MEMCPY：执行内存块复制。
+template <bool kVmChecked, bool kVmCompact>
 void op_memcpy(VMContext* ctx) {
     // 参数槽位：[pc+1]=dst_reg, [pc+2]=src_reg, [pc+3]=size_reg
     uint32_t dstReg = GET_INST(1);
     uint32_t srcReg = GET_INST(2);
     uint32_t sizeReg = GET_INST(3);
 
-    void* dst = reinterpret_cast<void*>(GET_REG(dstReg).value);
-    void* src = reinterpret_cast<void*>(GET_REG(srcReg).value);
-    size_t size = static_cast<size_t>(GET_REG(sizeReg).value);
+    void* dst = reinterpret_cast<void*>(GET_REG(dstReg));
+    void* src = reinterpret_cast<void*>(GET_REG(srcReg));
+    size_t size = static_cast<size_t>(GET_REG(sizeReg));
 
     if (dst && src && size > 0) {
         // 三元条件都满足才执行 memcpy。
@@ -1836,15 +2192,16 @@ void op_memcpy(VMContext* ctx) {
 }
 
 // OP_MEMSET：执行内存块填充。
+template <bool kVmChecked, bool kVmCompact>
 void op_memset(VMContext* ctx) {
     // 参数槽位：[pc+1]=dst_reg, [pc+2]=value_reg, [pc+3]=size_reg
     uint32_t dstReg = GET_INST(1);
     uint32_t valueReg = GET_INST(2);
     uint32_t sizeReg = GET_INST(3);
 
-    void* dst = reinterpret_cast<void*>(GET_REG(dstReg).value);
-    int value = static_cast<int>(GET_REG(valueReg).value);
-    size_t size = static_cast<size_t>(GET_REG(sizeReg).value);
+    void* dst = reinterpret_cast<void*>(GET_REG(dstReg));
+    int value = static_cast<int>(GET_REG(valueReg));
+    size_t size = static_cast<size_t>(GET_REG(sizeReg));
 
     if (dst && size > 0) {
         // value 按 byte 扩展填充 size 字节。
@@ -1856,21 +2213,23 @@ void op_memset(VMContext* ctx) {
 }
 
 // OP_STRLEN：计算字符串长度并写入目标寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_strlen(VMContext* ctx) {
     // 参数槽位：[pc+1]=str_reg, [pc+2]=dst_reg
     uint32_t strReg = GET_INST(1);
     uint32_t dstReg = GET_INST(2);
 
     // strReg 保存 C 字符串首地址。
-    const char* str = reinterpret_cast<const char*>(GET_REG(strReg).value);
+    const char* str = reinterpret_cast<const char*>(GET_REG(strReg));
     // 空指针按 0 长度处理。
-    GET_REG(dstReg).value = str ? strlen(str) : 0;
+    GET_REG(dstReg) = str ? strlen(str) : 0;
 
     // 指令长度固定 3 words。
     ctx->pc += 3;
 }
 
 // OP_FETCH_NEXT：推进到下一执行片段或下一条语义指令。
+template <bool kVmChecked, bool kVmCompact>
 void op_fetch_next(VMContext* ctx) {
     // 布局: [opcode][has_cmp][branch_id][cmp_reg][type_idx][alt_branch]
     // 参数槽位：[pc+0]=opcode=29, [pc+1]=has_cmp, [pc+2]=branch_id, [pc+3]=cmp_reg, [pc+4]=type_idx, [pc+5]=alt_branch
@@ -1885,7 +2244,7 @@ void op_fetch_next(VMContext* ctx) {
     uint32_t targetBranchIdx = branchIdFromInst;
     if (hasCmp) {
         // hasCmp 时当 cmpReg 为 0 走 altBranchIdx，否则走 branchIdFromInst。
-        uint64_t cmpVal = GET_REG(cmpReg).value;
+        uint64_t cmpVal = GET_REG(cmpReg);
         if (cmpVal == 0) {
             targetBranchIdx = altBranchIdx;
         }
@@ -1903,19 +2262,21 @@ void op_fetch_next(VMContext* ctx) {
 }
 
 // OP_CALL_INDIRECT：通过函数指针执行间接调用。
+template <bool kVmChecked, bool kVmCompact>
 void op_call_indirect(VMContext* ctx) {
     // 复用 op_call 逻辑，调用目标由寄存器中函数指针决定。
-    op_call(ctx);
+    op_call<kVmChecked, kVmCompact>(ctx);
 }
 
 // OP_SWITCH：根据 case 值跳转到对应分支目标。
+template <bool kVmChecked, bool kVmCompact>
 void op_switch(VMContext* ctx) {
     // 参数槽位：[pc+1]=value_reg, [pc+2]=default_target, [pc+3]=case_count, [pc+4..]=cases
     uint32_t valueReg = GET_INST(1);
     uint32_t defaultTarget = GET_INST(2);
     uint32_t caseCount = GET_INST(3);
 
-    uint64_t value = GET_REG(valueReg).value;
+    uint64_t value = GET_REG(valueReg);
     // 默认目标为 defaultTarget，命中 case 后覆盖。
     uint32_t target = defaultTarget;
 
@@ -1937,6 +2298,7 @@ void op_switch(VMContext* ctx) {
 }
 
 // OP_GET_PTR：获取地址值并写入目标寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_get_ptr(VMContext* ctx) {
     // 参数槽位：[pc+1]=base_reg, [pc+2]=offset, [pc+3]=dst_reg
     uint32_t baseReg = GET_INST(1);
@@ -1944,26 +2306,28 @@ void op_get_ptr(VMContext* ctx) {
     uint32_t dstReg = GET_INST(3);
 
     // 语义等价于 dst = base + offset。
-    GET_REG(dstReg).value = GET_REG(baseReg).value + offset;
+    GET_REG(dstReg) = GET_REG(baseReg) + offset;
 
     // 指令长度固定 4 words。
     ctx->pc += 4;
 }
 
 // OP_BITCAST：按位重解释，不改变底层 bit 模式。
+template <bool kVmChecked, bool kVmCompact>
 void op_bitcast(VMContext* ctx) {
     // 参数槽位：[pc+1]=src_reg, [pc+2]=dst_reg
     uint32_t srcReg = GET_INST(1);
     uint32_t dstReg = GET_INST(2);
 
     // bitcast 不做数值转换，仅复制位模式。
-    GET_REG(dstReg).value = GET_REG(srcReg).value;
+    GET_REG(dstReg) = GET_REG(srcReg);
 
     // 指令长度固定 3 words。
     ctx->pc += 3;
 }
 
 // OP_SIGN_EXTEND：按源位宽做有符号扩展。
+template <bool kVmChecked, bool kVmCompact>
 void op_sign_extend(VMContext* ctx) {
     // 参数槽位：[pc+1]=src_type, [pc+2]=dst_type, [pc+3]=src_reg, [pc+4]=dst_reg
     uint32_t srcTypeIdx = GET_INST(1);
@@ -1971,9 +2335,9 @@ void op_sign_extend(VMContext* ctx) {
     uint32_t srcReg = GET_INST(3);
     uint32_t dstReg = GET_INST(4);
 
-    zType* srcType = GET_TYPE(srcTypeIdx);
+    const zType* srcType = GET_TYPE(srcTypeIdx);
     // 先按有符号 64 位视图读取源值。
-    int64_t value = static_cast<int64_t>(GET_REG(srcReg).value);
+    int64_t value = static_cast<int64_t>(GET_REG(srcReg));
     // dstTypeIdx 当前仅占位保留，协议上用于描述目标宽度。
 
     // 符号扩展
@@ -1988,55 +2352,58 @@ void op_sign_extend(VMContext* ctx) {
         }
     }
 
-    GET_REG(dstReg).value = static_cast<uint64_t>(value);
+    GET_REG(dstReg) = static_cast<uint64_t>(value);
 
     // 指令长度固定 5 words。
     ctx->pc += 5;
 }
 
 // OP_ZERO_EXTEND：按源位宽做无符号零扩展。
+template <bool kVmChecked, bool kVmCompact>
 void op_zero_extend(VMContext* ctx) {
     // 参数槽位：[pc+1]=src_type, [pc+2]=dst_type, [pc+3]=src_reg, [pc+4]=dst_reg
     uint32_t srcTypeIdx = GET_INST(1);
     uint32_t srcReg = GET_INST(3);
     uint32_t dstReg = GET_INST(4);
 
-    zType* srcType = GET_TYPE(srcTypeIdx);
-    uint64_t value = GET_REG(srcReg).value;
+    const zType* srcType = GET_TYPE(srcTypeIdx);
+    uint64_t value = GET_REG(srcReg);
 
     if (srcType && srcType->bit_width < 64) {
         // 仅保留源位宽内的低位。
         value &= (1ULL << srcType->bit_width) - 1;
     }
 
-    GET_REG(dstReg).value = value;
+    GET_REG(dstReg) = value;
 
     // 指令长度固定 5 words。
     ctx->pc += 5;
 }
 
 // OP_TRUNCATE：按目标位宽截断高位数据。
+template <bool kVmChecked, bool kVmCompact>
 void op_truncate(VMContext* ctx) {
     // 参数槽位：[pc+1]=dst_type, [pc+2]=src_reg, [pc+3]=dst_reg
     uint32_t dstTypeIdx = GET_INST(1);
     uint32_t srcReg = GET_INST(2);
     uint32_t dstReg = GET_INST(3);
 
-    zType* dstType = GET_TYPE(dstTypeIdx);
-    uint64_t value = GET_REG(srcReg).value;
+    const zType* dstType = GET_TYPE(dstTypeIdx);
+    uint64_t value = GET_REG(srcReg);
 
     if (dstType && dstType->bit_width < 64) {
         // 截断到目标位宽。
         value &= (1ULL << dstType->bit_width) - 1;
     }
 
-    GET_REG(dstReg).value = value;
+    GET_REG(dstReg) = value;
 
     // 指令长度固定 4 words。
     ctx->pc += 4;
 }
 
 // OP_FLOAT_EXTEND：浮点窄类型扩展到宽类型。
+template <bool kVmChecked, bool kVmCompact>
 void op_float_extend(VMContext* ctx) {
     // 当前实现固定按 float -> double 扩展。
     uint32_t srcReg = GET_INST(1);
@@ -2044,33 +2411,35 @@ void op_float_extend(VMContext* ctx) {
 
     float f;
     // 从槽位低 4 字节读取 float。
-    memcpy(&f, &GET_REG(srcReg).value, 4);
+    memcpy(&f, &GET_REG(srcReg), 4);
     double d = f;
     // 以 double 位模式写回目标槽。
-    memcpy(&GET_REG(dstReg).value, &d, 8);
+    memcpy(&GET_REG(dstReg), &d, 8);
 
     // 指令长度固定 3 words。
     ctx->pc += 3;
 }
 
 // OP_FLOAT_TRUNCATE：浮点宽类型截断到窄类型。
+template <bool kVmChecked, bool kVmCompact>
 void op_float_truncate(VMContext* ctx) {
     // 当前实现固定按 double -> float 截断。
     uint32_t srcReg = GET_INST(1);
     uint32_t dstReg = GET_INST(2);
 
     double d;
-    memcpy(&d, &GET_REG(srcReg).value, 8);
+    memcpy(&d, &GET_REG(srcReg), 8);
     float f = static_cast<float>(d);
     // 先清槽再写低 4 字节，避免残留高位脏数据。
-    GET_REG(dstReg).value = 0;
-    memcpy(&GET_REG(dstReg).value, &f, 4);
+    GET_REG(dstReg) = 0;
+    memcpy(&GET_REG(dstReg), &f, 4);
 
     // 指令长度固定 3 words。
     ctx->pc += 3;
 }
 
 // OP_INT_TO_FLOAT：整数转浮点。
+template <bool kVmChecked, bool kVmCompact>
 void op_int_to_float(VMContext* ctx) {
     // 参数槽位：[pc+1]=is_signed, [pc+2]=dst_type, [pc+3]=src_reg, [pc+4]=dst_reg
     uint32_t isSigned = GET_INST(1);
@@ -2079,18 +2448,18 @@ void op_int_to_float(VMContext* ctx) {
     uint32_t dstReg = GET_INST(4);
 
     // 目标类型决定落入 float 还是 double。
-    zType* dstType = GET_TYPE(dstTypeIdx);
-    uint64_t src = GET_REG(srcReg).value;
+    const zType* dstType = GET_TYPE(dstTypeIdx);
+    uint64_t src = GET_REG(srcReg);
 
     if (dstType && dstType->size == 4) {
         // 目标是 float（4 字节）时仅写低 4 字节。
         float f = isSigned ? static_cast<float>(static_cast<int64_t>(src)) : static_cast<float>(src);
-        GET_REG(dstReg).value = 0;
-        memcpy(&GET_REG(dstReg).value, &f, 4);
+        GET_REG(dstReg) = 0;
+        memcpy(&GET_REG(dstReg), &f, 4);
     } else {
         // 目标是 double（8 字节）。
         double d = isSigned ? static_cast<double>(static_cast<int64_t>(src)) : static_cast<double>(src);
-        memcpy(&GET_REG(dstReg).value, &d, 8);
+        memcpy(&GET_REG(dstReg), &d, 8);
     }
 
     // 指令长度固定 5 words。
@@ -2098,6 +2467,7 @@ void op_int_to_float(VMContext* ctx) {
 }
 
 // OP_ARRAY_ELEM：按元素下标和类型信息计算元素地址。
+template <bool kVmChecked, bool kVmCompact>
 void op_array_elem(VMContext* ctx) {
     // 布局: [opcode][dst_reg][reserved][elem_type][dim_count][base_reg][idx_regs...]
     // 参数槽位：[pc+0]=opcode=40, [pc+1]=dst_reg, [pc+2]=reserved, [pc+3]=elem_type, [pc+4]=dim_count
@@ -2108,7 +2478,7 @@ void op_array_elem(VMContext* ctx) {
     uint32_t elemTypeIdx = GET_INST(3);
     uint32_t dimCount = GET_INST(4);
 
-    zType* elemType = GET_TYPE(elemTypeIdx);
+    const zType* elemType = GET_TYPE(elemTypeIdx);
     uint32_t elemSize = elemType ? elemType->getSize() : 8;
 
     uint64_t baseAddr = 0;
@@ -2116,12 +2486,12 @@ void op_array_elem(VMContext* ctx) {
 
     if (dimCount > 0) {
         uint32_t baseReg = GET_INST(5);
-        baseAddr = GET_REG(baseReg).value;
+        baseAddr = GET_REG(baseReg);
 
         // 计算偏移量（简化：假设一维数组）
         for (uint32_t dim = 0; dim < dimCount; dim++) {
             uint32_t idxReg = GET_INST(6 + dim);
-            uint64_t idx = GET_REG(idxReg).value;
+            uint64_t idx = GET_REG(idxReg);
             // 对于多维数组，需要更复杂的 stride 计算
             // 这里简化为一维处理
             if (dim == 0) {
@@ -2135,10 +2505,11 @@ void op_array_elem(VMContext* ctx) {
         ctx->pc += 5;
     }
 
-    GET_REG(dstReg).value = baseAddr + offset;
+    GET_REG(dstReg) = baseAddr + offset;
 }
 
 // OP_FLOAT_TO_INT：浮点转整数，按目标类型处理符号与位宽。
+template <bool kVmChecked, bool kVmCompact>
 void op_float_to_int(VMContext* ctx) {
     // 参数槽位：[pc+1]=is_signed, [pc+2]=src_type, [pc+3]=src_reg, [pc+4]=dst_reg
     uint32_t isSigned = GET_INST(1);
@@ -2146,24 +2517,25 @@ void op_float_to_int(VMContext* ctx) {
     uint32_t srcReg = GET_INST(3);
     uint32_t dstReg = GET_INST(4);
 
-    zType* srcType = GET_TYPE(srcTypeIdx);
+    const zType* srcType = GET_TYPE(srcTypeIdx);
 
     if (srcType && srcType->size == 4) {
         // float -> int/uint。
         float f;
-        memcpy(&f, &GET_REG(srcReg).value, 4);
-        GET_REG(dstReg).value = isSigned ? static_cast<uint64_t>(static_cast<int64_t>(f)) : static_cast<uint64_t>(f);
+        memcpy(&f, &GET_REG(srcReg), 4);
+        GET_REG(dstReg) = isSigned ? static_cast<uint64_t>(static_cast<int64_t>(f)) : static_cast<uint64_t>(f);
     } else {
         // double -> int/uint。
         double d;
-        memcpy(&d, &GET_REG(srcReg).value, 8);
-        GET_REG(dstReg).value = isSigned ? static_cast<uint64_t>(static_cast<int64_t>(d)) : static_cast<uint64_t>(d);
+        memcpy(&d, &GET_REG(srcReg), 8);
+        GET_REG(dstReg) = isSigned ? static_cast<uint64_t>(static_cast<int64_t>(d)) : static_cast<uint64_t>(d);
     }
 
     ctx->pc += 5;
 }
 
 // OP_READ：从地址读取值到寄存器。
+template <bool kVmChecked, bool kVmCompact>
 void op_read(VMContext* ctx) {
     // 布局: [opcode][type_idx][dst_reg][addr_reg]
     // 参数槽位：[pc+0]=opcode=42, [pc+1]=type_idx, [pc+2]=dst_reg, [pc+3]=addr_reg
@@ -2174,14 +2546,15 @@ void op_read(VMContext* ctx) {
     uint32_t addrReg = GET_INST(3);
 
     // readValue 内部负责按类型宽度读取与符号处理。
-    zType* type = GET_TYPE(typeIdx);
-    readValue(&GET_REG(addrReg), type, &GET_REG(dstReg));
+    const zType* type = GET_TYPE(typeIdx);
+    readValue(&GET_REG(addrReg), type, &GET_REG(dstReg), &REG_OWNED(dstReg));
 
     // 指令长度固定 4 words。
     ctx->pc += 4;
 }
 
 // OP_WRITE：把寄存器值写回地址。
+template <bool kVmChecked, bool kVmCompact>
 void op_write(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=addr_reg, [pc+3]=value_reg
     uint32_t typeIdx = GET_INST(1);
@@ -2189,7 +2562,7 @@ void op_write(VMContext* ctx) {
     uint32_t valueReg = GET_INST(3);
 
     // writeValue 内部负责按类型宽度写入与截断。
-    zType* type = GET_TYPE(typeIdx);
+    const zType* type = GET_TYPE(typeIdx);
     writeValue(&GET_REG(addrReg), type, &GET_REG(valueReg));
 
     // 指令长度固定 4 words。
@@ -2197,6 +2570,7 @@ void op_write(VMContext* ctx) {
 }
 
 // OP_LEA：执行地址计算（base + index * scale + offset）。
+template <bool kVmChecked, bool kVmCompact>
 void op_lea(VMContext* ctx) {
     // 参数槽位：[pc+1]=base_reg, [pc+2]=index_reg, [pc+3]=scale, [pc+4]=offset, [pc+5]=dst_reg
     uint32_t baseReg = GET_INST(1);
@@ -2206,17 +2580,18 @@ void op_lea(VMContext* ctx) {
     uint32_t dstReg = GET_INST(5);
 
     // 读取 base/index 两个地址算术输入。
-    uint64_t base = GET_REG(baseReg).value;
-    uint64_t index = GET_REG(indexReg).value;
+    uint64_t base = GET_REG(baseReg);
+    uint64_t index = GET_REG(indexReg);
 
     // LEA 只做地址算术，不访问内存。
-    GET_REG(dstReg).value = base + index * scale + offset;
+    GET_REG(dstReg) = base + index * scale + offset;
 
     // 指令长度固定 6 words。
     ctx->pc += 6;
 }
 
 // OP_ATOMIC_LOAD：执行带内存序的原子读取。
+template <bool kVmChecked, bool kVmCompact>
 void op_atomic_load(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=base_reg, [pc+3]=offset, [pc+4]=mem_order, [pc+5]=dst_reg
     uint32_t typeIdx = GET_INST(1);
@@ -2225,12 +2600,12 @@ void op_atomic_load(VMContext* ctx) {
     uint32_t memOrder = GET_INST(4);
     uint32_t dstReg = GET_INST(5);
 
-    zType* type = GET_TYPE(typeIdx);
-    uint64_t base = GET_REG(baseReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    uint64_t base = GET_REG(baseReg);
     if (base == 0) {
         // 空基址读取按 0 返回。
-        GET_REG(dstReg).value = 0;
-        GET_REG(dstReg).ownership = 0;
+        GET_REG(dstReg) = 0;
+        REG_OWNED(dstReg) = 0;
         ctx->pc += 6;
         return;
     }
@@ -2256,12 +2631,13 @@ void op_atomic_load(VMContext* ctx) {
         }
     }
 
-    GET_REG(dstReg).value = value;
-    GET_REG(dstReg).ownership = 0;
+    GET_REG(dstReg) = value;
+    REG_OWNED(dstReg) = 0;
     ctx->pc += 6;
 }
 
 // OP_ATOMIC_STORE：执行带内存序的原子写入。
+template <bool kVmChecked, bool kVmCompact>
 void op_atomic_store(VMContext* ctx) {
     // 参数槽位：[pc+1]=type_idx, [pc+2]=base_reg, [pc+3]=offset, [pc+4]=value_reg, [pc+5]=mem_order
     uint32_t typeIdx = GET_INST(1);
@@ -2270,8 +2646,8 @@ void op_atomic_store(VMContext* ctx) {
     uint32_t valueReg = GET_INST(4);
     uint32_t memOrder = GET_INST(5);
 
-    zType* type = GET_TYPE(typeIdx);
-    uint64_t base = GET_REG(baseReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    uint64_t base = GET_REG(baseReg);
     if (base == 0) {
         // 空基址直接跳过写入。
         ctx->pc += 6;
@@ -2279,7 +2655,7 @@ void op_atomic_store(VMContext* ctx) {
     }
 
     // valueReg 越界视作零寄存器语义。
-    uint64_t value = (valueReg < ctx->register_count) ? GET_REG(valueReg).value : 0;
+    uint64_t value = (valueReg < ctx->register_count) ? GET_REG(valueReg) : 0;
     void* fieldAddr = reinterpret_cast<void*>(base + static_cast<int64_t>(offset));
     const int order = atomic_order_from_vm(memOrder);
     if (fieldAddr && type) {
@@ -2303,29 +2679,39 @@ void op_atomic_store(VMContext* ctx) {
     ctx->pc += 6;
 }
 
-// OP_ATOMIC_ADD：执行原子加并返回旧值。
-void op_atomic_add(VMContext* ctx) {
-    // 参数槽位：[pc+1]=type_idx, [pc+2]=addr_reg, [pc+3]=value_reg, [pc+4]=result_reg
+// OP_ATOMIC_ADD/SUB/XCHG 共用实现：按 mem_order 执行原子读-改-写，结果寄存器拿到旧值。
+// value/result 越界视作零寄存器（LSE 的 LDADD xzr / STADD 形态）：读出 0、丢弃旧值。
+template <bool kVmChecked, bool kVmCompact>
+static inline void vmAtomicReadModifyWrite(VMContext* ctx, uint32_t opcode) {
+    // 参数槽位：[pc+1]=type_idx, [pc+2]=addr_reg, [pc+3]=value_reg, [pc+4]=mem_order, [pc+5]=result_reg
     uint32_t typeIdx = GET_INST(1);
     uint32_t addrReg = GET_INST(2);
     uint32_t valueReg = GET_INST(3);
-    uint32_t resultReg = GET_INST(4);
+    uint32_t memOrder = GET_INST(4);
+    uint32_t resultReg = GET_INST(5);
 
-    // type 决定使用 32 位还是 64 位原子语义。
-    zType* type = GET_TYPE(typeIdx);
-    void* addr = reinterpret_cast<void*>(GET_REG(addrReg).value);
-    uint64_t value = GET_REG(valueReg).value;
+    // type 决定原子访问宽度（1/2/4/8 字节）。
+    const zType* type = GET_TYPE(typeIdx);
+    void* addr = reinterpret_cast<void*>(GET_REG(addrReg));
+    uint64_t value = (valueReg < ctx->register_count) ? GET_REG(valueReg) : 0;
+    const int order = atomic_order_from_vm(memOrder);
 
     // 默认旧值为 0；仅在地址与类型有效时执行原子操作。
     uint64_t oldValue = 0;
     if (addr && type) {
-        // 按类型宽度选择 32/64 位原子实现。
+        // 按类型宽度选择原子实现（窄宽度旧值零扩展，与 LDADDB/SWPH 一致）。
         switch (type->size) {
+            case 1:
+                oldValue = atomic_rmw_ordered<uint8_t>(opcode, addr, static_cast<uint8_t>(value), order);
+                break;
+            case 2:
+                oldValue = atomic_rmw_ordered<uint16_t>(opcode, addr, static_cast<uint16_t>(value), order);
+                break;
             case 4:
-                oldValue = atomic_fetch_add(static_cast<uint32_t*>(addr), static_cast<uint32_t>(value));
+                oldValue = atomic_rmw_ordered<uint32_t>(opcode, addr, static_cast<uint32_t>(value), order);
                 break;
             case 8:
-                oldValue = atomic_fetch_add(static_cast<uint64_t*>(addr), value);
+                oldValue = atomic_rmw_ordered<uint64_t>(opcode, addr, value, order);
                 break;
             default:
                 // 其它宽度当前不支持，返回默认旧值 0。
@@ -2333,109 +2719,70 @@ void op_atomic_add(VMContext* ctx) {
         }
     }
 
-    GET_REG(resultReg).value = oldValue;
+    if (resultReg < ctx->register_count) {
+        GET_REG(resultReg) = oldValue;
+        REG_OWNED(resultReg) = 0;
+    }
 
-    // 指令长度固定 5 words。
-    ctx->pc += 5;
+    // 指令长度固定 6 words。
+    ctx->pc += 6;
+}
+
+// OP_ATOMIC_ADD：执行原子加并返回旧值。
+template <bool kVmChecked, bool kVmCompact>
+void op_atomic_add(VMContext* ctx) {
+    vmAtomicReadModifyWrite<kVmChecked, kVmCompact>(ctx, OP_ATOMIC_ADD);
 }
 
 // OP_ATOMIC_SUB：执行原子减并返回旧值。
+template <bool kVmChecked, bool kVmCompact>
 void op_atomic_sub(VMContext* ctx) {
-    // 参数布局与 op_atomic_add 一致，仅运算符替换为减法。
-    uint32_t typeIdx = GET_INST(1);
-    uint32_t addrReg = GET_INST(2);
-    uint32_t valueReg = GET_INST(3);
-    uint32_t resultReg = GET_INST(4);
-
-    // type 决定使用 32 位还是 64 位原子语义。
-    zType* type = GET_TYPE(typeIdx);
-    void* addr = reinterpret_cast<void*>(GET_REG(addrReg).value);
-    uint64_t value = GET_REG(valueReg).value;
-
-    // 默认旧值为 0；仅在地址与类型有效时执行原子操作。
-    uint64_t oldValue = 0;
-    if (addr && type) {
-        // 按类型宽度选择 32/64 位原子实现。
-        switch (type->size) {
-            case 4:
-                oldValue = atomic_fetch_sub(static_cast<uint32_t*>(addr), static_cast<uint32_t>(value));
-                break;
-            case 8:
-                oldValue = atomic_fetch_sub(static_cast<uint64_t*>(addr), value);
-                break;
-            default:
-                // 其它宽度当前不支持，返回默认旧值 0。
-                break;
-        }
-    }
-
-    GET_REG(resultReg).value = oldValue;
-
-    // 指令长度固定 5 words。
-    ctx->pc += 5;
+    vmAtomicReadModifyWrite<kVmChecked, kVmCompact>(ctx, OP_ATOMIC_SUB);
 }
 
 // OP_ATOMIC_XCHG：执行原子交换并返回旧值。
+template <bool kVmChecked, bool kVmCompact>
 void op_atomic_xchg(VMContext* ctx) {
-    // 参数槽位：[pc+1]=type_idx, [pc+2]=addr_reg, [pc+3]=value_reg, [pc+4]=result_reg
-    uint32_t typeIdx = GET_INST(1);
-    uint32_t addrReg = GET_INST(2);
-    uint32_t valueReg = GET_INST(3);
-    uint32_t resultReg = GET_INST(4);
-
-    // type 决定使用 32 位还是 64 位原子语义。
-    zType* type = GET_TYPE(typeIdx);
-    void* addr = reinterpret_cast<void*>(GET_REG(addrReg).value);
-    uint64_t value = GET_REG(valueReg).value;
-
-    // 默认旧值 0，只有在地址和类型都有效时才执行原子交换。
-    uint64_t oldValue = 0;
-    if (addr && type) {
-        // 按类型宽度选择 32/64 位原子实现。
-        switch (type->size) {
-            case 4:
-                oldValue = atomic_exchange(static_cast<uint32_t*>(addr), static_cast<uint32_t>(value));
-                break;
-            case 8:
-                oldValue = atomic_exchange(static_cast<uint64_t*>(addr), value);
-                break;
-            default:
-                // 其它宽度当前不支持，返回默认旧值 0。
-                break;
-        }
-    }
-
-    GET_REG(resultReg).value = oldValue;
-
-    // 指令长度固定 5 words。
-    ctx->pc += 5;
+    vmAtomicReadModifyWrite<kVmChecked, kVmCompact>(ctx, OP_ATOMIC_XCHG);
 }
 
 // OP_ATOMIC_CAS：执行原子比较交换并返回交换前值。
+template <bool kVmChecked, bool kVmCompact>
 void op_atomic_cas(VMContext* ctx) {
-    // 参数槽位：[pc+1]=type_idx, [pc+2]=addr_reg, [pc+3]=expected_reg, [pc+4]=new_reg, [pc+5]=result_reg
+    // 参数槽位：[pc+1]=type_idx, [pc+2]=addr_reg, [pc+3]=expected_reg, [pc+4]=new_reg, [pc+5]=mem_order, [pc+6]=result_reg
     uint32_t typeIdx = GET_INST(1);
     uint32_t addrReg = GET_INST(2);
     uint32_t expectedReg = GET_INST(3);
     uint32_t newReg = GET_INST(4);
-    uint32_t resultReg = GET_INST(5);
+    uint32_t memOrder = GET_INST(5);
+    uint32_t resultReg = GET_INST(6);
 
-    zType* type = GET_TYPE(typeIdx);
-    void* addr = reinterpret_cast<void*>(GET_REG(addrReg).value);
-    uint64_t expected = GET_REG(expectedReg).value;
-    uint64_t newVal = GET_REG(newReg).value;
+    const zType* type = GET_TYPE(typeIdx);
+    void* addr = reinterpret_cast<void*>(GET_REG(addrReg));
+    // expected/new 越界视作零寄存器。
+    uint64_t expected = (expectedReg < ctx->register_count) ? GET_REG(expectedReg) : 0;
+    uint64_t newVal = (newReg < ctx->register_count) ? GET_REG(newReg) : 0;
+    const int order = atomic_order_from_vm(memOrder);
 
     // 若类型不支持，返回 expected，等价于“未交换”语义。
     uint64_t oldValue = expected;
     if (addr && type) {
-        // 按类型宽度选择 32/64 位 CAS。
+        // 按类型宽度选择 CAS（窄宽度只比较低位，与 CASB/CASH 一致）。
         switch (type->size) {
+            case 1:
+                oldValue = atomic_cas_ordered<uint8_t>(addr,
+                    static_cast<uint8_t>(expected), static_cast<uint8_t>(newVal), order);
+                break;
+            case 2:
+                oldValue = atomic_cas_ordered<uint16_t>(addr,
+                    static_cast<uint16_t>(expected), static_cast<uint16_t>(newVal), order);
+                break;
             case 4:
-                oldValue = atomic_compare_exchange(static_cast<uint32_t*>(addr), 
-                    static_cast<uint32_t>(expected), static_cast<uint32_t>(newVal));
+                oldValue = atomic_cas_ordered<uint32_t>(addr,
+                    static_cast<uint32_t>(expected), static_cast<uint32_t>(newVal), order);
                 break;
             case 8:
-                oldValue = atomic_compare_exchange(static_cast<uint64_t*>(addr), expected, newVal);
+                oldValue = atomic_cas_ordered<uint64_t>(addr, expected, newVal, order);
                 break;
             default:
                 // 其它宽度当前不支持，返回 expected。
@@ -2443,26 +2790,79 @@ void op_atomic_cas(VMContext* ctx) {
         }
     }
 
-    GET_REG(resultReg).value = oldValue;
+    if (resultReg < ctx->register_count) {
+        GET_REG(resultReg) = oldValue;
+        REG_OWNED(resultReg) = 0;
+    }
 
-    ctx->pc += 6;
+    // 指令长度固定 7 words。
+    ctx->pc += 7;
 }
 
-// OP_FENCE：执行全内存栅栏。
+// OP_FENCE：按内存序执行线程栅栏（DMB ISH/ISHLD/ISHST 分别对应 seq_cst/acquire/release）。
+template <bool kVmChecked, bool kVmCompact>
 void op_fence(VMContext* ctx) {
-    // 全栅栏用于约束该线程内存访问重排。
-    atomic_fence();
-    // 本指令无参数，长度固定 1。
-    ctx->pc += 1;
+    // 参数槽位：[pc+1]=mem_order
+    const uint32_t memOrder = GET_INST(1);
+    // relaxed 栅栏无约束，直接跳过。
+    if (memOrder != VM_MEM_ORDER_RELAXED) {
+        __atomic_thread_fence(atomic_order_from_vm(memOrder));
+    }
+    // 指令长度固定 2 words。
+    ctx->pc += 2;
 }
 
 // OP_UNREACHABLE：触发不可达错误并停止执行。
+template <bool kVmChecked, bool kVmCompact>
 void op_unreachable(VMContext* ctx) {
     // 打印错误后立刻停机，避免继续执行损坏状态。
     std::cerr << "[VM ERROR] Reached unreachable code at pc=" << ctx->pc << std::endl;
     ctx->running = false;
 }
 
+// 类型特化 opcode 通用实现：[op][a][b][c] 固定 4 words，含义随 kKind 变化（见 VM_TYPED_OPCODE_LIST）。
+template <bool kVmChecked, bool kVmCompact, uint32_t kKind, uint32_t kOp, uint32_t kWidth, bool kSigned>
+static inline void op_typed(VMContext* ctx) {
+    const uint32_t a = GET_INST(1);
+    const uint32_t b = GET_INST(2);
+    const uint32_t c = GET_INST(3);
+    if (kKind == VM_TYPED_BINARY) {
+        // a=lhs_reg, b=rhs_reg, c=dst_reg。
+        const uint64_t lhs = GET_REG(a);
+        const uint64_t rhs = GET_REG(b);
+        GET_REG(c) = execTypedBinary<kOp, kWidth, kSigned>(lhs, rhs);
+    } else if (kKind == VM_TYPED_BINARY_IMM) {
+        // a=lhs_reg, b=imm（零扩展）, c=dst_reg。
+        GET_REG(c) = execTypedBinary<kOp, kWidth, kSigned>(GET_REG(a), static_cast<uint64_t>(b));
+    } else if (kKind == VM_TYPED_LOAD) {
+        // a=base_reg, b=offset（有符号）, c=dst_reg；空基址与 OP_GET_FIELD 一致读出 0。
+        const uint64_t base = GET_REG(a);
+        if (base == 0) {
+            GET_REG(c) = 0;
+            REG_OWNED(c) = 0;
+        } else {
+            GET_REG(c) = typedLoad<kWidth, kSigned>(base + static_cast<int32_t>(b));
+        }
+    } else {
+        // a=base_reg, b=offset（有符号）, c=value_reg（越界为零寄存器）；空基址与 OP_SET_FIELD 一致跳过。
+        const uint64_t base = GET_REG(a);
+        if (base != 0) {
+            const uint64_t value = (c < ctx->register_count) ? GET_REG(c) : 0;
+            typedStore<kWidth>(base + static_cast<int32_t>(b), value);
+        }
+    }
+    ctx->pc += 4;
+}
+
+// 按 VM_TYPED_OPCODE_LIST 为每个条目生成 op_xxx<kVmChecked, kVmCompact> 处理函数模板。
+#define VM_DEFINE_TYPED_HANDLER(opcode, handler, kind, binOp, width, isSigned) \
+template <bool kVmChecked, bool kVmCompact>                                    \
+void handler(VMContext* ctx) {                                                 \
+    op_typed<kVmChecked, kVmCompact, kind, binOp, width, (isSigned) != 0>(ctx); \
+}
+VM_TYPED_OPCODE_LIST(VM_DEFINE_TYPED_HANDLER)
+#undef VM_DEFINE_TYPED_HANDLER
+
 // 未知 opcode 兜底处理：打印警告并终止。
 void op_unknown(VMContext* ctx) {
     // 当前 pc 指向未知 opcode 的首字。
@@ -2472,6 +2872,577 @@ void op_unknown(VMContext* ctx) {
     ctx->running = false;
 }
 
+// ============================================================================
+// 处理函数变体实例化
+// ============================================================================
+// 对外声明的 op_xxx 为检查变体；免检变体只经 g_opcode_table_unchecked 与线程化循环使用。
+#define VM_DEFINE_CHECKED_HANDLER(opcode, handler) \
+void handler(VMContext* ctx) {                     \
+    handler<true, false>(ctx);                     \
+}
+VM_OPCODE_HANDLER_LIST(VM_DEFINE_CHECKED_HANDLER)
+#undef VM_DEFINE_CHECKED_HANDLER
+
+OpcodeHandler g_opcode_table_unchecked[OP_MAX] = {nullptr};
+OpcodeHandler g_opcode_table_compact[OP_MAX] = {nullptr};
+
+// 免检表与紧凑表：与 g_opcode_table 同构；清单外 opcode 不会通过校验，统一落到 op_unknown。
+static void initUncheckedOpcodeTable() {
+    for (uint32_t i = 0; i < OP_MAX; i++) {
+        g_opcode_table_unchecked[i] = op_unknown;
+        g_opcode_table_compact[i] = op_unknown;
+    }
+#define VM_REGISTER_UNCHECKED_HANDLER(opcode, handler) \
+    g_opcode_table_unchecked[opcode] = handler<false, false>; \
+    g_opcode_table_compact[opcode] = handler<false, true>;
+    VM_OPCODE_HANDLER_LIST(VM_REGISTER_UNCHECKED_HANDLER)
+#undef VM_REGISTER_UNCHECKED_HANDLER
+}
+
+// ============================================================================
+// 预解码快速处理函数
+// ============================================================================
+// 记录中的寄存器下标均已在 buildDecodedFunction 中校验，此处直接索引寄存器值数组与 ownership 侧表。
+#define DREG(idx) (ctx->registers[(idx)])
+#define DREG_OWNED(idx) (ctx->reg_owned[(idx)])
+
+// 从 pc 反查表回到记录流；无法承接时返回 nullptr，交由 word 解释循环继续。
+static inline const VMDecodedInst* decodedResume(VMContext* ctx) {
+    if (!ctx->running || ctx->pc >= ctx->inst_count) {
+        return nullptr;
+    }
+    const uint32_t index = ctx->decoded_pc_index[ctx->pc];
+    if (index == kVmDecodedInvalidIndex) {
+        return nullptr;
+    }
+    return ctx->decoded_list + index;
+}
+
+// 通用回退：按原 pc 执行 word 处理函数。
+const VMDecodedInst* op_generic_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    ctx->pc = inst->pc;
+    const OpcodeHandler* table = selectOpcodeTable(ctx);
+    if (inst->opcode < OP_MAX && table[inst->opcode]) {
+        table[inst->opcode](ctx);
+    } else {
+        op_unknown(ctx);
+    }
+    return decodedResume(ctx);
+}
+
+// 顺序后继。
+const VMDecodedInst* op_next_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    (void)ctx;
+    return inst + 1;
+}
+
+// 末尾哨兵：与 word 循环“pc 越界即结束”保持一致。
+const VMDecodedInst* op_halt_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    ctx->pc = inst->pc;
+    return nullptr;
+}
+
+// 停机。
+const VMDecodedInst* op_stop_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    ctx->pc = inst->pc;
+    ctx->running = false;
+    return nullptr;
+}
+
+// OP_END。
+const VMDecodedInst* op_end_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    ctx->pc = inst->pc;
+    ctx->running = false;
+    return nullptr;
+}
+
+// OP_RETURN。
+const VMDecodedInst* op_return_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    if (inst->operands[0]) {
+        ctx->ret_value = DREG(inst->operands[1]);
+        DREG_OWNED(inst->operands[1]) = 0;
+    }
+    ctx->pc = inst->pc;
+    ctx->running = false;
+    return nullptr;
+}
+
+// OP_MOV。
+const VMDecodedInst* op_mov_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    DREG(inst->operands[1]) = DREG(inst->operands[0]);
+    DREG_OWNED(inst->operands[1]) = 0;
+    return inst + 1;
+}
+
+// OP_LOAD_IMM。
+const VMDecodedInst* op_load_imm_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    DREG(inst->operands[0]) = inst->operands[1];
+    DREG_OWNED(inst->operands[0]) = 0;
+    return inst + 1;
+}
+
+// OP_LOAD_CONST / OP_LOAD_CONST64。
+const VMDecodedInst* op_load_const_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    DREG(inst->operands[0]) =
+            static_cast<uint64_t>(inst->operands[1]) | (static_cast<uint64_t>(inst->operands[2]) << 32);
+    return inst + 1;
+}
+
+// 二元运算后的标志位更新（与 op_binary / op_binary_imm 策略一致）。
+static inline void updateBinaryFlags(VMContext* ctx, uint32_t actualOp, uint64_t lhs, uint64_t rhs,
+                                     uint64_t result, const zType* type) {
+    const bool is64 = (type && type->size == 8);
+    if (actualOp == BIN_SUB)
+        setFlagsFromSub(ctx, lhs, rhs, result, is64);
+    else if (actualOp == BIN_ADD)
+        setFlagsFromAdd(ctx, lhs, rhs, result, is64);
+    else
+        setFlagsFromResultNZ(ctx, result, type);
+}
+
+// OP_BINARY。
+const VMDecodedInst* op_binary_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    const uint32_t subOp = inst->operands[0];
+    const uint32_t actualOp = subOp & 0x3Fu;
+    const uint64_t lhs = DREG(inst->operands[1]);
+    const uint64_t rhs = DREG(inst->operands[2]);
+    const uint64_t result = execBinaryOp(actualOp, lhs, rhs, inst->type);
+    DREG(inst->operands[3]) = result;
+    if (subOp & BIN_UPDATE_FLAGS) {
+        updateBinaryFlags(ctx, actualOp, lhs, rhs, result, inst->type);
+    }
+    return inst + 1;
+}
+
+// OP_BINARY_IMM。
+const VMDecodedInst* op_binary_imm_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    const uint32_t subOp = inst->operands[0];
+    const uint32_t actualOp = subOp & 0x3Fu;
+    const uint64_t lhs = DREG(inst->operands[1]);
+    const uint64_t rhs = static_cast<uint64_t>(inst->operands[2]);
+    const uint64_t result = execBinaryOp(actualOp, lhs, rhs, inst->type);
+    DREG(inst->operands[3]) = result;
+    if (subOp & BIN_UPDATE_FLAGS) {
+        updateBinaryFlags(ctx, actualOp, lhs, rhs, result, inst->type);
+    }
+    return inst + 1;
+}
+
+// OP_CMP。
+const VMDecodedInst* op_cmp_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    const zType* type = inst->type;
+    const uint64_t lhs = DREG(inst->operands[0]);
+    const uint64_t rhs = DREG(inst->operands[1]);
+    DREG(inst->operands[2]) = execCompareOp(inst->operands[3], lhs, rhs, type);
+    if (type && !type->is_float) {
+        const bool is64 = (type->size == 8);
+        uint64_t diff = lhs - rhs;
+        if (!is64) diff &= 0xFFFFFFFFu;
+        setFlagsFromSub(ctx, lhs, rhs, diff, is64);
+    }
+    return inst + 1;
+}
+
+// OP_GET_FIELD。
+const VMDecodedInst* op_get_field_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    uint64_t& dst = DREG(inst->operands[2]);
+    const uint64_t base = DREG(inst->operands[0]);
+    if (base == 0) {
+        dst = 0;
+        DREG_OWNED(inst->operands[2]) = 0;
+        return inst + 1;
+    }
+    const zType* type = inst->type;
+    if (type) {
+        void* fieldAddr = reinterpret_cast<void*>(base + static_cast<int32_t>(inst->operands[1]));
+        switch (type->size) {
+            case 1: dst = *static_cast<uint8_t*>(fieldAddr); break;
+            case 2: dst = *static_cast<uint16_t*>(fieldAddr); break;
+            case 4: dst = *static_cast<uint32_t*>(fieldAddr); break;
+            default: dst = *static_cast<uint64_t*>(fieldAddr); break;
+        }
+    }
+    return inst + 1;
+}
+
+// OP_SET_FIELD。
+const VMDecodedInst* op_set_field_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    const uint64_t base = DREG(inst->operands[0]);
+    const zType* type = inst->type;
+    if (base == 0 || type == nullptr) {
+        return inst + 1;
+    }
+    const uint32_t valueReg = inst->operands[2];
+    const uint64_t value = (valueReg < ctx->register_count) ? DREG(valueReg) : 0;
+    void* fieldAddr = reinterpret_cast<void*>(base + static_cast<int32_t>(inst->operands[1]));
+    switch (type->size) {
+        case 1: *static_cast<uint8_t*>(fieldAddr) = static_cast<uint8_t>(value); break;
+        case 2: *static_cast<uint16_t*>(fieldAddr) = static_cast<uint16_t>(value); break;
+        case 4: *static_cast<uint32_t*>(fieldAddr) = static_cast<uint32_t>(value); break;
+        default: *static_cast<uint64_t*>(fieldAddr) = value; break;
+    }
+    return inst + 1;
+}
+
+// 类型特化 opcode：operands = {a, b, c}，含义同 op_typed。
+template <uint32_t kKind, uint32_t kOp, uint32_t kWidth, bool kSigned>
+static const VMDecodedInst* op_typed_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    const uint32_t a = inst->operands[0];
+    const uint32_t b = inst->operands[1];
+    const uint32_t c = inst->operands[2];
+    if (kKind == VM_TYPED_BINARY) {
+        DREG(c) = execTypedBinary<kOp, kWidth, kSigned>(DREG(a), DREG(b));
+    } else if (kKind == VM_TYPED_BINARY_IMM) {
+        DREG(c) = execTypedBinary<kOp, kWidth, kSigned>(DREG(a), static_cast<uint64_t>(b));
+    } else if (kKind == VM_TYPED_LOAD) {
+        const uint64_t base = DREG(a);
+        if (base == 0) {
+            DREG(c) = 0;
+            DREG_OWNED(c) = 0;
+        } else {
+            DREG(c) = typedLoad<kWidth, kSigned>(base + static_cast<int32_t>(b));
+        }
+    } else {
+        const uint64_t base = DREG(a);
+        if (base != 0) {
+            typedStore<kWidth>(base + static_cast<int32_t>(b), (c < ctx->register_count) ? DREG(c) : 0);
+        }
+    }
+    return inst + 1;
+}
+
+DecodedHandler getTypedDecodedHandler(uint32_t opcode) {
+    switch (opcode) {
+#define VM_TYPED_DECODED_CASE(opcode, handler, kind, binOp, width, isSigned) \
+        case opcode: return op_typed_decoded<kind, binOp, width, (isSigned) != 0>;
+        VM_TYPED_OPCODE_LIST(VM_TYPED_DECODED_CASE)
+#undef VM_TYPED_DECODED_CASE
+        default: return nullptr;
+    }
+}
+
+// OP_READ。
+const VMDecodedInst* op_read_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    readValue(&DREG(inst->operands[1]), inst->type, &DREG(inst->operands[0]), &DREG_OWNED(inst->operands[0]));
+    return inst + 1;
+}
+
+// OP_WRITE。
+const VMDecodedInst* op_write_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    writeValue(&DREG(inst->operands[0]), inst->type, &DREG(inst->operands[1]));
+    return inst + 1;
+}
+
+// OP_BRANCH。
+const VMDecodedInst* op_branch_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    return ctx->decoded_list + inst->target;
+}
+
+// OP_BRANCH_IF。
+const VMDecodedInst* op_branch_if_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    return ctx->decoded_list + (DREG(inst->operands[0]) ? inst->target : inst->alt_target);
+}
+
+// OP_BRANCH_IF_CC。
+const VMDecodedInst* op_branch_if_cc_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    return evaluateCondition(ctx, inst->operands[0]) ? ctx->decoded_list + inst->target : inst + 1;
+}
+
+// OP_SWITCH：case 值为 32 位 word，寄存器值超出 32 位时必然落到默认目标。
+const VMDecodedInst* op_switch_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    const uint64_t value = DREG(inst->operands[0]);
+    const uint32_t* table = ctx->decoded_switch_pool + inst->operands[2];
+    const uint32_t count = inst->operands[3];
+    uint32_t record = inst->target;
+    switch (inst->operands[1]) {
+        case VM_SWITCH_DENSE: {
+            // table[0] = 最小 case 值，其后 count 个槽位为记录下标（空洞已填默认目标）。
+            const uint64_t delta = value - table[0];
+            if (value >= table[0] && delta < count) {
+                record = table[1 + delta];
+            }
+            break;
+        }
+        case VM_SWITCH_SPARSE: {
+            // [value, record] 升序，二分查找。
+            uint32_t lo = 0;
+            uint32_t hi = count;
+            while (lo < hi) {
+                const uint32_t mid = lo + (hi - lo) / 2;
+                const uint32_t caseValue = table[mid * 2];
+                if (caseValue < value) {
+                    lo = mid + 1;
+                } else if (caseValue > value) {
+                    hi = mid;
+                } else {
+                    record = table[mid * 2 + 1];
+                    break;
+                }
+            }
+            break;
+        }
+        default:
+            for (uint32_t i = 0; i < count; ++i) {
+                if (table[i * 2] == value) {
+                    record = table[i * 2 + 1];
+                    break;
+                }
+            }
+            break;
+    }
+    return ctx->decoded_list + record;
+}
+
+// 调用点缓存查找：命中返回槽位，未命中返回 nullptr。
+static inline const VMCallSiteEntry* callSiteLookup(const VMCallSiteCache& site, uint64_t target) {
+    for (uint32_t i = 0; i < kVmCallSiteWays; ++i) {
+        const VMCallSiteEntry& entry = site.entries[i];
+        const uint64_t cached = entry.target.load(std::memory_order_acquire);
+        if (cached == target) {
+            return &entry;
+        }
+        if (cached == 0) {
+            // 槽位按序填充：遇到空槽即说明后面没有已发布目标。
+            break;
+        }
+    }
+    return nullptr;
+}
+
+// 未命中时解析目标类别（与 op_call 的判定顺序一致）；无法由快速路径承接时返回 false。
+static bool resolveCallTarget(VMContext* ctx, uint64_t target, uint32_t& kind, uint64_t& payload) {
+    if (ctx->branch_id_list != nullptr && target < ctx->branch_count) {
+        // 函数内 branchId：目标必须是记录起点，否则交给通用路径。
+        const uint32_t targetPc = ctx->branch_id_list[static_cast<uint32_t>(target)];
+        if (targetPc >= ctx->inst_count || ctx->decoded_pc_index[targetPc] == kVmDecodedInvalidIndex) {
+            return false;
+        }
+        kind = VM_CALL_TARGET_LOCAL;
+        payload = ctx->decoded_pc_index[targetPc];
+        return true;
+    }
+    if (zVmEngine::getInstance().resolveProtectedTarget(ctx, target, payload)) {
+        kind = VM_CALL_TARGET_PROTECTED;
+        return true;
+    }
+    kind = VM_CALL_TARGET_NATIVE;
+    payload = 0;
+    return true;
+}
+
+// 把解析结果写入空槽；槽位已满时标记超多态。并发写者经 CAS 占槽，同一目标可能占用两个槽，不影响正确性。
+static void callSiteInstall(VMCallSiteCache& site, uint64_t target, uint32_t kind, uint64_t payload) {
+    if (target == kVmCallSiteFilling) {
+        return;
+    }
+    for (uint32_t i = 0; i < kVmCallSiteWays; ++i) {
+        VMCallSiteEntry& entry = site.entries[i];
+        uint64_t expected = 0;
+        if (entry.target.compare_exchange_strong(expected, kVmCallSiteFilling, std::memory_order_acquire)) {
+            entry.kind = kind;
+            entry.payload = payload;
+            entry.target.store(target, std::memory_order_release);
+            return;
+        }
+        if (expected == target) {
+            return;
+        }
+    }
+    site.megamorphic.store(1, std::memory_order_relaxed);
+}
+
+// OP_CALL / OP_CALL_INDIRECT：内联缓存命中时跳过目标类别判定与参数个数分派。
+const VMDecodedInst* op_call_decoded(VMContext* ctx, const VMDecodedInst* inst) {
+    const uint32_t typeMask = inst->operands[1];
+    const uint32_t resultReg = inst->operands[2];
+    const uint64_t target = DREG(inst->operands[3]);
+    // 空函数指针：若有返回值位，则返回 0 并继续。
+    if (target == 0) {
+        if (typeMask & 0x1) {
+            DREG(resultReg) = 0;
+        }
+        return inst + 1;
+    }
+
+    VMCallSiteCache& site = ctx->call_sites[inst->target];
+    uint32_t kind = 0;
+    uint64_t payload = 0;
+    if (const VMCallSiteEntry* hit = callSiteLookup(site, target)) {
+        kind = hit->kind;
+        payload = hit->payload;
+    } else if (site.megamorphic.load(std::memory_order_relaxed) != 0 ||
+               !resolveCallTarget(ctx, target, kind, payload)) {
+        // 超多态或快速路径无法承接：走通用处理函数。
+        return op_generic_decoded(ctx, inst);
+    } else {
+        callSiteInstall(site, target, kind, payload);
+    }
+
+    // 函数内调用：LR 已由前一条 OP_LOAD_IMM 填好，直接转到目标记录。
+    if (kind == VM_CALL_TARGET_LOCAL) {
+        return ctx->decoded_list + payload;
+    }
+
+    // executeNested 按 x0..x7 取参。
+    static_assert(kVmCallSiteMaxParams == 8, "call site params must match nested call arg count");
+    uint64_t args[kVmCallSiteMaxParams] = {0};
+    for (uint32_t i = 0; i < site.param_count; ++i) {
+        args[i] = DREG(site.param_regs[i]);
+    }
+    uint64_t callResult = 0;
+    // 受保护函数：嵌套 VM 调用；被调函数已不在缓存时回退原生调用。
+    if (kind != VM_CALL_TARGET_PROTECTED ||
+        !zVmEngine::getInstance().executeNested(ctx, payload, args, 0, callResult)) {
+        callResult = site.thunk(target, args);
+    }
+    if (typeMask & 0x1) {
+        DREG(resultReg) = callResult;
+        DREG_OWNED(resultReg) = 0;
+    }
+    return inst + 1;
+}
+
+#undef DREG
+
+// 预解码解释循环。
+void runDecoded(VMContext* ctx) {
+    if (ctx == nullptr || ctx->decoded_list == nullptr || ctx->decoded_pc_index == nullptr) {
+        return;
+    }
+    const VMDecodedInst* inst = decodedResume(ctx);
+    while (inst != nullptr) {
+        inst = inst->handler(ctx, inst);
+    }
+}
+
+// ============================================================================
+// 线程化解释循环
+// ============================================================================
+
+// 编译期校验：静态清单需从 0 开始按 opcode 连续排列，标签表才能直接按 opcode 下标取址。
+#define VM_LIST_OPCODE_VALUE(opcode, handler) static_cast<uint32_t>(opcode),
+static constexpr uint32_t kThreadedOpcodeOrder[] = { VM_OPCODE_HANDLER_LIST(VM_LIST_OPCODE_VALUE) };
+#undef VM_LIST_OPCODE_VALUE
+static constexpr uint32_t kThreadedOpcodeCount =
+        static_cast<uint32_t>(sizeof(kThreadedOpcodeOrder) / sizeof(kThreadedOpcodeOrder[0]));
+
+static constexpr bool isThreadedOpcodeOrderDense() {
+    for (uint32_t i = 0; i < kThreadedOpcodeCount; ++i) {
+        if (kThreadedOpcodeOrder[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(kThreadedOpcodeCount <= OP_MAX, "VM_OPCODE_HANDLER_LIST exceeds OP_MAX");
+static_assert(isThreadedOpcodeOrderDense(), "VM_OPCODE_HANDLER_LIST must be dense and sorted by opcode");
+
+// 线程化循环取当前 opcode：紧凑变体读 16 位槽位，其余读 word 流。
+template <bool kVmCompact>
+static inline uint32_t vmThreadedOpcode(const VMContext* ctx) {
+    if (kVmCompact) {
+        return vmCompactWord(ctx->compact_instructions, ctx->compact_wide_pool, ctx->pc);
+    }
+    return ctx->instructions[ctx->pc];
+}
+
+// 清单外 opcode 的兜底表与处理函数变体保持一致。
+template <bool kVmChecked, bool kVmCompact>
+static inline const OpcodeHandler* vmThreadedFallbackTable() {
+    if (kVmCompact) {
+        return g_opcode_table_compact;
+    }
+    return kVmChecked ? g_opcode_table : g_opcode_table_unchecked;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+
+// 线程化分发：每个标签尾部各自内联一份“取下一条 opcode + 间接跳转”，
+// 让分支预测器按“上一条 opcode”区分跳转历史；未列出的 opcode 走 g_opcode_table 兜底。
+#define VM_THREADED_NEXT()                                                        \
+    do {                                                                          \
+        if (!ctx->running || ctx->pc >= ctx->inst_count) {                        \
+            return;                                                               \
+        }                                                                         \
+        opcode = vmThreadedOpcode<kVmCompact>(ctx);                               \
+        goto* (opcode < kThreadedOpcodeCount ? kLabels[opcode] : &&L_TABLE);      \
+    } while (0)
+
+template <bool kVmChecked, bool kVmCompact>
+static void runThreadedLoop(VMContext* ctx) {
+    const OpcodeHandler* const table = vmThreadedFallbackTable<kVmChecked, kVmCompact>();
+
+    // 标签表：下标即 opcode，与 VM_OPCODE_HANDLER_LIST 顺序一一对应。
+#define VM_LIST_LABEL_ADDR(opcode, handler) &&L_##opcode,
+    static void* const kLabels[kThreadedOpcodeCount] = { VM_OPCODE_HANDLER_LIST(VM_LIST_LABEL_ADDR) };
+#undef VM_LIST_LABEL_ADDR
+
+    uint32_t opcode = 0;
+    VM_THREADED_NEXT();
+
+    // 每个 opcode 一个标签：直接调用处理函数（同编译单元，可被内联），随后就地分发下一条。
+#define VM_LIST_LABEL_BODY(opcode, handler) \
+L_##opcode:                                 \
+    handler<kVmChecked, kVmCompact>(ctx);   \
+    VM_THREADED_NEXT();
+    VM_OPCODE_HANDLER_LIST(VM_LIST_LABEL_BODY)
+#undef VM_LIST_LABEL_BODY
+
+L_TABLE:
+    // 清单外 opcode：保持与 dispatch 一致的查表语义。
+    if (opcode < OP_MAX && table[opcode]) {
+        table[opcode](ctx);
+    } else {
+        op_unknown(ctx);
+    }
+    VM_THREADED_NEXT();
+}
+
+#undef VM_THREADED_NEXT
+
+#else
+
+// 非 GCC/Clang：退化为 switch 循环，仍省去 dispatch 的函数调用与重复检查。
+template <bool kVmChecked, bool kVmCompact>
+static void runThreadedLoop(VMContext* ctx) {
+    const OpcodeHandler* const table = vmThreadedFallbackTable<kVmChecked, kVmCompact>();
+    while (ctx->running && ctx->pc < ctx->inst_count) {
+        const uint32_t opcode = vmThreadedOpcode<kVmCompact>(ctx);
+        switch (opcode) {
+#define VM_LIST_SWITCH_CASE(opcode, handler) \
+            case opcode: handler<kVmChecked, kVmCompact>(ctx); break;
+            VM_OPCODE_HANDLER_LIST(VM_LIST_SWITCH_CASE)
+#undef VM_LIST_SWITCH_CASE
+            default:
+                if (opcode < OP_MAX && table[opcode]) {
+                    table[opcode](ctx);
+                } else {
+                    op_unknown(ctx);
+                }
+                break;
+        }
+    }
+}
+
+#endif
+
+void runThreaded(VMContext* ctx) {
+    if (ctx == nullptr) {
+        return;
+    }
+    // 变体在入口处一次性选定：紧凑流（必然已校验）> 已校验 word 流 > 检查模式。
+    if (ctx->compact_instructions != nullptr && ctx->instructions == nullptr) {
+        runThreadedLoop<false, true>(ctx);
+    } else if (ctx->instructions == nullptr) {
+        return;
+    } else if (ctx->verified) {
+        runThreadedLoop<false, false>(ctx);
+    } else {
+        runThreadedLoop<true, false>(ctx);
+    }
+}
+
 } // namespace vm
 
 
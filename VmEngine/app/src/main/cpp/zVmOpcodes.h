@@ -10,73 +10,8 @@
 
 #include "zVmEngine.h"
 
-// ============================================================================
-// Opcode 定义
-// ============================================================================
-enum Opcode : uint32_t {
-    OP_END            = 0,
-    OP_BINARY         = 1,      // 二元运算
-    OP_TYPE_CONVERT   = 2,      // 类型转换
-    OP_LOAD_CONST     = 3,      // 加载常量
-    OP_STORE_CONST    = 4,      // 存储常量
-    OP_GET_ELEMENT    = 5,      // 获取数组元素
-    OP_ALLOC_RETURN   = 6,      // 申请一块用于存放返回值的内存；首条指令必须为本指令
-    OP_STORE          = 7,      // 写入内存
-    OP_LOAD_CONST64   = 8,      // 加载64位常量
-    OP_NOP            = 9,      // 空操作
-    OP_COPY           = 10,     // 复制值
-    OP_GET_FIELD      = 11,     // 获取字段
-    OP_CMP            = 12,     // 比较运算
-    OP_SET_FIELD      = 13,     // 设置字段
-    OP_RESTORE_REG    = 14,     // 恢复寄存器
-    OP_CALL           = 15,     // 函数调用
-    OP_RETURN         = 16,     // 返回
-    OP_BRANCH         = 17,     // 无条件跳转
-    OP_BRANCH_IF      = 18,     // 条件跳转
-    OP_ALLOC_MEMORY   = 19,     // 分配单对象
-    OP_MOV            = 20,     // 寄存器移动
-    OP_LOAD_IMM       = 21,     // 加载立即数
-    OP_DYNAMIC_CAST   = 22,     // 动态类型转换
-    OP_UNARY          = 23,     // 一元运算
-    OP_PHI            = 24,     // PHI 节点
-    OP_SELECT         = 25,     // 条件选择
-    OP_MEMCPY         = 26,     // 内存拷贝
-    OP_MEMSET         = 27,     // 内存设置
-    OP_STRLEN         = 28,     // 字符串长度
-    OP_FETCH_NEXT     = 29,     // 取下一条
-    OP_CALL_INDIRECT  = 30,     // 间接调用
-    OP_SWITCH         = 31,     // 多路分支跳转
-    OP_GET_PTR        = 32,     // 获取指针
-    OP_BITCAST        = 33,     // 位转换
-    OP_SIGN_EXTEND    = 34,     // 符号扩展
-    OP_ZERO_EXTEND    = 35,     // 零扩展
-    OP_TRUNCATE       = 36,     // 截断
-    OP_FLOAT_EXTEND   = 37,     // 浮点扩展
-    OP_FLOAT_TRUNCATE = 38,     // 浮点截断
-    OP_INT_TO_FLOAT   = 39,     // 整数转浮点
-    OP_ARRAY_ELEM     = 40,     // 数组元素
-    OP_FLOAT_TO_INT   = 41,     // 浮点转整数
-    OP_READ           = 42,     // 读取内存
-    OP_WRITE          = 43,     // 写入内存
-    OP_LEA            = 44,     // 计算地址
-    OP_ATOMIC_ADD     = 45,     // 原子加
-    OP_ATOMIC_SUB     = 46,     // 原子减
-    OP_ATOMIC_XCHG    = 47,     // 原子交换
-    OP_ATOMIC_CAS     = 48,     // 原子比较交换
-    OP_FENCE          = 49,     // 内存屏障
-    OP_UNREACHABLE    = 50,     // 不可达
-    OP_ALLOC_VSP      = 51,     // 动态申请虚拟栈（堆上），紧接 OP_ALLOC_RETURN 后
-    OP_BINARY_IMM     = 52,     // 二元运算（寄存器 + 立即数），结果写入目标寄存器
-    OP_BRANCH_IF_CC   = 53,     // 按 NZCV 条件码跳转到 branch_list[branchId]
-    OP_SET_RETURN_PC  = 54,     // 运行时写入返回地址寄存器（dstReg = 当前 pc + offset）
-    OP_BL             = 55,     // 带链接跳转（branchId -> branches[branchId]）
-    OP_ADRP           = 56,     // 基于模块基址 + 页偏移计算地址
-    OP_ATOMIC_LOAD    = 57,     // 原子读取（带内存序）
-    OP_ATOMIC_STORE   = 58,     // 原子写入（带内存序）
-    OP_BRANCH_REG     = 59,     // 间接跳转（目标地址由寄存器给出）
-
-    OP_MAX            = 64      // 最大 opcode 数量
-};
+// opcode 编号、类型特化清单、VMTypedKind、BinaryOp 与指令长度规则与翻译端共用。
+#include "shared/bytecode/zVmBytecodeProtocol.h"
 
 // 条件码（与 AArch64/capstone AArch64CC_CondCode 数值一致，供 OP_BRANCH_IF_CC 使用）
 enum VMConditionCode : uint32_t {
@@ -85,7 +20,8 @@ enum VMConditionCode : uint32_t {
     CC_GT = 0xc, CC_LE = 0xd, CC_AL = 0xe, CC_NV = 0xf
 };
 
-// 原子内存序（映射到 __ATOMIC_* 常量，供 OP_ATOMIC_LOAD/STORE 使用）
+// 原子内存序（映射到 __ATOMIC_* 常量，供全部 OP_ATOMIC_* 与 OP_FENCE 使用）
+// OP_FENCE 约定：DMB ISH -> SEQ_CST，DMB ISHLD -> ACQUIRE，DMB ISHST -> RELEASE。
 enum VMMemoryOrder : uint32_t {
     VM_MEM_ORDER_RELAXED = 0,   // relaxed
     VM_MEM_ORDER_ACQUIRE = 1,   // acquire
@@ -94,24 +30,8 @@ enum VMMemoryOrder : uint32_t {
     VM_MEM_ORDER_SEQ_CST = 4,   // seq_cst
 };
 
-// ============================================================================
-// 二元运算子操作码
-// ============================================================================
-enum BinaryOp : uint32_t {
-    BIN_XOR  = 0,     // 异或
-    BIN_SUB  = 1,     // 减法
-    BIN_ASR  = 2,     // 算术右移
-    BIN_DIV  = 3,     // 除法（浮点/整数）
-    BIN_ADD  = 4,     // 加法
-    BIN_OR   = 5,     // 或
-    BIN_MOD  = 6,     // 取模
-    BIN_IDIV = 7,     // 整数除法
-    BIN_FMOD = 8,     // 浮点 fmod / 整数取模
-    BIN_MUL  = 9,     // 乘法
-    BIN_LSR  = 0xA,   // 逻辑右移
-    BIN_SHL  = 0xB,   // 左移
-    BIN_AND  = 0xC,   // 与
-};
+// subOp 高位标记：0x40 表示本条运算需要更新 VM 标志寄存器（对应 ARM64 SUBS/ADDS）。
+#define BIN_UPDATE_FLAGS  0x40u
 
 // ============================================================================
 // 一元运算子操作码
@@ -304,58 +224,158 @@ void op_unreachable(VMContext* ctx);
 void op_alloc_vsp(VMContext* ctx);
 // 二元立即数运算。
 void op_binary_imm(VMContext* ctx);
+// 类型特化处理函数（由 VM_TYPED_OPCODE_LIST 生成）。
+#define VM_TYPED_DECLARE_HANDLER(opcode, handler, kind, binOp, width, isSigned) void handler(VMContext* ctx);
+VM_TYPED_OPCODE_LIST(VM_TYPED_DECLARE_HANDLER)
+#undef VM_TYPED_DECLARE_HANDLER
 
 // 未知 opcode 处理
 // 处理未识别 opcode，通常记录错误并停止执行。
 void op_unknown(VMContext* ctx);
 
+// ============================================================================
+// Opcode -> 处理函数静态清单
+// ============================================================================
+// 必须按 opcode 数值连续升序排列：线程化分发据此直接生成标签表（编译期校验）。
+// 类型特化 opcode 由 VM_TYPED_OPCODE_LIST 追加在末尾；未列出的 opcode 统一回退到 g_opcode_table。
+#define VM_TYPED_OPCODE_AS_HANDLER(X, opcode, handler, kind, binOp, width, isSigned) X(opcode, handler)
+#define VM_OPCODE_HANDLER_LIST(X) \
+    X(OP_END,            op_end) \
+    X(OP_BINARY,         op_binary) \
+    X(OP_TYPE_CONVERT,   op_type_convert) \
+    X(OP_LOAD_CONST,     op_load_const) \
+    X(OP_STORE_CONST,    op_store_const) \
+    X(OP_GET_ELEMENT,    op_get_element) \
+    X(OP_ALLOC_RETURN,   op_alloc_return) \
+    X(OP_STORE,          op_store) \
+    X(OP_LOAD_CONST64,   op_load_const64) \
+    X(OP_NOP,            op_nop) \
+    X(OP_COPY,           op_copy) \
+    X(OP_GET_FIELD,      op_get_field) \
+    X(OP_CMP,            op_cmp) \
+    X(OP_SET_FIELD,      op_set_field) \
+    X(OP_RESTORE_REG,    op_restore_reg) \
+    X(OP_CALL,           op_call) \
+    X(OP_RETURN,         op_return) \
+    X(OP_BRANCH,         op_branch) \
+    X(OP_BRANCH_IF,      op_branch_if) \
+    X(OP_ALLOC_MEMORY,   op_alloc_memory) \
+    X(OP_MOV,            op_mov) \
+    X(OP_LOAD_IMM,       op_load_imm) \
+    X(OP_DYNAMIC_CAST,   op_dynamic_cast) \
+    X(OP_UNARY,          op_unary) \
+    X(OP_PHI,            op_phi) \
+    X(OP_SELECT,         op_select) \
+    X(OP_MEMCPY,         op_memcpy) \
+    X(OP_MEMSET,         op_memset) \
+    X(OP_STRLEN,         op_strlen) \
+    X(OP_FETCH_NEXT,     op_fetch_next) \
+    X(OP_CALL_INDIRECT,  op_call_indirect) \
+    X(OP_SWITCH,         op_switch) \
+    X(OP_GET_PTR,        op_get_ptr) \
+    X(OP_BITCAST,        op_bitcast) \
+    X(OP_SIGN_EXTEND,    op_sign_extend) \
+    X(OP_ZERO_EXTEND,    op_zero_extend) \
+    X(OP_TRUNCATE,       op_truncate) \
+    X(OP_FLOAT_EXTEND,   op_float_extend) \
+    X(OP_FLOAT_TRUNCATE, op_float_truncate) \
+    X(OP_INT_TO_FLOAT,   op_int_to_float) \
+    X(OP_ARRAY_ELEM,     op_array_elem) \
+    X(OP_FLOAT_TO_INT,   op_float_to_int) \
+    X(OP_READ,           op_read) \
+    X(OP_WRITE,          op_write) \
+    X(OP_LEA,            op_lea) \
+    X(OP_ATOMIC_ADD,     op_atomic_add) \
+    X(OP_ATOMIC_SUB,     op_atomic_sub) \
+    X(OP_ATOMIC_XCHG,    op_atomic_xchg) \
+    X(OP_ATOMIC_CAS,     op_atomic_cas) \
+    X(OP_FENCE,          op_fence) \
+    X(OP_UNREACHABLE,    op_unreachable) \
+    X(OP_ALLOC_VSP,      op_alloc_vsp) \
+    X(OP_BINARY_IMM,     op_binary_imm) \
+    X(OP_BRANCH_IF_CC,   op_branch_if_cc) \
+    X(OP_SET_RETURN_PC,  op_set_return_pc) \
+    X(OP_BL,             op_bl) \
+    X(OP_ADRP,           op_adrp) \
+    X(OP_ATOMIC_LOAD,    op_atomic_load) \
+    X(OP_ATOMIC_STORE,   op_atomic_store) \
+    X(OP_BRANCH_REG,     op_branch_reg) \
+    VM_TYPED_OPCODE_SPEC(VM_TYPED_OPCODE_AS_HANDLER, X)
+
 // ============================================================================
 // Opcode 跳转表
 // ============================================================================
 extern OpcodeHandler g_opcode_table[OP_MAX];
+// 免检变体跳转表：处理函数跳过逐操作数边界检查，仅用于 VMContext::verified 为 true 的执行。
+extern OpcodeHandler g_opcode_table_unchecked[OP_MAX];
+// 紧凑变体跳转表：免检处理函数改从 16 位紧凑流取操作数，仅用于 VMContext::compact_instructions 非空的执行。
+extern OpcodeHandler g_opcode_table_compact[OP_MAX];
 
 // 初始化跳转表
-// 将 g_opcode_table 填充为各 opcode 对应处理函数。
+// 将 g_opcode_table / g_opcode_table_unchecked / g_opcode_table_compact 填充为各 opcode 对应处理函数。
 void initOpcodeTable();
 
+// 按上下文选择处理函数变体：紧凑流 > 已校验 > 检查模式。
+inline const OpcodeHandler* selectOpcodeTable(const VMContext* ctx) {
+    if (ctx->compact_instructions != nullptr) {
+        return g_opcode_table_compact;
+    }
+    return ctx->verified ? g_opcode_table_unchecked : g_opcode_table;
+}
+
+// 线程化解释循环：GCC/Clang 下使用 computed goto，每个处理函数执行后直接跳到下一条的标签；
+// 其他编译器回退为 switch 循环。语义与逐条 dispatch 一致，返回时 running=false 或 pc 越界。
+void runThreaded(VMContext* ctx);
+
+// 条件码判定（与 OP_BRANCH_IF_CC 语义一致，按需物化惰性 NZCV）；供基线 JIT 生成代码回调。
+bool evaluateConditionCode(VMContext* ctx, uint32_t cc);
+
 // ============================================================================
 // 辅助函数
 // ============================================================================
 
 // 执行二元运算
 // 按 op 与 type 语义执行二元算术/位运算。
-uint64_t execBinaryOp(uint32_t op, uint64_t lhs, uint64_t rhs, zType* type);
+uint64_t execBinaryOp(uint32_t op, uint64_t lhs, uint64_t rhs, const zType* type);
 
 // 执行一元运算
 // 按 op 与 type 语义执行一元运算。
-uint64_t execUnaryOp(uint32_t op, uint64_t src, zType* type);
+uint64_t execUnaryOp(uint32_t op, uint64_t src, const zType* type);
 
 // 执行比较运算
 // 按比较操作码计算比较结果（通常返回 0/1）。
-uint64_t execCompareOp(uint32_t op, uint64_t lhs, uint64_t rhs, zType* type);
+uint64_t execCompareOp(uint32_t op, uint64_t lhs, uint64_t rhs, const zType* type);
 
 // 执行类型转换
 // 在源类型与目标类型之间执行转换并返回转换后值。
-uint64_t execTypeConvert(uint32_t op, uint64_t src, zType* srcType, zType* dstType);
+uint64_t execTypeConvert(uint32_t op, uint64_t src, const zType* srcType, const zType* dstType);
+
+// 类型特化 opcode 静态描述（与 VM_TYPED_OPCODE_LIST 条目一一对应）。
+struct VMTypedOpcodeInfo {
+    uint32_t kind;        // VMTypedKind
+    uint32_t bin_op;      // 二元算子（读写类为 0）
+    uint32_t width;       // 操作宽度（字节）
+    uint32_t is_signed;   // 有符号除法 / 读取符号扩展
+};
+
+// 查询类型特化 opcode 描述；非特化 opcode 返回 nullptr。
+const VMTypedOpcodeInfo* getTypedOpcodeInfo(uint32_t opcode);
 
 // 调试：opcode 名称（VMP_DEBUG=1 时解释器会打日志）
 // 将 opcode 编号映射为可读名称，用于日志输出。
 const char* getOpcodeName(uint32_t opcode);
 
 // 复制值
-// 按类型信息复制一个槽位到另一个槽位。
-void copyValue(VMRegSlot* src, zType* type, VMRegSlot* dst);
+// 按类型信息把一个寄存器值复制到另一个寄存器值。
+void copyValue(const uint64_t* src, const zType* type, uint64_t* dst);
 
 // 从内存读取值
-// 从 addrSlot 指向地址读取 type 对应大小并写入 dst。
-void readValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* dst);
+// 从 *addrValue 指向地址读取 type 对应大小并写入 dst；返回地址本身时清除 dstOwned（可为空）。
+void readValue(const uint64_t* addrValue, const zType* type, uint64_t* dst, uint8_t* dstOwned);
 
 // 向内存写入值
-// 将 valueSlot 的值按 type 宽度写到 addrSlot 指向地址。
-void writeValue(VMRegSlot* addrSlot, zType* type, VMRegSlot* valueSlot);
-
-// 模块基址设置（供 ADRP 语义使用）。
-void setVmModuleBase(uint64_t base);
+// 将 *valuePtr 按 type 宽度写到 *addrValue 指向地址。
+void writeValue(const uint64_t* addrValue, const zType* type, const uint64_t* valuePtr);
 
 } // namespace vm
 
@@ -0,0 +1,337 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 加载期字节码校验：一次性证明指令流的全部操作数在界内。
+ * - 加固链路位置：cacheFunction 前的准备阶段（与预解码同批执行）。
+ * - 输入：已 loadEncodedData 的 zFunction。
+ * - 输出：校验结论；通过的函数执行时跳过逐操作数检查。
+ */
+#include "zVmVerifier.h"
+
+// zFunction 运行态数组。
+#include "zFunction.h"
+// vmInstructionLength。
+#include "zVmDecoded.h"
+// opcode 常量。
+#include "zVmOpcodes.h"
+// 日志。
+#include "zLog.h"
+// std::vector。
+#include <vector>
+
+namespace {
+
+// 单条指令的校验上下文：所有操作数读取都限定在已证明的指令长度内。
+class VerifyScope {
+public:
+    VerifyScope(const zFunction* function, const std::vector<uint8_t>& heads, uint32_t pc, uint32_t length)
+        : function_(function),
+          heads_(heads),
+          pc_(pc),
+          length_(length) {}
+
+    // 读取指令内第 offset 个 word（调用方保证 offset < length）。
+    uint32_t word(uint32_t offset) const {
+        return function_->inst_list[pc_ + offset];
+    }
+
+    // 指令内第 offset 个 word 是合法寄存器下标。
+    bool reg(uint32_t offset) const {
+        return inRange("reg", offset, function_->register_count);
+    }
+
+    // 指令内第 offset 个 word 是合法类型下标。
+    bool type(uint32_t offset) const {
+        return inRange("type", offset, function_->type_count);
+    }
+
+    // 指令内第 offset 个 word 是合法分支 ID。
+    bool branchId(uint32_t offset) const {
+        return inRange("branch", offset, function_->branch_count);
+    }
+
+    // 指令内第 offset 个 word 是合法 pc 目标：指令起点，或越过末尾（处理函数按顺序执行/停机处理）。
+    bool pcTarget(uint32_t offset) const {
+        if (offset >= length_) {
+            return fail("pc", offset, 0, length_);
+        }
+        const uint32_t target = word(offset);
+        if (target < function_->inst_count && heads_[target] == 0) {
+            return fail("pc", offset, target, function_->inst_count);
+        }
+        return true;
+    }
+
+private:
+    bool inRange(const char* kind, uint32_t offset, uint32_t limit) const {
+        if (offset >= length_) {
+            return fail(kind, offset, 0, length_);
+        }
+        const uint32_t value = word(offset);
+        if (value >= limit) {
+            return fail(kind, offset, value, limit);
+        }
+        return true;
+    }
+
+    bool fail(const char* kind, uint32_t offset, uint32_t value, uint32_t limit) const {
+        LOGW("verifyFunction rejected: %s operand out of range opcode=%u pc=%u offset=%u value=%u limit=%u fun_addr=0x%llx",
+             kind,
+             function_->inst_list[pc_],
+             pc_,
+             offset,
+             value,
+             limit,
+             static_cast<unsigned long long>(function_->functionAddress()));
+        return false;
+    }
+
+    const zFunction* function_;
+    const std::vector<uint8_t>& heads_;
+    uint32_t pc_;
+    uint32_t length_;
+};
+
+// 校验单条指令的全部操作数；布局与 zVmOpcodes.cpp 中各 op_xxx 的读取方式一一对应。
+// 处理函数自身已按运行态做范围判断的字段（OP_BL 的外部分支 ID、SET_FIELD 的零寄存器等）不在此重复约束。
+bool verifyOperands(const VerifyScope& s, uint32_t opcode) {
+    switch (opcode) {
+        // 无操作数或仅含立即数的指令。
+        case OP_END:
+        case OP_ALLOC_RETURN:
+        case OP_NOP:
+        case OP_PHI:
+        case OP_FENCE:  // [opcode][order]
+        case OP_UNREACHABLE:
+        case OP_SET_RETURN_PC:
+        case OP_BL:
+            return true;
+
+        // [opcode][sub_op][type][lhs][rhs][dst]
+        case OP_BINARY:
+            return s.type(2) && s.reg(3) && s.reg(4) && s.reg(5);
+        // [opcode][sub_op][type][lhs][imm][dst]
+        case OP_BINARY_IMM:
+            return s.type(2) && s.reg(3) && s.reg(5);
+        // [opcode][sub_op][dst_type][src_type][src][dst]
+        case OP_TYPE_CONVERT:
+            return s.type(2) && s.type(3) && s.reg(4) && s.reg(5);
+        // [opcode][dst][value...]
+        case OP_LOAD_CONST:
+        case OP_LOAD_CONST64:
+        case OP_LOAD_IMM:
+        case OP_ADRP:
+            return s.reg(1);
+        // [opcode][type][addr][imm]
+        case OP_STORE_CONST:
+            return s.type(1) && s.reg(2);
+        // [opcode][type][base][index][dst]
+        case OP_GET_ELEMENT:
+            return s.type(1) && s.reg(2) && s.reg(3) && s.reg(4);
+        // [opcode][type][addr][value] / [opcode][type][src][dst] / [opcode][type][dst][addr]
+        case OP_STORE:
+        case OP_COPY:
+        case OP_READ:
+        case OP_WRITE:
+            return s.type(1) && s.reg(2) && s.reg(3);
+        // [opcode][type][base][offset][dst]
+        case OP_GET_FIELD:
+            return s.type(1) && s.reg(2) && s.reg(4);
+        // [opcode][type][base][offset][value]（value 越界表示零寄存器，由处理函数判断）
+        case OP_SET_FIELD:
+            return s.type(1) && s.reg(2);
+        // [opcode][type][lhs][rhs][result][cmp_op]
+        case OP_CMP:
+            return s.type(1) && s.reg(2) && s.reg(3) && s.reg(4);
+        // [opcode][dst_slot][reserved][pair_count][(reg, branch_id)...]
+        case OP_RESTORE_REG: {
+            if (!s.reg(1)) return false;
+            const uint32_t pairCount = s.word(3);
+            for (uint32_t i = 0; i < pairCount; ++i) {
+                if (!s.reg(4 + i * 2)) return false;
+            }
+            return true;
+        }
+        // [opcode][type][param_count][mask][result][func][params...]
+        case OP_CALL:
+        case OP_CALL_INDIRECT: {
+            if (!s.reg(5)) return false;
+            // 仅 mask bit0 置位时才会写 result 寄存器。
+            if ((s.word(3) & 0x1u) != 0 && !s.reg(4)) return false;
+            const uint32_t paramCount = s.word(2);
+            // 与 op_call 一致：最多读取前 16 个参数寄存器。
+            for (uint32_t i = 0; i < paramCount && i < 16; ++i) {
+                if (!s.reg(6 + i)) return false;
+            }
+            return true;
+        }
+        // [opcode][has_value][value_reg?]
+        case OP_RETURN:
+            return s.word(1) == 0 || s.reg(2);
+        // [opcode][branch_id]
+        case OP_BRANCH:
+            return s.branchId(1);
+        // [opcode][cond][true_branch][false_branch]
+        case OP_BRANCH_IF:
+            return s.reg(1) && s.branchId(2) && s.branchId(3);
+        // [opcode][cc][branch_id]
+        case OP_BRANCH_IF_CC:
+            return s.branchId(2);
+        // [opcode][target_reg]
+        case OP_BRANCH_REG:
+            return s.reg(1);
+        // [opcode][type][dst]
+        case OP_ALLOC_MEMORY:
+            return s.type(1) && s.reg(2);
+        // [opcode][src][dst]
+        case OP_MOV:
+        case OP_STRLEN:
+        case OP_BITCAST:
+        case OP_FLOAT_EXTEND:
+        case OP_FLOAT_TRUNCATE:
+            return s.reg(1) && s.reg(2);
+        // [opcode][cmp][type][default_branch][pair_count][(value_reg, branch_id)...]
+        case OP_DYNAMIC_CAST: {
+            if (!s.reg(1) || !s.type(2)) return false;
+            const uint32_t pairCount = s.word(4);
+            for (uint32_t i = 0; i < pairCount; ++i) {
+                if (!s.reg(5 + i * 2)) return false;
+            }
+            return true;
+        }
+        // [opcode][sub_op][type][src][dst]
+        case OP_UNARY:
+            return s.type(2) && s.reg(3) && s.reg(4);
+        // [opcode][cond][true][false][dst]
+        case OP_SELECT:
+            return s.reg(1) && s.reg(2) && s.reg(3) && s.reg(4);
+        // [opcode][dst][src/value][size]
+        case OP_MEMCPY:
+        case OP_MEMSET:
+            return s.reg(1) && s.reg(2) && s.reg(3);
+        // [opcode][has_cmp][branch_id][cmp_reg][type][alt_branch]
+        case OP_FETCH_NEXT:
+            return s.word(1) == 0 || s.reg(3);
+        // [opcode][value][default_target][case_count][(value, target)...]
+        case OP_SWITCH: {
+            if (!s.reg(1) || !s.pcTarget(2)) return false;
+            const uint32_t caseCount = s.word(3);
+            for (uint32_t i = 0; i < caseCount; ++i) {
+                if (!s.pcTarget(4 + i * 2 + 1)) return false;
+            }
+            return true;
+        }
+        // [opcode][base][offset][dst]
+        case OP_GET_PTR:
+            return s.reg(1) && s.reg(3);
+        // [opcode][src_type][dst_type][src][dst]
+        case OP_SIGN_EXTEND:
+        case OP_ZERO_EXTEND:
+            return s.type(1) && s.reg(3) && s.reg(4);
+        // [opcode][dst_type][src][dst]
+        case OP_TRUNCATE:
+            return s.type(1) && s.reg(2) && s.reg(3);
+        // [opcode][signed][type][src][dst]
+        case OP_INT_TO_FLOAT:
+        case OP_FLOAT_TO_INT:
+            return s.type(2) && s.reg(3) && s.reg(4);
+        // [opcode][dst][reserved][elem_type][dim_count][base][idx...]
+        case OP_ARRAY_ELEM: {
+            if (!s.reg(1) || !s.type(3)) return false;
+            const uint32_t dimCount = s.word(4);
+            if (dimCount == 0) return true;
+            if (!s.reg(5)) return false;
+            for (uint32_t dim = 0; dim < dimCount; ++dim) {
+                if (!s.reg(6 + dim)) return false;
+            }
+            return true;
+        }
+        // [opcode][base][index][scale][offset][dst]
+        case OP_LEA:
+            return s.reg(1) && s.reg(2) && s.reg(5);
+        // [opcode][type][addr][value][order][result]（value/result 越界表示零寄存器）
+        case OP_ATOMIC_ADD:
+        case OP_ATOMIC_SUB:
+        case OP_ATOMIC_XCHG:
+            return s.type(1) && s.reg(2);
+        // [opcode][type][addr][expected][new][order][result]（expected/new/result 越界表示零寄存器）
+        case OP_ATOMIC_CAS:
+            return s.type(1) && s.reg(2);
+        // [opcode][result_type][size_type][stack_size][fp][sp]（stack_size 为立即数字节数，0 回退默认大小，无需校验）
+        case OP_ALLOC_VSP:
+            return s.reg(4) && s.reg(5);
+        // [opcode][type][base][offset][order][dst]
+        case OP_ATOMIC_LOAD:
+            return s.type(1) && s.reg(2) && s.reg(5);
+        // [opcode][type][base][offset][value][order]（value 越界表示零寄存器）
+        case OP_ATOMIC_STORE:
+            return s.type(1) && s.reg(2);
+        default: {
+            // 类型特化 opcode：[op][a][b][c]，按形态校验寄存器操作数（store 的 value 越界表示零寄存器）。
+            const vm::VMTypedOpcodeInfo* typed = vm::getTypedOpcodeInfo(opcode);
+            if (typed != nullptr) {
+                switch (typed->kind) {
+                    case VM_TYPED_BINARY: return s.reg(1) && s.reg(2) && s.reg(3);
+                    case VM_TYPED_STORE:  return s.reg(1);
+                    default:              return s.reg(1) && s.reg(3);
+                }
+            }
+            // 未登记布局的 opcode 无法证明安全，保持检查模式。
+            return false;
+        }
+    }
+}
+
+} // namespace
+
+bool verifyFunction(const zFunction* function) {
+    if (function == nullptr || function->inst_list == nullptr || function->inst_count == 0) {
+        return false;
+    }
+    // 分支表声明了表项却没有数组时，处理函数会走各自的兜底分支，此处不做免检承诺。
+    if (function->branch_count > 0 && function->branch_words_ptr == nullptr) {
+        return false;
+    }
+
+    const uint32_t instCount = function->inst_count;
+    const uint32_t* code = function->inst_list;
+    const unsigned long long funAddr = static_cast<unsigned long long>(function->functionAddress());
+
+    // 1) 线性切分：每条指令长度可解且完整落在指令流内，同时标记指令起点。
+    std::vector<uint8_t> heads(instCount, 0);
+    for (uint32_t pc = 0; pc < instCount;) {
+        const uint32_t length = vmInstructionLength(code, instCount, pc);
+        if (length == 0) {
+            LOGW("verifyFunction rejected: undecodable opcode=%u at pc=%u fun_addr=0x%llx", code[pc], pc, funAddr);
+            return false;
+        }
+        heads[pc] = 1;
+        pc += length;
+    }
+
+    // 2) 运行期动态跳转的目标表：落点必须是指令起点，或越过末尾（由处理函数停机）。
+    for (uint32_t i = 0; i < function->branch_count; ++i) {
+        const uint32_t target = function->branch_words_ptr[i];
+        if (target < instCount && heads[target] == 0) {
+            LOGW("verifyFunction rejected: branch %u targets mid-instruction pc=%u fun_addr=0x%llx", i, target, funAddr);
+            return false;
+        }
+    }
+    for (size_t i = 0; i < function->branch_lookup_words.size(); ++i) {
+        const uint32_t target = function->branch_lookup_words[i];
+        if (target < instCount && heads[target] == 0) {
+            LOGW("verifyFunction rejected: lookup %zu targets mid-instruction pc=%u fun_addr=0x%llx", i, target, funAddr);
+            return false;
+        }
+    }
+
+    // 3) 逐条校验操作数。
+    for (uint32_t pc = 0; pc < instCount;) {
+        const uint32_t length = vmInstructionLength(code, instCount, pc);
+        const VerifyScope scope(function, heads, pc, length);
+        if (!verifyOperands(scope, code[pc])) {
+            return false;
+        }
+        pc += length;
+    }
+    return true;
+}
@@ -0,0 +1,18 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 加载期字节码校验声明。
+ * - 加固链路位置：执行前准备层（cacheFunction 时一次性执行）。
+ * - 输入：zFunction 的 inst_list/branch/type 运行态数组。
+ * - 输出：是否可走免检处理函数（zFunction::verified）。
+ */
+#ifndef Z_VM_VERIFIER_H
+#define Z_VM_VERIFIER_H
+
+class zFunction;
+
+// 证明指令流中所有寄存器下标、类型下标、分支 ID、switch 目标与指令长度均在界内，
+// 且所有跳转目标都落在指令起点或函数末尾之后。
+// 通过返回 true：执行时可使用免检处理函数；失败返回 false 并记录原因，函数保持检查模式。
+bool verifyFunction(const zFunction* function);
+
+#endif // Z_VM_VERIFIER_H
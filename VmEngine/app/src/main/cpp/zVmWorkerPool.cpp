@@ -0,0 +1,181 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 工作窃取线程池实现：块区间打包为单个原子字，队首取块与队尾窃取都是一次 CAS。
+ * - 加固链路位置：执行核心的批量执行基础设施。
+ * - 输入：run 发布的任务（总数、块大小、并行度、参与者函数）。
+ * - 输出：调用线程与池内线程共同处理完全部块后返回。
+ */
+#include "zVmWorkerPool.h"
+
+namespace {
+
+// 块区间打包/拆包。
+inline uint64_t packRange(uint32_t lo, uint32_t hi) {
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+inline uint32_t rangeLo(uint64_t range) {
+    return static_cast<uint32_t>(range);
+}
+
+inline uint32_t rangeHi(uint64_t range) {
+    return static_cast<uint32_t>(range >> 32);
+}
+
+} // namespace
+
+bool zVmWorkCursor::next(size_t& begin, size_t& end) {
+    return pool_->take(lane_, begin, end);
+}
+
+zVmWorkerPool::zVmWorkerPool(uint32_t threadCount)
+    : lanes_(new Lane[static_cast<size_t>(threadCount) + 1]) {
+    threads_.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&zVmWorkerPool::workerLoop, this, i);
+    }
+}
+
+zVmWorkerPool::~zVmWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void zVmWorkerPool::run(size_t count, size_t grain, uint32_t parallelism, Body body, void* context) {
+    if (count == 0 || body == nullptr) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    // 块数必须能放进 32 位区间：任务极大时放大块。
+    size_t chunks = (count + grain - 1) / grain;
+    while (chunks > UINT32_MAX) {
+        grain *= 2;
+        chunks = (count + grain - 1) / grain;
+    }
+    // 并行度不超过池容量与块数。
+    if (parallelism == 0 || parallelism > maxParallelism()) {
+        parallelism = maxParallelism();
+    }
+    if (parallelism > chunks) {
+        parallelism = static_cast<uint32_t>(chunks);
+    }
+
+    std::lock_guard<std::mutex> runLock(run_mutex_);
+    // 初始分配：块按参与者均分为连续区间，余数摊给前面的参与者。
+    const uint32_t totalChunks = static_cast<uint32_t>(chunks);
+    const uint32_t share = totalChunks / parallelism;
+    const uint32_t extra = totalChunks % parallelism;
+    uint32_t cursor = 0;
+    for (uint32_t lane = 0; lane < parallelism; ++lane) {
+        const uint32_t size = share + (lane < extra ? 1 : 0);
+        lanes_[lane].range.store(packRange(cursor, cursor + size), std::memory_order_relaxed);
+        cursor += size;
+    }
+
+    {
+        // 发布任务：mutex_ 释放即让池内线程看到完整的任务字段与区间。
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = body;
+        context_ = context;
+        count_ = count;
+        grain_ = grain;
+        parallelism_ = parallelism;
+        pending_ = parallelism - 1;
+        ++job_seq_;
+    }
+    if (parallelism > 1) {
+        wake_.notify_all();
+    }
+
+    // 调用线程作为 0 号参与者。
+    zVmWorkCursor self(this, 0);
+    body(context, self);
+
+    // 等待池内参与者全部返回（它们返回时自己的区间已取空，剩余块已被窃取处理）。
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void zVmWorkerPool::workerLoop(uint32_t threadIndex) {
+    // 池内线程 i 担任 i+1 号参与者。
+    const uint32_t lane = threadIndex + 1;
+    uint64_t seenSeq = 0;
+    for (;;) {
+        Body body = nullptr;
+        void* context = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seenSeq] { return stopping_ || job_seq_ != seenSeq; });
+            if (stopping_) {
+                return;
+            }
+            seenSeq = job_seq_;
+            // 并行度不足时本线程不参与本轮任务。
+            if (lane >= parallelism_) {
+                continue;
+            }
+            body = body_;
+            context = context_;
+        }
+        zVmWorkCursor cursor(this, lane);
+        body(context, cursor);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+}
+
+bool zVmWorkerPool::take(uint32_t lane, size_t& begin, size_t& end) {
+    uint32_t chunk = 0;
+    bool found = false;
+    // 自己的区间：队首逐块取（与窃取者竞争时 CAS 失败重试）。
+    std::atomic<uint64_t>& own = lanes_[lane].range;
+    uint64_t range = own.load(std::memory_order_acquire);
+    while (rangeLo(range) < rangeHi(range)) {
+        if (own.compare_exchange_weak(range,
+                                      packRange(rangeLo(range) + 1, rangeHi(range)),
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+            chunk = rangeLo(range);
+            found = true;
+            break;
+        }
+    }
+    // 自己的区间空了：依次尝试从其他参与者队尾窃取一半，首块自己处理，其余放入自己的区间。
+    for (uint32_t step = 1; !found && step < parallelism_; ++step) {
+        std::atomic<uint64_t>& victim = lanes_[(lane + step) % parallelism_].range;
+        range = victim.load(std::memory_order_acquire);
+        while (rangeLo(range) < rangeHi(range)) {
+            const uint32_t lo = rangeLo(range);
+            const uint32_t hi = rangeHi(range);
+            const uint32_t mid = lo + (hi - lo) / 2;
+            if (victim.compare_exchange_weak(range,
+                                             packRange(lo, mid),
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                // 自己的区间此前为空，只有本线程会往里放任务；他人此后只能从中窃取。
+                own.store(packRange(mid + 1, hi), std::memory_order_release);
+                chunk = mid;
+                found = true;
+                break;
+            }
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    begin = static_cast<size_t>(chunk) * grain_;
+    end = begin + grain_ < count_ ? begin + grain_ : count_;
+    return true;
+}
@@ -0,0 +1,92 @@
+/*
+ * [VMP_FLOW_NOTE] 文件级流程注释
+ * - 工作窃取线程池声明：把 [0, count) 切成定长块分给各参与者，空闲者从他人队尾窃取一半。
+ * - 加固链路位置：执行核心的批量执行基础设施（zVmEngine::executeBatch）。
+ * - 输入：任务总数、块大小、并行度与参与者函数。
+ * - 输出：所有块处理完毕后 run 返回；块到参与者的分配不影响结果（调用方按下标写回）。
+ */
+#ifndef Z_VM_WORKER_POOL_H
+#define Z_VM_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class zVmWorkerPool;
+
+// 参与者取块游标：run 期间有效，只能在所属参与者线程内使用。
+class zVmWorkCursor {
+public:
+    // 取下一块 [begin, end)：先取自己队列的队首，空了再窃取；无剩余任务时返回 false。
+    bool next(size_t& begin, size_t& end);
+    // 参与者序号（0 为调用 run 的线程）。
+    uint32_t lane() const { return lane_; }
+
+private:
+    friend class zVmWorkerPool;
+    zVmWorkCursor(zVmWorkerPool* pool, uint32_t lane) : pool_(pool), lane_(lane) {}
+
+    zVmWorkerPool* pool_;
+    uint32_t lane_;
+};
+
+// 常驻线程池：调用 run 的线程作为 0 号参与者，其余参与者由池内线程担任。
+// 每个参与者持有一段块区间（打包在一个原子字里）：自己从队首逐块取，窃取者从队尾取走一半。
+// run 之间串行；参与者函数内不能再调用 run。
+class zVmWorkerPool {
+public:
+    // 参与者函数：反复调用 cursor.next 直到返回 false。
+    using Body = void (*)(void* context, zVmWorkCursor& cursor);
+
+    // threadCount 个常驻线程（可为 0，此时 run 只在调用线程上执行）。
+    explicit zVmWorkerPool(uint32_t threadCount);
+    ~zVmWorkerPool();
+    zVmWorkerPool(const zVmWorkerPool&) = delete;
+    zVmWorkerPool& operator=(const zVmWorkerPool&) = delete;
+
+    // 最大并行度（常驻线程数 + 调用线程）。
+    uint32_t maxParallelism() const { return static_cast<uint32_t>(threads_.size()) + 1; }
+
+    // 把 [0, count) 按 grain 切块，由最多 parallelism 个参与者并行处理；返回时全部块已处理完。
+    void run(size_t count, size_t grain, uint32_t parallelism, Body body, void* context);
+
+private:
+    friend class zVmWorkCursor;
+
+    // 参与者块区间：高 32 位 = 区间末块（不含），低 32 位 = 区间首块。独占 cache line。
+    struct alignas(64) Lane {
+        std::atomic<uint64_t> range{0};
+    };
+
+    // 池内线程主循环：等待新任务，按序号认领参与者位置。
+    void workerLoop(uint32_t threadIndex);
+    // 取块（游标实现）。
+    bool take(uint32_t lane, size_t& begin, size_t& end);
+
+    std::vector<std::thread> threads_;
+    std::unique_ptr<Lane[]> lanes_;
+
+    // 串行化 run。
+    std::mutex run_mutex_;
+    // 任务发布与完成通知。
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t job_seq_ = 0;      // 任务序号（递增即发布新任务）
+    bool stopping_ = false;     // 析构中
+    uint32_t pending_ = 0;      // 尚未完成的池内参与者数
+
+    // 当前任务（mutex_ 发布，参与者在任务期间只读）。
+    Body body_ = nullptr;
+    void* context_ = nullptr;
+    size_t count_ = 0;
+    size_t grain_ = 1;
+    uint32_t parallelism_ = 1;
+};
+
+#endif // Z_VM_WORKER_POOL_H
@@ -80,6 +80,13 @@ bool zElfReadFacade::collectDefinedDynamicExportInfos(std::vector<PatchDynamicEx
     return impl_->image.collectDefinedDynamicExportInfos(outExports, error);
 }
 
+bool zElfReadFacade::readVirtualBytes(uint64_t vaddr, uint64_t size, std::vector<uint8_t>* out) const {
+    if (impl_ == nullptr) {
+        return false;
+    }
+    return impl_->image.readVirtualBytes(vaddr, size, out);
+}
+
 bool zElfReadFacade::queryRequiredSections(PatchRequiredSections* out, std::string* error) const {
     if (impl_ == nullptr) {
         if (error != nullptr) {
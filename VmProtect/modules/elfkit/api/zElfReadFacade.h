@@ -56,6 +56,9 @@ public:
     bool collectDefinedDynamicExportInfos(std::vector<PatchDynamicExportInfo>* outExports,
                                           std::string* error) const;
 
+    // 按虚拟地址读取文件映像字节。
+    bool readVirtualBytes(uint64_t vaddr, uint64_t size, std::vector<uint8_t>* out) const;
+
     // 查询 patchbay 关键节快照。
     bool queryRequiredSections(PatchRequiredSections* out, std::string* error) const;
 
@@ -299,11 +299,44 @@ bool PatchElfImage::collectDefinedDynamicExportInfos(std::vector<PatchDynamicExp
         PatchDynamicExportInfo exportInfo{};
         exportInfo.name = symbolName;
         exportInfo.value = static_cast<uint64_t>(symbol.st_value);
+        exportInfo.size = static_cast<uint64_t>(symbol.st_size);
+        exportInfo.type = type;
         outExports->push_back(std::move(exportInfo));
     }
     return true;
 }
 
+// 按虚拟地址读取文件映像字节。
+bool PatchElfImage::readVirtualBytes(uint64_t vaddr, uint64_t size, std::vector<uint8_t>* out) const {
+    // 参数与加载状态校验。
+    if (!out || !isLoaded()) {
+        return false;
+    }
+    out->clear();
+    const uint8_t* image = impl_->elf.getFileImageData();
+    const size_t imageSize = impl_->elf.getFileImageSize();
+    if (!image) {
+        return false;
+    }
+    // 查找完整覆盖 [vaddr, vaddr + size) 文件部分的 PT_LOAD。
+    for (const zProgramTableElement* ph : impl_->elf.getAllProgramHeaders(PT_LOAD)) {
+        if (!ph || vaddr < ph->vaddr) {
+            continue;
+        }
+        const uint64_t delta = vaddr - ph->vaddr;
+        if (delta >= ph->filesz || size > ph->filesz - delta) {
+            continue;
+        }
+        const uint64_t fileOffset = ph->offset + delta;
+        if (fileOffset > imageSize || size > imageSize - fileOffset) {
+            return false;
+        }
+        out->assign(image + fileOffset, image + fileOffset + size);
+        return true;
+    }
+    return false;
+}
+
 // 查询 patchbay 流程依赖的关键节。
 bool PatchElfImage::queryRequiredSections(PatchRequiredSections* out, std::string* error) const {
     // 输出指针不能为空。
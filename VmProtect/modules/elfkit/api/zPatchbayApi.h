@@ -52,6 +52,9 @@ public:
     bool collectDefinedDynamicExportInfos(std::vector<PatchDynamicExportInfo>* outExports,
                                           std::string* error) const;
 
+    // 按虚拟地址读取文件映像中的字节（区间须完整落在某个 PT_LOAD 的文件部分）。
+    bool readVirtualBytes(uint64_t vaddr, uint64_t size, std::vector<uint8_t>* out) const;
+
     // 查询 patchbay 所需关键节集合。
     bool queryRequiredSections(PatchRequiredSections* out, std::string* error) const;
 
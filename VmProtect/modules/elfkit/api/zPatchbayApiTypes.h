@@ -45,6 +45,10 @@ struct PatchDynamicExportInfo {
     std::string name;
     // 导出符号值。
     uint64_t value = 0;
+    // 导出符号大小（st_size，未知为 0）。
+    uint64_t size = 0;
+    // 符号类型（STT_*）。
+    unsigned type = STT_NOTYPE;
 };
 
 // 通用节视图快照（只保留 patchbay 需要的最小元数据）。
@@ -535,6 +535,10 @@ static const char* getOpcodeName(uint32_t op) {
         case 57: return "OP_ATOMIC_LOAD";
         case 58: return "OP_ATOMIC_STORE";
         case 59: return "OP_BRANCH_REG";
+        // 类型特化 opcode（60 起）。
+#define VM_TYPED_OPCODE_NAME(opcode, handler, kind, binOp, width, isSigned) case opcode: return #opcode;
+        VM_TYPED_OPCODE_LIST(VM_TYPED_OPCODE_NAME)
+#undef VM_TYPED_OPCODE_NAME
         default: return "OP_UNKNOWN";
     }
 }
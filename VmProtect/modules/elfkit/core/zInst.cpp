@@ -149,6 +149,50 @@ zInst::zAsmDomain zInst::classifyArm64Domain(unsigned int instructionId) {  // 
         case ARM64_INS_LDRSH: // 指令分支：ARM64_INS_LDRSH，在此分支内完成等价 VM 语义映射。
         case ARM64_INS_LDRSW: // 指令分支：ARM64_INS_LDRSW，在此分支内完成等价 VM 语义映射。
         case ARM64_INS_LD4: // 指令分支：ARM64_INS_LD4，在此分支内完成等价 VM 语义映射。
+        // LSE 原子读-改-写（LDADD/STADD/SWP/CAS）与数据内存屏障。
+        case ARM64_INS_LDADD: // 指令分支：ARM64_INS_LDADD，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDB: // 指令分支：ARM64_INS_LDADDB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDH: // 指令分支：ARM64_INS_LDADDH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDA: // 指令分支：ARM64_INS_LDADDA，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDAB: // 指令分支：ARM64_INS_LDADDAB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDAH: // 指令分支：ARM64_INS_LDADDAH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDL: // 指令分支：ARM64_INS_LDADDL，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDLB: // 指令分支：ARM64_INS_LDADDLB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDLH: // 指令分支：ARM64_INS_LDADDLH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDAL: // 指令分支：ARM64_INS_LDADDAL，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDALB: // 指令分支：ARM64_INS_LDADDALB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_LDADDALH: // 指令分支：ARM64_INS_LDADDALH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWP: // 指令分支：ARM64_INS_SWP，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPB: // 指令分支：ARM64_INS_SWPB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPH: // 指令分支：ARM64_INS_SWPH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPA: // 指令分支：ARM64_INS_SWPA，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPAB: // 指令分支：ARM64_INS_SWPAB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPAH: // 指令分支：ARM64_INS_SWPAH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPL: // 指令分支：ARM64_INS_SWPL，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPLB: // 指令分支：ARM64_INS_SWPLB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPLH: // 指令分支：ARM64_INS_SWPLH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPAL: // 指令分支：ARM64_INS_SWPAL，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPALB: // 指令分支：ARM64_INS_SWPALB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_SWPALH: // 指令分支：ARM64_INS_SWPALH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CAS: // 指令分支：ARM64_INS_CAS，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASB: // 指令分支：ARM64_INS_CASB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASH: // 指令分支：ARM64_INS_CASH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASA: // 指令分支：ARM64_INS_CASA，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASAB: // 指令分支：ARM64_INS_CASAB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASAH: // 指令分支：ARM64_INS_CASAH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASL: // 指令分支：ARM64_INS_CASL，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASLB: // 指令分支：ARM64_INS_CASLB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASLH: // 指令分支：ARM64_INS_CASLH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASAL: // 指令分支：ARM64_INS_CASAL，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASALB: // 指令分支：ARM64_INS_CASALB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_CASALH: // 指令分支：ARM64_INS_CASALH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_ALIAS_STADD: // 指令分支：ARM64_INS_ALIAS_STADD，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_ALIAS_STADDL: // 指令分支：ARM64_INS_ALIAS_STADDL，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_ALIAS_STADDB: // 指令分支：ARM64_INS_ALIAS_STADDB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_ALIAS_STADDLB: // 指令分支：ARM64_INS_ALIAS_STADDLB，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_ALIAS_STADDH: // 指令分支：ARM64_INS_ALIAS_STADDH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_ALIAS_STADDLH: // 指令分支：ARM64_INS_ALIAS_STADDLH，在此分支内完成等价 VM 语义映射。
+        case ARM64_INS_DMB: // 指令分支：ARM64_INS_DMB，在此分支内完成等价 VM 语义映射。
             return zAsmDomain::Memory;  // 返回阶段：输出当前路径计算结果。
 
         // logic
@@ -1563,6 +1607,152 @@ uint32_t getOrAddTypeTagForRegWidth(std::vector<uint32_t>& typeIdList, unsigned
     return getOrAddTypeTag(typeIdList, isWide32 ? TYPE_TAG_INT32_SIGNED_2 : TYPE_TAG_INT64_SIGNED);
 }
 
+// 翻译器侧 opcode 字长（规则见 shared/bytecode/zVmBytecodeProtocol.h）；未知或截断返回 0。
+static uint32_t getTranslatedInstLength(const std::vector<uint32_t>& opcodeList, size_t pos) {
+    // 与运行时共用同一份长度规则，翻译端发射格式与解释器 pc 步进不会各自漂移。
+    if (pos >= opcodeList.size()) return 0;
+    return vmp::bytecode::protocol::instructionLength(opcodeList.data() + pos, opcodeList.size() - pos);
+}
+
+// 整数类型标签 -> (字节宽度, 有符号)；浮点/未知标签返回 false。
+static bool resolveIntTypeTag(const std::vector<uint32_t>& typeIdList, uint32_t typeIndex, uint32_t& width, bool& isSigned) {
+    if (typeIndex >= typeIdList.size()) return false;
+    switch (typeIdList[typeIndex]) {
+        case TYPE_TAG_INT8_SIGNED:    width = 1; isSigned = true;  return true;
+        case TYPE_TAG_INT8_UNSIGNED:  width = 1; isSigned = false; return true;
+        case TYPE_TAG_INT16_SIGNED:   width = 2; isSigned = true;  return true;
+        case TYPE_TAG_INT16_UNSIGNED: width = 2; isSigned = false; return true;
+        case TYPE_TAG_INT32_SIGNED_2: width = 4; isSigned = true;  return true;
+        case TYPE_TAG_INT32_UNSIGNED: width = 4; isSigned = false; return true;
+        case TYPE_TAG_INT64_SIGNED:   width = 8; isSigned = true;  return true;
+        case TYPE_TAG_INT64_UNSIGNED: width = 8; isSigned = false; return true;
+        default: return false;
+    }
+}
+
+// 按 (形态, 算子, 宽度, 符号) 查找类型特化 opcode；符号仅对除法与 load 生效。
+static bool findTypedOpcode(uint32_t kind, uint32_t binOp, uint32_t width, bool isSigned, uint32_t& outOpcode) {
+    struct TypedOpcodeEntry {
+        uint32_t opcode;
+        uint32_t kind;
+        uint32_t binOp;
+        uint32_t width;
+        uint32_t isSigned;
+    };
+    static const TypedOpcodeEntry kEntries[] = {
+#define VM_TYPED_OPCODE_ENTRY(opcode, handler, kind, binOp, width, isSigned) { opcode, kind, binOp, width, isSigned },
+        VM_TYPED_OPCODE_LIST(VM_TYPED_OPCODE_ENTRY)
+#undef VM_TYPED_OPCODE_ENTRY
+    };
+    const bool signMatters = kind == VM_TYPED_LOAD || binOp == BIN_IDIV;
+    for (const TypedOpcodeEntry& entry : kEntries) {
+        if (entry.kind != kind || entry.width != width) continue;
+        if (kind != VM_TYPED_LOAD && kind != VM_TYPED_STORE && entry.binOp != binOp) continue;
+        if (signMatters && (entry.isSigned != 0) != isSigned) continue;
+        outOpcode = entry.opcode;
+        return true;
+    }
+    return false;
+}
+
+void specializeTypedOpcodes(std::vector<uint32_t>& opcodeList, const std::vector<uint32_t>& typeIdList) {
+    std::vector<uint32_t> out;
+    out.reserve(opcodeList.size());
+    bool changed = false;
+    // 上一条输出是否已保证“目标寄存器高 32 位为 0”（I32 运算 / 无符号窄 load），用于剔除紧随的 w 掩码。
+    bool lastZeroExtended = false;
+    uint32_t lastDst = 0;
+
+    size_t pos = 0;
+    while (pos < opcodeList.size()) {
+        const uint32_t length = getTranslatedInstLength(opcodeList, pos);
+        if (length == 0) {
+            // 长度未知：剩余内容原样保留。
+            out.insert(out.end(), opcodeList.begin() + static_cast<std::ptrdiff_t>(pos), opcodeList.end());
+            break;
+        }
+        const uint32_t* inst = opcodeList.data() + pos;
+        uint32_t width = 0;
+        bool isSigned = false;
+        uint32_t typed = 0;
+        bool zeroExtended = false;
+        uint32_t dst = 0;
+        bool rewritten = false;
+
+        if ((inst[0] == OP_BINARY || inst[0] == OP_BINARY_IMM) &&
+            inst[1] < 0x40u &&
+            resolveIntTypeTag(typeIdList, inst[2], width, isSigned)) {
+            const bool isImm = inst[0] == OP_BINARY_IMM;
+            // 冗余 w 掩码：前一条已把 dst 高 32 位清零，AND 0xFFFFFFFF 不改变结果。
+            if (isImm && inst[1] == BIN_AND && inst[4] == 0xFFFFFFFFu &&
+                inst[3] == inst[5] && lastZeroExtended && lastDst == inst[5]) {
+                pos += length;
+                changed = true;
+                continue;
+            }
+            // 整数除法：BIN_DIV 与 BIN_IDIV 在整数类型下语义一致。
+            const uint32_t binOp = inst[1] == BIN_DIV ? BIN_IDIV : inst[1];
+            const bool isShift = binOp == BIN_SHL || binOp == BIN_LSR || binOp == BIN_ASR;
+            // 立即数移位量必须落在宽度内（特化版本按宽度取模，通用版本按 64 取模）。
+            const bool shiftInRange = !isImm || !isShift || inst[4] < width * 8u;
+            if ((width == 4u || width == 8u) && shiftInRange &&
+                findTypedOpcode(isImm ? VM_TYPED_BINARY_IMM : VM_TYPED_BINARY, binOp, width, isSigned, typed)) {
+                out.insert(out.end(), { typed, inst[3], inst[4], inst[5] });
+                zeroExtended = width == 4u;
+                dst = inst[5];
+                rewritten = true;
+            }
+        } else if (inst[0] == OP_GET_FIELD && resolveIntTypeTag(typeIdList, inst[1], width, isSigned)) {
+            // [GET_FIELD][type][base][offset][dst]：W 槽位 load 默认零扩展。
+            bool loadSigned = width < 4u && isSigned;
+            uint32_t consumed = length;
+            const size_t next = pos + length;
+            if (width == 4u && next < opcodeList.size() && opcodeList[next] == OP_SIGN_EXTEND &&
+                getTranslatedInstLength(opcodeList, next) == 5u) {
+                // LDRSW 形态：紧随 SIGN_EXTEND[i32 -> i64][dst][dst] 合并为 LDR_I32。
+                const uint32_t* ext = opcodeList.data() + next;
+                uint32_t srcWidth = 0, dstWidth = 0;
+                bool srcSigned = false, dstSigned = false;
+                if (resolveIntTypeTag(typeIdList, ext[1], srcWidth, srcSigned) && srcWidth == 4u &&
+                    resolveIntTypeTag(typeIdList, ext[2], dstWidth, dstSigned) && dstWidth == 8u &&
+                    ext[3] == inst[4] && ext[4] == inst[4]) {
+                    loadSigned = true;
+                    consumed += 5u;
+                }
+            }
+            if (findTypedOpcode(VM_TYPED_LOAD, 0, width, loadSigned, typed)) {
+                out.insert(out.end(), { typed, inst[2], inst[3], inst[4] });
+                zeroExtended = !loadSigned && width <= 4u;
+                dst = inst[4];
+                pos += consumed;
+                changed = true;
+                lastZeroExtended = zeroExtended;
+                lastDst = dst;
+                continue;
+            }
+        } else if (inst[0] == OP_SET_FIELD && resolveIntTypeTag(typeIdList, inst[1], width, isSigned)) {
+            // [SET_FIELD][type][base][offset][value]：按宽度截断写回。
+            if (findTypedOpcode(VM_TYPED_STORE, 0, width, false, typed)) {
+                out.insert(out.end(), { typed, inst[2], inst[3], inst[4] });
+                rewritten = true;
+            }
+        }
+
+        if (rewritten) {
+            changed = true;
+        } else {
+            out.insert(out.end(), inst, inst + length);
+        }
+        lastZeroExtended = rewritten && zeroExtended;
+        lastDst = dst;
+        pos += length;
+    }
+
+    if (changed) {
+        opcodeList.swap(out);
+    }
+}
+
 // 追加“按位与掩码”语义：优先用 imm32，超出时退化到加载常量再寄存器与。
 void appendAndByMask(
     std::vector<uint32_t>& opcodeList,
@@ -1776,6 +1966,152 @@ bool tryEmitAtomicStoreExclusiveLike(
     return true;
 }
 
+// LSE 原子指令查表：后缀 A/L/AL 对应 acquire/release/acq_rel，无后缀为 relaxed；B/H 为 8/16bit 访问。
+bool lookupArm64LseAtomic(
+    unsigned int id,
+    uint32_t& vmOpcode,
+    uint32_t& accessBytes,
+    uint32_t& memOrder
+) {
+    struct LseAtomicEntry {
+        unsigned int id;
+        uint32_t vmOpcode;
+        uint32_t accessBytes;
+        uint32_t memOrder;
+    };
+    static const LseAtomicEntry kEntries[] = {
+        // LDADD 族：原子加并返回旧值。
+        {ARM64_INS_LDADD,    OP_ATOMIC_ADD,  0, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_LDADDA,   OP_ATOMIC_ADD,  0, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_LDADDL,   OP_ATOMIC_ADD,  0, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_LDADDAL,  OP_ATOMIC_ADD,  0, VM_MEM_ORDER_ACQ_REL},
+        {ARM64_INS_LDADDB,   OP_ATOMIC_ADD,  1, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_LDADDAB,  OP_ATOMIC_ADD,  1, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_LDADDLB,  OP_ATOMIC_ADD,  1, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_LDADDALB, OP_ATOMIC_ADD,  1, VM_MEM_ORDER_ACQ_REL},
+        {ARM64_INS_LDADDH,   OP_ATOMIC_ADD,  2, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_LDADDAH,  OP_ATOMIC_ADD,  2, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_LDADDLH,  OP_ATOMIC_ADD,  2, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_LDADDALH, OP_ATOMIC_ADD,  2, VM_MEM_ORDER_ACQ_REL},
+        // STADD 别名（LDADD 目标为零寄存器）：只有 relaxed/release 形态。
+        {ARM64_INS_ALIAS_STADD,   OP_ATOMIC_ADD, 0, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_ALIAS_STADDL,  OP_ATOMIC_ADD, 0, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_ALIAS_STADDB,  OP_ATOMIC_ADD, 1, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_ALIAS_STADDLB, OP_ATOMIC_ADD, 1, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_ALIAS_STADDH,  OP_ATOMIC_ADD, 2, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_ALIAS_STADDLH, OP_ATOMIC_ADD, 2, VM_MEM_ORDER_RELEASE},
+        // SWP 族：原子交换并返回旧值。
+        {ARM64_INS_SWP,      OP_ATOMIC_XCHG, 0, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_SWPA,     OP_ATOMIC_XCHG, 0, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_SWPL,     OP_ATOMIC_XCHG, 0, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_SWPAL,    OP_ATOMIC_XCHG, 0, VM_MEM_ORDER_ACQ_REL},
+        {ARM64_INS_SWPB,     OP_ATOMIC_XCHG, 1, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_SWPAB,    OP_ATOMIC_XCHG, 1, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_SWPLB,    OP_ATOMIC_XCHG, 1, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_SWPALB,   OP_ATOMIC_XCHG, 1, VM_MEM_ORDER_ACQ_REL},
+        {ARM64_INS_SWPH,     OP_ATOMIC_XCHG, 2, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_SWPAH,    OP_ATOMIC_XCHG, 2, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_SWPLH,    OP_ATOMIC_XCHG, 2, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_SWPALH,   OP_ATOMIC_XCHG, 2, VM_MEM_ORDER_ACQ_REL},
+        // CAS 族：比较交换，比较寄存器回写旧值。
+        {ARM64_INS_CAS,      OP_ATOMIC_CAS,  0, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_CASA,     OP_ATOMIC_CAS,  0, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_CASL,     OP_ATOMIC_CAS,  0, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_CASAL,    OP_ATOMIC_CAS,  0, VM_MEM_ORDER_ACQ_REL},
+        {ARM64_INS_CASB,     OP_ATOMIC_CAS,  1, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_CASAB,    OP_ATOMIC_CAS,  1, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_CASLB,    OP_ATOMIC_CAS,  1, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_CASALB,   OP_ATOMIC_CAS,  1, VM_MEM_ORDER_ACQ_REL},
+        {ARM64_INS_CASH,     OP_ATOMIC_CAS,  2, VM_MEM_ORDER_RELAXED},
+        {ARM64_INS_CASAH,    OP_ATOMIC_CAS,  2, VM_MEM_ORDER_ACQUIRE},
+        {ARM64_INS_CASLH,    OP_ATOMIC_CAS,  2, VM_MEM_ORDER_RELEASE},
+        {ARM64_INS_CASALH,   OP_ATOMIC_CAS,  2, VM_MEM_ORDER_ACQ_REL},
+    };
+    for (const LseAtomicEntry& entry : kEntries) {
+        if (entry.id == id) {
+            vmOpcode = entry.vmOpcode;
+            accessBytes = entry.accessBytes;
+            memOrder = entry.memOrder;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 按访问字节数选择原子指令的类型标签（0 表示按寄存器宽度：w=32bit 无符号，x=64bit）。
+static uint32_t getOrAddAtomicTypeTag(std::vector<uint32_t>& typeIdList, uint32_t accessBytes, unsigned int reg) {
+    switch (accessBytes) {
+        case 1:
+            return getOrAddTypeTag(typeIdList, TYPE_TAG_INT8_UNSIGNED);
+        case 2:
+            return getOrAddTypeTag(typeIdList, TYPE_TAG_INT16_UNSIGNED);
+        default:
+            return isArm64WReg(reg)
+                   ? getOrAddTypeTag(typeIdList, TYPE_TAG_INT32_UNSIGNED)
+                   : getOrAddTypeTag(typeIdList, TYPE_TAG_INT64_SIGNED);
+    }
+}
+
+// 零寄存器操作数编码为 -1（执行期读出 0 / 丢弃写回），其余映射为 VM 寄存器下标。
+static uint32_t getOrAddRegOrZero(std::vector<uint32_t>& regIdList, unsigned int reg) {
+    return isArm64ZeroReg(reg)
+           ? static_cast<uint32_t>(-1)
+           : getOrAddReg(regIdList, arm64CapstoneToArchIndex(reg));
+}
+
+// 统一处理 LDADD/STADD/SWP 语义：OP_ATOMIC_ADD/XCHG(type, addr, value, order, result)。
+bool tryEmitAtomicReadModifyWriteLike(
+    std::vector<uint32_t>& opcodeList,
+    std::vector<uint32_t>& regIdList,
+    std::vector<uint32_t>& typeIdList,
+    uint32_t vmOpcode,
+    unsigned int valueReg,
+    unsigned int resultReg,
+    unsigned int baseReg,
+    uint32_t accessBytes,
+    uint32_t memOrder
+) {
+    if (!isArm64GpReg(valueReg) || !isArm64GpReg(resultReg) || !isArm64GpReg(baseReg)) {
+        return false;
+    }
+    opcodeList = {
+        vmOpcode,
+        getOrAddAtomicTypeTag(typeIdList, accessBytes, valueReg),
+        getOrAddReg(regIdList, arm64CapstoneToArchIndex(baseReg)),
+        getOrAddRegOrZero(regIdList, valueReg),
+        memOrder,
+        getOrAddRegOrZero(regIdList, resultReg)
+    };
+    return true;
+}
+
+// 统一处理 CAS 语义：比较寄存器同时是结果寄存器（拿回内存旧值）。
+bool tryEmitAtomicCompareSwapLike(
+    std::vector<uint32_t>& opcodeList,
+    std::vector<uint32_t>& regIdList,
+    std::vector<uint32_t>& typeIdList,
+    unsigned int compareReg,
+    unsigned int newReg,
+    unsigned int baseReg,
+    uint32_t accessBytes,
+    uint32_t memOrder
+) {
+    if (!isArm64GpReg(compareReg) || !isArm64GpReg(newReg) || !isArm64GpReg(baseReg)) {
+        return false;
+    }
+    const uint32_t compareIndex = getOrAddRegOrZero(regIdList, compareReg);
+    opcodeList = {
+        OP_ATOMIC_CAS,
+        getOrAddAtomicTypeTag(typeIdList, accessBytes, compareReg),
+        getOrAddReg(regIdList, arm64CapstoneToArchIndex(baseReg)),
+        compareIndex,
+        getOrAddRegOrZero(regIdList, newReg),
+        memOrder,
+        compareIndex
+    };
+    return true;
+}
+
 // 对 dst 低 width 位执行精确符号扩展（支持任意 width，非仅 8/16/32）。
 bool appendSignExtendFromWidth(
     std::vector<uint32_t>& opcodeList,
@@ -2149,6 +2485,88 @@ uint32_t getOrAddBranch(std::vector<uint64_t>& branchIdList, uint64_t targetArmA
 }
 
 
+static bool isArm64SpReg(unsigned int reg) {
+    return reg == AARCH64_REG_SP || reg == AARCH64_REG_WSP;
+}
+
+// sp 写入的可建模来源：sp 自身或帧指针 x29（恢复到已计入深度的帧内位置）。
+static bool isArm64FrameBaseReg(unsigned int reg) {
+    return isArm64SpReg(reg) || reg == AARCH64_REG_FP || reg == AARCH64_REG_X29;
+}
+
+// 估算函数所需虚拟栈字节数，写入 OP_ALLOC_VSP 的 stack_size 操作数：
+// - 累加所有 `sub sp, sp, #imm` 与 sp 前变址写回（`stp ..., [sp, #-N]!`）的下降量，作为各路径深度上界；
+// - 与 [sp, #off] 访问触及的最高偏移取较大值（按 16 字节访问宽度保守估计）；
+// - sp 写入只接受来源为 sp/fp（可带立即数）的形态；`mov sp, x9`、`sub sp, sp, x10`、对齐 and 等
+//   无法静态建模（可能经临时寄存器加深栈，如 alloca）时返回 0，运行时回退默认大小。
+// 结果按 16 字节对齐，最小 16。
+static uint32_t computeVmStackSize(const cs_insn* insn, size_t count) {
+    uint64_t depth = 0;
+    uint64_t touched = 0;
+    for (size_t j = 0; j < count; ++j) {
+        const cs_detail* detail = insn[j].detail;
+        if (detail == nullptr) {
+            continue;
+        }
+        const uint8_t opCount = detail->aarch64.op_count;
+        const cs_arm64_op* ops = reinterpret_cast<const cs_arm64_op*>(detail->aarch64.operands);
+        const unsigned int id = insn[j].id;
+
+        // 目标为 sp 的写入：只接受 sub/add sp, sp|fp, #imm 与 mov sp, sp|fp 这类可建模形态。
+        if (opCount >= 2 && ops[0].type == AARCH64_OP_REG && isArm64SpReg(ops[0].reg)) {
+            const bool frameImmForm = opCount >= 3 &&
+                                      ops[1].type == AARCH64_OP_REG && isArm64FrameBaseReg(ops[1].reg) &&
+                                      ops[2].type == AARCH64_OP_IMM;
+            if (id == ARM64_INS_SUB && frameImmForm && isArm64SpReg(ops[1].reg)) {
+                uint64_t imm64 = static_cast<uint64_t>(ops[2].imm);
+                if (ops[2].shift.type == AARCH64_SFT_LSL && ops[2].shift.value != 0) {
+                    imm64 <<= static_cast<uint32_t>(ops[2].shift.value);
+                }
+                depth += imm64;
+                continue;
+            }
+            if ((id == ARM64_INS_ADD || id == ARM64_INS_SUB) && frameImmForm) {
+                // 出栈 / 从帧指针恢复 sp：回到已计入深度的帧内位置，不会加深栈。
+                continue;
+            }
+            if (id == ARM64_INS_MOV && opCount == 2 &&
+                ops[1].type == AARCH64_OP_REG && isArm64FrameBaseReg(ops[1].reg)) {
+                continue;
+            }
+            if (id != ARM64_INS_STP && id != ARM64_INS_LDP && id != ARM64_INS_STR && id != ARM64_INS_LDR) {
+                // 来源为其它寄存器（sub x9, sp, #N; mov sp, x9 / alloca）或非常规运算：深度不可知。
+                return 0;
+            }
+        }
+
+        // 以 sp 为基址的访存：记录触及范围，前变址写回计入下降量。
+        for (uint8_t i = 0; i < opCount; ++i) {
+            if (ops[i].type != AARCH64_OP_MEM || !isArm64SpReg(ops[i].mem.base)) {
+                continue;
+            }
+            const int64_t disp = static_cast<int64_t>(ops[i].mem.disp);
+            if (detail->writeback && !detail->aarch64.post_index && disp < 0) {
+                depth += static_cast<uint64_t>(-disp);
+            } else if (disp >= 0) {
+                const uint64_t end = static_cast<uint64_t>(disp) + 16u;
+                if (end > touched) {
+                    touched = end;
+                }
+            }
+        }
+    }
+
+    uint64_t size = depth > touched ? depth : touched;
+    size = (size + 15u) & ~static_cast<uint64_t>(15u);
+    if (size == 0) {
+        size = 16;
+    }
+    if (size > 0xFFFFFFFFull) {
+        return 0;
+    }
+    return static_cast<uint32_t>(size);
+}
+
 static zInstAsmUnencodedBytecode buildUnencodedByCapstone(csh handle, const uint8_t* code, size_t size, uint64_t baseAddr) {
     // Capstone 翻译主流程：
     // ARM64 指令流 -> 未编码 VM opcode（按地址分组）。
@@ -2198,7 +2616,9 @@ static zInstAsmUnencodedBytecode buildUnencodedByCapstone(csh handle, const uint
 
     uint32_t vfp_idx = getOrAddReg(reg_id_list, 29);
     uint32_t vsp_idx = getOrAddReg(reg_id_list, 31);
-    prelude_words.insert(prelude_words.end(), { OP_ALLOC_VSP, 0, 0, 0, vfp_idx, vsp_idx });
+    // [opcode][result_type][size_type][stack_size][fp][sp]：stack_size 为字节数，0 表示运行时默认大小。
+    const uint32_t vsp_stack_size = computeVmStackSize(insn, count);
+    prelude_words.insert(prelude_words.end(), { OP_ALLOC_VSP, 0, 0, vsp_stack_size, vfp_idx, vsp_idx });
 
     // 本地跳转目标表：仅供 OP_BRANCH/OP_BRANCH_IF_CC 使用。
     std::vector<uint64_t> branch_id_list;
@@ -2284,6 +2704,8 @@ static zInstAsmUnencodedBytecode buildUnencodedByCapstone(csh handle, const uint
             break;
         }
 
+        // 类型静态已知的通用指令改写为类型特化 opcode（改变字数，需在 PC 映射之前完成）。
+        specializeTypedOpcodes(opcode_list, type_id_list);
         // 保存翻译结果。
         unencoded.instByAddress[addr] = std::move(opcode_list);
         // 同步保存可读反汇编文本，便于后续 dump/诊断。
@@ -17,6 +17,9 @@
 #include <capstone/arm64.h>  // AArch64 指令/寄存器常量定义。
 #include <capstone/capstone.h>
 
+// opcode 编号、类型特化清单（VM_TYPED_OPCODE_LIST）、BinaryOp 与指令长度规则与 VmEngine 共用。
+#include "shared/bytecode/zVmBytecodeProtocol.h"
+
 /*
  * [VMP_FLOW_NOTE] merged from zInstAsm.h
  * - 统一把 ARM64 反汇编辅助声明并入 zInst.h，减少头文件分散。
@@ -151,27 +154,6 @@ private:
  * [VMP_FLOW_NOTE] merged from zInstDispatch.h
  * - 统一收拢 ARM64->VM 分发契约，避免多头头文件。
  */
-enum : uint32_t {
-    OP_END = 0, OP_BINARY = 1, OP_TYPE_CONVERT = 2, OP_LOAD_CONST = 3, OP_STORE_CONST = 4,
-    OP_GET_ELEMENT = 5, OP_ALLOC_RETURN = 6, OP_STORE = 7, OP_LOAD_CONST64 = 8, OP_NOP = 9,
-    OP_COPY = 10, OP_GET_FIELD = 11, OP_CMP = 12, OP_SET_FIELD = 13, OP_RESTORE_REG = 14,
-    OP_CALL = 15, OP_RETURN = 16, OP_BRANCH = 17, OP_BRANCH_IF = 18, OP_ALLOC_MEMORY = 19,
-    OP_MOV = 20, OP_LOAD_IMM = 21, OP_DYNAMIC_CAST = 22, OP_UNARY = 23, OP_PHI = 24, OP_SELECT = 25,
-    OP_MEMCPY = 26, OP_MEMSET = 27, OP_STRLEN = 28, OP_FETCH_NEXT = 29, OP_CALL_INDIRECT = 30,
-    OP_SWITCH = 31, OP_GET_PTR = 32, OP_BITCAST = 33, OP_SIGN_EXTEND = 34, OP_ZERO_EXTEND = 35,
-    OP_TRUNCATE = 36, OP_FLOAT_EXTEND = 37, OP_FLOAT_TRUNCATE = 38, OP_INT_TO_FLOAT = 39,
-    OP_ARRAY_ELEM = 40, OP_FLOAT_TO_INT = 41, OP_READ = 42, OP_WRITE = 43, OP_LEA = 44,
-    OP_ATOMIC_ADD = 45, OP_ATOMIC_SUB = 46, OP_ATOMIC_XCHG = 47, OP_ATOMIC_CAS = 48,
-    OP_FENCE = 49, OP_UNREACHABLE = 50, OP_ALLOC_VSP = 51, OP_BINARY_IMM = 52,
-    OP_BRANCH_IF_CC = 53, OP_SET_RETURN_PC = 54, OP_BL = 55, OP_ADRP = 56,
-    OP_ATOMIC_LOAD = 57, OP_ATOMIC_STORE = 58, OP_BRANCH_REG = 59,
-};
-
-enum : uint32_t {
-    BIN_XOR = 0, BIN_SUB = 1, BIN_ASR = 2, BIN_DIV = 3, BIN_ADD = 4, BIN_OR = 5,
-    BIN_MOD = 6, BIN_IDIV = 7, BIN_FMOD = 8, BIN_MUL = 9, BIN_LSR = 0xA, BIN_SHL = 0xB, BIN_AND = 0xC,
-};
-
 enum : uint32_t {
     UNARY_NEG = 0,
     UNARY_NOT = 1,
@@ -231,6 +213,11 @@ bool appendAssignRegOrZero(
 uint32_t getOrAddTypeTag(std::vector<uint32_t>& typeIdList, uint32_t typeTag);
 uint32_t getOrAddTypeTagForRegWidth(std::vector<uint32_t>& typeIdList, unsigned int reg);
 
+// 把单条 ARM 指令的 VM opcode 序列中“类型静态已知”的通用指令改写为类型特化 opcode：
+// OP_BINARY/OP_BINARY_IMM（不更新标志、整数 32/64 位）、OP_GET_FIELD（含紧随的同寄存器符号扩展）与 OP_SET_FIELD。
+// 必须在 PC 映射建立之前调用（改写会改变指令字数）；遇到无法确定长度的 opcode 时保留其后内容不变。
+void specializeTypedOpcodes(std::vector<uint32_t>& opcodeList, const std::vector<uint32_t>& typeIdList);
+
 bool appendAddImmSelf(
     std::vector<uint32_t>& opcodeList,
     std::vector<uint32_t>& regIdList,
@@ -372,6 +359,37 @@ bool tryEmitAtomicStoreExclusiveLike(
     uint32_t memOrder
 );
 
+// LSE 原子指令（LDADD/STADD/SWP/CAS 各 A/L/AL 与 B/H 变体）-> VM opcode、访问字节数（0=按寄存器宽度）、内存序。
+bool lookupArm64LseAtomic(
+    unsigned int id,
+    uint32_t& vmOpcode,
+    uint32_t& accessBytes,
+    uint32_t& memOrder
+);
+
+bool tryEmitAtomicReadModifyWriteLike(
+    std::vector<uint32_t>& opcodeList,
+    std::vector<uint32_t>& regIdList,
+    std::vector<uint32_t>& typeIdList,
+    uint32_t vmOpcode,
+    unsigned int valueReg,
+    unsigned int resultReg,
+    unsigned int baseReg,
+    uint32_t accessBytes,
+    uint32_t memOrder
+);
+
+bool tryEmitAtomicCompareSwapLike(
+    std::vector<uint32_t>& opcodeList,
+    std::vector<uint32_t>& regIdList,
+    std::vector<uint32_t>& typeIdList,
+    unsigned int compareReg,
+    unsigned int newReg,
+    unsigned int baseReg,
+    uint32_t accessBytes,
+    uint32_t memOrder
+);
+
 bool appendSignExtendFromWidth(
     std::vector<uint32_t>& opcodeList,
     std::vector<uint32_t>& regIdList,
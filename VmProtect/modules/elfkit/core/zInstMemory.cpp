@@ -605,6 +605,125 @@ bool dispatchArm64MemoryCase(  // 流程注记：该语句参与当前阶段的
                 }
                 break;
             }
+            // LSE 原子读-改-写：LDADD/STADD -> OP_ATOMIC_ADD，SWP -> OP_ATOMIC_XCHG，CAS -> OP_ATOMIC_CAS（内存序取自 A/L/AL 后缀）。
+            case ARM64_INS_LDADD:
+            case ARM64_INS_LDADDB:
+            case ARM64_INS_LDADDH:
+            case ARM64_INS_LDADDA:
+            case ARM64_INS_LDADDAB:
+            case ARM64_INS_LDADDAH:
+            case ARM64_INS_LDADDL:
+            case ARM64_INS_LDADDLB:
+            case ARM64_INS_LDADDLH:
+            case ARM64_INS_LDADDAL:
+            case ARM64_INS_LDADDALB:
+            case ARM64_INS_LDADDALH:
+            case ARM64_INS_SWP:
+            case ARM64_INS_SWPB:
+            case ARM64_INS_SWPH:
+            case ARM64_INS_SWPA:
+            case ARM64_INS_SWPAB:
+            case ARM64_INS_SWPAH:
+            case ARM64_INS_SWPL:
+            case ARM64_INS_SWPLB:
+            case ARM64_INS_SWPLH:
+            case ARM64_INS_SWPAL:
+            case ARM64_INS_SWPALB:
+            case ARM64_INS_SWPALH:
+            case ARM64_INS_CAS:
+            case ARM64_INS_CASB:
+            case ARM64_INS_CASH:
+            case ARM64_INS_CASA:
+            case ARM64_INS_CASAB:
+            case ARM64_INS_CASAH:
+            case ARM64_INS_CASL:
+            case ARM64_INS_CASLB:
+            case ARM64_INS_CASLH:
+            case ARM64_INS_CASAL:
+            case ARM64_INS_CASALB:
+            case ARM64_INS_CASALH:
+            case ARM64_INS_ALIAS_STADD:
+            case ARM64_INS_ALIAS_STADDL:
+            case ARM64_INS_ALIAS_STADDB:
+            case ARM64_INS_ALIAS_STADDLB:
+            case ARM64_INS_ALIAS_STADDH:
+            case ARM64_INS_ALIAS_STADDLH:
+            { // 指令分支：LSE 原子族，在此分支内完成等价 VM 语义映射。
+                uint32_t vm_opcode = 0;
+                uint32_t access_bytes = 0;
+                uint32_t mem_order = VM_MEM_ORDER_RELAXED;
+                if (!lookupArm64LseAtomic(id, vm_opcode, access_bytes, mem_order) || op_count < 2) {
+                    break;
+                }
+                // 操作数形态：[Rs, Rt, mem]（LDADD/SWP/CAS）或 [Rs, mem]（STADD 别名，旧值丢弃）。
+                const bool has_result = op_count >= 3;
+                const cs_arm64_op& mem_op = ops[has_result ? 2 : 1];
+                if (ops[0].type != AARCH64_OP_REG ||
+                    (has_result && ops[1].type != AARCH64_OP_REG) ||
+                    mem_op.type != AARCH64_OP_MEM ||
+                    mem_op.mem.disp != 0) {
+                    break;
+                }
+                const unsigned int result_reg = has_result ? ops[1].reg : AARCH64_REG_XZR;
+                if (vm_opcode == OP_ATOMIC_CAS) {
+                    // CAS Rs, Rt, [Xn]：Rs 为比较值并回写旧值，Rt 为新值。
+                    if (!has_result) {
+                        break;
+                    }
+                    (void)tryEmitAtomicCompareSwapLike(
+                        opcode_list,
+                        reg_id_list,
+                        type_id_list,
+                        ops[0].reg,
+                        ops[1].reg,
+                        mem_op.mem.base,
+                        access_bytes,
+                        mem_order
+                    );
+                } else {
+                    // LDADD/SWP Rs, Rt, [Xn]：Rs 为操作数，Rt 拿回旧值。
+                    (void)tryEmitAtomicReadModifyWriteLike(
+                        opcode_list,
+                        reg_id_list,
+                        type_id_list,
+                        vm_opcode,
+                        ops[0].reg,
+                        result_reg,
+                        mem_op.mem.base,
+                        access_bytes,
+                        mem_order
+                    );
+                }
+                break;
+            }
+
+            // 数据内存屏障：DMB ISH -> OP_FENCE(SEQ_CST)，ISHLD -> ACQUIRE，ISHST -> RELEASE。
+            case ARM64_INS_DMB: { // 指令分支：ARM64_INS_DMB，在此分支内完成等价 VM 语义映射。
+                uint32_t mem_order = VM_MEM_ORDER_SEQ_CST;
+                if (op_count >= 1 && ops[0].sysop.sub_type == AARCH64_OP_DB) {
+                    switch (ops[0].sysop.alias.db) {
+                        // 只约束读：后续访问不得越过之前的读取。
+                        case AARCH64_DB_ISHLD:
+                        case AARCH64_DB_OSHLD:
+                        case AARCH64_DB_NSHLD:
+                        case AARCH64_DB_LD:
+                            mem_order = VM_MEM_ORDER_ACQUIRE;
+                            break;
+                        // 只约束写：release 栅栏语义更强，保守覆盖 store-store 顺序。
+                        case AARCH64_DB_ISHST:
+                        case AARCH64_DB_OSHST:
+                        case AARCH64_DB_NSHST:
+                        case AARCH64_DB_ST:
+                            mem_order = VM_MEM_ORDER_RELEASE;
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                opcode_list = { OP_FENCE, mem_order };
+                break;
+            }
+
             // 扩展指令族：SXT*/UXT*。
         default:
             return false;
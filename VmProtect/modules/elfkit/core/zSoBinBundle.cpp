@@ -10,6 +10,7 @@
 #include "zCodec.h"
 #include "zFile.h"
 #include "zLog.h"
+#include "shared/bundle/zSoBinBundleProtocol.h"
 
 #include <unordered_set>  // fun_addr 去重校验。
 
@@ -51,8 +52,8 @@ struct SoBinBundleFooter {
 constexpr uint32_t kSoBinBundleHeaderMagic = 0x48424D56; // 'VMBH'
 // 固定尾部魔数。
 constexpr uint32_t kSoBinBundleFooterMagic = 0x46424D56; // 'VMBF'
-// 当前协议版本。
-constexpr uint32_t kSoBinBundleVersion = 1;
+// 协议版本（与写入/读取端共用）。
+constexpr uint32_t kSoBinBundleVersion = vmp::bundle::protocol::kSoBinBundleVersion;
 
 void appendHeader(std::vector<uint8_t>* out, const SoBinBundleHeader& header) {
     vmp::base::codec::appendU32Le(out, header.magic);
@@ -153,12 +153,12 @@ bool buildPatchbayAliasTables(const vmp::elfkit::zElfReadFacade& elf,
         }
     }
 
-    // 若存在待回填条目，则必须能解析 dispatch 符号地址用于合成跳板。
+    // 若存在待回填条目，则必须能解析寄存器帧接管入口地址用于合成跳板。
     if (!out->pendingTakeoverBindings.empty()) {
         vmp::elfkit::PatchSymbolInfo dispatch{};
-        if (!elf.resolveSymbol("vm_takeover_dispatch_by_key", &dispatch) || !dispatch.found || dispatch.value == 0) {
+        if (!elf.resolveSymbol("vm_takeover_entry", &dispatch) || !dispatch.found || dispatch.value == 0) {
             if (error != nullptr) {
-                *error = "dispatch symbol not found or invalid: vm_takeover_dispatch_by_key";
+                *error = "dispatch symbol not found or invalid: vm_takeover_entry";
             }
             return false;
         }
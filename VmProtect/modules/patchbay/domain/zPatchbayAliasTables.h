@@ -27,7 +27,7 @@ struct AliasTableBuildResult {
     uint32_t appendedCount = 0;
     // dynsym 中需要在重构阶段回填 st_value 的条目绑定（symbolIndex -> symbolKey/soId）。
     std::vector<PendingTakeoverSymbolBinding> pendingTakeoverBindings;
-    // 供合成跳板使用的 dispatch 目标地址（vm_takeover_dispatch_by_key）。
+    // 供合成跳板使用的 dispatch 目标地址（寄存器帧接管入口 vm_takeover_entry）。
     uint64_t takeoverDispatchAddr = 0;
 };
 
@@ -61,16 +61,18 @@ void fillPatchbayOriginResult(zPatchbayOriginResult* outResult,  // 流程注记
     outResult->inputExportCount = inputExportCount;
     outResult->appendCount = appendCount;
     outResult->keyMode = keyMode;
+    outResult->skippedFpReturnExports.clear();
 }
 
 // 构建冲突摘要文本（限制输出条数，避免日志过长）。
-std::string buildConflictSummary(const std::vector<std::string>& duplicateExports) {
+std::string buildConflictSummary(const std::vector<std::string>& duplicateExports,
+                                 const char* title = "export conflict between origin and vmengine") {
     // 冲突为空时返回空串。
     if (duplicateExports.empty()) {
         return "";
     }
     // 先写入总数。
-    std::string summary = "export conflict between origin and vmengine: count=" +
+    std::string summary = std::string(title) + ": count=" +
                           std::to_string(duplicateExports.size());
     // 最多拼接前 8 个样例名。
     constexpr size_t kDetailLimit = 8;
@@ -284,20 +286,42 @@ bool runPatchbayExportAliasFromOrigin(const zPatchbayOriginRequest& request,
         return false;
     }
 
+    // takeover 桩只从寄存器帧回传 x0/x1，VM 不产生浮点/向量结果（q0 返回前被清零）：
+    // 接管函数中以 v0 返回的导出不追加 alias，保留 origin 原实现，避免调用方拿到错误结果。
+    std::unordered_set<std::string> takeoverSet(request.takeoverFunctions.begin(),
+                                                request.takeoverFunctions.end());
+    std::vector<std::string> fpReturnExports;
+    std::vector<uint8_t> exportCode;
     // 构建 alias 对列表。
     std::vector<AliasPair> aliasPairs;
     aliasPairs.reserve(originExports.size());
     const bool keyMode = true;
     constexpr uint32_t kDefaultTakeoverSoId = 1U;
-    for (size_t exportIndex = 0; exportIndex < originExports.size(); ++exportIndex) {
+    for (const vmp::elfkit::PatchDynamicExportInfo& originExport : originExports) {
+        const bool checkFpReturn = originExport.type == STT_FUNC && originExport.size != 0 &&
+                                   (takeoverSet.empty() || takeoverSet.count(originExport.name) != 0);
+        if (checkFpReturn) {
+            if (!originElf.readVirtualBytes(originExport.value, originExport.size, &exportCode)) {
+                LOGW("patchbay origin: skip fp-return check, code not readable: %s",
+                     originExport.name.c_str());
+            } else if (arm64CodeReturnsFpValue(exportCode.data(), exportCode.size())) {
+                fpReturnExports.push_back(originExport.name);
+                continue;
+            }
+        }
         AliasPair pair;
-        pair.exportName = originExports[exportIndex].name;
+        pair.exportName = originExport.name;
         // route4 约定：使用 origin st_value 作为导出 key。
-        pair.exportKey = originExports[exportIndex].value;
+        pair.exportKey = originExport.value;
         // 当前单模块默认 soId=1，后续多模块可在 pipeline 中分配独立 soId。
         pair.soId = kDefaultTakeoverSoId;
         aliasPairs.push_back(std::move(pair));
     }
+    if (!fpReturnExports.empty()) {
+        LOGW("patchbay origin: %s",
+             buildConflictSummary(fpReturnExports,
+                                  "skip takeover for exports returning fp/simd values").c_str());
+    }
 
     // 输出启动摘要日志。
     LOGI("patchbay origin start: originExports=%zu inputExports=%zu toAppend=%zu mode=%s",
@@ -350,6 +374,9 @@ bool runPatchbayExportAliasFromOrigin(const zPatchbayOriginRequest& request,
                             inputExports.size(),
                             aliasPairs.size(),
                             keyMode);
+    if (outResult != nullptr) {
+        outResult->skippedFpReturnExports = std::move(fpReturnExports);
+    }
     return true;
 }
 
@@ -3,6 +3,8 @@
 
 // 引入字符串类型。
 #include <string>
+// 引入字符串数组容器。
+#include <vector>
 
 // patchbay origin 导出流程的输入参数。
 struct zPatchbayOriginRequest {
@@ -12,6 +14,8 @@ struct zPatchbayOriginRequest {
     std::string originSoPath;
     // 输出 so（应用 alias patch 后的最终产物）。
     std::string outputSoPath;
+    // 由 VM 接管的函数名（加固函数集合）；只对这些导出做浮点返回检查，为空时检查全部函数导出。
+    std::vector<std::string> takeoverFunctions;
 };
 
 // origin 流程状态码（用于结构化错误定位）。
@@ -48,6 +52,8 @@ struct zPatchbayOriginResult {
     size_t inputExportCount = 0;
     // 实际追加 alias 数量。
     size_t appendCount = 0;
+    // 以浮点/向量值返回而未接管的导出（不追加 alias，调用仍落到 origin 原实现）。
+    std::vector<std::string> skippedFpReturnExports;
     // 是否启用 key 路由模式。
     bool keyMode = false;
 };
@@ -12,6 +12,8 @@
 #include "zLog.h"
 // 引入 ELF 只读 facade（用于输出文件复验）。
 #include "zElfReadFacade.h"
+// 引入 patchbay 跨端协议（接管跳板直连槽位容量）。
+#include "shared/patchbay/zPatchbayProtocol.h"
 
 // 引入 std::min。
 #include <algorithm>
@@ -535,29 +537,34 @@ void appendU64Le(std::vector<uint8_t>* out, uint64_t value) {
 }
 
 // 生成 ARM64 合成跳板（40 bytes）：
-// ldr  x2, #16          ; symbolKey
-// ldr  x3, #20          ; soId
-// ldr  x16, #24         ; dispatch
-// br   x16
+// ldr  x17, #16         ; 接管入口 vm_takeover_entry
+// adr  x16, #20         ; x16 -> {symbolKey, soId}
+// br   x17
+// nop                   ; 填充，使字面量 8 字节对齐
+// .quad entry_addr
 // .quad symbolKey
-// .quad soId
-// .quad dispatch_addr
+// .word soId
+// .word bindSlot        ; 直连槽位号（1 起，0 表示无槽位）
+// 路由 key 经 x16（IP0，调用约定允许跳板破坏）带外传递，x0..x7 / x8 / q0..q7 原样到达入口。
 void appendTakeoverTrampolineArm64(uint64_t symbolKey,
                                    uint32_t soId,
+                                   uint32_t bindSlot,
                                    uint64_t dispatchAddr,
                                    std::vector<uint8_t>* out) {
-    const uint32_t ldrX2LiteralPlus16 = 0x58000000U | (4U << 5) | 2U;
-    const uint32_t ldrX3LiteralPlus20 = 0x58000000U | (5U << 5) | 3U;
-    const uint32_t ldrX16LiteralPlus24 = 0x58000000U | (6U << 5) | 16U;
-    const uint32_t brX16 = 0xD61F0000U | (16U << 5);
-
-    appendU32Le(out, ldrX2LiteralPlus16);
-    appendU32Le(out, ldrX3LiteralPlus20);
-    appendU32Le(out, ldrX16LiteralPlus24);
-    appendU32Le(out, brX16);
-    appendU64Le(out, symbolKey);
-    appendU64Le(out, static_cast<uint64_t>(soId));
+    const uint32_t ldrX17LiteralPlus16 = 0x58000000U | (4U << 5) | 17U;
+    // adr 立即数 20：immlo=0，immhi=5。
+    const uint32_t adrX16Plus20 = 0x10000000U | (5U << 5) | 16U;
+    const uint32_t brX17 = 0xD61F0000U | (17U << 5);
+    const uint32_t nop = 0xD503201FU;
+
+    appendU32Le(out, ldrX17LiteralPlus16);
+    appendU32Le(out, adrX16Plus20);
+    appendU32Le(out, brX17);
+    appendU32Le(out, nop);
     appendU64Le(out, dispatchAddr);
+    appendU64Le(out, symbolKey);
+    appendU32Le(out, soId);
+    appendU32Le(out, bindSlot);
 }
 
 // 根据 pending 绑定构建“bindingIndex -> stub 相对偏移”与 stub blob。
@@ -595,7 +602,12 @@ bool buildSyntheticTakeoverStubBlob(
             return false;
         }
         const uint64_t relOff = outStubBytes->size();
-        appendTakeoverTrampolineArm64(binding.symbolKey, binding.soId, dispatchAddr, outStubBytes);
+        // 按生成顺序分配直连槽位，超出运行时容量的跳板只走按 key 分发。
+        const uint64_t stubIndex = outStubOffByBindingIndex->size();
+        const uint32_t bindSlot = stubIndex < vmp::patchbay::protocol::kTakeoverBindSlotCap
+                                  ? static_cast<uint32_t>(stubIndex + 1)
+                                  : 0U;
+        appendTakeoverTrampolineArm64(binding.symbolKey, binding.soId, bindSlot, dispatchAddr, outStubBytes);
         outStubOffByBindingIndex->push_back(relOff);
     }
     return true;
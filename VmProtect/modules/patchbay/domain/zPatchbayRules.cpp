@@ -40,3 +40,208 @@ bool validateVmengineExportNamingRules(const std::vector<std::string>& inputExpo
     }
     return true;
 }
+
+// 判断单条 arm64 指令是否以 SIMD&FP 0 号寄存器为目的。
+static bool arm64InstWritesFpRegister0(uint32_t insn) {
+    const uint32_t rt = insn & 0x1FU;
+    // LDR (literal, SIMD&FP)。
+    if ((insn & 0x3F000000U) == 0x1C000000U) {
+        return rt == 0;
+    }
+    // LDP/LDNP (SIMD&FP)：V=1 且 L=1，Rt 或 Rt2 为 0。
+    if ((insn & 0x3A000000U) == 0x28000000U) {
+        const bool simd = (insn & (1U << 26)) != 0;
+        const bool load = (insn & (1U << 22)) != 0;
+        const uint32_t rt2 = (insn >> 10) & 0x1FU;
+        return simd && load && (rt == 0 || rt2 == 0);
+    }
+    // LDR/LDUR (SIMD&FP, 各寻址形式)：V=1 且 opc<0>=1 为加载。
+    if ((insn & 0x38000000U) == 0x38000000U) {
+        const bool simd = (insn & (1U << 26)) != 0;
+        const bool load = (insn & (1U << 22)) != 0;
+        return simd && load && rt == 0;
+    }
+    // LD1..LD4 / LDnR 结构加载：寄存器列表最多 4 个且按 32 回绕，Rt>=29 时也会覆盖 v0。
+    const uint32_t structClass = insn & 0xBF800000U;
+    if (structClass == 0x0C000000U || structClass == 0x0C800000U ||
+        structClass == 0x0D000000U || structClass == 0x0D800000U) {
+        const bool load = (insn & (1U << 22)) != 0;
+        return load && (rt == 0 || rt >= 29);
+    }
+    // 其余只关心 SIMD&FP 数据处理（op0 = x111）。
+    if ((insn & 0x0E000000U) != 0x0E000000U) {
+        return false;
+    }
+    // FCMP/FCMPE、FCCMP/FCCMPE 只写 NZCV。
+    if ((insn & 0x5F203C00U) == 0x1E202000U || (insn & 0x5F200C00U) == 0x1E200400U) {
+        return false;
+    }
+    // 浮点 <-> 整数转换：仅 SCVTF/UCVTF(2/3) 与 FMOV 通用->浮点(7) 写浮点寄存器。
+    if ((insn & 0x5F20FC00U) == 0x1E200000U) {
+        const uint32_t opcode = (insn >> 16) & 0x7U;
+        return (opcode == 2 || opcode == 3 || opcode == 7) && rt == 0;
+    }
+    // 浮点 <-> 定点转换：仅 SCVTF/UCVTF(2/3) 写浮点寄存器。
+    if ((insn & 0x5F200000U) == 0x1E000000U) {
+        const uint32_t opcode = (insn >> 16) & 0x7U;
+        return (opcode == 2 || opcode == 3) && rt == 0;
+    }
+    // SMOV/UMOV 目的为通用寄存器。
+    if ((insn & 0xBFE08400U) == 0x0E000400U) {
+        const uint32_t imm4 = (insn >> 11) & 0xFU;
+        if (imm4 == 5 || imm4 == 7) {
+            return false;
+        }
+    }
+    // 其余 SIMD&FP 数据处理指令的 Rd 均为向量/浮点寄存器。
+    return rt == 0;
+}
+
+// 判断单条 arm64 指令是否以通用 0 号寄存器（x0/w0）为目的。
+static bool arm64InstWritesGpRegister0(uint32_t insn) {
+    const uint32_t rt = insn & 0x1FU;
+    // 数据处理（立即数）：ADR/ADD/SUB/逻辑/MOVZ/MOVN/MOVK/位域/EXTR 均写 Rd。
+    if ((insn & 0x1C000000U) == 0x10000000U) {
+        return rt == 0;
+    }
+    // 数据处理（寄存器）：除 CCMP/CCMN（低 4 位为 nzcv 立即数，只写 NZCV）外均写 Rd。
+    if ((insn & 0x0E000000U) == 0x0A000000U) {
+        if ((insn & 0x3FE00000U) == 0x3A400000U) {
+            return false;
+        }
+        return rt == 0;
+    }
+    // MRS：系统寄存器读到 Rt。
+    if ((insn & 0xFFF00000U) == 0xD5300000U) {
+        return rt == 0;
+    }
+    // LDR (literal, 通用寄存器)：opc=11 为 PRFM，不写寄存器。
+    if ((insn & 0x3F000000U) == 0x18000000U) {
+        return (insn >> 30) != 3U && rt == 0;
+    }
+    // 独占/有序访问：CAS/CASP（o2=1 且 o1=1）写 Rs，加载写 Rt/Rt2，独占存储把状态写入 Rs，STLR 不写寄存器。
+    if ((insn & 0x3F000000U) == 0x08000000U) {
+        const bool o2 = (insn & (1U << 23)) != 0;
+        const bool o1 = (insn & (1U << 21)) != 0;
+        const bool load = (insn & (1U << 22)) != 0;
+        const uint32_t rs = (insn >> 16) & 0x1FU;
+        const uint32_t rt2 = (insn >> 10) & 0x1FU;
+        if (o2 && o1) {
+            return rs == 0;
+        }
+        if (load) {
+            return rt == 0 || (o1 && rt2 == 0);
+        }
+        return !o2 && rs == 0;
+    }
+    // LDP/LDNP/LDPSW (通用寄存器)：L=1，Rt 或 Rt2 为 0。
+    if ((insn & 0x3E000000U) == 0x28000000U) {
+        const bool load = (insn & (1U << 22)) != 0;
+        const uint32_t rt2 = (insn >> 10) & 0x1FU;
+        return load && (rt == 0 || rt2 == 0);
+    }
+    // LDR/LDUR/LDRS* 与原子内存操作（通用寄存器）。
+    if ((insn & 0x3E000000U) == 0x38000000U) {
+        // LDADD/LDCLR/SWP 等原子操作把旧值写入 Rt。
+        if ((insn & 0x3F200C00U) == 0x38200000U) {
+            return rt == 0;
+        }
+        const uint32_t sizeBits = insn >> 30;
+        const uint32_t opc = (insn >> 22) & 0x3U;
+        // opc=00 为存储；size=11 且 opc=10 为 PRFM。
+        if (opc == 0 || (sizeBits == 3U && opc == 2U)) {
+            return false;
+        }
+        return rt == 0;
+    }
+    // SIMD&FP -> 通用寄存器：FCVT*/FMOV(to general) 与 SMOV/UMOV。
+    if ((insn & 0x5F20FC00U) == 0x1E200000U) {
+        const uint32_t opcode = (insn >> 16) & 0x7U;
+        return !(opcode == 2 || opcode == 3 || opcode == 7) && rt == 0;
+    }
+    if ((insn & 0x5F200000U) == 0x1E000000U) {
+        const uint32_t opcode = (insn >> 16) & 0x7U;
+        return (opcode == 0 || opcode == 1) && rt == 0;
+    }
+    if ((insn & 0xBFE08400U) == 0x0E000400U) {
+        const uint32_t imm4 = (insn >> 11) & 0xFU;
+        return (imm4 == 5 || imm4 == 7) && rt == 0;
+    }
+    return false;
+}
+
+// 判断单条 arm64 指令是否把 SIMD&FP 0 号寄存器作为存储数据源（STR/STUR/STP/ST1..ST4）。
+static bool arm64InstStoresFpRegister0(uint32_t insn) {
+    const uint32_t rt = insn & 0x1FU;
+    if ((insn & 0x3A000000U) == 0x28000000U) {
+        const bool simd = (insn & (1U << 26)) != 0;
+        const bool load = (insn & (1U << 22)) != 0;
+        const uint32_t rt2 = (insn >> 10) & 0x1FU;
+        return simd && !load && (rt == 0 || rt2 == 0);
+    }
+    if ((insn & 0x3E000000U) == 0x3C000000U) {
+        const bool load = (insn & (1U << 22)) != 0;
+        return !load && rt == 0;
+    }
+    const uint32_t structClass = insn & 0xBF800000U;
+    if (structClass == 0x0C000000U || structClass == 0x0C800000U ||
+        structClass == 0x0D000000U || structClass == 0x0D800000U) {
+        const bool load = (insn & (1U << 22)) != 0;
+        return !load && (rt == 0 || rt >= 29);
+    }
+    return false;
+}
+
+// 回溯中止点：BL/BLR（调用同时破坏 x0 与 v0）或 B/BR/RET（前一条不会顺序落入）。
+static bool arm64InstEndsStraightLine(uint32_t insn) {
+    // B / BL。
+    if ((insn & 0x7C000000U) == 0x14000000U) {
+        return true;
+    }
+    // 无条件跳转（寄存器）：BR/BLR/RET 及其 PAC 变体。
+    return (insn & 0xFE000000U) == 0xD6000000U;
+}
+
+// 判断是否为 RET / RETAA / RETAB。
+static bool arm64InstIsReturn(uint32_t insn) {
+    return (insn & 0xFFFFFC1FU) == 0xD65F0000U || insn == 0xD65F0BFFU || insn == 0xD65F0FFFU;
+}
+
+// 读取偏移处的小端指令字。
+static uint32_t readArm64Inst(const uint8_t* code, size_t offset) {
+    return static_cast<uint32_t>(code[offset]) |
+           (static_cast<uint32_t>(code[offset + 1]) << 8) |
+           (static_cast<uint32_t>(code[offset + 2]) << 16) |
+           (static_cast<uint32_t>(code[offset + 3]) << 24);
+}
+
+// 从每条 RET 回溯最后一个 0 号寄存器写入者。
+bool arm64CodeReturnsFpValue(const uint8_t* code, size_t size) {
+    if (code == nullptr) {
+        return false;
+    }
+    for (size_t retOffset = 0; retOffset + 4 <= size; retOffset += 4) {
+        if (!arm64InstIsReturn(readArm64Inst(code, retOffset))) {
+            continue;
+        }
+        // v0 写入后若先被存到内存，视为临时数据（清零/拷贝），不是返回值。
+        bool storedV0 = false;
+        for (size_t offset = retOffset; offset >= 4;) {
+            offset -= 4;
+            const uint32_t insn = readArm64Inst(code, offset);
+            if (arm64InstEndsStraightLine(insn) || arm64InstWritesGpRegister0(insn)) {
+                break;
+            }
+            if (arm64InstStoresFpRegister0(insn)) {
+                storedV0 = true;
+            }
+            if (arm64InstWritesFpRegister0(insn)) {
+                if (!storedV0) {
+                    return true;
+                }
+                break;
+            }
+        }
+    }
+    return false;
+}
@@ -1,6 +1,8 @@
 #ifndef VMPROTECT_PATCHBAY_RULES_H
 #define VMPROTECT_PATCHBAY_RULES_H
 
+// 引入 size_t。
+#include <cstddef>
 // 引入基础整型定义。
 #include <cstdint>
 // 引入字符串类型。
@@ -21,4 +23,17 @@
 bool validateVmengineExportNamingRules(const std::vector<std::string>& inputExports,
                                        std::string* error);
 
+// 判断一段 arm64 函数体是否以浮点/向量值返回（v0/q0/d0/s0/h0/b0）。
+// 用途：takeover 桩只回传 x0/x1，VM 不建模浮点/向量寄存器，以浮点/向量值返回的导出不能被接管。
+// 判定：从每条 RET 向前沿直线代码回溯，遇到的最后一个 0 号寄存器写入者是 v0（而非 x0/w0），
+// 且写入后到 RET 之间 v0 没有作为 SIMD 存储的数据源，则视为浮点返回；
+// 回溯遇到调用、无条件跳转或函数起点时该 RET 不下结论（清零结构体、NEON 拷贝、向量化循环等只在中途写 v0 不受影响）。
+// 入参：
+// - code: 函数体字节（小端 4 字节指令）。
+// - size: 字节数（尾部不足 4 字节的部分忽略）。
+// 返回：
+// - true: 至少一条 RET 返回的是 v0 中的值。
+// - false: 未发现浮点返回路径。
+bool arm64CodeReturnsFpValue(const uint8_t* code, size_t size);
+
 #endif // VMPROTECT_PATCHBAY_RULES_H
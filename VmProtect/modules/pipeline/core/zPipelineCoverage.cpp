@@ -140,6 +140,50 @@ std::unordered_set<unsigned int> buildSupportedInsnIdSet() {  // 处理阶段入
     ids.insert(ARM64_INS_LDAR);
     ids.insert(ARM64_INS_BICS);
     ids.insert(ARM64_INS_EON);
+    // LSE 原子与 DMB：翻译为带内存序的 OP_ATOMIC_* / OP_FENCE。
+    ids.insert(ARM64_INS_LDADD);
+    ids.insert(ARM64_INS_LDADDB);
+    ids.insert(ARM64_INS_LDADDH);
+    ids.insert(ARM64_INS_LDADDA);
+    ids.insert(ARM64_INS_LDADDAB);
+    ids.insert(ARM64_INS_LDADDAH);
+    ids.insert(ARM64_INS_LDADDL);
+    ids.insert(ARM64_INS_LDADDLB);
+    ids.insert(ARM64_INS_LDADDLH);
+    ids.insert(ARM64_INS_LDADDAL);
+    ids.insert(ARM64_INS_LDADDALB);
+    ids.insert(ARM64_INS_LDADDALH);
+    ids.insert(ARM64_INS_SWP);
+    ids.insert(ARM64_INS_SWPB);
+    ids.insert(ARM64_INS_SWPH);
+    ids.insert(ARM64_INS_SWPA);
+    ids.insert(ARM64_INS_SWPAB);
+    ids.insert(ARM64_INS_SWPAH);
+    ids.insert(ARM64_INS_SWPL);
+    ids.insert(ARM64_INS_SWPLB);
+    ids.insert(ARM64_INS_SWPLH);
+    ids.insert(ARM64_INS_SWPAL);
+    ids.insert(ARM64_INS_SWPALB);
+    ids.insert(ARM64_INS_SWPALH);
+    ids.insert(ARM64_INS_CAS);
+    ids.insert(ARM64_INS_CASB);
+    ids.insert(ARM64_INS_CASH);
+    ids.insert(ARM64_INS_CASA);
+    ids.insert(ARM64_INS_CASAB);
+    ids.insert(ARM64_INS_CASAH);
+    ids.insert(ARM64_INS_CASL);
+    ids.insert(ARM64_INS_CASLB);
+    ids.insert(ARM64_INS_CASLH);
+    ids.insert(ARM64_INS_CASAL);
+    ids.insert(ARM64_INS_CASALB);
+    ids.insert(ARM64_INS_CASALH);
+    ids.insert(ARM64_INS_ALIAS_STADD);
+    ids.insert(ARM64_INS_ALIAS_STADDL);
+    ids.insert(ARM64_INS_ALIAS_STADDB);
+    ids.insert(ARM64_INS_ALIAS_STADDLB);
+    ids.insert(ARM64_INS_ALIAS_STADDH);
+    ids.insert(ARM64_INS_ALIAS_STADDLH);
+    ids.insert(ARM64_INS_DMB);
     // 流程说明：该注释位置用于解释当前统计链路的关键步骤。
     return ids;
 }
@@ -19,6 +19,8 @@
 #include "zPipelineCli.h"
 // 引入 expand so 打包器。
 #include "zSoBinBundle.h"
+// 引入 bundle 跨端协议（branch 地址 VM 目标标记）。
+#include "shared/bundle/zSoBinBundleProtocol.h"
 
 // 进入 vmp 主命名空间。
 namespace vmp {
@@ -72,6 +74,34 @@ void appendUniqueBranchAddrs(const std::vector<uint64_t>& localAddrs,
     }
 }
 
+// 为目标本身也在受保护集合中的共享分支地址打上 VM 目标标记。
+// 运行时据此把 VM 到 VM 的 OP_BL 直接转成嵌套 VM 调用，不再经原生跳板绕回 takeover 分发。
+std::vector<uint64_t> tagVmTargetBranchAddrs(const std::vector<uint64_t>& sharedBranchAddrs,
+                                             const std::vector<elfkit::FunctionView>& functions,
+                                             size_t* outTaggedCount) {
+    // 受保护函数地址集合（与 payload.funAddr 同源）。
+    std::unordered_set<uint64_t> protectedAddrs;
+    for (const elfkit::FunctionView& function : functions) {
+        protectedAddrs.insert(static_cast<uint64_t>(function.getOffset()));
+    }
+    std::vector<uint64_t> taggedAddrs;
+    taggedAddrs.reserve(sharedBranchAddrs.size());
+    size_t taggedCount = 0;
+    for (uint64_t addr : sharedBranchAddrs) {
+        // 标记位与模块相对地址互不重叠；理论上不会出现高位已置位的地址，出现时保持原样。
+        if (!bundle::protocol::isVmTargetBranchAddr(addr) && protectedAddrs.count(addr) != 0) {
+            taggedAddrs.push_back(addr | bundle::protocol::kBranchAddrVmTarget);
+            ++taggedCount;
+        } else {
+            taggedAddrs.push_back(addr);
+        }
+    }
+    if (outTaggedCount != nullptr) {
+        *outTaggedCount = taggedCount;
+    }
+    return taggedAddrs;
+}
+
 // 校验导出前的翻译状态。
 // 优先复用覆盖率阶段产出的 translateOk 结果；缺失时回退到直接 prepareTranslation。
 bool validateTranslationForExport(const std::vector<std::string>& functionNames,
@@ -215,20 +245,25 @@ bool exportProtectedPackage(const VmProtectConfig& config,
     }
 
     // 第四阶段：把 payload 与地址表写入 expanded so。
+    // OP_BL 已按原始地址完成重映射，此后才能给表项打标记（标记不改变表项下标）。
+    size_t vmTargetCount = 0;
+    const std::vector<uint64_t> bundleBranchAddrs =
+        tagVmTargetBranchAddrs(sharedBranchAddrs, functions, &vmTargetCount);
     const std::string expandedSoPath = joinOutputPath(config, config.expandedSo);
     if (!zSoBinBundleWriter::writeExpandedSo(
             config.inputSo.c_str(),
             expandedSoPath.c_str(),
             payloads,
-            sharedBranchAddrs)) {
+            bundleBranchAddrs)) {
         LOGE("failed to build expanded so: %s", expandedSoPath.c_str());
         return false;
     }
 
     // 输出导出完成摘要。
-    LOGI("export completed: payload_count=%u shared_branch_addr_count=%u",
+    LOGI("export completed: payload_count=%u shared_branch_addr_count=%u vm_target_count=%u",
          static_cast<unsigned int>(payloads.size()),
-         static_cast<unsigned int>(sharedBranchAddrs.size()));
+         static_cast<unsigned int>(sharedBranchAddrs.size()),
+         static_cast<unsigned int>(vmTargetCount));
     return true;
 }
 
@@ -106,7 +106,8 @@ bool embedExpandedSoIntoVmengine(const std::string& vmengineSo,
 // 调用 patchbay：从 origin 导出 alias 并注入目标 so。
 bool runPatchbayExportFromOrigin(const std::string& inputSo,
                                  const std::string& outputSo,
-                                 const std::string& originSo) {
+                                 const std::string& originSo,
+                                 const std::vector<std::string>& takeoverFunctions) {
     // 校验输入 so 存在。
     if (!base::file::fileExists(inputSo)) {
         LOGE("patch input so not found: %s", inputSo.c_str());
@@ -127,6 +128,8 @@ bool runPatchbayExportFromOrigin(const std::string& inputSo,
     request.inputSoPath = inputSo;
     request.originSoPath = originSo;
     request.outputSoPath = outputSo;
+    // 加固函数集合即接管范围（浮点返回检查只针对这些导出）。
+    request.takeoverFunctions = takeoverFunctions;
 
     // 执行 origin API。
     zPatchbayOriginResult runResult;
@@ -143,6 +146,12 @@ bool runPatchbayExportFromOrigin(const std::string& inputSo,
         return false;
     }
 
+    // 浮点返回的接管函数未追加 alias（保留原实现），单独提示。
+    if (!runResult.skippedFpReturnExports.empty()) {
+        LOGW("patchbay export skipped fp-return takeover: count=%zu",
+             runResult.skippedFpReturnExports.size());
+    }
+
     // 输出完成摘要，便于问题排查。
     LOGI("patchbay export completed: tool=domain_api input=%s output=%s origin=%s mode=key",
          inputSo.c_str(),
@@ -178,7 +187,8 @@ bool runVmengineProtectFlow(const VmProtectConfig& config) {
     // 再执行 patchbay origin 导出流程。
     if (!runPatchbayExportFromOrigin(embedTmpSoPath,
                                      outputSoPath,
-                                     originSoPath)) {
+                                     originSoPath,
+                                     config.functions)) {
         return false;
     }
 
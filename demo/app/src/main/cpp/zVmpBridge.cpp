@@ -585,6 +585,14 @@ std::string buildProtectResultText() {
         << std::setw(10) << "status" << "\n";
     oss << "----------------------------------------------------------------------\n";
 
+    // 接管调用顺序用例：必须排在所有 fun_* 调用之前。
+    // 第一次调用走未绑定的按 key 分发路径（冷路径），第二次走已回填的直连绑定；两次都用非零且不同的 x0/x1，
+    // 冷路径若提前清掉参数寄存器，首条结果就会与 ref 不一致。
+    const std::vector<IntCase> takeoverOrderCases = {
+        {"takeover_first_call", fun_add, 7, 11, "fun_add_ref"},
+        {"takeover_bound_call", fun_add, -3, 9, "fun_add_ref"},
+    };
+
     const std::vector<IntCase> cases = {
         {"fun_add", fun_add, 2, 4, "fun_add_ref"},
         {"fun_for", fun_for, 2, 4, "fun_for_ref"},
@@ -682,6 +690,12 @@ std::string buildProtectResultText() {
 
     int passCount = 0;
     int totalCount = 0;
+    for (const IntCase& c : takeoverOrderCases) {
+        totalCount += 1;
+        if (appendIntCaseResult(oss, c)) {
+            passCount += 1;
+        }
+    }
     for (const IntCase& c : cases) {
         totalCount += 1;
         if (appendIntCaseResult(oss, c)) {
@@ -0,0 +1,39 @@
+// expand so bundle 跨端协议定义：
+// - 离线侧（VmProtect 写入）与运行时（VmEngine 读取）必须共用同一份版本与编码约定；
+// - 避免双端手工拷贝导致字段漂移。
+#pragma once
+
+// 固定宽度整数类型。
+#include <cstdint>
+
+namespace vmp::bundle::protocol {
+
+// bundle 协议版本。
+// v2：共享 branch 地址表项可带 VM 目标标记（见 kBranchAddrVmTarget）。
+constexpr uint32_t kSoBinBundleVersion = 2;
+// 读取端兼容的最低版本：v1 与 v2 布局相同，只是没有 VM 目标标记表项，按原生地址调用即可。
+constexpr uint32_t kSoBinBundleMinVersion = 1;
+
+// 读取端是否接受该版本（写入端始终写 kSoBinBundleVersion）。
+constexpr bool isSupportedSoBinBundleVersion(uint32_t version) {
+    return version >= kSoBinBundleMinVersion && version <= kSoBinBundleVersion;
+}
+
+// 共享 branch 地址表项标记位：目标本身是同一 bundle 内的受保护函数。
+// 低位仍是模块相对地址（等于该函数 payload 的 fun_addr），运行时可直接在 VM 内嵌套执行，
+// 无需经原生导出跳板绕回 takeover 分发；不识别该标记时剥离后按原生地址调用仍然正确。
+constexpr uint64_t kBranchAddrVmTarget = 1ULL << 63;
+// 剥离标记后的地址掩码。
+constexpr uint64_t kBranchAddrMask = ~kBranchAddrVmTarget;
+
+// 是否为 VM 目标表项。
+constexpr bool isVmTargetBranchAddr(uint64_t entry) {
+    return (entry & kBranchAddrVmTarget) != 0;
+}
+
+// 取表项的模块相对地址。
+constexpr uint64_t branchAddrOffset(uint64_t entry) {
+    return entry & kBranchAddrMask;
+}
+
+}  // namespace vmp::bundle::protocol
@@ -0,0 +1,328 @@
+// VM 字节码跨端协议定义：
+// - 离线侧（VmProtect 翻译器发射）与运行时（VmEngine 解释执行）必须共用同一份 opcode 编号、
+//   类型特化 opcode 清单与指令长度规则；
+// - 避免双端手工拷贝导致编号或操作数长度漂移（漂移不会产生编译错误，只会在运行时错位解码）。
+#pragma once
+
+// size_t。
+#include <cstddef>
+// 固定宽度整数类型。
+#include <cstdint>
+
+// ============================================================================
+// 类型特化 opcode 族（单一定义）
+// ============================================================================
+// 宽度/符号在 opcode 中静态确定：处理函数省去类型表查找与按 size 分派，翻译端在类型已知时直接发射。
+// 条目格式：X(opcode, handler, kind, binOp, width, isSigned)
+// - kind：VM_TYPED_BINARY     [op][lhs_reg][rhs_reg][dst_reg]
+//         VM_TYPED_BINARY_IMM [op][lhs_reg][imm][dst_reg]
+//         VM_TYPED_LOAD       [op][base_reg][offset][dst_reg]
+//         VM_TYPED_STORE      [op][base_reg][offset][value_reg]（value_reg 越界表示零寄存器）
+// - width：字节数；I32 运算结果按 AArch64 W 寄存器语义零扩展到 64 位。
+// - isSigned：除法按有符号计算 / 读取结果符号扩展到 64 位。
+// 本清单同时驱动 opcode 编号、指令长度（两端共用），以及运行时的处理函数生成、跳转表注册、校验与预解码；
+// handler 字段只在运行时展开，翻译端忽略。
+// 内部形式 VM_TYPED_OPCODE_SPEC(F, Y) 对每个条目展开 F(Y, ...)，便于把回调宏原样转发给 VM_OPCODE_HANDLER_LIST。
+#define VM_TYPED_OPCODE_SPEC(F, Y) \
+    F(Y, OP_ADD_I32,      op_add_i32,      VM_TYPED_BINARY,     BIN_ADD,  4, 0) \
+    F(Y, OP_ADD_I64,      op_add_i64,      VM_TYPED_BINARY,     BIN_ADD,  8, 0) \
+    F(Y, OP_SUB_I32,      op_sub_i32,      VM_TYPED_BINARY,     BIN_SUB,  4, 0) \
+    F(Y, OP_SUB_I64,      op_sub_i64,      VM_TYPED_BINARY,     BIN_SUB,  8, 0) \
+    F(Y, OP_MUL_I32,      op_mul_i32,      VM_TYPED_BINARY,     BIN_MUL,  4, 0) \
+    F(Y, OP_MUL_I64,      op_mul_i64,      VM_TYPED_BINARY,     BIN_MUL,  8, 0) \
+    F(Y, OP_AND_I32,      op_and_i32,      VM_TYPED_BINARY,     BIN_AND,  4, 0) \
+    F(Y, OP_AND_I64,      op_and_i64,      VM_TYPED_BINARY,     BIN_AND,  8, 0) \
+    F(Y, OP_OR_I32,       op_or_i32,       VM_TYPED_BINARY,     BIN_OR,   4, 0) \
+    F(Y, OP_OR_I64,       op_or_i64,       VM_TYPED_BINARY,     BIN_OR,   8, 0) \
+    F(Y, OP_XOR_I32,      op_xor_i32,      VM_TYPED_BINARY,     BIN_XOR,  4, 0) \
+    F(Y, OP_XOR_I64,      op_xor_i64,      VM_TYPED_BINARY,     BIN_XOR,  8, 0) \
+    F(Y, OP_SHL_I32,      op_shl_i32,      VM_TYPED_BINARY,     BIN_SHL,  4, 0) \
+    F(Y, OP_SHL_I64,      op_shl_i64,      VM_TYPED_BINARY,     BIN_SHL,  8, 0) \
+    F(Y, OP_LSR_I32,      op_lsr_i32,      VM_TYPED_BINARY,     BIN_LSR,  4, 0) \
+    F(Y, OP_LSR_I64,      op_lsr_i64,      VM_TYPED_BINARY,     BIN_LSR,  8, 0) \
+    F(Y, OP_ASR_I32,      op_asr_i32,      VM_TYPED_BINARY,     BIN_ASR,  4, 1) \
+    F(Y, OP_ASR_I64,      op_asr_i64,      VM_TYPED_BINARY,     BIN_ASR,  8, 1) \
+    F(Y, OP_SDIV_I32,     op_sdiv_i32,     VM_TYPED_BINARY,     BIN_IDIV, 4, 1) \
+    F(Y, OP_SDIV_I64,     op_sdiv_i64,     VM_TYPED_BINARY,     BIN_IDIV, 8, 1) \
+    F(Y, OP_UDIV_I32,     op_udiv_i32,     VM_TYPED_BINARY,     BIN_IDIV, 4, 0) \
+    F(Y, OP_UDIV_I64,     op_udiv_i64,     VM_TYPED_BINARY,     BIN_IDIV, 8, 0) \
+    F(Y, OP_ADD_I32_IMM,  op_add_i32_imm,  VM_TYPED_BINARY_IMM, BIN_ADD,  4, 0) \
+    F(Y, OP_ADD_I64_IMM,  op_add_i64_imm,  VM_TYPED_BINARY_IMM, BIN_ADD,  8, 0) \
+    F(Y, OP_SUB_I32_IMM,  op_sub_i32_imm,  VM_TYPED_BINARY_IMM, BIN_SUB,  4, 0) \
+    F(Y, OP_SUB_I64_IMM,  op_sub_i64_imm,  VM_TYPED_BINARY_IMM, BIN_SUB,  8, 0) \
+    F(Y, OP_MUL_I32_IMM,  op_mul_i32_imm,  VM_TYPED_BINARY_IMM, BIN_MUL,  4, 0) \
+    F(Y, OP_MUL_I64_IMM,  op_mul_i64_imm,  VM_TYPED_BINARY_IMM, BIN_MUL,  8, 0) \
+    F(Y, OP_AND_I32_IMM,  op_and_i32_imm,  VM_TYPED_BINARY_IMM, BIN_AND,  4, 0) \
+    F(Y, OP_AND_I64_IMM,  op_and_i64_imm,  VM_TYPED_BINARY_IMM, BIN_AND,  8, 0) \
+    F(Y, OP_OR_I32_IMM,   op_or_i32_imm,   VM_TYPED_BINARY_IMM, BIN_OR,   4, 0) \
+    F(Y, OP_OR_I64_IMM,   op_or_i64_imm,   VM_TYPED_BINARY_IMM, BIN_OR,   8, 0) \
+    F(Y, OP_XOR_I32_IMM,  op_xor_i32_imm,  VM_TYPED_BINARY_IMM, BIN_XOR,  4, 0) \
+    F(Y, OP_XOR_I64_IMM,  op_xor_i64_imm,  VM_TYPED_BINARY_IMM, BIN_XOR,  8, 0) \
+    F(Y, OP_SHL_I32_IMM,  op_shl_i32_imm,  VM_TYPED_BINARY_IMM, BIN_SHL,  4, 0) \
+    F(Y, OP_SHL_I64_IMM,  op_shl_i64_imm,  VM_TYPED_BINARY_IMM, BIN_SHL,  8, 0) \
+    F(Y, OP_LSR_I32_IMM,  op_lsr_i32_imm,  VM_TYPED_BINARY_IMM, BIN_LSR,  4, 0) \
+    F(Y, OP_LSR_I64_IMM,  op_lsr_i64_imm,  VM_TYPED_BINARY_IMM, BIN_LSR,  8, 0) \
+    F(Y, OP_ASR_I32_IMM,  op_asr_i32_imm,  VM_TYPED_BINARY_IMM, BIN_ASR,  4, 1) \
+    F(Y, OP_ASR_I64_IMM,  op_asr_i64_imm,  VM_TYPED_BINARY_IMM, BIN_ASR,  8, 1) \
+    F(Y, OP_LDR_U8,       op_ldr_u8,       VM_TYPED_LOAD,       0,        1, 0) \
+    F(Y, OP_LDR_U16,      op_ldr_u16,      VM_TYPED_LOAD,       0,        2, 0) \
+    F(Y, OP_LDR_U32,      op_ldr_u32,      VM_TYPED_LOAD,       0,        4, 0) \
+    F(Y, OP_LDR_U64,      op_ldr_u64,      VM_TYPED_LOAD,       0,        8, 0) \
+    F(Y, OP_LDR_I8,       op_ldr_i8,       VM_TYPED_LOAD,       0,        1, 1) \
+    F(Y, OP_LDR_I16,      op_ldr_i16,      VM_TYPED_LOAD,       0,        2, 1) \
+    F(Y, OP_LDR_I32,      op_ldr_i32,      VM_TYPED_LOAD,       0,        4, 1) \
+    F(Y, OP_STR_I8,       op_str_i8,       VM_TYPED_STORE,      0,        1, 0) \
+    F(Y, OP_STR_I16,      op_str_i16,      VM_TYPED_STORE,      0,        2, 0) \
+    F(Y, OP_STR_I32,      op_str_i32,      VM_TYPED_STORE,      0,        4, 0) \
+    F(Y, OP_STR_I64,      op_str_i64,      VM_TYPED_STORE,      0,        8, 0)
+
+// 对外形式：X(opcode, handler, kind, binOp, width, isSigned)。
+#define VM_TYPED_OPCODE_APPLY(X, opcode, handler, kind, binOp, width, isSigned) \
+    X(opcode, handler, kind, binOp, width, isSigned)
+#define VM_TYPED_OPCODE_LIST(X) VM_TYPED_OPCODE_SPEC(VM_TYPED_OPCODE_APPLY, X)
+
+// ============================================================================
+// Opcode 定义
+// ============================================================================
+enum Opcode : uint32_t {
+    OP_END            = 0,
+    OP_BINARY         = 1,      // 二元运算
+    OP_TYPE_CONVERT   = 2,      // 类型转换
+    OP_LOAD_CONST     = 3,      // 加载常量
+    OP_STORE_CONST    = 4,      // 存储常量
+    OP_GET_ELEMENT    = 5,      // 获取数组元素
+    OP_ALLOC_RETURN   = 6,      // 申请一块用于存放返回值的内存；首条指令必须为本指令
+    OP_STORE          = 7,      // 写入内存
+    OP_LOAD_CONST64   = 8,      // 加载64位常量
+    OP_NOP            = 9,      // 空操作
+    OP_COPY           = 10,     // 复制值
+    OP_GET_FIELD      = 11,     // 获取字段
+    OP_CMP            = 12,     // 比较运算
+    OP_SET_FIELD      = 13,     // 设置字段
+    OP_RESTORE_REG    = 14,     // 恢复寄存器
+    OP_CALL           = 15,     // 函数调用
+    OP_RETURN         = 16,     // 返回
+    OP_BRANCH         = 17,     // 无条件跳转
+    OP_BRANCH_IF      = 18,     // 条件跳转
+    OP_ALLOC_MEMORY   = 19,     // 分配单对象
+    OP_MOV            = 20,     // 寄存器移动
+    OP_LOAD_IMM       = 21,     // 加载立即数
+    OP_DYNAMIC_CAST   = 22,     // 动态类型转换
+    OP_UNARY          = 23,     // 一元运算
+    OP_PHI            = 24,     // PHI 节点
+    OP_SELECT         = 25,     // 条件选择
+    OP_MEMCPY         = 26,     // 内存拷贝
+    OP_MEMSET         = 27,     // 内存设置
+    OP_STRLEN         = 28,     // 字符串长度
+    OP_FETCH_NEXT     = 29,     // 取下一条
+    OP_CALL_INDIRECT  = 30,     // 间接调用
+    OP_SWITCH         = 31,     // 多路分支跳转
+    OP_GET_PTR        = 32,     // 获取指针
+    OP_BITCAST        = 33,     // 位转换
+    OP_SIGN_EXTEND    = 34,     // 符号扩展
+    OP_ZERO_EXTEND    = 35,     // 零扩展
+    OP_TRUNCATE       = 36,     // 截断
+    OP_FLOAT_EXTEND   = 37,     // 浮点扩展
+    OP_FLOAT_TRUNCATE = 38,     // 浮点截断
+    OP_INT_TO_FLOAT   = 39,     // 整数转浮点
+    OP_ARRAY_ELEM     = 40,     // 数组元素
+    OP_FLOAT_TO_INT   = 41,     // 浮点转整数
+    OP_READ           = 42,     // 读取内存
+    OP_WRITE          = 43,     // 写入内存
+    OP_LEA            = 44,     // 计算地址
+    OP_ATOMIC_ADD     = 45,     // 原子加
+    OP_ATOMIC_SUB     = 46,     // 原子减
+    OP_ATOMIC_XCHG    = 47,     // 原子交换
+    OP_ATOMIC_CAS     = 48,     // 原子比较交换
+    OP_FENCE          = 49,     // 内存屏障
+    OP_UNREACHABLE    = 50,     // 不可达
+    OP_ALLOC_VSP      = 51,     // 动态申请虚拟栈（堆上），紧接 OP_ALLOC_RETURN 后
+    OP_BINARY_IMM     = 52,     // 二元运算（寄存器 + 立即数），结果写入目标寄存器
+    OP_BRANCH_IF_CC   = 53,     // 按 NZCV 条件码跳转到 branch_list[branchId]
+    OP_SET_RETURN_PC  = 54,     // 运行时写入返回地址寄存器（dstReg = 当前 pc + offset）
+    OP_BL             = 55,     // 带链接跳转（branchId -> branches[branchId]）
+    OP_ADRP           = 56,     // 基于模块基址 + 页偏移计算地址
+    OP_ATOMIC_LOAD    = 57,     // 原子读取（带内存序）
+    OP_ATOMIC_STORE   = 58,     // 原子写入（带内存序）
+    OP_BRANCH_REG     = 59,     // 间接跳转（目标地址由寄存器给出）
+
+    // 类型特化 opcode：紧接 OP_BRANCH_REG 连续编号（60 起），顺序由 VM_TYPED_OPCODE_LIST 决定。
+#define VM_TYPED_OPCODE_ENUM(opcode, handler, kind, binOp, width, isSigned) opcode,
+    VM_TYPED_OPCODE_LIST(VM_TYPED_OPCODE_ENUM)
+#undef VM_TYPED_OPCODE_ENUM
+    OP_TYPED_END,               // 类型特化 opcode 上界（不含）
+
+    OP_MAX            = 128     // 最大 opcode 数量
+};
+
+// 类型特化 opcode 起点。
+constexpr uint32_t kVmTypedOpcodeBegin = static_cast<uint32_t>(OP_BRANCH_REG) + 1u;
+static_assert(OP_TYPED_END <= OP_MAX, "typed opcode family exceeds OP_MAX");
+
+// 类型特化 opcode 的操作形态（VM_TYPED_OPCODE_LIST 的 kind 字段）。
+enum VMTypedKind : uint32_t {
+    VM_TYPED_BINARY     = 0,    // 寄存器-寄存器二元运算
+    VM_TYPED_BINARY_IMM = 1,    // 寄存器-立即数二元运算
+    VM_TYPED_LOAD       = 2,    // 定宽读取
+    VM_TYPED_STORE      = 3,    // 定宽写入
+};
+
+// ============================================================================
+// 二元运算子操作码
+// ============================================================================
+enum BinaryOp : uint32_t {
+    BIN_XOR  = 0,     // 异或
+    BIN_SUB  = 1,     // 减法
+    BIN_ASR  = 2,     // 算术右移
+    BIN_DIV  = 3,     // 除法（浮点/整数）
+    BIN_ADD  = 4,     // 加法
+    BIN_OR   = 5,     // 或
+    BIN_MOD  = 6,     // 取模
+    BIN_IDIV = 7,     // 整数除法
+    BIN_FMOD = 8,     // 浮点 fmod / 整数取模
+    BIN_MUL  = 9,     // 乘法
+    BIN_LSR  = 0xA,   // 逻辑右移
+    BIN_SHL  = 0xB,   // 左移
+    BIN_AND  = 0xC,   // 与
+};
+
+namespace vmp::bytecode::protocol {
+
+// 计算单条指令的 word 数（各 op_xxx 的 pc 步进与翻译器发射格式均以此为准）。
+// words 指向指令首 word，remain 为含首 word 在内的剩余 word 数；
+// 未知 opcode、计数字段越界或整条指令超出 remain 时返回 0。
+inline uint32_t instructionLength(const uint32_t* words, size_t remain) {
+    if (words == nullptr || remain == 0) {
+        return 0;
+    }
+    // 读取第 offset 个 word；越界返回 false。
+    auto wordAt = [words, remain](size_t offset, uint32_t& out) -> bool {
+        if (offset >= remain) {
+            return false;
+        }
+        out = words[offset];
+        return true;
+    };
+
+    uint64_t length = 0;
+    uint32_t count = 0;
+    switch (words[0]) {
+        // 单 word 指令。
+        case OP_END:
+        case OP_NOP:
+        case OP_PHI:
+        case OP_UNREACHABLE:
+            length = 1;
+            break;
+        // 两 word 指令。
+        case OP_BRANCH:
+        case OP_BL:
+        case OP_BRANCH_REG:
+        case OP_FENCE:
+            length = 2;
+            break;
+        // 三 word 指令。
+        case OP_LOAD_CONST:
+        case OP_ALLOC_MEMORY:
+        case OP_MOV:
+        case OP_LOAD_IMM:
+        case OP_STRLEN:
+        case OP_BITCAST:
+        case OP_FLOAT_EXTEND:
+        case OP_FLOAT_TRUNCATE:
+        case OP_BRANCH_IF_CC:
+        case OP_SET_RETURN_PC:
+            length = 3;
+            break;
+        // 四 word 指令（含全部类型特化 opcode）。
+        case OP_STORE_CONST:
+        case OP_STORE:
+        case OP_LOAD_CONST64:
+        case OP_COPY:
+        case OP_BRANCH_IF:
+        case OP_MEMCPY:
+        case OP_MEMSET:
+        case OP_GET_PTR:
+        case OP_TRUNCATE:
+        case OP_READ:
+        case OP_WRITE:
+        case OP_ADRP:
+#define VM_TYPED_LENGTH_CASE(opcode, handler, kind, binOp, width, isSigned) case opcode:
+        VM_TYPED_OPCODE_LIST(VM_TYPED_LENGTH_CASE)
+#undef VM_TYPED_LENGTH_CASE
+            length = 4;
+            break;
+        // 五 word 指令。
+        case OP_GET_ELEMENT:
+        case OP_ALLOC_RETURN:
+        case OP_GET_FIELD:
+        case OP_SET_FIELD:
+        case OP_UNARY:
+        case OP_SELECT:
+        case OP_SIGN_EXTEND:
+        case OP_ZERO_EXTEND:
+        case OP_INT_TO_FLOAT:
+        case OP_FLOAT_TO_INT:
+            length = 5;
+            break;
+        // 六 word 指令。
+        case OP_BINARY:
+        case OP_TYPE_CONVERT:
+        case OP_CMP:
+        case OP_FETCH_NEXT:
+        case OP_LEA:
+        case OP_ALLOC_VSP:
+        case OP_BINARY_IMM:
+        case OP_ATOMIC_LOAD:
+        case OP_ATOMIC_STORE:
+        case OP_ATOMIC_ADD:
+        case OP_ATOMIC_SUB:
+        case OP_ATOMIC_XCHG:
+            length = 6;
+            break;
+        // 七 word 指令。
+        case OP_ATOMIC_CAS:
+            length = 7;
+            break;
+        // 变长指令：长度由指令内计数字段决定。
+        case OP_RETURN:
+            // [opcode][has_value][value_reg?]
+            if (!wordAt(1, count)) return 0;
+            length = count ? 3 : 2;
+            break;
+        case OP_RESTORE_REG:
+            // [opcode][dst][reserved][pair_count][pairs...]
+            if (!wordAt(3, count)) return 0;
+            length = 4ull + 2ull * count;
+            break;
+        case OP_CALL:
+        case OP_CALL_INDIRECT:
+            // [opcode][type][param_count][mask][result][func][params...]
+            if (!wordAt(2, count)) return 0;
+            length = 6ull + count;
+            break;
+        case OP_DYNAMIC_CAST:
+            // [opcode][cmp][type][default][pair_count][pairs...]
+            if (!wordAt(4, count)) return 0;
+            length = 5ull + 2ull * count;
+            break;
+        case OP_SWITCH:
+            // [opcode][value][default][case_count][cases...]
+            if (!wordAt(3, count)) return 0;
+            length = 4ull + 2ull * count;
+            break;
+        case OP_ARRAY_ELEM:
+            // [opcode][dst][reserved][elem_type][dim_count][base][idx...]
+            if (!wordAt(4, count)) return 0;
+            length = count > 0 ? 6ull + count : 5ull;
+            break;
+        default:
+            // 未知 opcode：无法确定长度。
+            return 0;
+    }
+
+    // 整条指令必须完整落在剩余 word 内。
+    return length <= remain ? static_cast<uint32_t>(length) : 0u;
+}
+
+}  // namespace vmp::bytecode::protocol
@@ -91,6 +91,10 @@ constexpr uint32_t kPatchBayGnuHashCap = 128U * 1024U;
 constexpr uint32_t kPatchBaySysvHashCap = 64U * 1024U;
 constexpr uint32_t kPatchBayVersymCap = 32U * 1024U;
 
+// 合成接管跳板的直连槽位容量：第 i 个跳板（i < 容量）在 soId 字面量高 32 位携带槽位号 i+1，
+// 运行时首次按 key 分发成功后把绑定写入该槽位，之后直接执行；超出容量的跳板槽位号为 0，只走按 key 分发。
+constexpr uint32_t kTakeoverBindSlotCap = 4096U;
+
 // 派生偏移与总大小。
 constexpr uint32_t kPatchBayHeaderSize = static_cast<uint32_t>(sizeof(PatchBayHeader));
 constexpr uint32_t kPatchBayDynsymOff = kPatchBayHeaderSize;
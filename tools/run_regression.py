@@ -91,6 +91,11 @@ DEFAULT_FUNCTIONS = [
     "fun_ret_std_string_mix",
     "fun_ret_vector_mix",
 ]
+# bridge 接管调用顺序用例名（fun_add 先冷路径后直连绑定，见 zVmpBridge.cpp takeoverOrderCases）。
+TAKEOVER_ORDER_CASES = [
+    "takeover_first_call",
+    "takeover_bound_call",
+]
 def locateVmProtectExe(project_root: Path):
     # 候选路径按优先顺序：Windows exe -> 非 exe 可执行名。
     candidates = [
@@ -590,6 +595,7 @@ def patchVmEngineSymbolsWithVmProtectRoute(
     env: dict,
     origin_so: Path,
     functions,
+    native_build_props=(),
 ):
     # route4 L2 接管前置（走 VmProtect 主流程）：
     # 1) 先强制重编 native，拿到“干净” libvmengine.so；
@@ -603,8 +609,9 @@ def patchVmEngineSymbolsWithVmProtectRoute(
     removeExistingVmEngineOutputs(vmengine_dir)
 
     # 强制重建 native so，确保 patch 输入是最新编译结果。
+    # native_build_props 为额外的 -P 构建属性（如 JIT 差分自检开关）。
     runCmd(
-        ["cmd", "/c", "gradlew.bat", "externalNativeBuildDebug", "--rerun-tasks"],
+        ["cmd", "/c", "gradlew.bat", "externalNativeBuildDebug", "--rerun-tasks", *native_build_props],
         cwd=str(vmengine_dir),
         env=env,
     )
@@ -740,8 +747,17 @@ def main():
         default=30.0,
         help="Max seconds to wait while cleaning one native cache directory",
     )
+    # 是否在 vm_init 运行解释/JIT 差分自检（需重编 vmengine，故依赖 --patch-vmengine-symbols）。
+    parser.add_argument(
+        "--jit-diff-check",
+        action="store_true",
+        help="Build libvmengine.so with VM_JIT_DIFF_CHECK and require route_jit_diff result=1",
+    )
     # 解析参数。
     args = parser.parse_args()
+    # 非 patch 路线不重编 vmengine，差分自检开关无法生效。
+    if args.jit_diff_check and not args.patch_vmengine_symbols:
+        parser.error("--jit-diff-check requires --patch-vmengine-symbols")
 
     # 归一化项目根目录为绝对路径。
     root = Path(os.path.abspath(args.project_root))
@@ -797,6 +813,7 @@ def main():
             env=env,
             origin_so=origin,
             functions=args.functions,
+            native_build_props=["-PvmJitDiffCheck=true"] if args.jit_diff_check else [],
         )
         try:
             # Skip native rebuild so patched output is not overwritten.
@@ -841,6 +858,9 @@ def main():
         "VMP_DEMO: fun_global_mutable_state(",
         "VMP_DEMO: demo protect results",
     ]
+    # 差分自检：解释执行与 JIT 执行结果逐例一致。
+    if args.jit_diff_check:
+        expected_markers.append("route_jit_diff result=1")
     # 通用崩溃/链接失败 marker。
     fail_markers = [
         # vm_init 路径错误文案。
@@ -850,8 +870,19 @@ def main():
         "Fatal signal",
         "FATAL EXCEPTION",
         "UnsatisfiedLinkError",
+        # 解释/JIT 差分自检发现不一致。
+        "route_jit_diff mismatch",
     ]
 
+    # 接管调用顺序用例（bridge 在所有 fun_* 之前调用）：首次调用走未绑定的按 key 分发，第二次走直连绑定。
+    # 两行都必须出现且 status=PASS，覆盖冷路径参数寄存器被提前清零一类问题。
+    for case_name in TAKEOVER_ORDER_CASES:
+        case_lines = [line for line in log_text.splitlines() if f"VMP_DEMO: {case_name}(" in line]
+        if not case_lines:
+            expected_markers.append(f"VMP_DEMO: {case_name}(")
+        elif not all("status=PASS" in line for line in case_lines):
+            fail_markers.append(f"VMP_DEMO: {case_name}(")
+
     # 收集缺失的必需成功 marker。
     missing = [marker for marker in expected_markers if marker not in log_text]
     # 收集通用失败 marker。